@@ -20,8 +20,24 @@ void BIH::init_empty()
     m_useRemap = false;
     m_primCountCached = 0;
     // create space for the first node
-    tree.push_back(static_cast<uint32_t>(3 << 30)); // dummy leaf
-    tree.insert(tree.end(), 2, 0);
+    std::vector<uint32_t>& nodes = tree.Mutable();
+    nodes.push_back(static_cast<uint32_t>(3 << 30)); // dummy leaf
+    nodes.insert(nodes.end(), 2, 0);
+}
+
+void BIH::bindView(const G3D::AABox& treeBounds, const uint32_t* nodes, uint32_t nodeCount,
+    const uint32_t* objectIds, uint32_t objectCount, uint32_t primCount)
+{
+    bounds = treeBounds;
+    tree.clear();
+    objects.clear();
+    if (nodeCount)
+        tree.SetView(nodes, nodeCount);
+    if (objectCount)
+        objects.SetView(objectIds, objectCount);
+    m_remap.clear();
+    m_useRemap = false;
+    m_primCountCached = primCount;
 }
 
 bool BIH::readFromFile(FILE* rf)
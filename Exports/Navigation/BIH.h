@@ -7,6 +7,7 @@
 #include <limits>
 #include "AABox.h"
 #include "Ray.h"
+#include "SceneArray.h"
 
 class BIH
 {
@@ -20,6 +21,21 @@ public:
         float tfar;
     };
 
+    // Rays traced together by intersectRayPacket.
+    static const int RAY_PACKET_SIZE = 4;
+
+    // Per-ray clip intervals of a deferred subtree; mask holds the rays that
+    // still have to visit it, cull those that drop it once their hit is
+    // nearer than tnear (the rays intersectRay itself would have stacked it).
+    struct PacketStackNode
+    {
+        uint32_t node;
+        uint32_t mask;
+        uint32_t cull;
+        float tnear[RAY_PACKET_SIZE];
+        float tfar[RAY_PACKET_SIZE];
+    };
+
 public:
     BIH();
 
@@ -29,11 +45,13 @@ public:
     // indices [0..N-1] or original file IDs that are remapped to a dense range
     // during readFromFile(). All query methods (intersectRay/intersectPoint/QueryAABB)
     // will return indices already remapped to this dense [0..primCount()-1] range.
-    std::vector<uint32_t> tree;
-    std::vector<uint32_t> objects;
+    // Both arrays are owned when read from a .vmo/.vmtree and views when
+    // bound to a mapped .vmm model.
+    SceneArray<uint32_t> tree;
+    SceneArray<uint32_t> objects;
     G3D::AABox bounds;
 
-    // Default copy and move operations work fine with vectors and AABox
+    // Default copy and move operations work fine with the arrays and AABox
     BIH(const BIH&) = default;
     BIH& operator=(const BIH&) = default;
     BIH(BIH&&) = default;
@@ -47,6 +65,11 @@ public:
     // File I/O
     bool readFromFile(FILE* rf);
 
+    // Use node and object arrays that live in a mapped file (no copy). The
+    // caller keeps the mapping alive; object IDs must already be dense.
+    void bindView(const G3D::AABox& treeBounds, const uint32_t* nodes, uint32_t nodeCount,
+        const uint32_t* objectIds, uint32_t objectCount, uint32_t primCount);
+
     // Query methods
     uint32_t primCount() const { return m_primCountCached; }
     const G3D::AABox& getBounds() const { return bounds; }
@@ -56,6 +79,20 @@ public:
     void intersectRay(const G3D::Ray& r, RayCallback& intersectCallback,
         float& maxDist, bool stopAtFirst = true, bool ignoreM2Model = false) const;
 
+    // Packet ray intersection: up to RAY_PACKET_SIZE rays walk the tree
+    // together, sharing node fetches, with the slab tests of all rays done in
+    // one SSE operation. callbacks[i] and maxDist[i] belong to rays[i]. Each
+    // ray visits the same leaves in the same order as intersectRay would, so
+    // results are identical. The rays must share the signs of their direction
+    // components (same directionOctant); otherwise they are traced one by one.
+    template<typename RayCallback>
+    void intersectRayPacket(const G3D::Ray* rays, RayCallback* callbacks, float* maxDist, int count,
+        bool stopAtFirst = true, bool ignoreM2Model = false) const;
+
+    // Sign bits of a ray direction (bit 0 = x, 1 = y, 2 = z). Rays with the
+    // same octant order the children of every node the same way.
+    static uint32_t directionOctant(const G3D::Vector3& dir);
+
     // Point intersection
     template<typename IsectCallback>
     void intersectPoint(const G3D::Vector3& p, IsectCallback& intersectCallback) const;
@@ -71,6 +108,9 @@ public:
 private:
     void init_empty();
 
+    // Clips a ray to the tree bounds; false when it misses them within maxDist.
+    bool clipRayToBounds(const G3D::Ray& r, float maxDist, float& intervalMin, float& intervalMax) const;
+
     // If the file's object IDs are not a dense [0..N-1] range, we build a remap
     // from original ID -> compact index. When not needed, this stays disabled.
     std::vector<uint32_t> m_remap;       // size = maxOriginalId+1, value = compact or 0xFFFFFFFF
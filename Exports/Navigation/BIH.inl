@@ -7,20 +7,13 @@
 #include <string>
 #include <iomanip>
 #include <cmath>
+#include <xmmintrin.h>
 #include "CoordinateTransforms.h"
 
-// Ray intersection template implementation
-template<typename RayCallback>
-void BIH::intersectRay(const G3D::Ray& r, RayCallback& intersectCallback,
-    float& maxDist, bool stopAtFirstHit, bool ignoreM2Model) const
+inline bool BIH::clipRayToBounds(const G3D::Ray& r, float maxDist, float& intervalMin, float& intervalMax) const
 {
-    if (tree.empty() || objects.empty())
-    {
-        return;
-    }
-
-    float intervalMin = -1.f;
-    float intervalMax = -1.f;
+    intervalMin = -1.f;
+    intervalMax = -1.f;
     const G3D::Vector3& org = r.origin();
     const G3D::Vector3& dir = r.direction();
     const G3D::Vector3& invDir = r.invDirection();
@@ -41,18 +34,48 @@ void BIH::intersectRay(const G3D::Ray& r, RayCallback& intersectCallback,
 
             if (intervalMax <= 0 || intervalMin >= maxDist)
             {
-                return;
+                return false;
             }
         }
     }
 
     if (intervalMin > intervalMax)
     {
-        return;
+        return false;
     }
 
     intervalMin = std::max(intervalMin, 0.f);
     intervalMax = std::min(intervalMax, maxDist);
+    return true;
+}
+
+inline uint32_t BIH::directionOctant(const G3D::Vector3& dir)
+{
+    return (VMAP::floatToRawIntBits(dir.x) >> 31)
+        | ((VMAP::floatToRawIntBits(dir.y) >> 31) << 1)
+        | ((VMAP::floatToRawIntBits(dir.z) >> 31) << 2);
+}
+
+// Ray intersection template implementation
+template<typename RayCallback>
+void BIH::intersectRay(const G3D::Ray& r, RayCallback& intersectCallback,
+    float& maxDist, bool stopAtFirstHit, bool ignoreM2Model) const
+{
+    if (tree.empty() || objects.empty())
+    {
+        return;
+    }
+
+    float intervalMin;
+    float intervalMax;
+    if (!clipRayToBounds(r, maxDist, intervalMin, intervalMax))
+    {
+        return;
+    }
+
+    const G3D::Vector3& org = r.origin();
+    const G3D::Vector3& dir = r.direction();
+    const G3D::Vector3& invDir = r.invDirection();
 
     // Compute custom offsets from direction sign bit
     uint32_t offsetFront[3], offsetBack[3];
@@ -68,6 +91,10 @@ void BIH::intersectRay(const G3D::Ray& r, RayCallback& intersectCallback,
         ++offsetBack[i];
     }
 
+    // Node and object arrays may be views into a mapped .vmm file
+    const uint32_t* const nodes = tree.data();
+    const uint32_t* const objs = objects.data();
+
     // Stack for tree traversal
     StackNode stack[MAX_STACK_SIZE];
     int stackPos = 0;
@@ -82,7 +109,7 @@ void BIH::intersectRay(const G3D::Ray& r, RayCallback& intersectCallback,
         while (true)
         {
             nodesVisited++;
-            uint32_t tn = tree[node];
+            uint32_t tn = nodes[node];
             uint32_t axis = (tn >> 30) & 3;
             bool BVH2 = tn & (1 << 29);
             int offset = tn & ~(7 << 29);
@@ -92,8 +119,8 @@ void BIH::intersectRay(const G3D::Ray& r, RayCallback& intersectCallback,
                 if (axis < 3)
                 {
                     // "normal" interior node
-                    float tf = (VMAP::intBitsToFloat(tree[node + offsetFront[axis]]) - org[axis]) * invDir[axis];
-                    float tb = (VMAP::intBitsToFloat(tree[node + offsetBack[axis]]) - org[axis]) * invDir[axis];
+                    float tf = (VMAP::intBitsToFloat(nodes[node + offsetFront[axis]]) - org[axis]) * invDir[axis];
+                    float tb = (VMAP::intBitsToFloat(nodes[node + offsetBack[axis]]) - org[axis]) * invDir[axis];
 
                     // ray passes between clip zones
                     if (tf < intervalMin && tb > intervalMax)
@@ -141,12 +168,12 @@ void BIH::intersectRay(const G3D::Ray& r, RayCallback& intersectCallback,
                 {
                     // leaf - test some objects
                     leavesProcessed++;
-                    int n = tree[node + 1];
+                    int n = nodes[node + 1];
 
                     while (n > 0)
                     {
                         objectsTested++;
-                        uint32_t srcIdx = objects[offset];
+                        uint32_t srcIdx = objs[offset];
                         uint32_t objIdx = mapObjectIndex(srcIdx);
                         if (objIdx != 0xFFFFFFFFu)
                         {
@@ -176,8 +203,8 @@ void BIH::intersectRay(const G3D::Ray& r, RayCallback& intersectCallback,
                     return;
                 }
 
-                float tf = (VMAP::intBitsToFloat(tree[node + offsetFront[axis]]) - org[axis]) * invDir[axis];
-                float tb = (VMAP::intBitsToFloat(tree[node + offsetBack[axis]]) - org[axis]) * invDir[axis];
+                float tf = (VMAP::intBitsToFloat(nodes[node + offsetFront[axis]]) - org[axis]) * invDir[axis];
+                float tb = (VMAP::intBitsToFloat(nodes[node + offsetBack[axis]]) - org[axis]) * invDir[axis];
 
                 node = offset;
                 intervalMin = (tf >= intervalMin) ? tf : intervalMin;
@@ -217,6 +244,250 @@ void BIH::intersectRay(const G3D::Ray& r, RayCallback& intersectCallback,
     }
 }
 
+// Packet ray intersection template implementation. Mirrors intersectRay
+// lane by lane: every decision intersectRay makes for one ray (which children
+// to enter, how to narrow the interval, when to drop a stacked subtree) is
+// made here per lane, and a node is entered while any lane still needs it.
+template<typename RayCallback>
+void BIH::intersectRayPacket(const G3D::Ray* rays, RayCallback* callbacks, float* maxDist, int count,
+    bool stopAtFirstHit, bool ignoreM2Model) const
+{
+    if (count <= 0 || tree.empty() || objects.empty())
+    {
+        return;
+    }
+
+    const uint32_t octant = directionOctant(rays[0].direction());
+    bool coherent = count <= RAY_PACKET_SIZE;
+    for (int i = 1; coherent && i < count; ++i)
+    {
+        coherent = directionOctant(rays[i].direction()) == octant;
+    }
+    if (!coherent)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            intersectRay(rays[i], callbacks[i], maxDist[i], stopAtFirstHit, ignoreM2Model);
+        }
+        return;
+    }
+
+    // Lane data, one float per ray (unused lanes stay zero and masked off)
+    alignas(16) float org[3][RAY_PACKET_SIZE] = {};
+    alignas(16) float invDir[3][RAY_PACKET_SIZE] = {};
+    alignas(16) float intervalMin[RAY_PACKET_SIZE] = {};
+    alignas(16) float intervalMax[RAY_PACKET_SIZE] = {};
+    uint32_t live = 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (!clipRayToBounds(rays[i], maxDist[i], intervalMin[i], intervalMax[i]))
+        {
+            continue;
+        }
+        for (int a = 0; a < 3; ++a)
+        {
+            org[a][i] = rays[i].origin()[a];
+            invDir[a][i] = rays[i].invDirection()[a];
+        }
+        live |= 1u << i;
+    }
+    if (!live)
+    {
+        return;
+    }
+
+    // All lanes share the direction signs, hence the child order
+    uint32_t offsetFront[3], offsetBack[3];
+    uint32_t offsetFront3[3], offsetBack3[3];
+
+    for (int i = 0; i < 3; ++i)
+    {
+        offsetFront[i] = (octant >> i) & 1;
+        offsetBack[i] = offsetFront[i] ^ 1;
+        offsetFront3[i] = offsetFront[i] * 3;
+        offsetBack3[i] = offsetBack[i] * 3;
+        ++offsetFront[i];
+        ++offsetBack[i];
+    }
+
+    // select(m, a, b): a in lanes where m is set, b elsewhere
+    auto select = [](__m128 m, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); };
+
+    __m128 tMin = _mm_load_ps(intervalMin);
+    __m128 tMax = _mm_load_ps(intervalMax);
+    uint32_t mask = live;   // lanes traversing the current subtree
+    uint32_t done = 0;      // lanes that stopped at their first hit
+
+    // Node and object arrays may be views into a mapped .vmm file
+    const uint32_t* const nodes = tree.data();
+    const uint32_t* const objs = objects.data();
+
+    PacketStackNode stack[MAX_STACK_SIZE];
+    int stackPos = 0;
+    int node = 0;
+
+    while (true)
+    {
+        while (true)
+        {
+            uint32_t tn = nodes[node];
+            uint32_t axis = (tn >> 30) & 3;
+            bool BVH2 = tn & (1 << 29);
+            int offset = tn & ~(7 << 29);
+
+            if (!BVH2)
+            {
+                if (axis < 3)
+                {
+                    // "normal" interior node
+                    __m128 o = _mm_load_ps(org[axis]);
+                    __m128 inv = _mm_load_ps(invDir[axis]);
+                    __m128 tf = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(VMAP::intBitsToFloat(nodes[node + offsetFront[axis]])), o), inv);
+                    __m128 tb = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(VMAP::intBitsToFloat(nodes[node + offsetBack[axis]])), o), inv);
+
+                    // a lane needs the front node unless tf < intervalMin and
+                    // the back node unless tb > intervalMax
+                    uint32_t front = mask & ~static_cast<uint32_t>(_mm_movemask_ps(_mm_cmplt_ps(tf, tMin)));
+                    uint32_t back = mask & ~static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpgt_ps(tb, tMax)));
+
+                    // every lane passes between clip zones
+                    if (!(front | back))
+                    {
+                        break;
+                    }
+
+                    __m128 backMin = select(_mm_cmpge_ps(tb, tMin), tb, tMin);
+                    __m128 frontMax = select(_mm_cmple_ps(tf, tMax), tf, tMax);
+
+                    int backNode = offset + offsetBack3[axis];
+
+                    // far node only
+                    if (!front)
+                    {
+                        node = backNode;
+                        mask = back;
+                        tMin = backMin;
+                        continue;
+                    }
+
+                    // push back node for the lanes that need it
+                    if (back)
+                    {
+                        if (stackPos < MAX_STACK_SIZE)
+                        {
+                            stack[stackPos].node = backNode;
+                            stack[stackPos].mask = back;
+                            stack[stackPos].cull = front & back;
+                            _mm_storeu_ps(stack[stackPos].tnear, backMin);
+                            _mm_storeu_ps(stack[stackPos].tfar, tMax);
+                            ++stackPos;
+                        }
+                        else
+                        {
+                            return;
+                        }
+                    }
+
+                    // update lane intervals for front node
+                    node = offset + offsetFront3[axis];
+                    mask = front;
+                    tMax = frontMax;
+                    continue;
+                }
+                else
+                {
+                    // leaf - test its objects against every lane still in it
+                    int n = nodes[node + 1];
+
+                    while (n > 0)
+                    {
+                        uint32_t objIdx = mapObjectIndex(objs[offset]);
+                        if (objIdx != 0xFFFFFFFFu)
+                        {
+                            uint32_t lanes = mask & ~done;
+                            for (int i = 0; i < count; ++i)
+                            {
+                                if (!(lanes & (1u << i)))
+                                {
+                                    continue;
+                                }
+                                bool hit = callbacks[i](rays[i], objIdx, maxDist[i], stopAtFirstHit, ignoreM2Model);
+                                if (stopAtFirstHit && hit)
+                                {
+                                    done |= 1u << i;
+                                }
+                            }
+                            if (done == live)
+                            {
+                                return;
+                            }
+                        }
+                        --n;
+                        ++offset;
+                    }
+                    break;
+                }
+            }
+            else  // BVH2 node
+            {
+                if (axis > 2)
+                {
+                    return;
+                }
+
+                __m128 o = _mm_load_ps(org[axis]);
+                __m128 inv = _mm_load_ps(invDir[axis]);
+                __m128 tf = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(VMAP::intBitsToFloat(nodes[node + offsetFront[axis]])), o), inv);
+                __m128 tb = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(VMAP::intBitsToFloat(nodes[node + offsetBack[axis]])), o), inv);
+
+                node = offset;
+                tMin = select(_mm_cmpge_ps(tf, tMin), tf, tMin);
+                tMax = select(_mm_cmple_ps(tb, tMax), tb, tMax);
+
+                mask &= ~static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpgt_ps(tMin, tMax)));
+                if (!mask)
+                {
+                    break;
+                }
+
+                continue;
+            }
+        } // traversal loop
+
+        do
+        {
+            // stack is empty?
+            if (stackPos == 0)
+            {
+                return;
+            }
+
+            // move back up the stack; lanes that stacked the subtree drop it
+            // when their hit is already nearer
+            --stackPos;
+            tMin = _mm_loadu_ps(stack[stackPos].tnear);
+            mask = stack[stackPos].mask & ~done;
+            for (int i = 0; i < count; ++i)
+            {
+                if ((stack[stackPos].cull & (1u << i)) && maxDist[i] < stack[stackPos].tnear[i])
+                {
+                    mask &= ~(1u << i);
+                }
+            }
+            if (!mask)
+            {
+                continue;
+            }
+
+            node = stack[stackPos].node;
+            tMax = _mm_loadu_ps(stack[stackPos].tfar);
+
+            break;
+        } while (true);
+    }
+}
+
 // Point intersection template implementation
 template<typename IsectCallback>
 void BIH::intersectPoint(const G3D::Vector3& p, IsectCallback& intersectCallback) const
@@ -226,6 +497,10 @@ void BIH::intersectPoint(const G3D::Vector3& p, IsectCallback& intersectCallback
         return;
     }
 
+    // Node and object arrays may be views into a mapped .vmm file
+    const uint32_t* const nodes = tree.data();
+    const uint32_t* const objs = objects.data();
+
     StackNode stack[MAX_STACK_SIZE];
     int stackPos = 0;
     int node = 0;
@@ -238,7 +513,7 @@ void BIH::intersectPoint(const G3D::Vector3& p, IsectCallback& intersectCallback
         while (true)
         {
             nodesVisited++;
-            uint32_t tn = tree[node];
+            uint32_t tn = nodes[node];
             uint32_t axis = (tn >> 30) & 3;
             bool const BVH2 = tn & (1 << 29);
             int offset = tn & ~(7 << 29);
@@ -248,8 +523,8 @@ void BIH::intersectPoint(const G3D::Vector3& p, IsectCallback& intersectCallback
                 if (axis < 3)
                 {
                     // "normal" interior node
-                    float tl = VMAP::intBitsToFloat(tree[node + 1]);
-                    float tr = VMAP::intBitsToFloat(tree[node + 2]);
+                    float tl = VMAP::intBitsToFloat(nodes[node + 1]);
+                    float tr = VMAP::intBitsToFloat(nodes[node + 2]);
 
                     // point is between clip zones
                     if (tl < p[axis] && tr > p[axis])
@@ -287,12 +562,12 @@ void BIH::intersectPoint(const G3D::Vector3& p, IsectCallback& intersectCallback
                 else
                 {
                     leavesChecked++;
-                    int n = tree[node + 1];
+                    int n = nodes[node + 1];
                     uint32_t off = offset;
                     while (n > 0)
                     {
                         objectsTested++;
-                        uint32_t srcIdx = objects[off];
+                        uint32_t srcIdx = objs[off];
                         uint32_t objIdx = mapObjectIndex(srcIdx);
                         if (objIdx != 0xFFFFFFFFu)
                         {
@@ -310,8 +585,8 @@ void BIH::intersectPoint(const G3D::Vector3& p, IsectCallback& intersectCallback
                     return;
                 }
 
-                float tl = VMAP::intBitsToFloat(tree[node + 1]);
-                float tr = VMAP::intBitsToFloat(tree[node + 2]);
+                float tl = VMAP::intBitsToFloat(nodes[node + 1]);
+                float tr = VMAP::intBitsToFloat(nodes[node + 2]);
 
                 node = offset;
 
@@ -348,6 +623,10 @@ inline bool BIH::QueryAABB(const G3D::AABox& query, uint32_t* outIndices, uint32
     if (maxCount == 0 || outIndices == nullptr) {
         return false; }
 
+    // Node and object arrays may be views into a mapped .vmm file
+    const uint32_t* const nodes = tree.data();
+    const uint32_t* const objs = objects.data();
+
     // Traversal stack
     StackNode stack[MAX_STACK_SIZE];
     int stackPos = 0;
@@ -363,7 +642,7 @@ inline bool BIH::QueryAABB(const G3D::AABox& query, uint32_t* outIndices, uint32
         while (true)
         {
             ++nodesVisited;
-            uint32_t tn = tree[node];
+            uint32_t tn = nodes[node];
             uint32_t axis = (tn >> 30) & 3;
             bool const BVH2 = tn & (1 << 29);
             uint32_t offset = tn & ~(7u << 29);
@@ -373,8 +652,8 @@ inline bool BIH::QueryAABB(const G3D::AABox& query, uint32_t* outIndices, uint32
                 if (axis < 3)
                 {
                     // interior node with clipping planes
-                    float tl = VMAP::intBitsToFloat(tree[node + 1]);
-                    float tr = VMAP::intBitsToFloat(tree[node + 2]);
+                    float tl = VMAP::intBitsToFloat(nodes[node + 1]);
+                    float tr = VMAP::intBitsToFloat(nodes[node + 2]);
 
                     bool goLeft = query.low()[axis] <= tr;   // overlaps left if min <= right clip
                     bool goRight = query.high()[axis] >= tl; // overlaps right if max >= left clip
@@ -416,11 +695,11 @@ inline bool BIH::QueryAABB(const G3D::AABox& query, uint32_t* outIndices, uint32
                 else
                 {
                     ++leavesVisited;
-                    uint32_t n = tree[node + 1];
+                    uint32_t n = nodes[node + 1];
                     uint32_t off = offset;
                     while (n > 0)
                     {
-                        uint32_t srcIdx = objects[off];
+                        uint32_t srcIdx = objs[off];
                         uint32_t objIdx = mapObjectIndex(srcIdx);
                         if (objIdx != 0xFFFFFFFFu)
                         {
@@ -447,8 +726,8 @@ inline bool BIH::QueryAABB(const G3D::AABox& query, uint32_t* outIndices, uint32
                     return outCount > 0;
                 }
 
-                float tl = VMAP::intBitsToFloat(tree[node + 1]);
-                float tr = VMAP::intBitsToFloat(tree[node + 2]);
+                float tl = VMAP::intBitsToFloat(nodes[node + 1]);
+                float tr = VMAP::intBitsToFloat(nodes[node + 2]);
 
                 if (query.low()[axis] <= tr && query.high()[axis] >= tl)
                 {
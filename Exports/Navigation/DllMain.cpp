@@ -10,6 +10,8 @@
 #include "MapLoader.h"
 #include "SceneQuery.h"
 #include "SceneCache.h"
+#include "SceneTileStreamer.h"
+#include "WorldModelStore.h"
 #include "DynamicObjectRegistry.h"
 #ifndef PHYSICS_DLL_ONLY
 #include "DetourPathCorridor.h"
@@ -284,7 +286,8 @@ extern "C" __declspec(dllexport) void PreloadMap(uint32_t mapId)
 
 // Inject scene triangles into the SceneCache for a map.
 // Called by the bot client after receiving scene data from SceneDataService.
-// The triangles are added to (or replace) the existing SceneCache for this map.
+// The triangles replace the existing SceneCache for this map (see
+// InjectSceneTile for per-tile merging).
 extern "C" __declspec(dllexport) bool InjectSceneTriangles(
     uint32_t mapId,
     float minX, float minY, float maxX, float maxY,
@@ -304,7 +307,7 @@ extern "C" __declspec(dllexport) bool InjectSceneTriangles(
         cache->mapId = mapId;
         cache->InjectTriangles(minX, minY, maxX, maxY, triangles, triangleCount);
 
-        // Replace or merge into the existing scene cache
+        // Replace the existing scene cache
         SceneQuery::SetSceneCache(mapId, cache);
         return true;
     }
@@ -314,6 +317,114 @@ extern "C" __declspec(dllexport) bool InjectSceneTriangles(
     }
 }
 
+// Inject one ADT tile of scene triangles for a map. Unlike InjectSceneTriangles,
+// tiles injected earlier stay in place and are not re-indexed; injecting the
+// same tile again replaces just that tile. Queries running on other threads
+// keep the previous view until they finish.
+extern "C" __declspec(dllexport) bool InjectSceneTile(
+    uint32_t mapId,
+    int tileX, int tileY,
+    float minX, float minY, float maxX, float maxY,
+    const SceneCache::InjectedTriangle* triangles,
+    int triangleCount)
+{
+    try
+    {
+        if (!g_initialized)
+            InitializeAllSystems();
+
+        if (!triangles || triangleCount <= 0)
+            return false;
+
+        auto* tile = new SceneCache();
+        tile->mapId = mapId;
+        tile->InjectTriangles(minX, minY, maxX, maxY, triangles, triangleCount);
+
+        SceneQuery::InjectSceneTile(mapId, tileX, tileY, tile);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+// Counter bumped whenever mapId's published scene cache is replaced, re-tiled
+// or cleared. A client that injects tiles records it after each of its own
+// changes; a different value means someone else touched the map.
+extern "C" __declspec(dllexport) uint64_t GetSceneGeneration(uint32_t mapId)
+{
+    try
+    {
+        return SceneQuery::GetSceneGeneration(mapId);
+    }
+    catch (...)
+    {
+        return 0;
+    }
+}
+
+// True while the tile added with InjectSceneTile is still part of the map's
+// scene cache (a clear, a file load or InjectSceneTriangles drops it).
+extern "C" __declspec(dllexport) bool IsSceneTileInjected(uint32_t mapId, int tileX, int tileY)
+{
+    try
+    {
+        return SceneQuery::HasInjectedSceneTile(mapId, tileX, tileY);
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+// Drop one tile previously added with InjectSceneTile. Returns false when the
+// tile was not injected.
+extern "C" __declspec(dllexport) bool EvictSceneTile(uint32_t mapId, int tileX, int tileY)
+{
+    try
+    {
+        return SceneQuery::EvictSceneTile(mapId, tileX, tileY);
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+// Rewrite every older .scene (and tiles/*.scenetile) in scenesDir in the
+// current mappable format. Offline only (tools/NavDataConvert): the runtime
+// never rewrites scene files other processes may be mapping. Returns the
+// number of files rewritten, or -1 when the directory does not exist.
+extern "C" __declspec(dllexport) int ConvertSceneCaches(const char* scenesDir)
+{
+    try
+    {
+        return SceneCache::ConvertDirectory(scenesDir);
+    }
+    catch (...)
+    {
+        return -1;
+    }
+}
+
+// Write a memory-mappable .vmm beside every .vmo in vmapsDir. Offline only
+// (tools/NavDataConvert), after VMAP data changes. Returns the number of
+// models converted, or -1 when the directory does not exist.
+extern "C" __declspec(dllexport) int ConvertVmapModels(const char* vmapsDir)
+{
+    try
+    {
+        if (!vmapsDir)
+            return -1;
+        return VMAP::WorldModelStore::ConvertDirectory(vmapsDir);
+    }
+    catch (...)
+    {
+        return -1;
+    }
+}
+
 // Query AABB terrain contacts for a region — used by SceneDataService.
 struct ExportedAABBContact
 {
@@ -382,6 +493,170 @@ extern "C" __declspec(dllexport) void ClearSceneCache(uint32_t mapId)
     catch (...) {}
 }
 
+// Per-map byte budget for streamed scene tiles (0 restores the default).
+// Least-recently-used tiles beyond the budget are unloaded.
+extern "C" __declspec(dllexport) void SetSceneTileMemoryBudget(uint64_t bytes)
+{
+    try
+    {
+        SceneQuery::SetSceneTileMemoryBudget(static_cast<size_t>(bytes));
+    }
+    catch (...) {}
+}
+
+struct SceneTileMemoryStats
+{
+    uint64_t tileCount;
+    uint64_t residentBytes;
+    uint64_t budget;
+    uint64_t missingTiles;
+    uint64_t loads;
+    uint64_t evictions;
+};
+
+// Streamed scene tiles of a map: resident count and bytes against the
+// budget, tiles found to have no file, loads and evictions. False when the
+// map is not streamed from .scenetile files.
+extern "C" __declspec(dllexport) bool GetSceneTileMemoryStats(uint32_t mapId, SceneTileMemoryStats* out)
+{
+    if (!out)
+        return false;
+    try
+    {
+        auto cache = SceneQuery::GetSceneCache(mapId);
+        if (!cache || !cache->IsStreamed())
+            return false;
+        SceneTileStreamer::Stats stats = cache->GetStreamer()->GetStats();
+        out->tileCount = stats.residentTiles;
+        out->residentBytes = stats.residentBytes;
+        out->budget = stats.budget;
+        out->missingTiles = stats.missingTiles;
+        out->loads = stats.loads;
+        out->evictions = stats.evictions;
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+// Queue background loads of the streamed scene tiles around (x, y) and
+// along the velocity lookahead, as PhysicsStepV2 does for each bot.
+extern "C" __declspec(dllexport) void PrefetchSceneTiles(uint32_t mapId, float x, float y, float vx, float vy)
+{
+    try
+    {
+        SceneQuery::PrefetchSceneTiles(mapId, x, y, vx, vy);
+    }
+    catch (...) {}
+}
+
+// Byte budget for loaded ADT (.map) tiles (0 restores the default).
+// Least-recently-used tiles beyond the budget are unloaded.
+extern "C" __declspec(dllexport) void SetMapTileMemoryBudget(uint64_t bytes)
+{
+    try
+    {
+        SceneQuery::SetMapTileMemoryBudget(static_cast<size_t>(bytes));
+    }
+    catch (...) {}
+}
+
+struct MapTileMemoryStats
+{
+    uint64_t tileCount;
+    uint64_t residentBytes;
+    uint64_t budget;
+    uint64_t loads;
+    uint64_t evictions;
+};
+
+// Loaded ADT tile count and memory against the budget. False when no
+// MapLoader has been created yet.
+extern "C" __declspec(dllexport) bool GetMapTileMemoryStats(MapTileMemoryStats* out)
+{
+    if (!out)
+        return false;
+    try
+    {
+        MapLoader* loader = SceneQuery::GetMapLoader();
+        if (!loader)
+            return false;
+        MapLoader::MemoryStats stats = loader->GetMemoryStats();
+        out->tileCount = stats.tileCount;
+        out->residentBytes = stats.residentBytes;
+        out->budget = stats.budget;
+        out->loads = stats.loads;
+        out->evictions = stats.evictions;
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+// Byte budget for the models held by loaded VMAP tiles (0 = no limit, the
+// default). Tiles no bot is near are unloaded least-recently-used beyond it.
+extern "C" __declspec(dllexport) void SetVmapTileMemoryBudget(uint64_t bytes)
+{
+    try
+    {
+        std::lock_guard<std::recursive_mutex> lock(g_navigationMutex);
+        if (g_vmapManager)
+            g_vmapManager->setTileMemoryBudget(static_cast<size_t>(bytes));
+    }
+    catch (...) {}
+}
+
+// How long the tiles around an agent stay pinned after its last step, in
+// milliseconds (default one minute; 0 = until ReleasePhysicsAgent).
+extern "C" __declspec(dllexport) void SetVmapTilePinTimeout(uint32_t milliseconds)
+{
+    try
+    {
+        std::lock_guard<std::recursive_mutex> lock(g_navigationMutex);
+        if (g_vmapManager)
+            g_vmapManager->setBotTilePinTimeout(milliseconds);
+    }
+    catch (...) {}
+}
+
+struct VmapTileMemoryStats
+{
+    uint64_t tileCount;
+    uint64_t pinnedTiles;
+    uint64_t residentBytes;
+    uint64_t budget;
+    uint64_t evictions;
+};
+
+// Loaded VMAP tiles, the tiles bots pin and their model bytes against the
+// budget. False before the VMAP system is initialized.
+extern "C" __declspec(dllexport) bool GetVmapTileMemoryStats(VmapTileMemoryStats* out)
+{
+    if (!out)
+        return false;
+    try
+    {
+        std::lock_guard<std::recursive_mutex> lock(g_navigationMutex);
+        if (!g_vmapManager)
+            return false;
+        VMAP::VMapManager2::TileResidencyStats stats = g_vmapManager->getTileResidencyStats();
+        out->tileCount = stats.residentTiles;
+        out->pinnedTiles = stats.pinnedTiles;
+        out->residentBytes = stats.residentBytes;
+        out->budget = stats.budget;
+        out->evictions = stats.evictions;
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
 // No-op: kept as exported symbol for backward compat with test P/Invoke declarations.
 // BG bots now load Physics.dll (PHYSICS_DLL_ONLY) which strips mmaps/VMAPs.
 extern "C" __declspec(dllexport) void SetSceneSliceMode(bool) {}
@@ -762,17 +1037,40 @@ static PhysicsOutput MakePassthroughOutput(const PhysicsInput& input)
     return output;
 }
 
-static PhysicsOutput PhysicsStepV2Inner(const PhysicsInput& input)
+// Transport time a step spans, for TransportTimeScope.
+static uint32_t StepIntervalMs(const PhysicsInput& input)
+{
+    if (!(input.deltaTime > 0.0f))
+        return 0;
+    return static_cast<uint32_t>(std::ceil(std::min(input.deltaTime, 60.0f) * 1000.0f));
+}
+
+// agentId != 0 steps through the agent's contact cache (same results).
+static PhysicsOutput PhysicsStepV2Inner(const PhysicsInput& input, uint64_t agentId = 0)
 {
     if (!g_initialized)
         InitializeAllSystems();
 
     std::lock_guard<std::recursive_mutex> lock(g_navigationMutex);
 
+    // Streamed maps: start loading the tiles this bot is heading into
+    SceneQuery::PrefetchSceneTiles(input.mapId, input.x, input.y, input.vx, input.vy);
+
+    PhysicsOutput output;
     if (auto* physics = PhysicsEngine::Instance())
-        return physics->StepV2(input, input.deltaTime);
+        output = agentId != 0 ? physics->StepV2ForAgent(agentId, input, input.deltaTime)
+                              : physics->StepV2(input, input.deltaTime);
+    else
+        output = MakePassthroughOutput(input);
 
-    return MakePassthroughOutput(input);
+    // VMAP residency: keep the tiles around this bot loaded and, with no
+    // query running under the lock, let idle tiles go once over budget
+    if (g_vmapManager)
+    {
+        g_vmapManager->updateBotTiles(agentId, input.mapId, input.x, input.y);
+        g_vmapManager->trimTileResidency();
+    }
+    return output;
 }
 
 extern "C" __declspec(dllexport) PhysicsOutput PhysicsStepV2(const PhysicsInput& input)
@@ -790,6 +1088,88 @@ extern "C" __declspec(dllexport) PhysicsOutput PhysicsStepV2(const PhysicsInput&
     }
 }
 
+// PhysicsStepV2 for a bot that steps every tick: agentId (its GUID) keys a
+// cache of the collision geometry around it, reused while the bot stays in
+// the cached area. Output is identical to PhysicsStepV2.
+extern "C" __declspec(dllexport) PhysicsOutput PhysicsStepV2ForAgent(uint64_t agentId, const PhysicsInput& input)
+{
+    try
+    {
+        return PhysicsStepV2Inner(input, agentId);
+    }
+    catch (...)
+    {
+        OutputDebugStringA("[Navigation.dll] SEH exception in PhysicsStepV2ForAgent\n");
+        fprintf(stderr, "[Navigation.dll] SEH exception in PhysicsStepV2ForAgent\n");
+        return MakePassthroughOutput(input);
+    }
+}
+
+// PhysicsStepV2 / PhysicsStepV2ForAgent (agentId 0 for the former) with
+// timeline-driven transports posed at transportTimeMs, the server time of
+// this step. Steps given the same time see the same transport collision.
+// The step covers [transportTimeMs, transportTimeMs + deltaTime]: transports
+// whose path stays clear of the bot over that span do not keep it awake.
+extern "C" __declspec(dllexport) PhysicsOutput PhysicsStepV2AtTime(uint64_t agentId, const PhysicsInput& input,
+                                                                   uint64_t transportTimeMs)
+{
+    try
+    {
+        DynamicObjectRegistry::TransportTimeScope transportTime(transportTimeMs, StepIntervalMs(input));
+        return PhysicsStepV2Inner(input, agentId);
+    }
+    catch (...)
+    {
+        OutputDebugStringA("[Navigation.dll] SEH exception in PhysicsStepV2AtTime\n");
+        fprintf(stderr, "[Navigation.dll] SEH exception in PhysicsStepV2AtTime\n");
+        return MakePassthroughOutput(input);
+    }
+}
+
+// PhysicsStepV2AtTime for a bot inside one instance of input.mapId (dungeon,
+// battleground): dynamic objects registered into other instances of the map
+// do not collide with it. Instance 0 is the open world.
+extern "C" __declspec(dllexport) PhysicsOutput PhysicsStepV2InInstance(uint64_t agentId, const PhysicsInput& input,
+                                                                       uint32_t mapInstanceId, uint64_t transportTimeMs)
+{
+    try
+    {
+        DynamicObjectRegistry::MapInstanceScope mapInstance(mapInstanceId);
+        DynamicObjectRegistry::TransportTimeScope transportTime(transportTimeMs, StepIntervalMs(input));
+        return PhysicsStepV2Inner(input, agentId);
+    }
+    catch (...)
+    {
+        OutputDebugStringA("[Navigation.dll] SEH exception in PhysicsStepV2InInstance\n");
+        fprintf(stderr, "[Navigation.dll] SEH exception in PhysicsStepV2InInstance\n");
+        return MakePassthroughOutput(input);
+    }
+}
+
+// Drop an agent's cached geometry (bot logged out / left the world).
+extern "C" __declspec(dllexport) void ReleasePhysicsAgent(uint64_t agentId)
+{
+    try
+    {
+        std::lock_guard<std::recursive_mutex> lock(g_navigationMutex);
+        if (auto* physics = PhysicsEngine::Instance())
+            physics->ReleaseAgent(agentId);
+        if (g_vmapManager)
+            g_vmapManager->releaseBotTiles(agentId);
+    }
+    catch (...)
+    {
+        fprintf(stderr, "[Navigation.dll] exception in ReleasePhysicsAgent\n");
+    }
+}
+
+// Number of steps answered by the resting fast path (diagnostics).
+extern "C" __declspec(dllexport) uint64_t GetRestingStepHitCount()
+{
+    auto* physics = PhysicsEngine::Instance();
+    return physics ? physics->GetRestingHitCount() : 0;
+}
+
 extern "C" __declspec(dllexport) void SetPhysicsLogLevel(int level, uint32_t mask)
 {
     gPhysLogLevel = level;
@@ -831,6 +1211,99 @@ extern "C" __declspec(dllexport) float GetWalkableGroundZ(uint32_t mapId, float
     return SceneQuery::GetWalkableGroundZ(mapId, x, y, z, maxSearchDist, walkableMinNormalZ);
 }
 
+// ---------------------------------------------------------------------------
+// Batched ground / line-of-sight queries. One call validates a whole path or
+// audits a tile: outZ[i] / outClear[i] match what GetGroundZ /
+// GetWalkableGroundZ / LineOfSight return for element i. Returns false on
+// bad arguments or an exception (outputs are then unspecified).
+// ---------------------------------------------------------------------------
+
+static std::vector<G3D::Vector3> ToVectors(const XYZ* points, int count)
+{
+    std::vector<G3D::Vector3> out(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i)
+        out[i] = G3D::Vector3(points[i].X, points[i].Y, points[i].Z);
+    return out;
+}
+
+extern "C" __declspec(dllexport) bool GetGroundZBatch(uint32_t mapId, const XYZ* points, int count,
+                                                      float maxSearchDist, float* outZ)
+{
+    if (!points || !outZ || count < 0)
+        return false;
+
+    try
+    {
+        if (!g_initialized)
+            InitializeAllSystems();
+
+        std::lock_guard<std::recursive_mutex> lock(g_navigationMutex);
+
+        const std::vector<G3D::Vector3> pts = ToVectors(points, count);
+        SceneQuery::GetGroundZBatch(mapId, pts.data(), count, maxSearchDist, outZ);
+        return true;
+    }
+    catch (...)
+    {
+        fprintf(stderr, "[Navigation.dll] exception in GetGroundZBatch (count=%d)\n", count);
+        return false;
+    }
+}
+
+extern "C" __declspec(dllexport) bool GetWalkableGroundZBatch(uint32_t mapId, const XYZ* points, int count,
+                                                              float maxSearchDist, float walkableMinNormalZ,
+                                                              float* outZ)
+{
+    if (!points || !outZ || count < 0)
+        return false;
+
+    try
+    {
+        if (!g_initialized)
+            InitializeAllSystems();
+
+        std::lock_guard<std::recursive_mutex> lock(g_navigationMutex);
+
+        const std::vector<G3D::Vector3> pts = ToVectors(points, count);
+        SceneQuery::GetWalkableGroundZBatch(mapId, pts.data(), count, maxSearchDist, walkableMinNormalZ, outZ);
+        return true;
+    }
+    catch (...)
+    {
+        fprintf(stderr, "[Navigation.dll] exception in GetWalkableGroundZBatch (count=%d)\n", count);
+        return false;
+    }
+}
+
+// outClear[i] = 1 when segment from[i] -> to[i] is unobstructed, else 0.
+extern "C" __declspec(dllexport) bool LineOfSightBatch(uint32_t mapId, const XYZ* from, const XYZ* to, int count,
+                                                       uint8_t* outClear)
+{
+    if (!from || !to || !outClear || count < 0)
+        return false;
+
+    try
+    {
+        if (!g_initialized)
+            InitializeAllSystems();
+
+        std::lock_guard<std::recursive_mutex> lock(g_navigationMutex);
+
+        const std::vector<G3D::Vector3> starts = ToVectors(from, count);
+        const std::vector<G3D::Vector3> ends = ToVectors(to, count);
+        std::unique_ptr<bool[]> clear(new bool[static_cast<size_t>(count)]);
+        SceneQuery::LineOfSightBatch(mapId, starts.data(), ends.data(), count, clear.get());
+        for (int i = 0; i < count; ++i)
+            outClear[i] = clear[i] ? 1u : 0u;
+        return true;
+    }
+    catch (...)
+    {
+        fprintf(stderr, "[Navigation.dll] exception in LineOfSightBatch (count=%d)\n", count);
+        return false;
+    }
+}
+
 // Möller–Trumbore segment-triangle intersection.
 // Returns true if segment (p0→p1) intersects triangle (a, b, c).
 static bool SegmentIntersectsTriangle(
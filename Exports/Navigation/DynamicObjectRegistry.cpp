@@ -1,5 +1,6 @@
 #include "DynamicObjectRegistry.h"
 #include "WorldModel.h"
+#include "WorldModelStore.h"
 #include <cmath>
 #include <cstdio>
 #include <algorithm>
@@ -47,6 +48,53 @@ bool SegmentTriangleIntersectionT(
 
     return true;
 }
+
+G3D::AABox TriangleBounds(const G3D::Vector3& a, const G3D::Vector3& b, const G3D::Vector3& c)
+{
+    return G3D::AABox(a.min(b).min(c), a.max(b).max(c));
+}
+
+// Triangle bounds against the box; touching counts as overlapping.
+bool TriangleOverlapsBox(const CapsuleCollision::Triangle& tri, const G3D::AABox& box)
+{
+    const float minX = std::min(std::min(tri.a.x, tri.b.x), tri.c.x);
+    const float maxX = std::max(std::max(tri.a.x, tri.b.x), tri.c.x);
+    if (maxX < box.low().x || minX > box.high().x) return false;
+    const float minY = std::min(std::min(tri.a.y, tri.b.y), tri.c.y);
+    const float maxY = std::max(std::max(tri.a.y, tri.b.y), tri.c.y);
+    if (maxY < box.low().y || minY > box.high().y) return false;
+    const float minZ = std::min(std::min(tri.a.z, tri.b.z), tri.c.z);
+    const float maxZ = std::max(std::max(tri.a.z, tri.b.z), tri.c.z);
+    if (maxZ < box.low().z || minZ > box.high().z) return false;
+    return true;
+}
+
+// Slab test: does p0 + t * dir, t in [0, 1], pass through [lo, hi]?
+bool SegmentOverlapsBox(const G3D::Vector3& p0, const G3D::Vector3& dir,
+                        const G3D::Vector3& lo, const G3D::Vector3& hi)
+{
+    float tMin = 0.0f;
+    float tMax = 1.0f;
+    for (int a = 0; a < 3; ++a)
+    {
+        if (fabsf(dir[a]) < 1e-12f)
+        {
+            if (p0[a] < lo[a] || p0[a] > hi[a])
+                return false;
+            continue;
+        }
+        const float inv = 1.0f / dir[a];
+        float t0 = (lo[a] - p0[a]) * inv;
+        float t1 = (hi[a] - p0[a]) * inv;
+        if (t0 > t1)
+            std::swap(t0, t1);
+        tMin = std::max(tMin, t0);
+        tMax = std::min(tMax, t1);
+        if (tMin > tMax)
+            return false;
+    }
+    return true;
+}
 }
 
 DynamicObjectRegistry* DynamicObjectRegistry::s_instance = nullptr;
@@ -58,6 +106,54 @@ DynamicObjectRegistry* DynamicObjectRegistry::Instance()
     return s_instance;
 }
 
+DynamicObjectRegistry::MapShard* DynamicObjectRegistry::FindShard(uint64_t key) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_shardsMutex);
+    auto it = m_shards.find(key);
+    return it != m_shards.end() ? it->second.get() : nullptr;
+}
+
+DynamicObjectRegistry::MapShard& DynamicObjectRegistry::GetOrCreateShard(uint64_t key) const
+{
+    if (MapShard* shard = FindShard(key))
+        return *shard;
+
+    std::unique_lock<std::shared_mutex> lock(m_shardsMutex);
+    auto& world = m_shards[ShardKey(ShardMapId(key), 0)];
+    if (!world)
+        world = std::make_unique<MapShard>();
+    auto& slot = m_shards[key];
+    if (!slot)
+    {
+        slot = std::make_unique<MapShard>();
+        slot->worldShard = world.get();
+    }
+    return *slot;
+}
+
+const DynamicObjectRegistry::MapShard* DynamicObjectRegistry::QueryShard(uint32_t mapId) const
+{
+    const uint32_t mapInstanceId = CurrentMapInstance();
+    if (const MapShard* shard = FindShard(ShardKey(mapId, mapInstanceId)))
+        return shard;
+    // An instance nothing was registered in still sees the map's variant pools.
+    if (mapInstanceId == 0 || !FindShard(ShardKey(mapId, 0)))
+        return nullptr;
+    return &GetOrCreateShard(ShardKey(mapId, mapInstanceId));
+}
+
+template<typename QueryFn>
+void DynamicObjectRegistry::RunShardQuery(const MapShard& shard, QueryFn&& query)
+{
+    // Writers only ever lock one shard, so taking the world shard second
+    // cannot deadlock.
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    std::shared_lock<std::shared_mutex> worldLock;
+    if (shard.worldShard != &shard)
+        worldLock = std::shared_lock<std::shared_mutex>(shard.worldShard->mutex);
+    query();
+}
+
 uint32_t DynamicObjectRegistry::AllocateRuntimeInstanceId()
 {
     if (m_nextRuntimeInstanceId < 0x80000001u)
@@ -76,7 +172,7 @@ uint32_t DynamicObjectRegistry::AllocateRuntimeInstanceId()
 
 bool DynamicObjectRegistry::LoadDisplayIdMapping(const std::string& vmapsBasePath)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<std::mutex> lock(m_modelMutex);
 
     if (m_mappingLoaded) return true;
     m_vmapsBasePath = vmapsBasePath;
@@ -128,6 +224,137 @@ bool DynamicObjectRegistry::LoadDisplayIdMapping(const std::string& vmapsBasePat
     return count > 0;
 }
 
+// ==========================================================================
+// Mesh BVH
+// ==========================================================================
+
+std::vector<uint32_t> DynamicObjectRegistry::BuildMeshBvh(const std::vector<G3D::AABox>& triBounds,
+                                                          std::vector<MeshBvhNode>& outNodes)
+{
+    std::vector<uint32_t> order(triBounds.size());
+    for (uint32_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+
+    outNodes.clear();
+    if (triBounds.empty())
+        return order;
+
+    std::vector<G3D::Vector3> centers(triBounds.size());
+    for (size_t i = 0; i < triBounds.size(); ++i)
+        centers[i] = (triBounds[i].low() + triBounds[i].high()) * 0.5f;
+
+    // Top-down median split on the widest centroid axis, as in
+    // SceneCache::BuildStackedBvh. Children are allocated as a pair and the
+    // left half of each range goes to the left child, so leaves come out in
+    // range order.
+    struct BuildItem { uint32_t node, begin, end; };
+    std::vector<BuildItem> stack;
+    outNodes.reserve(2 * (triBounds.size() / MESH_BVH_LEAF_SIZE + 1));
+    outNodes.push_back(MeshBvhNode{});
+    stack.push_back({ 0, 0, static_cast<uint32_t>(order.size()) });
+
+    while (!stack.empty())
+    {
+        BuildItem item = stack.back();
+        stack.pop_back();
+
+        G3D::Vector3 lo = triBounds[order[item.begin]].low();
+        G3D::Vector3 hi = triBounds[order[item.begin]].high();
+        G3D::Vector3 cLo = centers[order[item.begin]];
+        G3D::Vector3 cHi = cLo;
+        for (uint32_t i = item.begin + 1; i < item.end; ++i)
+        {
+            const G3D::AABox& b = triBounds[order[i]];
+            lo = lo.min(b.low());
+            hi = hi.max(b.high());
+            cLo = cLo.min(centers[order[i]]);
+            cHi = cHi.max(centers[order[i]]);
+        }
+
+        MeshBvhNode& node = outNodes[item.node];
+        node.minX = lo.x; node.minY = lo.y; node.minZ = lo.z;
+        node.maxX = hi.x; node.maxY = hi.y; node.maxZ = hi.z;
+
+        int axis = 0;
+        for (int a = 1; a < 3; ++a)
+            if (cHi[a] - cLo[a] > cHi[axis] - cLo[axis])
+                axis = a;
+
+        const uint32_t n = item.end - item.begin;
+        if (n <= MESH_BVH_LEAF_SIZE || cHi[axis] - cLo[axis] < 1e-4f)
+        {
+            node.first = item.begin;
+            node.count = n;
+            continue;
+        }
+
+        const uint32_t mid = item.begin + n / 2;
+        std::nth_element(order.begin() + item.begin, order.begin() + mid, order.begin() + item.end,
+            [&](uint32_t a, uint32_t b) { return centers[a][axis] < centers[b][axis]; });
+
+        const uint32_t left = static_cast<uint32_t>(outNodes.size());
+        node.first = left;
+        node.count = 0;
+        outNodes.push_back(MeshBvhNode{});
+        outNodes.push_back(MeshBvhNode{});
+        stack.push_back({ left, item.begin, mid });
+        stack.push_back({ left + 1, mid, item.end });
+    }
+    return order;
+}
+
+template<typename EnterFn, typename LeafFn>
+void DynamicObjectRegistry::WalkMeshBvh(const std::vector<MeshBvhNode>& nodes, EnterFn&& enter, LeafFn&& leaf)
+{
+    if (nodes.empty())
+        return;
+
+    uint32_t stack[64];
+    int stackPos = 0;
+    stack[stackPos++] = 0;
+
+    while (stackPos > 0)
+    {
+        const MeshBvhNode& node = nodes[stack[--stackPos]];
+        if (!enter(node))
+            continue;
+
+        if (node.count == 0)
+        {
+            if (stackPos + 2 > 64)
+                continue; // cannot happen with median splits, but never overflow
+            stack[stackPos++] = node.first + 1;
+            stack[stackPos++] = node.first;
+            continue;
+        }
+        leaf(node.first, node.count);
+    }
+}
+
+void DynamicObjectRegistry::BuildModelBvh(CachedModel& model)
+{
+    const auto& verts = model.localVertices;
+    const size_t triCount = model.localIndices.size() / 3;
+    std::vector<G3D::AABox> triBounds(triCount);
+    for (size_t t = 0; t < triCount; ++t)
+    {
+        triBounds[t] = TriangleBounds(verts[model.localIndices[t * 3 + 0]],
+                                      verts[model.localIndices[t * 3 + 1]],
+                                      verts[model.localIndices[t * 3 + 2]]);
+    }
+
+    model.maxTriangleSize = 0.0f;
+    for (const G3D::AABox& b : triBounds)
+        model.maxTriangleSize = std::max(model.maxTriangleSize, (b.high() - b.low()).length());
+
+    const std::vector<uint32_t> order = BuildMeshBvh(triBounds, model.bvh);
+    std::vector<uint32_t> indices(triCount * 3);
+    for (size_t t = 0; t < triCount; ++t)
+        for (int k = 0; k < 3; ++k)
+            indices[t * 3 + k] = model.localIndices[order[t] * 3 + k];
+    model.localIndices.swap(indices);
+}
+
 // ==========================================================================
 // Model loading (from .vmo files)
 // ==========================================================================
@@ -179,9 +406,10 @@ DynamicObjectRegistry::LoadModel(const std::string& modelName)
         return nullptr;
     }
 
-    // Load the WorldModel
-    VMAP::WorldModel wm;
-    if (!wm.readFile(vmoPath))
+    // Load the WorldModel through the shared store, so a model the static
+    // VMAP tree already parsed is not parsed again
+    std::shared_ptr<const VMAP::WorldModel> wm = VMAP::WorldModelStore::Instance().Acquire(vmoPath);
+    if (!wm)
     {
         std::cerr << "[DynObjReg] Failed to load model: " << vmoPath << "\n";
         m_modelCache[modelName] = nullptr;
@@ -192,7 +420,7 @@ DynamicObjectRegistry::LoadModel(const std::string& modelName)
     auto cached = std::make_shared<CachedModel>();
     cached->modelName = modelName;
 
-    if (!wm.GetAllMeshData(cached->localVertices, cached->localIndices))
+    if (!wm->GetAllMeshData(cached->localVertices, cached->localIndices))
     {
         std::cerr << "[DynObjReg] No mesh data in model: " << vmoPath << "\n";
         m_modelCache[modelName] = nullptr;
@@ -210,6 +438,7 @@ DynamicObjectRegistry::LoadModel(const std::string& modelName)
         }
         cached->localBounds = G3D::AABox(bmin, bmax);
     }
+    BuildModelBvh(*cached);
 
     std::cout << "[DynObjReg] Loaded model '" << modelName << "': "
               << cached->localVertices.size() << " vertices, "
@@ -280,6 +509,7 @@ DynamicObjectRegistry::CreateFallbackModel(uint32_t displayId)
     cached->localBounds = G3D::AABox(
         G3D::Vector3(-Radius, -Radius, 0.0f),
         G3D::Vector3(Radius, Radius, Height));
+    BuildModelBvh(*cached);
 
     std::cerr << "[DynObjReg] Using fallback collision hull for unknown displayId "
               << displayId << "\n";
@@ -299,51 +529,89 @@ static bool IsDoorModel(const std::string& modelName)
     return lower.find("door") != std::string::npos;
 }
 
-bool DynamicObjectRegistry::EnsureRegistered(
-    uint64_t guid, uint32_t displayId, uint32_t mapId, float scale)
+std::shared_ptr<DynamicObjectRegistry::CachedModel>
+DynamicObjectRegistry::ResolveModel(uint32_t displayId, bool& outIsDoorModel)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    // Already registered?
-    if (m_objects.count(guid) > 0)
-        return true;
+    std::lock_guard<std::mutex> lock(m_modelMutex);
 
     // Look up model name from displayId, falling back to a conservative
     // hull for city props that are not present in temp_gameobject_models.
     auto mapIt = m_displayIdMap.find(displayId);
     const bool hasMappedModel = mapIt != m_displayIdMap.end();
+    outIsDoorModel = hasMappedModel && IsDoorModel(mapIt->second.modelName);
     // Load the model mesh (cached)
-    auto model = hasMappedModel ? LoadModel(mapIt->second.modelName) : CreateFallbackModel(displayId);
+    return hasMappedModel ? LoadModel(mapIt->second.modelName) : CreateFallbackModel(displayId);
+}
+
+bool DynamicObjectRegistry::EnsureRegistered(
+    uint64_t guid, uint32_t displayId, uint32_t mapId, float scale, uint32_t mapInstanceId)
+{
+    // Already registered?
+    {
+        std::shared_lock<std::shared_mutex> lock(m_directoryMutex);
+        if (m_guidToShard.count(guid) > 0)
+            return true;
+    }
+
+    bool isDoorModel = false;
+    auto model = ResolveModel(displayId, isDoorModel);
     if (!model)
         return false;
 
+    std::unique_lock<std::shared_mutex> directoryLock(m_directoryMutex);
+    if (m_guidToShard.count(guid) > 0)
+        return true;
+
     DynamicObject obj;
     obj.guid = guid;
     obj.entry = 0;
     obj.displayId = displayId;
     obj.mapId = mapId;
+    obj.mapInstanceId = mapInstanceId;
     obj.runtimeInstanceId = AllocateRuntimeInstanceId();
     obj.scale = scale;
     obj.model = model;
-    obj.isDoorModel = hasMappedModel && IsDoorModel(mapIt->second.modelName);
+    obj.isDoorModel = isDoorModel;
 
+    const uint64_t key = ShardKey(mapId, mapInstanceId);
     m_instanceIdToGuid[obj.runtimeInstanceId] = guid;
-    m_objects[guid] = std::move(obj);
+    m_guidToShard[guid] = key;
+
+    MapShard& shard = GetOrCreateShard(key);
+    std::unique_lock<std::shared_mutex> shardLock(shard.mutex);
+    shard.MarkChanged(shard.objects[guid] = std::move(obj));
     return true;
 }
 
 bool DynamicObjectRegistry::RegisterObject(
     uint64_t guid, uint32_t entry, uint32_t displayId,
-    uint32_t mapId, float scale)
+    uint32_t mapId, float scale, uint32_t mapInstanceId)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    bool isDoorModel = false;
+    auto model = ResolveModel(displayId, isDoorModel);
+    const uint64_t key = ShardKey(mapId, mapInstanceId);
+
+    std::unique_lock<std::shared_mutex> directoryLock(m_directoryMutex);
+
+    // Re-registering a guid replaces it, possibly on another map or instance.
+    auto existing = m_guidToShard.find(guid);
+    if (existing != m_guidToShard.end())
+    {
+        MapShard& oldShard = GetOrCreateShard(existing->second);
+        std::unique_lock<std::shared_mutex> shardLock(oldShard.mutex);
+        oldShard.BumpGeneration();
+        if (model)
+        {
+            auto oldIt = oldShard.objects.find(guid);
+            if (oldIt != oldShard.objects.end())
+            {
+                oldShard.UnindexObject(oldIt->second);
+                if (existing->second != key)
+                    oldShard.objects.erase(oldIt);
+            }
+        }
+    }
 
-    // Look up model name from displayId, falling back to a conservative
-    // hull for city props that are not present in temp_gameobject_models.
-    auto mapIt = m_displayIdMap.find(displayId);
-    const bool hasMappedModel = mapIt != m_displayIdMap.end();
-    // Load the model mesh (cached)
-    auto model = hasMappedModel ? LoadModel(mapIt->second.modelName) : CreateFallbackModel(displayId);
     if (!model)
         return false;
 
@@ -352,13 +620,18 @@ bool DynamicObjectRegistry::RegisterObject(
     obj.entry = entry;
     obj.displayId = displayId;
     obj.mapId = mapId;
+    obj.mapInstanceId = mapInstanceId;
     obj.runtimeInstanceId = AllocateRuntimeInstanceId();
     obj.scale = scale;
     obj.model = model;
-    obj.isDoorModel = hasMappedModel && IsDoorModel(mapIt->second.modelName);
+    obj.isDoorModel = isDoorModel;
 
     m_instanceIdToGuid[obj.runtimeInstanceId] = guid;
-    m_objects[guid] = std::move(obj);
+    m_guidToShard[guid] = key;
+
+    MapShard& shard = GetOrCreateShard(key);
+    std::unique_lock<std::shared_mutex> shardLock(shard.mutex);
+    shard.MarkChanged(shard.objects[guid] = std::move(obj));
     return true;
 }
 
@@ -370,69 +643,419 @@ void DynamicObjectRegistry::UpdatePosition(
     uint64_t guid, float x, float y, float z, float orientation,
     uint32_t goState)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t key = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_directoryMutex);
+        auto shardIt = m_guidToShard.find(guid);
+        if (shardIt == m_guidToShard.end()) return;
+        key = shardIt->second;
+    }
 
-    auto it = m_objects.find(guid);
-    if (it == m_objects.end()) return;
+    MapShard& shard = GetOrCreateShard(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.objects.find(guid);
+    if (it == shard.objects.end()) return;
 
     auto& obj = it->second;
-    obj.posX = x;
-    obj.posY = y;
-    obj.posZ = z;
-    obj.orientation = orientation;
+    if (obj.timeline)
+    {
+        // The timeline owns the pose; only door/GO state comes from here.
+        if (obj.goState != goState)
+        {
+            obj.goState = goState;
+            shard.MarkChanged(obj);
+        }
+        return;
+    }
+
+    // Bots resend every nearby object each tick; most of those are static.
+    if (obj.placed && obj.pose.x == x && obj.pose.y == y && obj.pose.z == z &&
+        obj.pose.orientation == orientation && obj.goState == goState)
+        return;
+
+    obj.pose = ObjectPose::Make(x, y, z, orientation);
     obj.goState = goState;
-    obj.RebuildWorldTriangles();
+    obj.placed = true;
+    obj.UpdatePoseBounds();
+    shard.IndexObject(obj);
+    shard.MarkChanged(obj);
+}
+
+G3D::AABox DynamicObjectRegistry::DynamicObject::PosedBounds(const ObjectPose& p) const
+{
+    if (!model)
+        return G3D::AABox();
+
+    // Same scale -> rotate -> translate as WorldTriangle, applied to the
+    // corners of the local box.
+    const G3D::Vector3& lo = model->localBounds.low();
+    const G3D::Vector3& hi = model->localBounds.high();
+    G3D::Vector3 bmin, bmax;
+    for (int i = 0; i < 8; ++i)
+    {
+        const float sx = ((i & 1) ? hi.x : lo.x) * scale;
+        const float sy = ((i & 2) ? hi.y : lo.y) * scale;
+        const float sz = ((i & 4) ? hi.z : lo.z) * scale;
+        const G3D::Vector3 corner(sx * p.cosO - sy * p.sinO + p.x, sx * p.sinO + sy * p.cosO + p.y, sz + p.z);
+        bmin = i ? bmin.min(corner) : corner;
+        bmax = i ? bmax.max(corner) : corner;
+    }
+    const G3D::Vector3 pad(0.05f, 0.05f, 0.05f);
+    return G3D::AABox(bmin - pad, bmax + pad);
+}
+
+void DynamicObjectRegistry::DynamicObject::PoseAt(uint64_t timeMs, ObjectPose& outPose, G3D::AABox& outBounds) const
+{
+    if (!timeline)
+    {
+        outPose = pose;
+        outBounds = poseBounds;
+        return;
+    }
+    const TransportKeyframe k = timeline->Evaluate(timeMs);
+    outPose = ObjectPose::Make(k.x, k.y, k.z, k.orientation);
+    outBounds = PosedBounds(outPose);
+}
+
+CapsuleCollision::Triangle DynamicObjectRegistry::DynamicObject::WorldTriangle(const ObjectPose& p, uint32_t t) const
+{
+    const auto& verts = model->localVertices;
+    const uint32_t* idx = &model->localIndices[t * 3];
+    auto toWorld = [&](const G3D::Vector3& v) -> CapsuleCollision::Vec3 {
+        const float sx = v.x * scale;
+        const float sy = v.y * scale;
+        const float sz = v.z * scale;
+        return { sx * p.cosO - sy * p.sinO + p.x, sx * p.sinO + sy * p.cosO + p.y, sz + p.z };
+    };
+
+    CapsuleCollision::Triangle tri;
+    tri.a = toWorld(verts[idx[0]]);
+    tri.b = toWorld(verts[idx[1]]);
+    tri.c = toWorld(verts[idx[2]]);
+    tri.doubleSided = false;
+    tri.collisionMask = 0xFFFFFFFFu;
+    return tri;
+}
+
+G3D::Vector3 DynamicObjectRegistry::DynamicObject::WorldToLocal(const ObjectPose& p, const G3D::Vector3& v) const
+{
+    const float dx = v.x - p.x;
+    const float dy = v.y - p.y;
+    const float dz = v.z - p.z;
+    return G3D::Vector3((dx * p.cosO + dy * p.sinO) / scale,
+                        (-dx * p.sinO + dy * p.cosO) / scale,
+                        dz / scale);
+}
+
+bool DynamicObjectRegistry::DynamicObject::WorldBoxToLocal(
+    const ObjectPose& p, const G3D::AABox& box, G3D::Vector3& outLow, G3D::Vector3& outHigh) const
+{
+    if (!HasInvertibleScale())
+        return false;
+
+    // Center through the inverse pose; half extents of the rotated box grow
+    // by the absolute rotation, so the result holds every point of the box.
+    const G3D::Vector3 center = WorldToLocal(p, (box.low() + box.high()) * 0.5f);
+    const float inv = 1.0f / fabsf(scale);
+    const float hx = 0.5f * (box.high().x - box.low().x);
+    const float hy = 0.5f * (box.high().y - box.low().y);
+    const float hz = 0.5f * (box.high().z - box.low().z);
+    const float ac = fabsf(p.cosO);
+    const float as = fabsf(p.sinO);
+    const float pad = LocalPad() + model->maxTriangleSize;
+    const G3D::Vector3 half((ac * hx + as * hy) * inv + pad, (as * hx + ac * hy) * inv + pad, hz * inv + pad);
+    outLow = center - half;
+    outHigh = center + half;
+    return true;
+}
+
+// ==========================================================================
+// Transport timelines
+// ==========================================================================
+
+namespace
+{
+    thread_local bool t_hasTransportTime = false;
+    thread_local uint64_t t_transportTime = 0;
+    thread_local uint32_t t_transportInterval = 0;
+    thread_local uint32_t t_mapInstanceId = 0;
+}
+
+DynamicObjectRegistry::TransportTimeScope::TransportTimeScope(uint64_t timeMs, uint32_t intervalMs)
+    : m_hadPrevious(t_hasTransportTime), m_previous(t_transportTime), m_previousInterval(t_transportInterval)
+{
+    t_hasTransportTime = true;
+    t_transportTime = timeMs;
+    t_transportInterval = intervalMs;
+}
+
+DynamicObjectRegistry::TransportTimeScope::~TransportTimeScope()
+{
+    t_hasTransportTime = m_hadPrevious;
+    t_transportTime = m_previous;
+    t_transportInterval = m_previousInterval;
+}
+
+uint64_t DynamicObjectRegistry::CurrentTransportTime() const
+{
+    return t_hasTransportTime ? t_transportTime : m_defaultTransportTime.load(std::memory_order_relaxed);
+}
+
+void DynamicObjectRegistry::CurrentTransportInterval(uint64_t& t0, uint64_t& t1) const
+{
+    // The default time can be moved by any thread at any moment, so work
+    // without a scope has to allow for every time.
+    t0 = CurrentTransportTime();
+    t1 = t_hasTransportTime ? t0 + t_transportInterval : UINT64_MAX;
 }
 
-void DynamicObjectRegistry::DynamicObject::RebuildWorldTriangles()
+DynamicObjectRegistry::MapInstanceScope::MapInstanceScope(uint32_t mapInstanceId)
+    : m_previous(t_mapInstanceId)
 {
-    worldTriangles.clear();
-    if (!model || model->localIndices.empty()) return;
+    t_mapInstanceId = mapInstanceId;
+}
 
-    // Build world vertices: scale → rotate around Z → translate
-    float cosO = cosf(orientation);
-    float sinO = sinf(orientation);
+DynamicObjectRegistry::MapInstanceScope::~MapInstanceScope()
+{
+    t_mapInstanceId = m_previous;
+}
 
-    const auto& localVerts = model->localVertices;
-    std::vector<G3D::Vector3> worldVerts(localVerts.size());
-    for (size_t i = 0; i < localVerts.size(); ++i)
+uint32_t DynamicObjectRegistry::CurrentMapInstance() const
+{
+    return t_mapInstanceId;
+}
+
+DynamicObjectRegistry::TransportKeyframe
+DynamicObjectRegistry::TransportTimeline::Evaluate(uint64_t timeMs) const
+{
+    const uint32_t phase = static_cast<uint32_t>(timeMs % periodMs);
+
+    if (keyframes.size() == 1)
+        return keyframes.front();
+
+    // Segment around phase: between two keyframes, or across the end of the
+    // cycle from the last keyframe to the first.
+    auto next = std::upper_bound(keyframes.begin(), keyframes.end(), phase,
+                                 [](uint32_t t, const TransportKeyframe& k) { return t < k.timeMs; });
+    const TransportKeyframe* from;
+    const TransportKeyframe* to;
+    int64_t fromTime, toTime;
+    if (next == keyframes.begin() || next == keyframes.end())
+    {
+        from = &keyframes.back();
+        to = &keyframes.front();
+        fromTime = int64_t(from->timeMs) - (next == keyframes.begin() ? int64_t(periodMs) : 0);
+        toTime = int64_t(to->timeMs) + (next == keyframes.end() ? int64_t(periodMs) : 0);
+    }
+    else
     {
-        float sx = localVerts[i].x * scale;
-        float sy = localVerts[i].y * scale;
-        float sz = localVerts[i].z * scale;
-        float wx = sx * cosO - sy * sinO + posX;
-        float wy = sx * sinO + sy * cosO + posY;
-        float wz = sz + posZ;
-        worldVerts[i] = G3D::Vector3(wx, wy, wz);
+        from = &*(next - 1);
+        to = &*next;
+        fromTime = from->timeMs;
+        toTime = to->timeMs;
     }
+    const float t = static_cast<float>(int64_t(phase) - fromTime) / static_cast<float>(toTime - fromTime);
+
+    float turn = to->orientation - from->orientation;
+    const float pi = static_cast<float>(G3D::pi());
+    while (turn > pi) turn -= 2.0f * pi;
+    while (turn < -pi) turn += 2.0f * pi;
+
+    TransportKeyframe pose;
+    pose.timeMs = phase;
+    pose.x = from->x + (to->x - from->x) * t;
+    pose.y = from->y + (to->y - from->y) * t;
+    pose.z = from->z + (to->z - from->z) * t;
+    pose.orientation = from->orientation + turn * t;
+    return pose;
+}
 
-    // Build AABB
-    G3D::Vector3 bmin = worldVerts[0], bmax = worldVerts[0];
-    for (size_t i = 1; i < worldVerts.size(); ++i)
+G3D::AABox DynamicObjectRegistry::TransportTimeline::SweptBounds(uint64_t t0, uint64_t t1) const
+{
+    if (t1 < t0)
+        std::swap(t0, t1);
+    if (keyframes.size() == 1 || t1 - t0 >= periodMs)
+        return sweptBounds;
+
+    // The path is piecewise linear, so positions in [t0, t1] stay within the
+    // box of its two end poses and the keyframes whose phase lies between them.
+    const TransportKeyframe a = Evaluate(t0);
+    const TransportKeyframe b = Evaluate(t1);
+    G3D::Vector3 pathMin = G3D::Vector3(a.x, a.y, a.z).min(G3D::Vector3(b.x, b.y, b.z));
+    G3D::Vector3 pathMax = G3D::Vector3(a.x, a.y, a.z).max(G3D::Vector3(b.x, b.y, b.z));
+    const uint32_t phase0 = a.timeMs;
+    const uint32_t phase1 = b.timeMs;
+    for (const TransportKeyframe& k : keyframes)
     {
-        bmin = bmin.min(worldVerts[i]);
-        bmax = bmax.max(worldVerts[i]);
+        // phase1 < phase0 when the span wraps past the end of the cycle.
+        const bool inside = phase0 <= phase1 ? (k.timeMs > phase0 && k.timeMs < phase1)
+                                             : (k.timeMs > phase0 || k.timeMs < phase1);
+        if (!inside)
+            continue;
+        pathMin = pathMin.min(G3D::Vector3(k.x, k.y, k.z));
+        pathMax = pathMax.max(G3D::Vector3(k.x, k.y, k.z));
     }
-    worldBounds = G3D::AABox(bmin, bmax);
 
-    // Build triangles
-    const auto& indices = model->localIndices;
-    int triCount = (int)indices.size() / 3;
-    worldTriangles.reserve(triCount);
-    for (int t = 0; t < triCount; ++t)
+    const G3D::Vector3 pad(0.05f, 0.05f, 0.05f);
+    return G3D::AABox(
+        G3D::Vector3(pathMin.x - radius, pathMin.y - radius, pathMin.z + zLo) - pad,
+        G3D::Vector3(pathMax.x + radius, pathMax.y + radius, pathMax.z + zHi) + pad);
+}
+
+bool DynamicObjectRegistry::SetTransportTimeline(
+    uint64_t guid, const std::vector<TransportKeyframe>& keyframes, uint32_t periodMs)
+{
+    if (keyframes.empty() || periodMs == 0 || keyframes.back().timeMs >= periodMs)
+        return false;
+    for (size_t i = 1; i < keyframes.size(); ++i)
+        if (keyframes[i].timeMs <= keyframes[i - 1].timeMs)
+            return false;
+
+    uint64_t key = 0;
     {
-        uint32_t ia = indices[t * 3 + 0];
-        uint32_t ib = indices[t * 3 + 1];
-        uint32_t ic = indices[t * 3 + 2];
+        std::shared_lock<std::shared_mutex> lock(m_directoryMutex);
+        auto shardIt = m_guidToShard.find(guid);
+        if (shardIt == m_guidToShard.end())
+            return false;
+        key = shardIt->second;
+    }
 
-        CapsuleCollision::Triangle tri;
-        tri.a = { worldVerts[ia].x, worldVerts[ia].y, worldVerts[ia].z };
-        tri.b = { worldVerts[ib].x, worldVerts[ib].y, worldVerts[ib].z };
-        tri.c = { worldVerts[ic].x, worldVerts[ic].y, worldVerts[ic].z };
-        tri.doubleSided = false;
-        tri.collisionMask = 0xFFFFFFFFu;
-        worldTriangles.push_back(tri);
+    MapShard& shard = GetOrCreateShard(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.objects.find(guid);
+    if (it == shard.objects.end() || !it->second.model)
+        return false;
+    DynamicObject& obj = it->second;
+
+    // Interpolated positions stay within the keyframes' box, and any
+    // orientation keeps the model inside its XY radius around the position.
+    const G3D::Vector3& lo = obj.model->localBounds.low();
+    const G3D::Vector3& hi = obj.model->localBounds.high();
+    const float s = fabsf(obj.scale);
+    const float rx = std::max(fabsf(lo.x), fabsf(hi.x)) * s;
+    const float ry = std::max(fabsf(lo.y), fabsf(hi.y)) * s;
+    const float radius = sqrtf(rx * rx + ry * ry);
+    const float zLo = std::min(lo.z * obj.scale, hi.z * obj.scale);
+    const float zHi = std::max(lo.z * obj.scale, hi.z * obj.scale);
+    G3D::Vector3 pathMin(keyframes[0].x, keyframes[0].y, keyframes[0].z);
+    G3D::Vector3 pathMax = pathMin;
+    for (const TransportKeyframe& k : keyframes)
+    {
+        pathMin = pathMin.min(G3D::Vector3(k.x, k.y, k.z));
+        pathMax = pathMax.max(G3D::Vector3(k.x, k.y, k.z));
+    }
+
+    auto timeline = std::make_shared<TransportTimeline>();
+    timeline->keyframes = keyframes;
+    timeline->periodMs = periodMs;
+    timeline->radius = radius;
+    timeline->zLo = zLo;
+    timeline->zHi = zHi;
+    const G3D::Vector3 pad(0.05f, 0.05f, 0.05f);
+    timeline->sweptBounds = G3D::AABox(
+        G3D::Vector3(pathMin.x - radius, pathMin.y - radius, pathMin.z + zLo) - pad,
+        G3D::Vector3(pathMax.x + radius, pathMax.y + radius, pathMax.z + zHi) + pad);
+
+    obj.timeline = std::move(timeline);
+    obj.placed = true;
+    shard.UnindexObject(obj);
+    shard.IndexObject(obj);
+    shard.MarkChanged(obj);
+    return true;
+}
+
+void DynamicObjectRegistry::ClearTransportTimeline(uint64_t guid)
+{
+    uint64_t key = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_directoryMutex);
+        auto shardIt = m_guidToShard.find(guid);
+        if (shardIt == m_guidToShard.end())
+            return;
+        key = shardIt->second;
+    }
+
+    MapShard& shard = GetOrCreateShard(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.objects.find(guid);
+    if (it == shard.objects.end() || !it->second.timeline)
+        return;
+
+    DynamicObject& obj = it->second;
+    const TransportKeyframe last = obj.timeline->Evaluate(CurrentTransportTime());
+    obj.pose = ObjectPose::Make(last.x, last.y, last.z, last.orientation);
+    obj.timeline.reset();
+    obj.UpdatePoseBounds();
+    shard.IndexObject(obj);
+    shard.MarkChanged(obj);
+}
+
+bool DynamicObjectRegistry::GetTransportPose(uint64_t guid, uint64_t timeMs, TransportKeyframe& outPose) const
+{
+    uint64_t key = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_directoryMutex);
+        auto shardIt = m_guidToShard.find(guid);
+        if (shardIt == m_guidToShard.end())
+            return false;
+        key = shardIt->second;
+    }
+
+    const MapShard* shard = FindShard(key);
+    if (!shard)
+        return false;
+    std::shared_lock<std::shared_mutex> lock(shard->mutex);
+    auto it = shard->objects.find(guid);
+    if (it == shard->objects.end() || !it->second.timeline)
+        return false;
+    outPose = it->second.timeline->Evaluate(timeMs);
+    return true;
+}
+
+bool DynamicObjectRegistry::HasTransportNear(uint32_t mapId, const G3D::AABox& box) const
+{
+    const MapShard* shard = QueryShard(mapId);
+    if (!shard)
+        return false;
+
+    uint64_t t0, t1;
+    CurrentTransportInterval(t0, t1);
+    thread_local std::vector<const DynamicObject*> gathered;
+    std::shared_lock<std::shared_mutex> lock(shard->mutex);
+    shard->GatherObjects(box.low().x, box.low().y, box.high().x, box.high().y, gathered);
+    for (const DynamicObject* obj : gathered)
+    {
+        if (obj->timeline && obj->timeline->keyframes.size() > 1 &&
+            obj->timeline->SweptBounds(t0, t1).intersects(box))
+            return true;
     }
+    return false;
+}
+
+DynamicObjectRegistry::RegionStamp DynamicObjectRegistry::GetRegionStamp(uint32_t mapId, const G3D::AABox& box) const
+{
+    RegionStamp stamp;
+    const MapShard* shard = QueryShard(mapId);
+    if (!shard)
+        return stamp;
+
+    uint64_t t0, t1;
+    CurrentTransportInterval(t0, t1);
+    thread_local std::vector<const DynamicObject*> gathered;
+    RunShardQuery(*shard, [&]
+    {
+        shard->GatherObjects(box.low().x, box.low().y, box.high().x, box.high().y, gathered);
+        stamp.variantGeneration = shard->worldShard->variantGeneration.load(std::memory_order_relaxed);
+        stamp.objectCount = static_cast<uint32_t>(gathered.size());
+        for (const DynamicObject* obj : gathered)
+        {
+            stamp.newestChange = std::max(stamp.newestChange, obj->changeStamp);
+            if (obj->timeline && obj->timeline->keyframes.size() > 1 &&
+                obj->timeline->SweptBounds(t0, t1).intersects(box))
+                stamp.hasTransport = true;
+        }
+    });
+    return stamp;
 }
 
 // ==========================================================================
@@ -441,37 +1064,187 @@ void DynamicObjectRegistry::DynamicObject::RebuildWorldTriangles()
 
 void DynamicObjectRegistry::Unregister(uint64_t guid)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_objects.find(guid);
-    if (it != m_objects.end())
+    std::unique_lock<std::shared_mutex> directoryLock(m_directoryMutex);
+    auto shardIt = m_guidToShard.find(guid);
+    if (shardIt == m_guidToShard.end())
+        return;
+
+    MapShard& shard = GetOrCreateShard(shardIt->second);
+    m_guidToShard.erase(shardIt);
+
+    std::unique_lock<std::shared_mutex> shardLock(shard.mutex);
+    auto it = shard.objects.find(guid);
+    if (it != shard.objects.end())
     {
+        shard.BumpGeneration();
+        shard.UnindexObject(it->second);
         m_instanceIdToGuid.erase(it->second.runtimeInstanceId);
-        m_objects.erase(it);
+        shard.objects.erase(it);
+    }
+}
+
+void DynamicObjectRegistry::ClearShardObjects(MapShard& shard)
+{
+    std::unique_lock<std::shared_mutex> shardLock(shard.mutex);
+    shard.BumpGeneration();
+    for (const auto& kv : shard.objects)
+    {
+        m_instanceIdToGuid.erase(kv.second.runtimeInstanceId);
+        m_guidToShard.erase(kv.first);
     }
+    shard.objects.clear();
+    shard.grid = ObjectGrid();
 }
 
 void DynamicObjectRegistry::ClearMap(uint32_t mapId)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    for (auto it = m_objects.begin(); it != m_objects.end(); )
+    // Only this map's objects are visited; other maps' shards are not locked.
+    std::unique_lock<std::shared_mutex> directoryLock(m_directoryMutex);
+    std::shared_lock<std::shared_mutex> shardsLock(m_shardsMutex);
+    for (auto& kv : m_shards)
     {
-        if (it->second.mapId == mapId)
-        {
-            m_instanceIdToGuid.erase(it->second.runtimeInstanceId);
-            it = m_objects.erase(it);
-        }
-        else
-            ++it;
+        if (ShardMapId(kv.first) == mapId)
+            ClearShardObjects(*kv.second);
     }
 }
 
+void DynamicObjectRegistry::ClearMapInstance(uint32_t mapId, uint32_t mapInstanceId)
+{
+    std::unique_lock<std::shared_mutex> directoryLock(m_directoryMutex);
+    if (MapShard* shard = FindShard(ShardKey(mapId, mapInstanceId)))
+        ClearShardObjects(*shard);
+}
+
 void DynamicObjectRegistry::ClearAll()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_objects.clear();
+    std::unique_lock<std::shared_mutex> directoryLock(m_directoryMutex);
+    std::shared_lock<std::shared_mutex> shardsLock(m_shardsMutex);
+    for (auto& kv : m_shards)
+    {
+        MapShard& shard = *kv.second;
+        std::unique_lock<std::shared_mutex> shardLock(shard.mutex);
+        if (shard.objects.empty())
+            continue;
+        shard.BumpGeneration();
+        shard.objects.clear();
+        shard.grid = ObjectGrid();
+    }
+    m_guidToShard.clear();
     m_instanceIdToGuid.clear();
 }
 
+// ==========================================================================
+// Broad phase
+// ==========================================================================
+
+void DynamicObjectRegistry::MapShard::IndexObject(DynamicObject& obj)
+{
+    if (!obj.HasCollision())
+    {
+        UnindexObject(obj);
+        return;
+    }
+
+    const G3D::AABox& b = obj.BroadBounds();
+    const int minX = CellCoord(b.low().x), minY = CellCoord(b.low().y);
+    const int maxX = CellCoord(b.high().x), maxY = CellCoord(b.high().y);
+    if (obj.indexed && minX == obj.cellMinX && minY == obj.cellMinY &&
+        maxX == obj.cellMaxX && maxY == obj.cellMaxY)
+        return;
+
+    UnindexObject(obj);
+    obj.cellMinX = minX; obj.cellMinY = minY;
+    obj.cellMaxX = maxX; obj.cellMaxY = maxY;
+    obj.inLargeList = maxX - minX >= MAX_CELL_SPAN || maxY - minY >= MAX_CELL_SPAN;
+    obj.indexed = true;
+
+    if (obj.inLargeList)
+    {
+        grid.large.push_back(&obj);
+        return;
+    }
+    for (int cx = minX; cx <= maxX; ++cx)
+        for (int cy = minY; cy <= maxY; ++cy)
+            grid.cells[CellKey(cx, cy)].push_back(&obj);
+}
+
+void DynamicObjectRegistry::MapShard::UnindexObject(DynamicObject& obj)
+{
+    if (!obj.indexed)
+        return;
+    obj.indexed = false;
+
+    auto removeFrom = [&](std::vector<DynamicObject*>& list) {
+        auto it = std::find(list.begin(), list.end(), &obj);
+        if (it == list.end())
+            return;
+        *it = list.back();
+        list.pop_back();
+    };
+
+    if (obj.inLargeList)
+    {
+        removeFrom(grid.large);
+        return;
+    }
+    for (int cx = obj.cellMinX; cx <= obj.cellMaxX; ++cx)
+    {
+        for (int cy = obj.cellMinY; cy <= obj.cellMaxY; ++cy)
+        {
+            auto cellIt = grid.cells.find(CellKey(cx, cy));
+            if (cellIt == grid.cells.end())
+                continue;
+            removeFrom(cellIt->second);
+            if (cellIt->second.empty())
+                grid.cells.erase(cellIt);
+        }
+    }
+}
+
+void DynamicObjectRegistry::MapShard::GatherObjects(
+    float minX, float minY, float maxX, float maxY, std::vector<const DynamicObject*>& out) const
+{
+    // Queries share the lock, so objects carry no per-query marks; objects
+    // listed in several cells are deduplicated after sorting.
+    out.clear();
+    auto collect = [&](const std::vector<DynamicObject*>& list) {
+        out.insert(out.end(), list.begin(), list.end());
+    };
+
+    collect(grid.large);
+
+    const int qMinX = CellCoord(minX), qMinY = CellCoord(minY);
+    const int qMaxX = CellCoord(maxX), qMaxY = CellCoord(maxY);
+    const double queryCells = (static_cast<double>(qMaxX) - qMinX + 1.0) * (static_cast<double>(qMaxY) - qMinY + 1.0);
+    if (queryCells > static_cast<double>(grid.cells.size()))
+    {
+        // Wide query: walking the occupied cells is cheaper than the range.
+        for (const auto& [key, list] : grid.cells)
+        {
+            const int cx = static_cast<int>(static_cast<uint32_t>(key >> 32));
+            const int cy = static_cast<int>(static_cast<uint32_t>(key));
+            if (cx >= qMinX && cx <= qMaxX && cy >= qMinY && cy <= qMaxY)
+                collect(list);
+        }
+    }
+    else
+    {
+        for (int cx = qMinX; cx <= qMaxX; ++cx)
+        {
+            for (int cy = qMinY; cy <= qMaxY; ++cy)
+            {
+                auto cellIt = grid.cells.find(CellKey(cx, cy));
+                if (cellIt != grid.cells.end())
+                    collect(cellIt->second);
+            }
+        }
+    }
+
+    std::sort(out.begin(), out.end(),
+              [](const DynamicObject* a, const DynamicObject* b) { return a->runtimeInstanceId < b->runtimeInstanceId; });
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
 // ==========================================================================
 // Query
 // ==========================================================================
@@ -481,7 +1254,9 @@ void DynamicObjectRegistry::QueryTriangles(
     std::vector<CapsuleCollision::Triangle>& outTriangles,
     std::vector<uint32_t>* outInstanceIds) const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    const MapShard* shard = QueryShard(mapId);
+    if (!shard)
+        return;
 
     auto aabbOverlap = [&](const G3D::AABox& b) -> bool
     {
@@ -490,61 +1265,240 @@ void DynamicObjectRegistry::QueryTriangles(
                  b.high().z < worldAABB.low().z  || b.low().z > worldAABB.high().z);
     };
 
-    for (const auto& [guid, obj] : m_objects)
+    const uint64_t transportTime = CurrentTransportTime();
+    thread_local std::vector<const DynamicObject*> gathered;
+
+    RunShardQuery(*shard, [&]
     {
-        if (obj.mapId != mapId) continue;
-        if (obj.worldTriangles.empty()) continue;
+        shard->GatherObjects(worldAABB.low().x, worldAABB.low().y, worldAABB.high().x, worldAABB.high().y, gathered);
+        for (const DynamicObject* object : gathered)
+        {
+            const DynamicObject& obj = *object;
 
-        // Door models in Active state (goState=0 = open/used): skip from collision.
-        // The .vmo mesh represents the default (closed) pose. When Active (open),
-        // the door has been animated to a different position we can't replicate.
-        // Ready (goState=1) = closed = mesh matches reality = KEEP in collision.
-        if (obj.isDoorModel && obj.goState == 0)
-            continue;
+            // Door models in Active state (goState=0 = open/used): skip from collision.
+            // The .vmo mesh represents the default (closed) pose. When Active (open),
+            // the door has been animated to a different position we can't replicate.
+            // Ready (goState=1) = closed = mesh matches reality = KEEP in collision.
+            if (obj.isDoorModel && obj.goState == 0)
+                continue;
 
-        if (!aabbOverlap(obj.worldBounds))
-            continue;
+            ObjectPose pose;
+            G3D::AABox pb;
+            obj.PoseAt(transportTime, pose, pb);
+            if (!aabbOverlap(pb))
+                continue;
 
-        outTriangles.insert(outTriangles.end(),
-            obj.worldTriangles.begin(), obj.worldTriangles.end());
-        if (outInstanceIds)
-            outInstanceIds->insert(outInstanceIds->end(), obj.worldTriangles.size(), obj.runtimeInstanceId);
-    }
+            const size_t before = outTriangles.size();
+            const uint32_t triCount = static_cast<uint32_t>(obj.model->localIndices.size() / 3);
+            if (pb.low().x >= worldAABB.low().x && pb.high().x <= worldAABB.high().x &&
+                pb.low().y >= worldAABB.low().y && pb.high().y <= worldAABB.high().y &&
+                pb.low().z >= worldAABB.low().z && pb.high().z <= worldAABB.high().z)
+            {
+                // Every triangle lies inside the box.
+                for (uint32_t i = 0; i < triCount; ++i)
+                    outTriangles.push_back(obj.WorldTriangle(pose, i));
+            }
+            else
+            {
+                // Cull in model space with the query box carried into the
+                // object's frame; only the triangles reached are posed.
+                G3D::Vector3 lo, hi;
+                const bool cull = obj.WorldBoxToLocal(pose, worldAABB, lo, hi);
+                WalkMeshBvh(obj.model->bvh,
+                    [&](const MeshBvhNode& node) {
+                        return !cull ||
+                               !(node.maxX < lo.x || node.minX > hi.x ||
+                                 node.maxY < lo.y || node.minY > hi.y ||
+                                 node.maxZ < lo.z || node.minZ > hi.z);
+                    },
+                    [&](uint32_t first, uint32_t count) {
+                        for (uint32_t i = first; i < first + count; ++i)
+                        {
+                            const CapsuleCollision::Triangle tri = obj.WorldTriangle(pose, i);
+                            if (TriangleOverlapsBox(tri, worldAABB))
+                                outTriangles.push_back(tri);
+                        }
+                    });
+            }
+            if (outInstanceIds)
+                outInstanceIds->insert(outInstanceIds->end(), outTriangles.size() - before, obj.runtimeInstanceId);
+        }
+
+        // Phase 4 — variant scene-cache pools. Pre-baked world-space triangles
+        // pre-partitioned by tile. Early reject by pool and tile bounds, then the
+        // tile BVH down to per-triangle bounds.
+        for (const auto& kv : shard->worldShard->variantPools)
+        {
+            const VariantPool& pool = kv.second;
+            if (pool.totalTriangles == 0) continue;
+            if (pool.poolBoundsValid && !aabbOverlap(pool.poolBounds))
+                continue;
 
-    // Phase 4 — variant scene-cache pools. Pre-baked world-space triangles
-    // pre-partitioned by tile. Three-level early reject (pool → tile → tri AABB).
-    for (const auto& kv : m_variantPools)
+            for (const auto& tkv : pool.tilesByXY)
+            {
+                const VariantTilePool& tile = tkv.second;
+                if (tile.triangles.empty()) continue;
+                if (tile.boundsValid && !aabbOverlap(tile.bounds))
+                    continue;
+
+                const size_t before = outTriangles.size();
+                WalkMeshBvh(tile.bvh,
+                    [&](const MeshBvhNode& node) {
+                        return !(node.maxX < worldAABB.low().x || node.minX > worldAABB.high().x ||
+                                 node.maxY < worldAABB.low().y || node.minY > worldAABB.high().y ||
+                                 node.maxZ < worldAABB.low().z || node.minZ > worldAABB.high().z);
+                    },
+                    [&](uint32_t first, uint32_t count) {
+                        for (uint32_t i = first; i < first + count; ++i)
+                            if (TriangleOverlapsBox(tile.triangles[i], worldAABB))
+                                outTriangles.push_back(tile.triangles[i]);
+                    });
+                if (outInstanceIds)
+                    outInstanceIds->insert(outInstanceIds->end(), outTriangles.size() - before, kVariantInstanceId);
+            }
+        }
+    });
+}
+
+void DynamicObjectRegistry::CaptureRegion(uint32_t mapId, float minX, float minY, float maxX, float maxY,
+                                          RegionSnapshot& out) const
+{
+    out.valid = true;
+    out.mapId = mapId;
+    out.mapInstanceId = CurrentMapInstance();
+    out.generation = 0;
+    out.minX = minX;
+    out.minY = minY;
+    out.maxX = maxX;
+    out.maxY = maxY;
+    out.objects.clear();
+    out.variantTriangles.clear();
+    uint64_t t0, t1;
+    CurrentTransportInterval(t0, t1);
+    out.validFrom = 0;
+    out.validTo = UINT64_MAX;
+
+    const MapShard* shard = QueryShard(mapId);
+    if (!shard)
+        return;
+
+    thread_local std::vector<const DynamicObject*> gathered;
+    RunShardQuery(*shard, [&]
     {
-        if (kv.first.first != mapId) continue;
-        const VariantPool& pool = kv.second;
-        if (pool.totalTriangles == 0) continue;
-        if (pool.poolBoundsValid && !aabbOverlap(pool.poolBounds))
-            continue;
+        out.generation = shard->CombinedGeneration();
 
-        for (const auto& tkv : pool.tilesByXY)
+        // Same selection as QueryTriangles, minus the Z test: anything a query
+        // inside the region could return.
+        shard->GatherObjects(minX, minY, maxX, maxY, gathered);
+        for (const DynamicObject* object : gathered)
         {
-            const VariantTilePool& tile = tkv.second;
-            if (tile.triangles.empty()) continue;
-            if (tile.boundsValid && !aabbOverlap(tile.bounds))
+            const DynamicObject& obj = *object;
+            if (obj.isDoorModel && obj.goState == 0) continue;
+            auto missesRegion = [&](const G3D::AABox& b) {
+                return b.high().x < minX || b.low().x > maxX || b.high().y < minY || b.low().y > maxY;
+            };
+            if (obj.timeline)
+            {
+                // A transport whose path crosses the region limits the
+                // snapshot to the interval; one inside it during the
+                // interval pins the snapshot to the capture time.
+                if (missesRegion(obj.timeline->sweptBounds))
+                    continue;
+                out.validFrom = t0;
+                out.validTo = std::min(out.validTo, t1);
+                if (missesRegion(obj.timeline->SweptBounds(t0, t1)))
+                    continue;
+                out.validTo = t0;
+            }
+            ObjectPose pose;
+            G3D::AABox pb;
+            obj.PoseAt(t0, pose, pb);
+            if (missesRegion(pb))
                 continue;
 
-            for (const CapsuleCollision::Triangle& tri : tile.triangles)
+            // Snapshots are read without the lock, so they hold the posed triangles.
+            RegionSnapshot::Object snap;
+            snap.instanceId = obj.runtimeInstanceId;
+            const uint32_t triCount = static_cast<uint32_t>(obj.model->localIndices.size() / 3);
+            snap.triangles.reserve(triCount);
+            G3D::Vector3 lo, hi;
+            for (uint32_t i = 0; i < triCount; ++i)
             {
-                const float minX = std::min(std::min(tri.a.x, tri.b.x), tri.c.x);
-                const float maxX = std::max(std::max(tri.a.x, tri.b.x), tri.c.x);
-                if (maxX < worldAABB.low().x || minX > worldAABB.high().x) continue;
-                const float minY = std::min(std::min(tri.a.y, tri.b.y), tri.c.y);
-                const float maxY = std::max(std::max(tri.a.y, tri.b.y), tri.c.y);
-                if (maxY < worldAABB.low().y || minY > worldAABB.high().y) continue;
-                const float minZ = std::min(std::min(tri.a.z, tri.b.z), tri.c.z);
-                const float maxZ = std::max(std::max(tri.a.z, tri.b.z), tri.c.z);
-                if (maxZ < worldAABB.low().z || minZ > worldAABB.high().z) continue;
+                const CapsuleCollision::Triangle tri = obj.WorldTriangle(pose, i);
+                const G3D::Vector3 ta(tri.a.x, tri.a.y, tri.a.z);
+                const G3D::Vector3 tb(tri.b.x, tri.b.y, tri.b.z);
+                const G3D::Vector3 tc(tri.c.x, tri.c.y, tri.c.z);
+                lo = i ? lo.min(ta).min(tb).min(tc) : ta.min(tb).min(tc);
+                hi = i ? hi.max(ta).max(tb).max(tc) : ta.max(tb).max(tc);
+                snap.triangles.push_back(tri);
+            }
+            if (hi.x < minX || lo.x > maxX || hi.y < minY || lo.y > maxY)
+                continue;
+            snap.worldBounds = G3D::AABox(lo, hi);
+            out.objects.push_back(std::move(snap));
+        }
 
-                outTriangles.push_back(tri);
-                if (outInstanceIds)
-                    outInstanceIds->push_back(kVariantInstanceId);
+        for (const auto& kv : shard->worldShard->variantPools)
+        {
+            for (const auto& tkv : kv.second.tilesByXY)
+            {
+                const VariantTilePool& tile = tkv.second;
+                WalkMeshBvh(tile.bvh,
+                    [&](const MeshBvhNode& node) {
+                        return !(node.maxX < minX || node.minX > maxX || node.maxY < minY || node.minY > maxY);
+                    },
+                    [&](uint32_t first, uint32_t count) {
+                        for (uint32_t i = first; i < first + count; ++i)
+                        {
+                            const CapsuleCollision::Triangle& tri = tile.triangles[i];
+                            const float triMinX = std::min(std::min(tri.a.x, tri.b.x), tri.c.x);
+                            const float triMaxX = std::max(std::max(tri.a.x, tri.b.x), tri.c.x);
+                            if (triMaxX < minX || triMinX > maxX) continue;
+                            const float triMinY = std::min(std::min(tri.a.y, tri.b.y), tri.c.y);
+                            const float triMaxY = std::max(std::max(tri.a.y, tri.b.y), tri.c.y);
+                            if (triMaxY < minY || triMinY > maxY) continue;
+                            out.variantTriangles.push_back(tri);
+                        }
+                    });
             }
         }
+    });
+}
+
+void DynamicObjectRegistry::RegionSnapshot::QueryTriangles(
+    const G3D::AABox& worldAABB,
+    std::vector<CapsuleCollision::Triangle>& outTriangles,
+    std::vector<uint32_t>* outInstanceIds) const
+{
+    for (const Object& obj : objects)
+    {
+        const G3D::AABox& b = obj.worldBounds;
+        if (b.high().x < worldAABB.low().x || b.low().x > worldAABB.high().x ||
+            b.high().y < worldAABB.low().y || b.low().y > worldAABB.high().y ||
+            b.high().z < worldAABB.low().z || b.low().z > worldAABB.high().z)
+            continue;
+
+        // The registry walks the model BVH, whose nodes only ever reject
+        // triangles the per-triangle test rejects too, and visits the rest
+        // in stored order.
+        const size_t before = outTriangles.size();
+        for (const CapsuleCollision::Triangle& tri : obj.triangles)
+            if (TriangleOverlapsBox(tri, worldAABB))
+                outTriangles.push_back(tri);
+        if (outInstanceIds)
+            outInstanceIds->insert(outInstanceIds->end(), outTriangles.size() - before, obj.instanceId);
+    }
+
+    // Likewise pool, tile and BVH bounds only ever reject whole groups of
+    // triangles the per-triangle test would reject, so testing triangles is enough.
+    for (const CapsuleCollision::Triangle& tri : variantTriangles)
+    {
+        if (!TriangleOverlapsBox(tri, worldAABB))
+            continue;
+
+        outTriangles.push_back(tri);
+        if (outInstanceIds)
+            outInstanceIds->push_back(kVariantInstanceId);
     }
 }
 
@@ -644,8 +1598,25 @@ bool DynamicObjectRegistry::LoadVariantSceneCache(
         tile.boundsValid = true;
     }
 
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto& pool = m_variantPools[std::make_pair(mapId, variantId)];
+    // Store the triangles in BVH leaf order (outside the registry lock).
+    std::vector<G3D::AABox> triBounds(tile.triangles.size());
+    for (size_t t = 0; t < tile.triangles.size(); ++t)
+    {
+        const CapsuleCollision::Triangle& tri = tile.triangles[t];
+        triBounds[t] = TriangleBounds(G3D::Vector3(tri.a.x, tri.a.y, tri.a.z),
+                                      G3D::Vector3(tri.b.x, tri.b.y, tri.b.z),
+                                      G3D::Vector3(tri.c.x, tri.c.y, tri.c.z));
+    }
+    const std::vector<uint32_t> order = BuildMeshBvh(triBounds, tile.bvh);
+    std::vector<CapsuleCollision::Triangle> ordered(tile.triangles.size());
+    for (size_t t = 0; t < ordered.size(); ++t)
+        ordered[t] = tile.triangles[order[t]];
+    tile.triangles.swap(ordered);
+
+    MapShard& shard = GetOrCreateShard(ShardKey(mapId, 0));
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.MarkVariantsChanged();
+    auto& pool = shard.variantPools[variantId];
     pool.variantId = variantId;
 
     auto& slot = pool.tilesByXY[std::make_pair(tile.tileX, tile.tileY)];
@@ -673,49 +1644,69 @@ bool DynamicObjectRegistry::LoadVariantSceneCache(
 
 void DynamicObjectRegistry::UnloadVariant(uint32_t mapId, const std::string& variantId)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_variantPools.erase(std::make_pair(mapId, variantId));
+    MapShard* shard = FindShard(ShardKey(mapId, 0));
+    if (!shard)
+        return;
+    std::unique_lock<std::shared_mutex> lock(shard->mutex);
+    if (shard->variantPools.erase(variantId) > 0)
+        shard->MarkVariantsChanged();
 }
 
 void DynamicObjectRegistry::UnloadAllVariants(uint32_t mapId)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    for (auto it = m_variantPools.begin(); it != m_variantPools.end(); )
-    {
-        if (it->first.first == mapId) it = m_variantPools.erase(it);
-        else ++it;
-    }
+    MapShard& shard = GetOrCreateShard(ShardKey(mapId, 0));
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.MarkVariantsChanged();
+    shard.variantPools.clear();
 }
 
 size_t DynamicObjectRegistry::VariantTriangleCount(uint32_t mapId) const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    const MapShard* shard = FindShard(ShardKey(mapId, 0));
+    if (!shard)
+        return 0;
+    std::shared_lock<std::shared_mutex> lock(shard->mutex);
     size_t total = 0;
-    for (const auto& kv : m_variantPools)
-        if (kv.first.first == mapId) total += kv.second.totalTriangles;
+    for (const auto& kv : shard->variantPools)
+        total += kv.second.totalTriangles;
     return total;
 }
 
 bool DynamicObjectRegistry::TryGetLocalPoint(
     uint32_t instanceId, const G3D::Vector3& worldPoint, G3D::Vector3& outLocalPoint) const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t guid = 0;
+    uint64_t key = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_directoryMutex);
+        auto guidIt = m_instanceIdToGuid.find(instanceId);
+        if (guidIt == m_instanceIdToGuid.end())
+            return false;
+        auto shardIt = m_guidToShard.find(guidIt->second);
+        if (shardIt == m_guidToShard.end())
+            return false;
+        guid = guidIt->second;
+        key = shardIt->second;
+    }
 
-    auto guidIt = m_instanceIdToGuid.find(instanceId);
-    if (guidIt == m_instanceIdToGuid.end())
+    const MapShard* shard = FindShard(key);
+    if (!shard)
         return false;
-
-    auto objIt = m_objects.find(guidIt->second);
-    if (objIt == m_objects.end())
+    std::shared_lock<std::shared_mutex> lock(shard->mutex);
+    auto objIt = shard->objects.find(guid);
+    if (objIt == shard->objects.end())
         return false;
 
     const auto& obj = objIt->second;
+    ObjectPose pose;
+    G3D::AABox poseBounds;
+    obj.PoseAt(CurrentTransportTime(), pose, poseBounds);
     const float scale = std::fabs(obj.scale) > 1e-6f ? obj.scale : 1.0f;
-    const float cosO = std::cos(obj.orientation);
-    const float sinO = std::sin(obj.orientation);
-    const float dx = worldPoint.x - obj.posX;
-    const float dy = worldPoint.y - obj.posY;
-    const float dz = worldPoint.z - obj.posZ;
+    const float cosO = pose.cosO;
+    const float sinO = pose.sinO;
+    const float dx = worldPoint.x - pose.x;
+    const float dy = worldPoint.y - pose.y;
+    const float dz = worldPoint.z - pose.z;
 
     outLocalPoint.x = (dx * cosO + dy * sinO) / scale;
     outLocalPoint.y = (-dx * sinO + dy * cosO) / scale;
@@ -731,7 +1722,9 @@ bool DynamicObjectRegistry::FindFirstIntersectingObject(
     uint64_t* outGuid,
     uint32_t* outDisplayId) const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    const MapShard* shard = QueryShard(mapId);
+    if (!shard)
+        return false;
 
     const float pad = 0.5f;
     const G3D::AABox segBox(
@@ -744,54 +1737,73 @@ bool DynamicObjectRegistry::FindFirstIntersectingObject(
             std::max(start.y, end.y) + pad,
             std::max(start.z, end.z) + pad));
 
+    const G3D::Vector3 dir = end - start;
     bool found = false;
     float bestT = std::numeric_limits<float>::infinity();
     uint32_t bestInstanceId = 0;
     uint64_t bestGuid = 0;
     uint32_t bestDisplayId = 0;
+    const uint64_t transportTime = CurrentTransportTime();
 
-    for (const auto& [guid, obj] : m_objects)
+    thread_local std::vector<const DynamicObject*> gathered;
+    RunShardQuery(*shard, [&]
     {
-        if (obj.mapId != mapId)
-            continue;
-
-        if (obj.worldTriangles.empty())
-            continue;
-
-        if (obj.isDoorModel && obj.goState == 0)
-            continue;
-
-        if (obj.worldBounds.high().x < segBox.low().x ||
-            obj.worldBounds.low().x > segBox.high().x ||
-            obj.worldBounds.high().y < segBox.low().y ||
-            obj.worldBounds.low().y > segBox.high().y ||
-            obj.worldBounds.high().z < segBox.low().z ||
-            obj.worldBounds.low().z > segBox.high().z)
+        shard->GatherObjects(segBox.low().x, segBox.low().y, segBox.high().x, segBox.high().y, gathered);
+        for (const DynamicObject* object : gathered)
         {
-            continue;
-        }
+            const DynamicObject& obj = *object;
 
-        for (const auto& tri : obj.worldTriangles)
-        {
-            const G3D::Vector3 ta(tri.a.x, tri.a.y, tri.a.z);
-            const G3D::Vector3 tb(tri.b.x, tri.b.y, tri.b.z);
-            const G3D::Vector3 tc(tri.c.x, tri.c.y, tri.c.z);
-            float hitT = 0.0f;
-            if (!SegmentTriangleIntersectionT(start, end, ta, tb, tc, &hitT))
+            if (obj.isDoorModel && obj.goState == 0)
                 continue;
 
-            if (!found ||
-                hitT < bestT - 1e-6f ||
-                (fabsf(hitT - bestT) <= 1e-6f && obj.runtimeInstanceId < bestInstanceId))
-            {
-                found = true;
-                bestT = hitT;
-                bestInstanceId = obj.runtimeInstanceId;
-                bestGuid = guid;
-                bestDisplayId = obj.displayId;
-            }
+            ObjectPose pose;
+            G3D::AABox pb;
+            obj.PoseAt(transportTime, pose, pb);
+            if (pb.high().x < segBox.low().x || pb.low().x > segBox.high().x ||
+                pb.high().y < segBox.low().y || pb.low().y > segBox.high().y ||
+                pb.high().z < segBox.low().z || pb.low().z > segBox.high().z)
+                continue;
+
+            // The pose is affine, so the segment carried into the object's
+            // frame passes through the same nodes; the hit itself is tested
+            // on the posed triangle.
+            const bool cull = obj.HasInvertibleScale();
+            const G3D::Vector3 localStart = cull ? obj.WorldToLocal(pose, start) : start;
+            const G3D::Vector3 localDir = cull ? obj.WorldToLocal(pose, end) - localStart : dir;
+            const float localPad = cull ? obj.LocalPad() : 0.0f;
+            WalkMeshBvh(obj.model->bvh,
+                [&](const MeshBvhNode& node) {
+                    if (!cull)
+                        return true;
+                    return SegmentOverlapsBox(localStart, localDir,
+                        G3D::Vector3(node.minX - localPad, node.minY - localPad, node.minZ - localPad),
+                        G3D::Vector3(node.maxX + localPad, node.maxY + localPad, node.maxZ + localPad));
+                },
+                [&](uint32_t first, uint32_t count) {
+                    for (uint32_t i = first; i < first + count; ++i)
+                    {
+                        const CapsuleCollision::Triangle tri = obj.WorldTriangle(pose, i);
+                        const G3D::Vector3 ta(tri.a.x, tri.a.y, tri.a.z);
+                        const G3D::Vector3 tb(tri.b.x, tri.b.y, tri.b.z);
+                        const G3D::Vector3 tc(tri.c.x, tri.c.y, tri.c.z);
+                        float hitT = 0.0f;
+                        if (!SegmentTriangleIntersectionT(start, end, ta, tb, tc, &hitT))
+                            continue;
+
+                        if (!found ||
+                            hitT < bestT - 1e-6f ||
+                            (fabsf(hitT - bestT) <= 1e-6f && obj.runtimeInstanceId < bestInstanceId))
+                        {
+                            found = true;
+                            bestT = hitT;
+                            bestInstanceId = obj.runtimeInstanceId;
+                            bestGuid = obj.guid;
+                            bestDisplayId = obj.displayId;
+                        }
+                    }
+                });
         }
-    }
+    });
 
     if (!found)
         return false;
@@ -810,21 +1822,27 @@ bool DynamicObjectRegistry::FindFirstIntersectingObject(
 
 int DynamicObjectRegistry::Count() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return (int)m_objects.size();
+    std::shared_lock<std::shared_mutex> lock(m_directoryMutex);
+    return (int)m_guidToShard.size();
 }
 
 int DynamicObjectRegistry::CachedModelCount() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<std::mutex> lock(m_modelMutex);
     int valid = 0;
     for (const auto& [name, ptr] : m_modelCache)
         if (ptr) ++valid;
     return valid;
 }
 
+uint64_t DynamicObjectRegistry::GetMapGeneration(uint32_t mapId) const
+{
+    const MapShard* shard = QueryShard(mapId);
+    return shard ? shard->CombinedGeneration() : 0;
+}
+
 bool DynamicObjectRegistry::HasDisplayId(uint32_t displayId) const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::lock_guard<std::mutex> lock(m_modelMutex);
     return m_displayIdMap.count(displayId) > 0;
 }
@@ -5,9 +5,12 @@
 #include <map>
 #include <cstdint>
 #include <mutex>
+#include <shared_mutex>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <utility>
+#include <cmath>
 #include "CapsuleCollision.h"
 #include "AABox.h"
 #include "Vector3.h"
@@ -23,10 +26,31 @@ namespace VMAP { class WorldModel; }
 /// The model is resolved from displayId via the temp_gameobject_models index file
 /// (displayId → modelName → .vmo path).
 ///
-/// On position update, model-local triangles are transformed to world space using
-/// the object's position and orientation.
+/// Triangles stay in model-local space. A position update only stores the
+/// pose and refreshes conservative bounds derived from the model's local
+/// bounds, so moving an object costs the same whatever its triangle count.
+/// Queries carry the query box or segment into the object's frame, walk the
+/// model BVH there, and transform only the triangles they test into world
+/// space.
 ///
-/// Thread safety: all public methods lock a shared mutex.
+/// Placed objects are indexed per map in a uniform XY grid of CELL_SIZE cells
+/// keyed on their world bounds, so queries only visit objects near the query
+/// box. Queries report objects in runtime instance ID order.
+///
+/// Each cached model mesh and each variant tile carries a BVH built once at
+/// load time; queries walk it and return only the triangles whose bounds
+/// overlap the query box, and segment tests only visit leaves the segment
+/// can reach. Model BVHs are shared by every instance of the model.
+///
+/// Thread safety: each map instance (map ID plus map instance ID, see
+/// MapInstanceScope) is a separate shard with its own reader-writer lock,
+/// objects and grid, so work in one instance never waits on another.
+/// Variant pools are world data every instance of a map sees; they live in
+/// the map's instance-0 shard, whose lock queries in other instances also
+/// take shared. Queries hold their shard's lock shared and run concurrently;
+/// registration, moves and variant loads hold it exclusively. A small
+/// directory (guid / instance ID → shard) and the model cache have their own
+/// locks.
 /// </summary>
 class DynamicObjectRegistry
 {
@@ -38,27 +62,154 @@ public:
     /// The file is typically "temp_gameobject_models" in the vmaps directory.
     bool LoadDisplayIdMapping(const std::string& vmapsBasePath);
 
-    /// Register a dynamic object by its displayId. Loads the model .vmo file if not cached.
+    /// Register a dynamic object by its displayId into the given map instance.
+    /// Loads the model .vmo file if not cached.
     /// Returns true if the model was successfully loaded and registered.
     bool RegisterObject(uint64_t guid, uint32_t entry, uint32_t displayId,
-                        uint32_t mapId, float scale = 1.0f);
+                        uint32_t mapId, float scale = 1.0f, uint32_t mapInstanceId = 0);
 
     /// Update the world position, orientation, and GO state of a registered object.
-    /// Rebuilds world-space triangles from the cached model mesh.
+    /// Only the pose is stored; a call that repeats the current pose and state
+    /// is a no-op. For an object driven by a transport timeline only the GO
+    /// state is taken.
     void UpdatePosition(uint64_t guid, float x, float y, float z, float orientation,
                         uint32_t goState = 0);
 
+    // ----------------------------------------------------------------------
+    // Transport timelines.
+    //
+    // Elevators, trams, boats and zeppelins loop over fixed paths. Instead of
+    // an UpdatePosition call per tick, such an object can be given its path
+    // as keyframes; queries then pose it at the transport time of the query
+    // (TransportTimeScope, or the default set with SetTransportTime), so the
+    // same time always gives the same collision. A timeline object is filed
+    // in the grid under the bounds swept by its whole path, which never
+    // change; each query that reaches it evaluates its pose at the query's
+    // time without storing it, so queries at different times can run
+    // concurrently.
+    // ----------------------------------------------------------------------
+
+    /// One pose on a transport path; timeMs is measured from the start of the cycle.
+    struct TransportKeyframe
+    {
+        uint32_t timeMs;
+        float x, y, z;
+        float orientation;
+    };
+
+    /// Drive a registered object from a looping path. Keyframe times must be
+    /// strictly increasing and below periodMs. Between keyframes the pose is
+    /// interpolated linearly (orientation along the shorter arc); after the
+    /// last keyframe the path runs back to the first one, reached again at
+    /// periodMs. Returns false for an unknown guid or an invalid path.
+    bool SetTransportTimeline(uint64_t guid, const std::vector<TransportKeyframe>& keyframes,
+                              uint32_t periodMs);
+
+    /// Stop driving the object from its timeline; it keeps its last evaluated
+    /// pose until the next UpdatePosition.
+    void ClearTransportTimeline(uint64_t guid);
+
+    /// Pose of a timeline-driven object at timeMs. False when the object has no timeline.
+    bool GetTransportPose(uint64_t guid, uint64_t timeMs, TransportKeyframe& outPose) const;
+
+    /// Transport time used by queries on threads without a TransportTimeScope.
+    void SetTransportTime(uint64_t timeMs) { m_defaultTransportTime.store(timeMs, std::memory_order_relaxed); }
+
+    /// Transport time for queries made on this thread now.
+    uint64_t CurrentTransportTime() const;
+
+    /// Transport time span [t0, t1] this thread's work covers: the step
+    /// interval of the enclosing TransportTimeScope, or unbounded without one.
+    void CurrentTransportInterval(uint64_t& t0, uint64_t& t1) const;
+
+    /// Makes timeMs the transport time of this thread's queries until destroyed
+    /// (see PhysicsEngine::StepV2 callers passing a step timestamp). intervalMs
+    /// is how far past timeMs the step reaches; HasTransportNear and
+    /// GetRegionStamp look at transports over that whole span.
+    class TransportTimeScope
+    {
+    public:
+        explicit TransportTimeScope(uint64_t timeMs, uint32_t intervalMs = 0);
+        ~TransportTimeScope();
+        TransportTimeScope(const TransportTimeScope&) = delete;
+        TransportTimeScope& operator=(const TransportTimeScope&) = delete;
+
+    private:
+        bool m_hadPrevious = false;
+        uint64_t m_previous = 0;
+        uint32_t m_previousInterval = 0;
+    };
+
+    // ----------------------------------------------------------------------
+    // Map instances.
+    //
+    // Dungeons, battlegrounds and other copies of a map run as separate
+    // instances that must not collide with each other's objects. Objects are
+    // registered into a map instance; queries name the map and take the
+    // instance from the calling thread (MapInstanceScope), like the transport
+    // time. Instance 0 is the open world and the default.
+    // ----------------------------------------------------------------------
+
+    /// Map instance of this thread's queries.
+    uint32_t CurrentMapInstance() const;
+
+    /// Makes mapInstanceId the map instance of this thread's queries until
+    /// destroyed (see PhysicsStepV2InInstance).
+    class MapInstanceScope
+    {
+    public:
+        explicit MapInstanceScope(uint32_t mapInstanceId);
+        ~MapInstanceScope();
+        MapInstanceScope(const MapInstanceScope&) = delete;
+        MapInstanceScope& operator=(const MapInstanceScope&) = delete;
+
+    private:
+        uint32_t m_previous = 0;
+    };
+
+    /// Whether a timeline-driven object can overlap the box at some time of
+    /// the current transport interval (CurrentTransportInterval), i.e. whether
+    /// collision in the box can change with the transport time alone during it.
+    bool HasTransportNear(uint32_t mapId, const G3D::AABox& box) const;
+
+    /// Identifies the dynamic collision in an XY region. Two stamps of the
+    /// same region compare equal only if no object in it was added, removed,
+    /// moved or changed GO state and no variant pool changed in between:
+    /// every change gives the object the shard's newest generation, so an
+    /// object entering the region raises newestChange and one leaving it
+    /// lowers objectCount. Changes elsewhere on the map leave it unchanged.
+    struct RegionStamp
+    {
+        uint64_t newestChange = 0;
+        uint64_t variantGeneration = 0;
+        uint32_t objectCount = 0;
+        bool hasTransport = false; // see HasTransportNear
+
+        bool operator==(const RegionStamp& o) const
+        {
+            return newestChange == o.newestChange && variantGeneration == o.variantGeneration &&
+                   objectCount == o.objectCount && hasTransport == o.hasTransport;
+        }
+        bool operator!=(const RegionStamp& o) const { return !(*this == o); }
+    };
+
+    RegionStamp GetRegionStamp(uint32_t mapId, const G3D::AABox& box) const;
+
     /// Remove a single object by GUID.
     void Unregister(uint64_t guid);
 
-    /// Remove all objects on a given map.
+    /// Remove all objects on a given map, in every instance.
     void ClearMap(uint32_t mapId);
 
+    /// Remove all objects of one map instance.
+    void ClearMapInstance(uint32_t mapId, uint32_t mapInstanceId);
+
     /// Remove all registered objects (keeps model cache).
     void ClearAll();
 
     /// Query world-space triangles overlapping a world-space AABB on a given map.
-    /// Appends matching triangles to outTriangles.
+    /// Appends the triangles whose bounds overlap the box to outTriangles,
+    /// grouped by object in runtime instance ID order.
     void QueryTriangles(uint32_t mapId, const G3D::AABox& worldAABB,
                         std::vector<CapsuleCollision::Triangle>& outTriangles,
                         std::vector<uint32_t>* outInstanceIds = nullptr) const;
@@ -87,10 +238,63 @@ public:
     /// Check if a displayId has a known model mapping.
     bool HasDisplayId(uint32_t displayId) const;
 
+    /// Change counter for a map's dynamic collision in the current map
+    /// instance: bumped whenever an object in the instance is added, removed,
+    /// moved or changes GO state, and when the map's variant pools change.
+    /// Callers caching query results for the map compare it to detect staleness.
+    uint64_t GetMapGeneration(uint32_t mapId) const;
+
+    /// Copy of a map's dynamic collision inside an XY region, taken under the
+    /// map's lock together with the map generation. For any box whose XY
+    /// extent lies inside the region, QueryTriangles returns exactly what the
+    /// registry's QueryTriangles would have returned at capture time (same
+    /// triangles, same order), without locking. A region a timeline-driven
+    /// object reaches during the capturing thread's transport interval is
+    /// only valid at the transport time it was captured at; one merely on its
+    /// path stays valid through that interval.
+    struct RegionSnapshot
+    {
+        struct Object
+        {
+            G3D::AABox worldBounds;
+            uint32_t instanceId = 0;
+            std::vector<CapsuleCollision::Triangle> triangles; // model BVH leaf order
+        };
+
+        bool valid = false;
+        uint32_t mapId = 0;
+        uint32_t mapInstanceId = 0;
+        uint64_t generation = 0;
+        uint64_t validFrom = 0;           // transport times the snapshot holds for
+        uint64_t validTo = UINT64_MAX;
+        float minX = 0, minY = 0, maxX = 0, maxY = 0;
+        std::vector<Object> objects;                              // runtime instance ID order
+        std::vector<CapsuleCollision::Triangle> variantTriangles; // pool/tile/triangle order
+
+        bool Covers(uint32_t queryMapId, uint32_t queryMapInstanceId, const G3D::AABox& box,
+                    uint64_t queryTransportTime) const
+        {
+            return valid && queryMapId == mapId && queryMapInstanceId == mapInstanceId &&
+                   queryTransportTime >= validFrom && queryTransportTime <= validTo &&
+                   box.low().x >= minX && box.low().y >= minY &&
+                   box.high().x <= maxX && box.high().y <= maxY;
+        }
+
+        void QueryTriangles(const G3D::AABox& worldAABB,
+                            std::vector<CapsuleCollision::Triangle>& outTriangles,
+                            std::vector<uint32_t>* outInstanceIds = nullptr) const;
+    };
+
+    /// Fill out with the map's dynamic collision in the current map instance
+    /// overlapping the XY region.
+    void CaptureRegion(uint32_t mapId, float minX, float minY, float maxX, float maxY,
+                       RegionSnapshot& out) const;
+
     /// Ensure an object with the given GUID is registered. If already registered,
     /// this is a no-op. If not, registers it by displayId (loads .vmo model if needed).
     /// Returns true if the object is registered (either existing or newly created).
-    bool EnsureRegistered(uint64_t guid, uint32_t displayId, uint32_t mapId, float scale = 1.0f);
+    bool EnsureRegistered(uint64_t guid, uint32_t displayId, uint32_t mapId, float scale = 1.0f,
+                          uint32_t mapInstanceId = 0);
 
     // ----------------------------------------------------------------------
     // Phase 4 — variant scene-cache API.
@@ -132,14 +336,71 @@ public:
 private:
     DynamicObjectRegistry() = default;
 
+    /// Node of a mesh BVH, laid out like SceneCache::BvhNode. Triangles are
+    /// stored in leaf order, so a leaf is a contiguous range and walking the
+    /// tree left to right visits triangles in their stored order.
+    struct MeshBvhNode
+    {
+        float minX, minY, minZ;
+        float maxX, maxY, maxZ;
+        uint32_t first;   // leaf: first triangle; interior: left child (right = first + 1)
+        uint32_t count;   // leaf triangle count, 0 for interior nodes
+    };
+    static_assert(sizeof(MeshBvhNode) == 32, "MeshBvhNode must stay 32 bytes");
+    static constexpr uint32_t MESH_BVH_LEAF_SIZE = 4;
+
+    /// Build nodes over triangles with the given bounds. Returns the leaf
+    /// order: position i of the reordered triangle list holds triangle order[i].
+    static std::vector<uint32_t> BuildMeshBvh(const std::vector<G3D::AABox>& triBounds,
+                                              std::vector<MeshBvhNode>& outNodes);
+
+    /// Visit the leaves of nodes, left to right, whose node passes enter(node).
+    /// leaf(first, count) receives each leaf's triangle range.
+    template<typename EnterFn, typename LeafFn>
+    static void WalkMeshBvh(const std::vector<MeshBvhNode>& nodes, EnterFn&& enter, LeafFn&& leaf);
+
     /// Cached model mesh data extracted from a .vmo file.
     /// Stored once per unique model name, shared across all instances.
     struct CachedModel
     {
         std::string modelName;
         std::vector<G3D::Vector3> localVertices;  // model-local vertices
-        std::vector<uint32_t> localIndices;        // triangle index triples
+        std::vector<uint32_t> localIndices;        // triangle index triples, BVH leaf order
         G3D::AABox localBounds;                     // model-local AABB
+        std::vector<MeshBvhNode> bvh;               // model-local bounds over localIndices
+        float maxTriangleSize = 0.0f;               // longest triangle bounds diagonal
+    };
+
+    /// Reorder the model's triangles into leaf order and build its BVH.
+    static void BuildModelBvh(CachedModel& model);
+
+    /// Keyframed path of a transport (SetTransportTimeline). Immutable once set.
+    struct TransportTimeline
+    {
+        std::vector<TransportKeyframe> keyframes;
+        uint32_t periodMs = 0;
+        float radius = 0.0f;            // XY reach of the model around its position, any orientation
+        float zLo = 0.0f, zHi = 0.0f;   // Z extent of the model around its position
+        G3D::AABox sweptBounds;         // contains the object's collision at any time
+
+        TransportKeyframe Evaluate(uint64_t timeMs) const;
+        // Contains the object's collision at every time in [t0, t1]: the
+        // poses at both ends and the keyframes passed in between, grown by
+        // the model's reach. sweptBounds once the span covers a whole period.
+        G3D::AABox SweptBounds(uint64_t t0, uint64_t t1) const;
+    };
+
+    /// World transform of an object: scale -> rotate around Z -> translate.
+    struct ObjectPose
+    {
+        float x = 0, y = 0, z = 0;
+        float orientation = 0;
+        float cosO = 1.0f, sinO = 0.0f;
+
+        static ObjectPose Make(float x, float y, float z, float orientation)
+        {
+            return { x, y, z, orientation, cosf(orientation), sinf(orientation) };
+        }
     };
 
     /// A placed dynamic object in the world.
@@ -149,23 +410,73 @@ private:
         uint32_t entry = 0;
         uint32_t displayId = 0;
         uint32_t mapId = 0;
+        uint32_t mapInstanceId = 0;
         uint32_t runtimeInstanceId = 0;
         float scale = 1.0f;
         uint32_t goState = 0;    // 0=closed/default, 1=open/active
         bool isDoorModel = false; // true if model name contains "door" (case-insensitive)
+        bool placed = false;      // set by the first UpdatePosition or SetTransportTimeline
+        // Shard generation of the object's last change (see RegionStamp).
+        uint64_t changeStamp = 0;
 
-        // World transform
-        float posX = 0, posY = 0, posZ = 0;
-        float orientation = 0;
+        // World transform from UpdatePosition (or the pose a cleared
+        // timeline left). Unused while a timeline drives the object.
+        ObjectPose pose;
 
         // Reference to cached model data
         std::shared_ptr<CachedModel> model;
 
-        // Pre-transformed world-space triangles (rebuilt on position change)
-        std::vector<CapsuleCollision::Triangle> worldTriangles;
-        G3D::AABox worldBounds;
+        // Set while the pose comes from a transport timeline. Queries pose
+        // the object at their own transport time (PoseAt).
+        std::shared_ptr<const TransportTimeline> timeline;
+
+        // Model local bounds carried through pose, padded for rounding.
+        // O(1) to update and contains every posed triangle; used by the grid
+        // and to skip objects before visiting their triangles.
+        G3D::AABox poseBounds;
+
+        // Grid cells the object is filed under (see ObjectGrid).
+        bool indexed = false;
+        bool inLargeList = false;
+        int cellMinX = 0, cellMinY = 0, cellMaxX = 0, cellMaxY = 0;
+
+        bool HasCollision() const { return placed && model && !model->localIndices.empty(); }
+        // What the grid files the object under.
+        const G3D::AABox& BroadBounds() const { return timeline ? timeline->sweptBounds : poseBounds; }
+        void UpdatePoseBounds() { poseBounds = PosedBounds(pose); }
+        // Model local bounds carried through p, padded like poseBounds.
+        G3D::AABox PosedBounds(const ObjectPose& p) const;
+        // Pose and posed bounds at transport time timeMs: the timeline
+        // evaluated at timeMs, else the stored pose. Reads only, so it is
+        // safe under a shared shard lock.
+        void PoseAt(uint64_t timeMs, ObjectPose& outPose, G3D::AABox& outBounds) const;
+        // Model triangle t (BVH leaf order) posed by p.
+        CapsuleCollision::Triangle WorldTriangle(const ObjectPose& p, uint32_t t) const;
+        // Inverse of the pose transform, as in TryGetLocalPoint.
+        G3D::Vector3 WorldToLocal(const ObjectPose& p, const G3D::Vector3& v) const;
+        // Model-local box holding every model triangle whose posed bounds
+        // overlap box: the box carried through the inverse pose, grown by the
+        // model's largest triangle (posed bounds are not rotation invariant)
+        // and padded like poseBounds. False for a degenerate scale, where
+        // nothing can be culled in model space.
+        bool WorldBoxToLocal(const ObjectPose& p, const G3D::AABox& box,
+                             G3D::Vector3& outLow, G3D::Vector3& outHigh) const;
+        // Model-space padding matching the world-space pad of poseBounds.
+        float LocalPad() const { return 0.05f / fabsf(scale); }
+        bool HasInvertibleScale() const { return fabsf(scale) > 1e-6f; }
+    };
+
+    /// Broad phase for one map's placed objects. An object is listed in every
+    /// cell its world XY bounds (a transport's swept bounds) touch; objects spanning more than
+    /// MAX_CELL_SPAN cells on an axis (transports) are kept in `large` and
+    /// tested by every query instead.
+    static constexpr float CELL_SIZE = 16.0f;
+    static constexpr int MAX_CELL_SPAN = 8;
 
-        void RebuildWorldTriangles();
+    struct ObjectGrid
+    {
+        std::unordered_map<uint64_t, std::vector<DynamicObject*>> cells;
+        std::vector<DynamicObject*> large;
     };
 
     /// DisplayId mapping entry from temp_gameobject_models.
@@ -180,9 +491,10 @@ private:
     {
         int tileX = 0;
         int tileY = 0;
-        std::vector<CapsuleCollision::Triangle> triangles;
+        std::vector<CapsuleCollision::Triangle> triangles; // BVH leaf order
         G3D::AABox bounds;          // union of triangle vertices in this tile
         bool boundsValid = false;
+        std::vector<MeshBvhNode> bvh;
     };
 
     /// All tiles for one (mapId, variantId) key. UnloadVariant erases this whole
@@ -197,7 +509,89 @@ private:
         size_t totalTriangles = 0;
     };
 
-    mutable std::mutex m_mutex;
+    static int CellCoord(float v) { return static_cast<int>(std::floor(v / CELL_SIZE)); }
+    static uint64_t CellKey(int cx, int cy)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+    }
+
+    /// Everything registered in one map instance. Shards are created on first
+    /// use and live as long as the registry, so a shard pointer stays valid
+    /// after m_shardsMutex is released.
+    struct MapShard
+    {
+        mutable std::shared_mutex mutex;
+        // The map's instance-0 shard, which holds the variant pools every
+        // instance sees; this shard itself for instance 0.
+        MapShard* worldShard = this;
+
+        // guid → placed object instance
+        std::unordered_map<uint64_t, DynamicObject> objects;
+        // Points into objects, whose nodes never move.
+        ObjectGrid grid;
+        // variantId → bulk variant pool (Phase 4); only used in instance-0 shards.
+        std::map<std::string, VariantPool> variantPools;
+        // Change counter (see GetMapGeneration); bumped with the lock held exclusively.
+        std::atomic<uint64_t> generation{ 0 };
+        // Generation of the last variant pool change; written with the lock held exclusively.
+        std::atomic<uint64_t> variantGeneration{ 0 };
+
+        uint64_t BumpGeneration() { return generation.fetch_add(1, std::memory_order_relaxed) + 1; }
+        void MarkChanged(DynamicObject& obj) { obj.changeStamp = BumpGeneration(); }
+        void MarkVariantsChanged() { variantGeneration.store(BumpGeneration(), std::memory_order_relaxed); }
+        // Changes with this instance's objects and with the map's variant
+        // pools, but not with objects of the map's other instances. Both
+        // terms only grow, so any change moves the sum.
+        uint64_t CombinedGeneration() const
+        {
+            uint64_t g = generation.load(std::memory_order_relaxed);
+            if (worldShard != this)
+                g += worldShard->variantGeneration.load(std::memory_order_relaxed);
+            return g;
+        }
+
+        /// File obj under the cells of its current world bounds (or drop it from
+        /// the grid when it has no collision yet). Cheap when the cells are unchanged.
+        void IndexObject(DynamicObject& obj);
+        void UnindexObject(DynamicObject& obj);
+
+        /// Objects whose cells overlap the XY box, in runtime instance ID order.
+        void GatherObjects(float minX, float minY, float maxX, float maxY,
+                           std::vector<const DynamicObject*>& out) const;
+    };
+
+    static uint64_t ShardKey(uint32_t mapId, uint32_t mapInstanceId)
+    {
+        return (static_cast<uint64_t>(mapId) << 32) | mapInstanceId;
+    }
+    static uint32_t ShardMapId(uint64_t key) { return static_cast<uint32_t>(key >> 32); }
+
+    /// The shard, or null when nothing was ever registered or loaded in it.
+    MapShard* FindShard(uint64_t key) const;
+    /// Creating an instance shard also creates its map's instance-0 shard.
+    MapShard& GetOrCreateShard(uint64_t key) const;
+    /// Shard queries on mapId read in the current map instance, or null when
+    /// nothing was ever registered or loaded on the map.
+    const MapShard* QueryShard(uint32_t mapId) const;
+
+    /// Run query() with the shard lock (and its world shard's lock) held shared.
+    template<typename QueryFn>
+    static void RunShardQuery(const MapShard& shard, QueryFn&& query);
+
+    mutable std::shared_mutex m_shardsMutex;
+    mutable std::unordered_map<uint64_t, std::unique_ptr<MapShard>> m_shards;   // by ShardKey
+
+    // Which shard each object is in, for calls that only name the object.
+    // Taken before a shard lock when both are needed.
+    mutable std::shared_mutex m_directoryMutex;
+    std::unordered_map<uint64_t, uint64_t> m_guidToShard;
+    std::unordered_map<uint32_t, uint64_t> m_instanceIdToGuid;
+    uint32_t m_nextRuntimeInstanceId = 0x80000001u;
+
+    std::atomic<uint64_t> m_defaultTransportTime{ 0 };
+
+    // Shared by every shard. Never held together with another registry lock.
+    mutable std::mutex m_modelMutex;
     std::string m_vmapsBasePath;
     bool m_mappingLoaded = false;
 
@@ -207,13 +601,9 @@ private:
     // modelName → cached mesh data (loaded from .vmo files)
     std::unordered_map<std::string, std::shared_ptr<CachedModel>> m_modelCache;
 
-    // guid → placed object instance
-    std::unordered_map<uint64_t, DynamicObject> m_objects;
-    std::unordered_map<uint32_t, uint64_t> m_instanceIdToGuid;
-    uint32_t m_nextRuntimeInstanceId = 0x80000001u;
-
-    // (mapId, variantId) → bulk variant pool (Phase 4).
-    std::map<std::pair<uint32_t, std::string>, VariantPool> m_variantPools;
+    /// Model for a displayId (mapped model or fallback hull), under m_modelMutex.
+    /// Returns nullptr when a mapped model fails to load.
+    std::shared_ptr<CachedModel> ResolveModel(uint32_t displayId, bool& outIsDoorModel);
 
     /// Load and cache a model by its .vmo filename. Returns nullptr on failure.
     std::shared_ptr<CachedModel> LoadModel(const std::string& modelName);
@@ -222,7 +612,10 @@ private:
     /// missing from temp_gameobject_models.
     std::shared_ptr<CachedModel> CreateFallbackModel(uint32_t displayId);
 
+    /// Called with m_directoryMutex held exclusively.
     uint32_t AllocateRuntimeInstanceId();
+    /// Remove every object of the shard; called with m_directoryMutex held exclusively.
+    void ClearShardObjects(MapShard& shard);
 
     static DynamicObjectRegistry* s_instance;
 };
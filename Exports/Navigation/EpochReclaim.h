@@ -0,0 +1,108 @@
+#pragma once
+
+// EpochReclaim.h - Epoch-based reclamation for lock-free readers of
+// atomically published entries (MapLoader tiles, SceneTileStreamer tiles).
+//
+// Each reading thread owns a record holding the global epoch it entered its
+// read section at (0 when not reading). An entry unpublished and then retired
+// at epoch E can be freed once every record is 0 or >= E: a reader that still
+// holds the entry must have announced itself before the entry was
+// unpublished, so it announced an epoch below E.
+
+#include <atomic>
+#include <cstdint>
+
+namespace EpochReclaim
+{
+    struct Record
+    {
+        alignas(64) std::atomic<uint64_t> epoch{ 0 };
+        std::atomic<bool> claimed{ false };
+        Record* next = nullptr;
+    };
+
+    inline std::atomic<uint64_t> g_epoch{ 1 };
+    // Records are never freed; a thread releases its record on exit and the
+    // next new thread reuses it.
+    inline std::atomic<Record*> g_records{ nullptr };
+
+    inline Record* ClaimRecord()
+    {
+        for (Record* r = g_records.load(std::memory_order_acquire); r; r = r->next)
+        {
+            bool expected = false;
+            if (!r->claimed.load(std::memory_order_relaxed) && r->claimed.compare_exchange_strong(expected, true))
+                return r;
+        }
+
+        auto* record = new Record();
+        record->claimed.store(true, std::memory_order_relaxed);
+        Record* head = g_records.load(std::memory_order_relaxed);
+        do
+        {
+            record->next = head;
+        } while (!g_records.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+        return record;
+    }
+
+    struct ThreadState
+    {
+        Record* record = nullptr;
+        int depth = 0;
+
+        ~ThreadState()
+        {
+            if (record)
+                record->claimed.store(false, std::memory_order_release);
+        }
+    };
+
+    inline thread_local ThreadState t_state;
+
+    // Lowest epoch any reader announced, or UINT64_MAX when none is reading.
+    inline uint64_t OldestActiveEpoch()
+    {
+        uint64_t oldest = UINT64_MAX;
+        for (Record* r = g_records.load(std::memory_order_acquire); r; r = r->next)
+        {
+            uint64_t e = r->epoch.load();
+            if (e != 0 && e < oldest)
+                oldest = e;
+        }
+        return oldest;
+    }
+
+    // Epoch to retire an entry at, called right after unpublishing it. The
+    // entry may be freed once RetiredEpoch <= OldestActiveEpoch().
+    inline uint64_t RetireEpoch()
+    {
+        return g_epoch.fetch_add(1) + 1;
+    }
+
+    // Marks the calling thread as reading published entries until destroyed;
+    // entries looked up meanwhile stay allocated. Sections may nest.
+    class ReadGuard
+    {
+    public:
+        ReadGuard()
+        {
+            if (t_state.depth++ == 0)
+            {
+                if (!t_state.record)
+                    t_state.record = ClaimRecord();
+                // Sequentially consistent, so the announcement is ordered
+                // before the slot loads that follow it.
+                t_state.record->epoch.store(g_epoch.load());
+            }
+        }
+
+        ~ReadGuard()
+        {
+            if (--t_state.depth == 0)
+                t_state.record->epoch.store(0, std::memory_order_release);
+        }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+    };
+}
@@ -443,9 +443,9 @@ bool GridMap::loadData(const std::string& filename)
 
     fclose(in);
 
-    // Pre-compute terrain triangle cache after all data is loaded
+    // Terrain triangles are derived from V9/V8 on demand once heights are in
     if (success)
-        buildTriangleCache();
+        m_hasTerrainTriangles = (m_V9 || m_uint16_V9 || m_uint8_V9) && (m_V8 || m_uint16_V8 || m_uint8_V8);
 
     return success;
 }
@@ -483,6 +483,33 @@ void GridMap::unloadData()
     m_holes = nullptr;
 
     m_gridGetHeight = nullptr;
+    m_hasTerrainTriangles = false;
+}
+
+size_t GridMap::getMemoryUsage() const
+{
+    size_t bytes = sizeof(GridMap);
+    if (m_heightHeader) bytes += sizeof(MapHeightHeader);
+    if (m_liquidHeader) bytes += sizeof(MapLiquidHeader);
+    if (m_areaHeader) bytes += sizeof(MapAreaHeader);
+
+    if (m_V9)
+    {
+        size_t sampleSize = sizeof(float);
+        if (m_gridGetHeight == &GridMap::getHeightFromUint16)
+            sampleSize = sizeof(uint16_t);
+        else if (m_gridGetHeight == &GridMap::getHeightFromUint8)
+            sampleSize = sizeof(uint8_t);
+        bytes += sampleSize * (V9_SIZE_SQ + V8_SIZE_SQ);
+    }
+
+    if (m_liquidHeight && m_liquidHeader)
+        bytes += sizeof(float) * m_liquidHeader->width * m_liquidHeader->height;
+    if (m_liquidEntry) bytes += sizeof(uint16_t) * 16 * 16;
+    if (m_liquidFlags) bytes += sizeof(uint8_t) * 16 * 16;
+    if (m_areaMap) bytes += sizeof(uint16_t) * 16 * 16;
+    if (m_holes) bytes += sizeof(uint16_t) * 64;
+    return bytes;
 }
 
 float GridMap::getHeight(float x, float y) const
@@ -751,14 +778,9 @@ float GridMap::sampleV9Height(int xi, int yi) const
     if (xi < 0 || xi >= V9_SIZE || yi < 0 || yi >= V9_SIZE)
         return INVALID_HEIGHT;
 
-    int idx = xi * V9_SIZE + yi;
-    if (m_V9)
-        return m_V9[idx];
-    if (m_uint16_V9)
-        return m_uint16_V9[idx] * m_gridIntHeightMultiplier + m_gridHeight;
-    if (m_uint8_V9)
-        return m_uint8_V9[idx] * m_gridIntHeightMultiplier + m_gridHeight;
-    return INVALID_HEIGHT;
+    float h;
+    sampleV9Row(xi, yi, 1, &h);
+    return h;
 }
 
 // Helper to sample V8 (center) heights regardless of storage type
@@ -766,14 +788,46 @@ float GridMap::sampleV8Center(int xi, int yi) const
 {
     if (xi < 0 || xi >= V8_SIZE || yi < 0 || yi >= V8_SIZE)
         return INVALID_HEIGHT;
-    int idx = xi * V8_SIZE + yi;
-    if (m_V8)
-        return m_V8[idx];
-    if (m_uint16_V8)
-        return (m_uint16_V8[idx] * m_gridIntHeightMultiplier + m_gridHeight);
-    if (m_uint8_V8)
-        return (m_uint8_V8[idx] * m_gridIntHeightMultiplier + m_gridHeight);
-    return INVALID_HEIGHT;
+    float h;
+    sampleV8Row(xi, yi, 1, &h);
+    return h;
+}
+
+// Integer storage decodes as value * multiplier + base; kept in a plain loop
+// over contiguous values so it vectorizes for row reads.
+template <typename T>
+static void decodeHeightRow(const T* src, int count, float multiplier, float base, float* out)
+{
+    for (int i = 0; i < count; ++i)
+        out[i] = src[i] * multiplier + base;
+}
+
+// The V9/V8 pointers share a union per array, so the storage format is told
+// apart by the height getter loadHeightData picked, not by which pointer is set.
+void GridMap::sampleV9Row(int xi, int yi0, int count, float* out) const
+{
+    const int idx = xi * V9_SIZE + yi0;
+    if (!m_V9)
+        std::fill(out, out + count, INVALID_HEIGHT);
+    else if (m_gridGetHeight == &GridMap::getHeightFromUint16)
+        decodeHeightRow(m_uint16_V9 + idx, count, m_gridIntHeightMultiplier, m_gridHeight, out);
+    else if (m_gridGetHeight == &GridMap::getHeightFromUint8)
+        decodeHeightRow(m_uint8_V9 + idx, count, m_gridIntHeightMultiplier, m_gridHeight, out);
+    else
+        std::copy(m_V9 + idx, m_V9 + idx + count, out);
+}
+
+void GridMap::sampleV8Row(int xi, int yi0, int count, float* out) const
+{
+    const int idx = xi * V8_SIZE + yi0;
+    if (!m_V8)
+        std::fill(out, out + count, INVALID_HEIGHT);
+    else if (m_gridGetHeight == &GridMap::getHeightFromUint16)
+        decodeHeightRow(m_uint16_V8 + idx, count, m_gridIntHeightMultiplier, m_gridHeight, out);
+    else if (m_gridGetHeight == &GridMap::getHeightFromUint8)
+        decodeHeightRow(m_uint8_V8 + idx, count, m_gridIntHeightMultiplier, m_gridHeight, out);
+    else
+        std::copy(m_V8 + idx, m_V8 + idx + count, out);
 }
 
 // New: compute surface normal at world position (returns false if invalid / hole)
@@ -922,7 +976,7 @@ void GridMap::getTerrainTriangles(std::vector<TerrainTriangle>& out) const
 void GridMap::getTerrainTrianglesInAABB(float minX, float minY, float maxX, float maxY,
                                         std::vector<TerrainTriangle>& out) const
 {
-    if (!m_trianglesCached) return;
+    if (!m_hasTerrainTriangles) return;
 
     // Clamp to tile-local bounds [0, GRID_SIZE]
     float x0 = std::max(0.0f, minX);
@@ -936,24 +990,48 @@ void GridMap::getTerrainTrianglesInAABB(float minX, float minY, float maxX, floa
     int xi1 = std::min(V8_SIZE - 1, (int)std::floor(x1 / GRID_PART_SIZE));
     int yi1 = std::min(V8_SIZE - 1, (int)std::floor(y1 / GRID_PART_SIZE));
 
+    // Decode the covered V9 corner rows and V8 center row once per square
+    // row; neighbouring squares share corners.
+    const int cols = yi1 - yi0 + 1;
+    float nearRow[V9_SIZE], farRow[V9_SIZE], centerRow[V8_SIZE];
+    sampleV9Row(xi0, yi0, cols + 1, nearRow);
+
     for (int xi = xi0; xi <= xi1; ++xi)
     {
-        for (int yi = yi0; yi <= yi1; ++yi)
+        sampleV9Row(xi + 1, yi0, cols + 1, farRow);
+        sampleV8Row(xi, yi0, cols, centerRow);
+
+        for (int c = 0; c < cols; ++c)
         {
-            const auto& cell = m_cellTriangles[xi][yi];
-            for (int t = 0; t < cell.count; t++)
-                out.push_back(cell.tris[t]);
+            const int yi = yi0 + c;
+            if (isHole(xi, yi))
+                continue;
+
+            float h1 = nearRow[c];
+            float h2 = farRow[c];
+            float h3 = nearRow[c + 1];
+            float h4 = farRow[c + 1];
+            float h5 = centerRow[c];
+            if (h1 <= INVALID_HEIGHT || h2 <= INVALID_HEIGHT ||
+                h3 <= INVALID_HEIGHT || h4 <= INVALID_HEIGHT ||
+                h5 <= INVALID_HEIGHT)
+            {
+                continue;
+            }
+
+            TerrainTriangle tris[4];
+            makeCellTriangles(xi, yi, h1, h2, h3, h4, h5, tris);
+            out.insert(out.end(), tris, tris + 4);
         }
+        std::copy(farRow, farRow + cols + 1, nearRow);
     }
 }
 
-// ---- Pre-computed triangle cache ----
+// ---- On-demand cell triangles ----
 
-void GridMap::buildTriangleCache()
+void GridMap::makeCellTriangles(int xi, int yi, float h1, float h2, float h3, float h4, float h5,
+                                TerrainTriangle* out)
 {
-    if (!(m_V9 || m_uint16_V9 || m_uint8_V9) || !(m_V8 || m_uint16_V8 || m_uint8_V8))
-        return;
-
     auto makeUpward = [](float ax, float ay, float az,
                          float bx, float by, float bz,
                          float cx, float cy, float cz) -> TerrainTriangle {
@@ -966,49 +1044,44 @@ void GridMap::buildTriangleCache()
             return { ax, ay, az, bx, by, bz, cx, cy, cz };
     };
 
-    for (int xi = 0; xi < V8_SIZE; ++xi)
-    {
-        for (int yi = 0; yi < V8_SIZE; ++yi)
-        {
-            auto& cell = m_cellTriangles[xi][yi];
-            cell.count = 0;
-
-            if (isHole(xi, yi))
-                continue;
-
-            float h1 = sampleV9Height(xi, yi);
-            float h2 = sampleV9Height(xi + 1, yi);
-            float h3 = sampleV9Height(xi, yi + 1);
-            float h4 = sampleV9Height(xi + 1, yi + 1);
-            float h5 = sampleV8Center(xi, yi);
-
-            if (h1 <= INVALID_HEIGHT || h2 <= INVALID_HEIGHT ||
-                h3 <= INVALID_HEIGHT || h4 <= INVALID_HEIGHT ||
-                h5 <= INVALID_HEIGHT)
-            {
-                continue;
-            }
+    // V8 center value is stored as 2*actual_height in vMaNGOS format;
+    // the bilinear formula halves it internally, so triangles need h5*0.5
+    float centerH = h5 * 0.5f;
+
+    float wx0 = xi * GRID_PART_SIZE;
+    float wy0 = yi * GRID_PART_SIZE;
+    float wx1 = (xi + 1) * GRID_PART_SIZE;
+    float wy1 = (yi + 1) * GRID_PART_SIZE;
+    float cx = (wx0 + wx1) * 0.5f;
+    float cy = (wy0 + wy1) * 0.5f;
+
+    // 4 triangles in fan pattern around center (matching getTerrainTriangles order)
+    out[0] = makeUpward(wx0, wy0, h1, wx1, wy0, h2, cx, cy, centerH);
+    out[1] = makeUpward(wx0, wy0, h1, wx0, wy1, h3, cx, cy, centerH);
+    out[2] = makeUpward(wx1, wy0, h2, wx1, wy1, h4, cx, cy, centerH);
+    out[3] = makeUpward(wx0, wy1, h3, wx1, wy1, h4, cx, cy, centerH);
+}
 
-            // V8 center value is stored as 2*actual_height in vMaNGOS format;
-            // the bilinear formula halves it internally, so triangles need h5*0.5
-            float centerH = h5 * 0.5f;
+bool GridMap::getCellTriangles(int xi, int yi, TerrainTriangle* out) const
+{
+    if (!m_hasTerrainTriangles || isHole(xi, yi))
+        return false;
 
-            float wx0 = xi * GRID_PART_SIZE;
-            float wy0 = yi * GRID_PART_SIZE;
-            float wx1 = (xi + 1) * GRID_PART_SIZE;
-            float wy1 = (yi + 1) * GRID_PART_SIZE;
-            float cx = (wx0 + wx1) * 0.5f;
-            float cy = (wy0 + wy1) * 0.5f;
+    float h1 = sampleV9Height(xi, yi);
+    float h2 = sampleV9Height(xi + 1, yi);
+    float h3 = sampleV9Height(xi, yi + 1);
+    float h4 = sampleV9Height(xi + 1, yi + 1);
+    float h5 = sampleV8Center(xi, yi);
 
-            // 4 triangles in fan pattern around center (matching getTerrainTriangles order)
-            cell.tris[0] = makeUpward(wx0, wy0, h1, wx1, wy0, h2, cx, cy, centerH);
-            cell.tris[1] = makeUpward(wx0, wy0, h1, wx0, wy1, h3, cx, cy, centerH);
-            cell.tris[2] = makeUpward(wx1, wy0, h2, wx1, wy1, h4, cx, cy, centerH);
-            cell.tris[3] = makeUpward(wx0, wy1, h3, wx1, wy1, h4, cx, cy, centerH);
-            cell.count = 4;
-        }
+    if (h1 <= INVALID_HEIGHT || h2 <= INVALID_HEIGHT ||
+        h3 <= INVALID_HEIGHT || h4 <= INVALID_HEIGHT ||
+        h5 <= INVALID_HEIGHT)
+    {
+        return false;
     }
-    m_trianglesCached = true;
+
+    makeCellTriangles(xi, yi, h1, h2, h3, h4, h5, out);
+    return true;
 }
 
 // Barycentric test: is point (px, py) inside triangle XY projection? If so, compute Z.
@@ -1041,20 +1114,20 @@ static bool pointOnTriangleXY(const TerrainTriangle& tri, float px, float py, fl
 
 float GridMap::getTriangleZ(float localX, float localY) const
 {
-    if (!m_trianglesCached) return INVALID_HEIGHT;
+    if (!m_hasTerrainTriangles) return INVALID_HEIGHT;
 
     int cellX = (int)(localX / GRID_PART_SIZE);
     int cellY = (int)(localY / GRID_PART_SIZE);
     if (cellX < 0 || cellX >= V8_SIZE || cellY < 0 || cellY >= V8_SIZE)
         return INVALID_HEIGHT;
 
-    const auto& cell = m_cellTriangles[cellX][cellY];
-    if (cell.count == 0) return INVALID_HEIGHT;
+    TerrainTriangle tris[4];
+    if (!getCellTriangles(cellX, cellY, tris)) return INVALID_HEIGHT;
 
-    for (int t = 0; t < cell.count; t++)
+    for (int t = 0; t < 4; t++)
     {
         float z;
-        if (pointOnTriangleXY(cell.tris[t], localX, localY, z))
+        if (pointOnTriangleXY(tris[t], localX, localY, z))
             return z;
     }
     return INVALID_HEIGHT;
@@ -1063,6 +1136,7 @@ float GridMap::getTriangleZ(float localX, float localY) const
 // ==================== MapLoader Implementation ====================
 
 MapLoader::MapLoader()
+    : m_maps(std::make_unique<std::atomic<MapTiles*>[]>(DIRECT_MAP_COUNT))
 {
 
 }
@@ -1070,6 +1144,19 @@ MapLoader::MapLoader()
 MapLoader::~MapLoader()
 {
     Shutdown();
+
+    // No reader can be running any more, so whatever is still retired goes.
+    for (auto& [epoch, entry] : m_retired)
+        delete entry;
+    m_retired.clear();
+    for (uint32_t i = 0; i < DIRECT_MAP_COUNT; ++i)
+        delete m_maps[i].load();
+    for (OtherMap* map = m_otherMaps.load(); map;)
+    {
+        OtherMap* next = map->next;
+        delete map;
+        map = next;
+    }
 }
 
 bool MapLoader::Initialize(const std::string& dataPath)
@@ -1094,7 +1181,8 @@ void MapLoader::Shutdown()
 {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    m_loadedTiles.clear();
+    unpublishAllLocked();
+    reclaimLocked();
     m_initialized = false;
 }
 
@@ -1119,44 +1207,216 @@ void MapLoader::worldToGridCoords(float worldX, float worldY, uint32_t& gridX, u
 
 bool MapLoader::LoadMapTile(uint32_t mapId, uint32_t x, uint32_t y)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    ReadGuard guard;
+    return acquireTile(mapId, x, y) != nullptr;
+}
+
+std::atomic<MapLoader::TileEntry*>* MapLoader::findSlot(uint32_t mapId, uint32_t x, uint32_t y, bool create)
+{
+    if (x >= TILES_PER_MAP || y >= TILES_PER_MAP)
+        return nullptr;
 
-    uint64_t key = makeKey(mapId, x, y);
-    if (m_loadedTiles.find(key) != m_loadedTiles.end())
+    MapTiles* tiles = nullptr;
+    if (mapId < DIRECT_MAP_COUNT)
     {
-        return true;
+        tiles = m_maps[mapId].load(std::memory_order_acquire);
+        if (!tiles && create)
+        {
+            // Only writers (holding m_mutex) create tables.
+            tiles = new MapTiles();
+            m_maps[mapId].store(tiles, std::memory_order_release);
+        }
+    }
+    else
+    {
+        OtherMap* head = m_otherMaps.load(std::memory_order_acquire);
+        for (OtherMap* map = head; map && !tiles; map = map->next)
+        {
+            if (map->mapId == mapId)
+                tiles = &map->tiles;
+        }
+        if (!tiles && create)
+        {
+            // Only writers (holding m_mutex) push nodes, so head is current.
+            auto* map = new OtherMap();
+            map->mapId = mapId;
+            map->next = head;
+            m_otherMaps.store(map, std::memory_order_release);
+            tiles = &map->tiles;
+        }
+    }
+
+    return tiles ? &tiles->slots[x * TILES_PER_MAP + y] : nullptr;
+}
+
+GridMap* MapLoader::acquireTile(uint32_t mapId, uint32_t x, uint32_t y)
+{
+    if (std::atomic<TileEntry*>* slot = findSlot(mapId, x, y, false))
+    {
+        if (TileEntry* entry = slot->load())
+        {
+            // Every hit takes a fresh stamp, so eviction sees the most
+            // recently read tiles as recent and not just recently loaded ones.
+            entry->lastUse.store(m_useClock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return entry->tile.get();
+        }
     }
+    if (x >= TILES_PER_MAP || y >= TILES_PER_MAP)
+        return nullptr;
 
+    // Read the file without holding the lock so parallel extraction can load
+    // different tiles at once. If two threads race on the same tile the first
+    // insert wins and the other copy is dropped.
     std::string filename = getMapFileName(mapId, x, y);
 
     if (!std::filesystem::exists(filename))
     {
-        return false;
+        return nullptr;
     }
 
-    auto gridMap = std::make_unique<GridMap>();
+    auto gridMap = std::make_shared<GridMap>();
     if (!gridMap->loadData(filename))
     {
-        return false;
+        return nullptr;
     }
 
-    m_loadedTiles[key] = std::move(gridMap);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::atomic<TileEntry*>* slot = findSlot(mapId, x, y, true);
+    TileEntry* entry = slot->load(std::memory_order_relaxed);
+    if (!entry)
+    {
+        entry = new TileEntry();
+        entry->bytes = gridMap->getMemoryUsage();
+        entry->tile = std::move(gridMap);
+        m_residentBytes += entry->bytes;
+        ++m_loadCount;
+        m_resident.emplace(makeKey(mapId, x, y), entry);
+        m_tileCount.store(m_resident.size(), std::memory_order_relaxed);
+        slot->store(entry);
+    }
+    entry->lastUse.store(m_useClock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    evictOverBudgetLocked(makeKey(mapId, x, y));
+    reclaimLocked();
 
-    return true;
+    // Still valid after eviction of other tiles; the caller's ReadGuard keeps
+    // it allocated even if a later writer evicts it.
+    return entry->tile.get();
+}
+
+void MapLoader::evictOverBudgetLocked(uint64_t pinnedKey)
+{
+    while (m_residentBytes > m_budget)
+    {
+        auto victim = m_resident.end();
+        uint64_t victimUse = 0;
+        for (auto it = m_resident.begin(); it != m_resident.end(); ++it)
+        {
+            if (it->first == pinnedKey)
+                continue;
+            uint64_t use = it->second->lastUse.load(std::memory_order_relaxed);
+            if (victim == m_resident.end() || use < victimUse)
+            {
+                victim = it;
+                victimUse = use;
+            }
+        }
+        if (victim == m_resident.end())
+            break; // only the tile being handed out is left
+
+        unpublishLocked(victim);
+        ++m_evictionCount;
+    }
+}
+
+void MapLoader::unpublishLocked(std::unordered_map<uint64_t, TileEntry*>::iterator it)
+{
+    const uint64_t key = it->first;
+    TileEntry* entry = it->second;
+    findSlot(static_cast<uint32_t>(key >> 32), static_cast<uint32_t>((key >> 16) & 0xFFFF),
+             static_cast<uint32_t>(key & 0xFFFF), true)->store(nullptr);
+    m_residentBytes -= entry->bytes;
+    m_resident.erase(it);
+    m_tileCount.store(m_resident.size(), std::memory_order_relaxed);
+    m_retired.emplace_back(EpochReclaim::RetireEpoch(), entry);
+}
+
+void MapLoader::unpublishAllLocked()
+{
+    while (!m_resident.empty())
+        unpublishLocked(m_resident.begin());
+}
+
+void MapLoader::reclaimLocked()
+{
+    if (m_retired.empty())
+        return;
+
+    const uint64_t oldest = EpochReclaim::OldestActiveEpoch();
+    auto keep = std::remove_if(m_retired.begin(), m_retired.end(), [&](const std::pair<uint64_t, TileEntry*>& retired) {
+        if (retired.first > oldest)
+            return false;
+        delete retired.second;
+        return true;
+    });
+    m_retired.erase(keep, m_retired.end());
 }
 
 void MapLoader::UnloadMapTile(uint32_t mapId, uint32_t x, uint32_t y)
 {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    m_loadedTiles.erase(makeKey(mapId, x, y));
+    auto it = m_resident.find(makeKey(mapId, x, y));
+    if (it != m_resident.end())
+        unpublishLocked(it);
+    reclaimLocked();
 }
 
 void MapLoader::UnloadAllTiles()
 {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    m_loadedTiles.clear();
+    unpublishAllLocked();
+    reclaimLocked();
+}
+
+std::shared_ptr<GridMap> MapLoader::GetGridMap(uint32_t mapId, uint32_t x, uint32_t y)
+{
+    ReadGuard guard;
+    std::atomic<TileEntry*>* slot = findSlot(mapId, x, y, false);
+    TileEntry* entry = slot ? slot->load() : nullptr;
+    return entry ? entry->tile : nullptr;
+}
+
+void MapLoader::SetMemoryBudget(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = bytes;
+    evictOverBudgetLocked(NO_PINNED_TILE);
+    reclaimLocked();
+}
+
+size_t MapLoader::GetMemoryBudget() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_budget;
+}
+
+size_t MapLoader::GetMemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_residentBytes;
+}
+
+MapLoader::MemoryStats MapLoader::GetMemoryStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    MemoryStats stats;
+    stats.tileCount = m_resident.size();
+    stats.residentBytes = m_residentBytes;
+    stats.budget = m_budget;
+    stats.loads = m_loadCount;
+    stats.evictions = m_evictionCount;
+    return stats;
 }
 
 void MapLoader::computeTileOrigin(uint32_t gridY, uint32_t gridX, float& originX, float& originY) const
@@ -1314,14 +1574,9 @@ float MapLoader::GetTriangleZ(uint32_t mapId, float x, float y)
     uint32_t gridX, gridY;
     worldToGridCoords(x, y, gridX, gridY);
 
-    if (!LoadMapTile(mapId, gridY, gridX))
-        return MapFormat::INVALID_HEIGHT;
-
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_loadedTiles.find(makeKey(mapId, gridY, gridX));
-    if (it == m_loadedTiles.end()) return MapFormat::INVALID_HEIGHT;
-    MapFormat::GridMap* tile = it->second.get();
-    if (!tile || !tile->hasTriangleCache()) return MapFormat::INVALID_HEIGHT;
+    ReadGuard guard;
+    GridMap* tile = acquireTile(mapId, gridY, gridX);
+    if (!tile || !tile->hasTerrainTriangles()) return MapFormat::INVALID_HEIGHT;
 
     // Convert world → tile-local inverted coordinates (matching cell indexing)
     // Cell 0 corresponds to tileMaxWorld, cell 127 to tileMinWorld
@@ -1338,20 +1593,14 @@ float MapLoader::GetLiquidLevel(uint32_t mapId, float x, float y)
     uint32_t gridX, gridY;
     worldToGridCoords(x, y, gridX, gridY);
 
-    if (!LoadMapTile(mapId, gridY, gridX))
-    {
-        return VMAP::VMAP_INVALID_LIQUID_HEIGHT;
-    }
-
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    auto it = m_loadedTiles.find(makeKey(mapId, gridY, gridX));
-    if (it == m_loadedTiles.end())
+    ReadGuard guard;
+    GridMap* tile = acquireTile(mapId, gridY, gridX);
+    if (!tile)
     {
         return VMAP::VMAP_INVALID_LIQUID_HEIGHT;
     }
 
-    float liquidLevel = it->second->getLiquidLevel(x, y);
+    float liquidLevel = tile->getLiquidLevel(x, y);
 
     return liquidLevel;
 }
@@ -1361,20 +1610,14 @@ uint8_t MapLoader::GetLiquidType(uint32_t mapId, float x, float y)
     uint32_t gridX, gridY;
     worldToGridCoords(x, y, gridX, gridY);
 
-    if (!LoadMapTile(mapId, gridY, gridX))
-    {
-        return VMAP::MAP_LIQUID_TYPE_NO_WATER;
-    }
-
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    auto it = m_loadedTiles.find(makeKey(mapId, gridY, gridX));
-    if (it == m_loadedTiles.end())
+    ReadGuard guard;
+    GridMap* tile = acquireTile(mapId, gridY, gridX);
+    if (!tile)
     {
         return VMAP::MAP_LIQUID_TYPE_NO_WATER;
     }
 
-    uint8_t liquidType = it->second->getLiquidType(x, y);
+    uint8_t liquidType = tile->getLiquidType(x, y);
 
     return liquidType;
 }
@@ -1384,34 +1627,28 @@ uint16_t MapLoader::GetAreaId(uint32_t mapId, float x, float y)
     uint32_t gridX, gridY;
     worldToGridCoords(x, y, gridX, gridY);
 
-    if (!LoadMapTile(mapId, gridY, gridX))
-    {
-        return 0;
-    }
-
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    auto it = m_loadedTiles.find(makeKey(mapId, gridY, gridX));
-    if (it == m_loadedTiles.end())
+    ReadGuard guard;
+    GridMap* tile = acquireTile(mapId, gridY, gridX);
+    if (!tile)
     {
         return 0;
     }
 
-    uint16_t areaId = it->second->getArea(x, y);
+    uint16_t areaId = tile->getArea(x, y);
 
     return areaId;
 }
 
 size_t MapLoader::GetLoadedTileCount() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_loadedTiles.size();
+    return m_tileCount.load(std::memory_order_relaxed);
 }
 
 bool MapLoader::IsTileLoaded(uint32_t mapId, uint32_t x, uint32_t y) const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_loadedTiles.find(makeKey(mapId, x, y)) != m_loadedTiles.end();
+    // Only tests the slot, so no ReadGuard is needed.
+    std::atomic<TileEntry*>* slot = const_cast<MapLoader*>(this)->findSlot(mapId, x, y, false);
+    return slot && slot->load(std::memory_order_acquire) != nullptr;
 }
 
 // ---- New: terrain triangle extraction ----
@@ -1424,127 +1661,117 @@ bool MapLoader::GetTerrainTriangles(uint32_t mapId, float minX, float minY, floa
         return false;
     }
 
+    uint32_t minGX, minGY, maxGX, maxGY;
+    GetTerrainTileRange(minX, minY, maxX, maxY, minGX, minGY, maxGX, maxGY);
+
+    size_t before = out.size();
+    for (uint32_t tileY = minGY; tileY <= maxGY; ++tileY)
+        for (uint32_t tileX = minGX; tileX <= maxGX; ++tileX)
+            GetTileTerrainTriangles(mapId, tileY, tileX, minX, minY, maxX, maxY, out);
+
+    bool any = out.size() > before;
+
+    return any;
+}
+
+void MapLoader::GetTerrainTileRange(float minX, float minY, float maxX, float maxY,
+                                    uint32_t& minGX, uint32_t& minGY, uint32_t& maxGX, uint32_t& maxGY) const
+{
     uint32_t gx0, gy0, gx1, gy1;
     worldToGridCoords(minX, minY, gx0, gy0);
     worldToGridCoords(maxX, maxY, gx1, gy1);
 
-    uint32_t minGX = std::min(gx0, gx1);
-    uint32_t maxGX = std::max(gx0, gx1);
-    uint32_t minGY = std::min(gy0, gy1);
-    uint32_t maxGY = std::max(gy0, gy1);
+    minGX = std::min(gx0, gx1);
+    maxGX = std::max(gx0, gx1);
+    minGY = std::min(gy0, gy1);
+    maxGY = std::max(gy0, gy1);
+}
 
-    size_t before = out.size();
-    size_t tilesVisited = 0, tilesLoaded = 0, tilesMissing = 0;
-    size_t trisOut = 0;
+bool MapLoader::GetTileTerrainTriangles(uint32_t mapId, uint32_t tileY, uint32_t tileX,
+                                        float minX, float minY, float maxX, float maxY,
+                                        std::vector<MapFormat::TerrainTriangle>& out)
+{
+    // The guard keeps the tile allocated even if it is evicted meanwhile, so
+    // the triangles are generated without holding the lock. That lets
+    // several extraction threads work on different tiles concurrently.
+    ReadGuard guard;
+    GridMap* tile = acquireTile(mapId, tileY, tileX);
+    if (!tile)
+        return false;
 
-    for (uint32_t tileY = minGY; tileY <= maxGY; ++tileY)
+    // Compute tile origin (lower bound world corner)
+    float tileMaxWorldX = (CENTER_GRID_ID - static_cast<float>(tileY)) * GRID_SIZE;
+    float tileMaxWorldY = (CENTER_GRID_ID - static_cast<float>(tileX)) * GRID_SIZE;
+    float tileOriginX = tileMaxWorldX - GRID_SIZE;
+    float tileOriginY = tileMaxWorldY - GRID_SIZE;
+
+    // Convert world AABB to tile-local space (non-inverted for logging)
+    float localMinX = minX - tileOriginX;
+    float localMinY = minY - tileOriginY;
+    float localMaxX = maxX - tileOriginX;
+    float localMaxY = maxY - tileOriginY;
+    localMinX = std::max(0.0f, localMinX); localMinY = std::max(0.0f, localMinY);
+    localMaxX = std::min(GRID_SIZE, localMaxX); localMaxY = std::min(GRID_SIZE, localMaxY);
+
+    // Invert local coordinates to match GetHeight indexing (cell 0 near tile upper bound)
+    float invMinX = GRID_SIZE - localMaxX;
+    float invMaxX = GRID_SIZE - localMinX;
+    float invMinY = GRID_SIZE - localMaxY;
+    float invMaxY = GRID_SIZE - localMinY;
+
+    // Clamp inverted ranges
+    invMinX = std::max(0.0f, invMinX); invMinY = std::max(0.0f, invMinY);
+    invMaxX = std::min(GRID_SIZE, invMaxX); invMaxY = std::min(GRID_SIZE, invMaxY);
+
+    int xi0 = std::max(0, (int)std::floor(invMinX / GRID_PART_SIZE));
+    int yi0 = std::max(0, (int)std::floor(invMinY / GRID_PART_SIZE));
+    int xi1 = std::min(V8_SIZE - 1, (int)std::floor(invMaxX / GRID_PART_SIZE));
+    int yi1 = std::min(V8_SIZE - 1, (int)std::floor(invMaxY / GRID_PART_SIZE));
+
+    size_t before = out.size();
+    for (int xi = xi0; xi <= xi1; ++xi)
     {
-        for (uint32_t tileX = minGX; tileX <= maxGX; ++tileX)
+        for (int yi = yi0; yi <= yi1; ++yi)
         {
-            ++tilesVisited;
-            bool loadedOk = LoadMapTile(mapId, tileY, tileX);
-
-            if (!loadedOk)
-            {
-                ++tilesMissing;
-                continue;
-            }
-            ++tilesLoaded;
-
-            std::lock_guard<std::mutex> lock(m_mutex);
-            auto it = m_loadedTiles.find(makeKey(mapId, tileY, tileX));
-            if (it == m_loadedTiles.end())
-            {
-                std::cout << "[TerrainQueryTile] not in cache after load key(map, y, x)=" << mapId << "," << tileY << "," << tileX << std::endl;
-                ++tilesMissing;
-                continue;
-            }
-            GridMap* tile = it->second.get();
-            if (!tile)
-            {
-                std::cout << "[TerrainQueryTile] null GridMap ptr for tile y=" << tileY << " x=" << tileX << std::endl;
-                ++tilesMissing;
+            float h1, h2, h3, h4, h5;
+            if (!tile->getSquareHeights(xi, yi, h1, h2, h3, h4, h5))
                 continue;
-            }
 
-            // Compute tile origin (lower bound world corner)
-            float tileMaxWorldX = (CENTER_GRID_ID - static_cast<float>(tileY)) * GRID_SIZE;
-            float tileMaxWorldY = (CENTER_GRID_ID - static_cast<float>(tileX)) * GRID_SIZE;
-            float tileOriginX = tileMaxWorldX - GRID_SIZE;
-            float tileOriginY = tileMaxWorldY - GRID_SIZE;
-
-            // Convert world AABB to tile-local space (non-inverted for logging)
-            float localMinX = minX - tileOriginX;
-            float localMinY = minY - tileOriginY;
-            float localMaxX = maxX - tileOriginX;
-            float localMaxY = maxY - tileOriginY;
-            localMinX = std::max(0.0f, localMinX); localMinY = std::max(0.0f, localMinY);
-            localMaxX = std::min(GRID_SIZE, localMaxX); localMaxY = std::min(GRID_SIZE, localMaxY);
-
-            // Invert local coordinates to match GetHeight indexing (cell 0 near tile upper bound)
-            float invMinX = GRID_SIZE - localMaxX;
-            float invMaxX = GRID_SIZE - localMinX;
-            float invMinY = GRID_SIZE - localMaxY;
-            float invMaxY = GRID_SIZE - localMinY;
-
-            // Clamp inverted ranges
-            invMinX = std::max(0.0f, invMinX); invMinY = std::max(0.0f, invMinY);
-            invMaxX = std::min(GRID_SIZE, invMaxX); invMaxY = std::min(GRID_SIZE, invMaxY);
-
-            int xi0 = std::max(0, (int)std::floor(invMinX / GRID_PART_SIZE));
-            int yi0 = std::max(0, (int)std::floor(invMinY / GRID_PART_SIZE));
-            int xi1 = std::min(V8_SIZE - 1, (int)std::floor(invMaxX / GRID_PART_SIZE));
-            int yi1 = std::min(V8_SIZE - 1, (int)std::floor(invMaxY / GRID_PART_SIZE));
-
-            size_t addedThisTile = 0;
-            for (int xi = xi0; xi <= xi1; ++xi)
-            {
-                for (int yi = yi0; yi <= yi1; ++yi)
-                {
-                    float h1, h2, h3, h4, h5;
-                    if (!tile->getSquareHeights(xi, yi, h1, h2, h3, h4, h5))
-                        continue;
-
-                    // Inverted local positions
-                    float invX0 = xi * GRID_PART_SIZE;
-                    float invY0 = yi * GRID_PART_SIZE;
-                    float invX1 = (xi + 1) * GRID_PART_SIZE;
-                    float invY1 = (yi + 1) * GRID_PART_SIZE;
-
-                    // Map to world: world = origin + (GRID_SIZE - local)
-                    float wA0 = tileOriginX + (GRID_SIZE - invX0);
-                    float wB0 = tileOriginX + (GRID_SIZE - invX1);
-                    float wY0 = tileOriginY + (GRID_SIZE - invY0);
-                    float wY1 = tileOriginY + (GRID_SIZE - invY1);
-                    float wCX = tileOriginX + (GRID_SIZE - (invX0 + invX1) * 0.5f);
-                    float wCY = tileOriginY + (GRID_SIZE - (invY0 + invY1) * 0.5f);
-
-                    auto pushUpward = [&](float ax, float ay, float az,
-                                          float bx, float by, float bz,
-                                          float cx, float cy, float cz) {
-                        float abx = bx - ax, aby = by - ay, abz = bz - az;
-                        float acx = cx - ax, acy = cy - ay, acz = cz - az;
-                        float nz = abx * acy - aby * acx;
-                        if (nz < 0.0f)
-                            out.push_back({ ax, ay, az, cx, cy, cz, bx, by, bz });
-                        else
-                            out.push_back({ ax, ay, az, bx, by, bz, cx, cy, cz });
-                        ++trisOut; ++addedThisTile;
-                    };
-
-                    // Four triangles (matching GetHeight order after inversion)
-                    pushUpward(wA0, wY0, h1, wB0, wY0, h2, wCX, wCY, h5); // (h1,h2,h5)
-                    pushUpward(wA0, wY0, h1, wA0, wY1, h3, wCX, wCY, h5); // (h1,h3,h5)
-                    pushUpward(wB0, wY0, h2, wB0, wY1, h4, wCX, wCY, h5); // (h2,h4,h5)
-                    pushUpward(wA0, wY1, h3, wB0, wY1, h4, wCX, wCY, h5); // (h3,h4,h5)
-                }
-            }
+            // Inverted local positions
+            float invX0 = xi * GRID_PART_SIZE;
+            float invY0 = yi * GRID_PART_SIZE;
+            float invX1 = (xi + 1) * GRID_PART_SIZE;
+            float invY1 = (yi + 1) * GRID_PART_SIZE;
+
+            // Map to world: world = origin + (GRID_SIZE - local)
+            float wA0 = tileOriginX + (GRID_SIZE - invX0);
+            float wB0 = tileOriginX + (GRID_SIZE - invX1);
+            float wY0 = tileOriginY + (GRID_SIZE - invY0);
+            float wY1 = tileOriginY + (GRID_SIZE - invY1);
+            float wCX = tileOriginX + (GRID_SIZE - (invX0 + invX1) * 0.5f);
+            float wCY = tileOriginY + (GRID_SIZE - (invY0 + invY1) * 0.5f);
+
+            auto pushUpward = [&](float ax, float ay, float az,
+                                  float bx, float by, float bz,
+                                  float cx, float cy, float cz) {
+                float abx = bx - ax, aby = by - ay, abz = bz - az;
+                float acx = cx - ax, acy = cy - ay, acz = cz - az;
+                float nz = abx * acy - aby * acx;
+                if (nz < 0.0f)
+                    out.push_back({ ax, ay, az, cx, cy, cz, bx, by, bz });
+                else
+                    out.push_back({ ax, ay, az, bx, by, bz, cx, cy, cz });
+            };
+
+            // Four triangles (matching GetHeight order after inversion)
+            pushUpward(wA0, wY0, h1, wB0, wY0, h2, wCX, wCY, h5); // (h1,h2,h5)
+            pushUpward(wA0, wY0, h1, wA0, wY1, h3, wCX, wCY, h5); // (h1,h3,h5)
+            pushUpward(wB0, wY0, h2, wB0, wY1, h4, wCX, wCY, h5); // (h2,h4,h5)
+            pushUpward(wA0, wY1, h3, wB0, wY1, h4, wCX, wCY, h5); // (h3,h4,h5)
         }
     }
 
-    bool any = out.size() > before;
-
-    return any;
+    return out.size() > before;
 }
 
 bool GridMap::getSquareHeights(int xi, int yi, float& h1, float& h2, float& h3, float& h4, float& h5) const
@@ -1579,13 +1806,8 @@ bool MapLoader::SampleHeightAndSquare(uint32_t mapId, float x, float y, int& cel
 {
     uint32_t gridX, gridY;
     worldToGridCoords(x, y, gridX, gridY);
-    if (!LoadMapTile(mapId, gridY, gridX))
-        return false;
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_loadedTiles.find(makeKey(mapId, gridY, gridX));
-    if (it == m_loadedTiles.end())
-        return false;
-    GridMap* tile = it->second.get();
+    ReadGuard guard;
+    GridMap* tile = acquireTile(mapId, gridY, gridX);
     if (!tile)
         return false;
 
@@ -1,6 +1,7 @@
 ﻿// MapLoader.h - Complete vMaNGOS-style map loader with separate load methods
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include <unordered_map>
@@ -9,6 +10,7 @@
 #include <cstdio>
 #include <vector>
 #include "CapsuleCollision.h"
+#include "EpochReclaim.h"
 
 // Map file format constants (matching vMaNGOS)
 namespace MapFormat
@@ -103,13 +105,6 @@ namespace MapFormat
         float cx, cy, cz;
     };
 
-    // Pre-computed triangles for one cell (4 triangles in fan pattern around center)
-    struct CellTriangles
-    {
-        TerrainTriangle tris[4];
-        int count = 0;  // 0 = hole/invalid, 4 = normal
-    };
-
     // GridMap class - holds one map tile
     class GridMap
     {
@@ -172,10 +167,20 @@ namespace MapFormat
         // Helper to sample V8 center height regardless of storage type (returns 2*center like getHeight)
         float sampleV8Center(int xi, int yi) const;
 
-        // Pre-computed terrain triangle cache (tile-local XY, world Z)
-        CellTriangles m_cellTriangles[V8_SIZE][V8_SIZE];
-        bool m_trianglesCached = false;
-        void buildTriangleCache();
+        // Heights of V9 row xi / V8 row xi for columns [yi0, yi0 + count),
+        // decoded to world Z like sampleV9Height / sampleV8Center (no range check)
+        void sampleV9Row(int xi, int yi0, int count, float* out) const;
+        void sampleV8Row(int xi, int yi0, int count, float* out) const;
+
+        // Terrain triangles are derived from the height arrays on demand, so a
+        // tile holds no per-cell triangle storage. Set once heights are loaded.
+        bool m_hasTerrainTriangles = false;
+        // The 4 triangles of square (xi, yi) in fan order around its center,
+        // from corner heights h1..h4 and the raw V8 center value h5.
+        static void makeCellTriangles(int xi, int yi, float h1, float h2, float h3, float h4, float h5,
+                                      TerrainTriangle* out);
+        // Fills out with square (xi, yi)'s triangles; false for holes / invalid heights.
+        bool getCellTriangles(int xi, int yi, TerrainTriangle* out) const;
 
     public:
         GridMap() = default;
@@ -183,6 +188,8 @@ namespace MapFormat
 
         bool loadData(const std::string& filename);
         void unloadData();
+        // Bytes held by the loaded height, liquid, area and hole arrays.
+        size_t getMemoryUsage() const;
 
         float getHeight(float x, float y) const;
         float getLiquidLevel(float x, float y) const;
@@ -195,9 +202,9 @@ namespace MapFormat
         void getTerrainTrianglesInAABB(float minX, float minY, float maxX, float maxY,
                                        std::vector<TerrainTriangle>& out) const;
 
-        // Triangle-based Z lookup using cached triangles (tile-local XY input)
+        // Triangle-based Z lookup on the cell's terrain triangles (tile-local XY input)
         float getTriangleZ(float localX, float localY) const;
-        bool hasTriangleCache() const { return m_trianglesCached; }
+        bool hasTerrainTriangles() const { return m_hasTerrainTriangles; }
 
         // New: compute surface normal at world position (returns false if invalid / hole)
         bool getNormal(float x, float y, float& nx, float& ny, float& nz) const;
@@ -209,13 +216,97 @@ namespace MapFormat
 // MapLoader main class
 constexpr float CENTER_GRID_ID = 32.0f;
 
+// Loaded tiles are evicted least-recently-used once their combined size
+// exceeds the memory budget.
+//
+// Lookups take no lock: each map has a fixed 64x64 table of atomically
+// published tile entries. Loads, unloads and evictions are serialized on
+// m_mutex; an entry they unpublish is retired and only freed once every
+// reader that could still see it has left its read section (epoch-based
+// reclamation, see EpochReclaim.h).
 class MapLoader
 {
+public:
+    // A .map tile is roughly 35-135 KB, so the default holds well over a
+    // thousand tiles; long-lived hosts can lower it with SetMemoryBudget.
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 256ull * 1024ull * 1024ull;
+    static constexpr uint32_t TILES_PER_MAP = 64;
+
+    struct MemoryStats
+    {
+        size_t tileCount = 0;
+        size_t residentBytes = 0;
+        size_t budget = 0;
+        uint64_t loads = 0;
+        uint64_t evictions = 0;
+    };
+
 private:
-    std::unordered_map<uint64_t, std::unique_ptr<MapFormat::GridMap>> m_loadedTiles;
+    struct TileEntry
+    {
+        std::shared_ptr<MapFormat::GridMap> tile;
+        size_t bytes = 0;
+        std::atomic<uint64_t> lastUse{ 0 };
+    };
+
+    struct MapTiles
+    {
+        std::atomic<TileEntry*> slots[TILES_PER_MAP * TILES_PER_MAP] = {};
+    };
+
+    // Marks the calling thread as reading tile entries until destroyed;
+    // entries looked up meanwhile stay allocated. Sections may nest.
+    using ReadGuard = EpochReclaim::ReadGuard;
+
+    // Table of a map at or above DIRECT_MAP_COUNT. Nodes are pushed onto
+    // m_otherMaps under m_mutex and never unlinked, so readers walk the list
+    // without locking.
+    struct OtherMap
+    {
+        uint32_t mapId = 0;
+        MapTiles tiles;
+        OtherMap* next = nullptr;
+    };
+
+    // Maps below this id have their table in m_maps; the rest (none in the
+    // shipped data) are found by walking m_otherMaps. Tables live until the
+    // loader is destroyed.
+    static constexpr uint32_t DIRECT_MAP_COUNT = 1024;
+    std::unique_ptr<std::atomic<MapTiles*>[]> m_maps;
+    std::atomic<OtherMap*> m_otherMaps{ nullptr };
+
+    // Writer-side index of published entries (m_mutex), used for eviction,
+    // unloading and stats. Readers never touch it.
+    std::unordered_map<uint64_t, TileEntry*> m_resident;
+    // Unpublished entries and the epoch they were retired at (m_mutex).
+    std::vector<std::pair<uint64_t, TileEntry*>> m_retired;
+
     std::string m_dataPath;
     mutable std::mutex m_mutex;
     bool m_initialized = false;
+    std::atomic<uint64_t> m_useClock{ 0 };
+    std::atomic<size_t> m_tileCount{ 0 };
+    size_t m_budget = DEFAULT_MEMORY_BUDGET;
+    size_t m_residentBytes = 0;
+    uint64_t m_loadCount = 0;
+    uint64_t m_evictionCount = 0;
+
+    // Slot of tile (x, y) of mapId, or null when out of range (or, with
+    // create false, when the map has no table yet).
+    std::atomic<TileEntry*>* findSlot(uint32_t mapId, uint32_t x, uint32_t y, bool create);
+    // Tile (x, y) of mapId with its use stamp refreshed, loading it (without
+    // holding m_mutex) when it is not resident. Null when there is no file.
+    // The caller must hold a ReadGuard for as long as it uses the tile.
+    MapFormat::GridMap* acquireTile(uint32_t mapId, uint32_t x, uint32_t y);
+    // All helpers below expect m_mutex to be held.
+    // Drops least-recently-used tiles other than pinnedKey until the
+    // resident bytes fit the budget.
+    static constexpr uint64_t NO_PINNED_TILE = ~0ull;
+    void evictOverBudgetLocked(uint64_t pinnedKey);
+    void unpublishLocked(std::unordered_map<uint64_t, TileEntry*>::iterator it);
+    void unpublishAllLocked();
+    // Frees retired entries no reader can still hold.
+    void reclaimLocked();
 
     // Helper functions
     std::string getMapFileName(uint32_t mapId, uint32_t x, uint32_t y) const;
@@ -252,24 +343,35 @@ public:
 
     size_t GetLoadedTileCount() const;
     bool IsTileLoaded(uint32_t mapId, uint32_t x, uint32_t y) const;
+
+    // Resident byte budget for loaded tiles; lowering it evicts right away.
+    void SetMemoryBudget(size_t bytes);
+    size_t GetMemoryBudget() const;
+    size_t GetMemoryUsage() const;
+    MemoryStats GetMemoryStats() const;
     bool IsInitialized() const { return m_initialized; }
 
     void WorldToGridCoords(float worldX, float worldY, uint32_t& gridX, uint32_t& gridY) const { worldToGridCoords(worldX, worldY, gridX, gridY); }
 
-    // Helper to get a pointer to the loaded GridMap for a tile (returns nullptr if not loaded)
-    MapFormat::GridMap* GetGridMap(uint32_t mapId, uint32_t x, uint32_t y)
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        auto it = m_loadedTiles.find(makeKey(mapId, x, y));
-        if (it != m_loadedTiles.end())
-            return it->second.get();
-        return nullptr;
-    }
+    // Loaded GridMap for a tile (null if not loaded). The returned pointer
+    // keeps the tile alive even if it is evicted meanwhile.
+    std::shared_ptr<MapFormat::GridMap> GetGridMap(uint32_t mapId, uint32_t x, uint32_t y);
 
     // New: Gather terrain triangles across all tiles overlapped by world-space AABB
     bool GetTerrainTriangles(uint32_t mapId, float minX, float minY, float maxX, float maxY,
                              std::vector<MapFormat::TerrainTriangle>& out);
 
+    // Grid tile range (inclusive) overlapped by a world-space AABB, in the
+    // (tileY, tileX) order GetTerrainTriangles visits.
+    void GetTerrainTileRange(float minX, float minY, float maxX, float maxY,
+                             uint32_t& minGX, uint32_t& minGY, uint32_t& maxGX, uint32_t& maxGY) const;
+
+    // Terrain triangles of one tile clipped to the AABB (loads the tile if
+    // needed). Safe to call concurrently for different tiles.
+    bool GetTileTerrainTriangles(uint32_t mapId, uint32_t tileY, uint32_t tileX,
+                                 float minX, float minY, float maxX, float maxY,
+                                 std::vector<MapFormat::TerrainTriangle>& out);
+
     // Expose sampling helper (optional external use)
     bool GetHeightAndSquare(uint32_t mapId, float x, float y, int& cellX, int& cellY,
                             float& outHeight, float& h1, float& h2, float& h3, float& h4, float& h5) { return SampleHeightAndSquare(mapId, x, y, cellX, cellY, outHeight, h1, h2, h3, h4, h5); }
@@ -0,0 +1,36 @@
+#pragma once
+
+// MappedFile.h - Read-only memory mapping of a whole file.
+// Used by on-disk caches whose layout is designed to be queried in place
+// (.scene v3). The mapping is shared with the OS page cache, so several
+// processes mapping the same file share its physical pages.
+
+#include <cstddef>
+#include <cstdint>
+
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map the whole file read-only. Returns false if the file cannot be
+    // opened, is empty, or the mapping fails.
+    bool Open(const char* path);
+    void Close();
+
+    bool IsOpen() const { return m_data != nullptr; }
+    const uint8_t* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#if defined(_WIN32)
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+#endif
+};
@@ -89,7 +89,7 @@ namespace VMAP
 	{
 	}
 
-	ModelInstance::ModelInstance(const ModelSpawn& spawn, std::shared_ptr<WorldModel> model)
+	ModelInstance::ModelInstance(const ModelSpawn& spawn, std::shared_ptr<const WorldModel> model)
 		: ModelSpawn(spawn), iModel(model)
 	{
         // Compute world->model rotation from spawn Euler angles (degrees)
@@ -114,6 +114,12 @@ namespace VMAP
 			return false;
 		}
 
+		// The M2 flag is per spawn; the model itself is shared
+		if (ignoreM2Model && (flags & MOD_M2))
+		{
+			return false;
+		}
+
 		float time = ray.intersectionTime(iBound);
 		if (time == G3D::inf())
 		{
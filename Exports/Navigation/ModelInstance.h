@@ -53,10 +53,10 @@ namespace VMAP
         G3D::Matrix3 iInvRot; // world->model rotation
         G3D::Matrix3 iRot;    // model->world rotation (cached)
         float iInvScale;
-        std::shared_ptr<WorldModel> iModel;
+        std::shared_ptr<const WorldModel> iModel;
 
         ModelInstance();
-        ModelInstance(const ModelSpawn& spawn, std::shared_ptr<WorldModel> model);
+        ModelInstance(const ModelSpawn& spawn, std::shared_ptr<const WorldModel> model);
 
         // Original ray-based collision methods
         bool intersectRay(const G3D::Ray& ray, float& maxDist, bool stopAtFirstHit, bool ignoreM2Model = false) const;
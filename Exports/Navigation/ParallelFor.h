@@ -0,0 +1,212 @@
+#pragma once
+
+// ParallelFor.h - Minimal fork/join loop for offline build paths
+// (SceneCache::Extract and friends) and batched queries
+// (SceneQuery::GetGroundZBatch and friends). Work items are handed out through an
+// atomic counter; the calling thread takes part, so a thread count of 1 runs
+// the loop inline. Callers keep results deterministic by writing each item's
+// output to its own slot and merging the slots in index order afterwards.
+//
+// Helpers come from one process-wide pool started on first use, so a batched
+// query does not pay for creating threads on every call. Loops of a single
+// item, and loops started from inside another loop's items, run inline on
+// the calling thread. Several threads may run loops at once; the pool's
+// workers help whichever loops are open.
+//
+// WWOW_BUILD_THREADS overrides the default worker count (hardware
+// concurrency), which is handy for checking that output does not depend on it.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Parallel
+{
+    inline unsigned DefaultThreadCount()
+    {
+        if (const char* env = std::getenv("WWOW_BUILD_THREADS"))
+        {
+            int n = std::atoi(env);
+            if (n > 0)
+                return static_cast<unsigned>(n);
+        }
+        unsigned hw = std::thread::hardware_concurrency();
+        return hw ? hw : 1u;
+    }
+
+    namespace Detail
+    {
+        // One open loop. Lives on the stack of the thread that runs it; the
+        // pool only touches it while counted in activeHelpers.
+        struct Job
+        {
+            size_t count = 0;
+            void (*invoke)(void* fn, size_t i) = nullptr;
+            void* fn = nullptr;
+
+            std::atomic<size_t> next{ 0 };
+            std::atomic<bool> failed{ false };
+            std::exception_ptr error;
+            std::mutex errorMutex;
+
+            // Guarded by the pool mutex.
+            unsigned helperSlots = 0;
+            unsigned activeHelpers = 0;
+        };
+
+        // Depth of loop items running on this thread; nested loops run inline.
+        inline thread_local int t_depth = 0;
+
+        inline void RunItems(Job& job)
+        {
+            ++t_depth;
+            for (;;)
+            {
+                if (job.failed.load(std::memory_order_relaxed))
+                    break;
+                size_t i = job.next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= job.count)
+                    break;
+                try
+                {
+                    job.invoke(job.fn, i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(job.errorMutex);
+                    if (!job.error)
+                        job.error = std::current_exception();
+                    job.failed.store(true, std::memory_order_relaxed);
+                }
+            }
+            --t_depth;
+        }
+
+        class Pool
+        {
+        public:
+            // Never destroyed: workers outlive static destruction, so a
+            // library unloaded from a process never joins threads under the
+            // loader lock.
+            static Pool& Instance()
+            {
+                static Pool* pool = new Pool(DefaultThreadCount() - 1);
+                return *pool;
+            }
+
+            unsigned WorkerCount() const { return static_cast<unsigned>(m_workers.size()); }
+
+            // Runs job with up to `helpers` pool workers joining the calling thread.
+            void Run(Job& job, unsigned helpers)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    job.helperSlots = helpers;
+                    m_jobs.push_back(&job);
+                }
+                if (helpers == 1)
+                    m_workReady.notify_one();
+                else
+                    m_workReady.notify_all();
+
+                RunItems(job);
+
+                // Close the job to new helpers, then wait for the ones inside.
+                std::unique_lock<std::mutex> lock(m_mutex);
+                auto it = std::find(m_jobs.begin(), m_jobs.end(), &job);
+                if (it != m_jobs.end())
+                    m_jobs.erase(it);
+                m_helperDone.wait(lock, [&] { return job.activeHelpers == 0; });
+            }
+
+        private:
+            explicit Pool(unsigned workers)
+            {
+                m_workers.reserve(workers);
+                for (unsigned t = 0; t < workers; ++t)
+                    m_workers.emplace_back([this] { WorkerLoop(); });
+                for (auto& th : m_workers)
+                    th.detach();
+            }
+
+            void WorkerLoop()
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                for (;;)
+                {
+                    m_workReady.wait(lock, [&] { return !m_jobs.empty(); });
+                    Job* job = m_jobs.front();
+                    if (--job->helperSlots == 0 || job->next.load(std::memory_order_relaxed) >= job->count)
+                        m_jobs.pop_front();
+                    ++job->activeHelpers;
+
+                    lock.unlock();
+                    RunItems(*job);
+                    lock.lock();
+
+                    if (--job->activeHelpers == 0)
+                        m_helperDone.notify_all();
+                }
+            }
+
+            std::mutex m_mutex;
+            std::condition_variable m_workReady;
+            std::condition_variable m_helperDone;
+            std::deque<Job*> m_jobs;
+            std::vector<std::thread> m_workers;
+        };
+    }
+
+    // True while the calling thread runs an item of a loop, its own or
+    // another thread's as a pool worker.
+    inline bool InLoopItem()
+    {
+        return Detail::t_depth > 0;
+    }
+
+    // Run fn(i) for every i in [0, count). threads == 0 picks
+    // DefaultThreadCount(). The first exception thrown by fn stops further
+    // items from being handed out and is rethrown on the calling thread.
+    template <typename Fn>
+    void For(size_t count, Fn&& fn, unsigned threads = 0)
+    {
+        if (count == 0)
+            return;
+        if (threads == 0)
+            threads = DefaultThreadCount();
+        threads = static_cast<unsigned>(std::min<size_t>(threads, count));
+        if (threads <= 1 || Detail::t_depth > 0)
+        {
+            for (size_t i = 0; i < count; ++i)
+                fn(i);
+            return;
+        }
+
+        Detail::Pool& pool = Detail::Pool::Instance();
+        const unsigned helpers = std::min(threads - 1, pool.WorkerCount());
+        if (helpers == 0)
+        {
+            for (size_t i = 0; i < count; ++i)
+                fn(i);
+            return;
+        }
+
+        using FnType = std::remove_reference_t<Fn>;
+        Detail::Job job;
+        job.count = count;
+        job.fn = const_cast<void*>(static_cast<const void*>(&fn));
+        job.invoke = [](void* f, size_t i) { (*static_cast<FnType*>(f))(i); };
+        pool.Run(job, helpers);
+
+        if (job.error)
+            std::rethrow_exception(job.error);
+    }
+}
@@ -105,6 +105,9 @@ void PhysicsEngine::Shutdown()
 {
     PHYS_INFO(PHYS_MOVE, "Shutdown");
     m_initialized = false;
+    m_sleepCache.Clear();
+    std::lock_guard<std::mutex> lock(m_agentMutex);
+    m_agents.clear();
 }
 
 // =====================================================================================
@@ -5404,11 +5407,34 @@ PhysicsOutput PhysicsEngine::StepV2(const PhysicsInput& input, float dt)
 		for (int i = 0; i < input.nearbyObjectCount; ++i)
 		{
 			const auto& obj = input.nearbyObjects[i];
-			dynReg->EnsureRegistered(obj.guid, obj.displayId, input.mapId, obj.scale);
+			dynReg->EnsureRegistered(obj.guid, obj.displayId, input.mapId, obj.scale, dynReg->CurrentMapInstance());
 			dynReg->UpdatePosition(obj.guid, obj.x, obj.y, obj.z, obj.orientation, obj.goState);
 		}
 	}
 
+	// ---- Resting fast path ----
+	// A bot idling on stable ground whose last step came back unchanged gets
+	// that step's output again until its input or the collision around it
+	// changes. The region stamp only moves with objects near the bot, so doors
+	// and NPC objects elsewhere on the map do not wake it. A timeline-driven
+	// transport moves without changing the stamp, so a bot it can reach
+	// during this step's transport interval always simulates.
+	bool sleepEligible = PhysicsSleepCache::IsEligible(input);
+	PhysicsSleepCache::WorldState sleepWorld;
+	if (sleepEligible)
+	{
+		auto* dynReg = DynamicObjectRegistry::Instance();
+		sleepWorld.mapInstanceId = dynReg->CurrentMapInstance();
+		sleepWorld.region = dynReg->GetRegionStamp(input.mapId, PhysicsSleepCache::RegionBox(input));
+		sleepWorld.sceneGeneration = SceneQuery::GetSceneGeneration(input.mapId);
+		sleepEligible = !sleepWorld.region.hasTransport;
+	}
+	if (sleepEligible && m_sleepCache.TryGet(input, dt, sleepWorld, out))
+	{
+		PHYS_INFO(PHYS_MOVE, "[StepV2] resting; returning cached output");
+		return out;
+	}
+
 	// ---- Transport-local → world coordinate transform ----
 	float simX = input.x, simY = input.y, simZ = input.z;
 	float simO = input.orientation;
@@ -6795,5 +6821,41 @@ PhysicsOutput PhysicsEngine::StepV2(const PhysicsInput& input, float dt)
 			<< "  groundZ=" << out.groundZ << " liquidZ=" << out.liquidZ << " liquidType=" << static_cast<int>(out.liquidType);
 		PHYS_INFO(PHYS_MOVE, oss.str());
 	}
+
+	if (sleepEligible && PhysicsSleepCache::IsResting(input, out))
+		m_sleepCache.Store(input, sleepWorld, out);
 	return out;
 }
+
+std::shared_ptr<SceneContactCache> PhysicsEngine::AcquireAgentCache(uint64_t agentId)
+{
+	std::lock_guard<std::mutex> lock(m_agentMutex);
+	auto it = m_agents.find(agentId);
+	if (it == m_agents.end())
+	{
+		if (m_agents.size() >= MAX_AGENTS)
+		{
+			auto oldest = std::min_element(m_agents.begin(), m_agents.end(),
+				[](const auto& a, const auto& b) { return a.second.lastUse < b.second.lastUse; });
+			m_agents.erase(oldest);
+		}
+		it = m_agents.emplace(agentId, AgentEntry{ std::make_shared<SceneContactCache>(), 0 }).first;
+	}
+	it->second.lastUse = ++m_agentUseCounter;
+	return it->second.cache;
+}
+
+PhysicsOutput PhysicsEngine::StepV2ForAgent(uint64_t agentId, const PhysicsInput& input, float dt)
+{
+	// The shared_ptr keeps the cache alive if the agent is evicted or
+	// released while this step is still running.
+	std::shared_ptr<SceneContactCache> cache = AcquireAgentCache(agentId);
+	SceneContactCache::Scope scope(cache.get(), input.mapId);
+	return StepV2(input, dt);
+}
+
+void PhysicsEngine::ReleaseAgent(uint64_t agentId)
+{
+	std::lock_guard<std::mutex> lock(m_agentMutex);
+	m_agents.erase(agentId);
+}
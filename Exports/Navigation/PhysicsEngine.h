@@ -9,6 +9,10 @@
 #include <vector>
 #include "Vector3.h" // Needed for by-value usage of G3D::Vector3
 #include "SceneQuery.h"
+#include "PhysicsSleepCache.h"
+#include "SceneContactCache.h"
+#include <mutex>
+#include <unordered_map>
 
 // Forward declarations
 namespace VMAP {
@@ -247,6 +251,15 @@ public:
     // New: modernized step using diagnostics-driven movement
     PhysicsOutput StepV2(const PhysicsInput& input, float dt);
 
+    // StepV2 for a long-lived agent (bot GUID or handle): the agent's
+    // SceneContactCache reuses nearby collision geometry across its steps.
+    // Results are identical to StepV2. ReleaseAgent drops the cache.
+    PhysicsOutput StepV2ForAgent(uint64_t agentId, const PhysicsInput& input, float dt);
+    void ReleaseAgent(uint64_t agentId);
+
+    // Diagnostics: StepV2 calls answered by the resting fast path.
+    uint64_t GetRestingHitCount() const { return m_sleepCache.GetHitCount(); }
+
     // Configuration: walkable slope threshold (cosine of max slope angle)
     void SetWalkableCosMin(float cosMin);
     float GetWalkableCosMin() const;
@@ -287,6 +300,23 @@ private:
     // Tunables
     float m_walkableCosMin; // cosine of max slope angle considered walkable
 
+    // Remembered results for bots resting on stable ground (StepV2 fast path)
+    PhysicsSleepCache m_sleepCache;
+
+    // Per-agent contact caches (StepV2ForAgent); least recently stepped
+    // agents are dropped past MAX_AGENTS.
+    static constexpr size_t MAX_AGENTS = 1024;
+    struct AgentEntry
+    {
+        std::shared_ptr<SceneContactCache> cache;
+        uint64_t lastUse = 0;
+    };
+    std::mutex m_agentMutex;
+    std::unordered_map<uint64_t, AgentEntry> m_agents;
+    uint64_t m_agentUseCounter = 0;
+
+    std::shared_ptr<SceneContactCache> AcquireAgentCache(uint64_t agentId);
+
     // Movement state (created fresh each Step call)
     struct MovementState
     {
@@ -0,0 +1,221 @@
+// PhysicsSleepCache.cpp - Fast path for bots standing still on stable ground
+#include "PhysicsSleepCache.h"
+#include "PhysicsEngine.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    inline uint32_t Bits(float v)
+    {
+        uint32_t u;
+        std::memcpy(&u, &v, sizeof(u));
+        return u;
+    }
+}
+
+bool PhysicsSleepCache::IsEligible(const PhysicsInput& input)
+{
+    constexpr uint32_t kActiveBits =
+        PhysicsConstants::DIRECTIONAL_BITS | PhysicsConstants::TURN_BITS | PhysicsConstants::PITCH_BITS |
+        MOVEFLAG_JUMPING | MOVEFLAG_FALLINGFAR | MOVEFLAG_SWIMMING | MOVEFLAG_FLYING |
+        MOVEFLAG_LEVITATING | MOVEFLAG_HOVER | MOVEFLAG_SPLINE_ENABLED | MOVEFLAG_ONTRANSPORT;
+
+    if (input.moveFlags & kActiveBits)
+        return false;
+    if (input.hasSplinePath || input.transportGuid != 0)
+        return false;
+    if (input.physicsFlags & PHYSICS_FLAG_TRUST_INPUT_VELOCITY)
+        return false;
+    if (input.vx != 0.0f || input.vy != 0.0f || input.vz != 0.0f)
+        return false;
+    if (input.pendingDepenX != 0.0f || input.pendingDepenY != 0.0f || input.pendingDepenZ != 0.0f)
+        return false;
+    if (input.fallTime != 0 || input.wasGrounded == 0)
+        return false;
+    // Need a known support plane to compare the step result against.
+    return input.prevGroundZ > PhysicsConstants::INVALID_HEIGHT && input.prevGroundNz > 0.0f;
+}
+
+bool PhysicsSleepCache::IsResting(const PhysicsInput& input, const PhysicsOutput& output)
+{
+    return output.x == input.x && output.y == input.y && output.z == input.z
+        && output.orientation == input.orientation && output.pitch == input.pitch
+        && output.vx == 0.0f && output.vy == 0.0f && output.vz == 0.0f
+        && output.moveFlags == input.moveFlags
+        && output.groundZ == input.prevGroundZ
+        && output.groundNx == input.prevGroundNx
+        && output.groundNy == input.prevGroundNy
+        && output.groundNz == input.prevGroundNz
+        && output.pendingDepenX == 0.0f && output.pendingDepenY == 0.0f && output.pendingDepenZ == 0.0f
+        && output.standingOnInstanceId == input.standingOnInstanceId
+        && output.standingOnLocalX == input.standingOnLocalX
+        && output.standingOnLocalY == input.standingOnLocalY
+        && output.standingOnLocalZ == input.standingOnLocalZ
+        && output.fallTime == 0.0f
+        && output.fallStartZ == input.fallStartZ
+        && output.groundedWallState == input.groundedWallState;
+}
+
+G3D::AABox PhysicsSleepCache::RegionBox(const PhysicsInput& input)
+{
+    const float r = input.radius + REGION_MARGIN;
+    return G3D::AABox(
+        G3D::Vector3(input.x - r, input.y - r, input.z - REGION_MARGIN),
+        G3D::Vector3(input.x + r, input.y + r, input.z + input.height + REGION_MARGIN));
+}
+
+void PhysicsSleepCache::BuildKey(const PhysicsInput& input, Key& key)
+{
+    key = {
+        input.moveFlags,
+        input.mapId,
+        input.physicsFlags,
+        Bits(input.x),
+        Bits(input.y),
+        Bits(input.z),
+        Bits(input.orientation),
+        Bits(input.pitch),
+        Bits(input.walkSpeed),
+        Bits(input.runSpeed),
+        Bits(input.runBackSpeed),
+        Bits(input.swimSpeed),
+        Bits(input.swimBackSpeed),
+        Bits(input.flightSpeed),
+        Bits(input.turnSpeed),
+        input.fallTime,
+        Bits(input.fallStartZ),
+        Bits(input.height),
+        Bits(input.radius),
+        Bits(input.prevGroundZ),
+        Bits(input.prevGroundNx),
+        Bits(input.prevGroundNy),
+        Bits(input.prevGroundNz),
+        input.standingOnInstanceId,
+        Bits(input.standingOnLocalX),
+        Bits(input.standingOnLocalY),
+        Bits(input.standingOnLocalZ),
+        Bits(input.stepUpBaseZ),
+        input.stepUpAge,
+        input.groundedWallState,
+        input.wasGrounded,
+    };
+}
+
+uint64_t PhysicsSleepCache::HashKey(const Key& key)
+{
+    // FNV-1a over 32-bit words.
+    uint64_t h = 1469598103934665603ull;
+    for (uint32_t w : key)
+    {
+        h ^= w;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+bool PhysicsSleepCache::TryGet(const PhysicsInput& input, float dt, const WorldState& world, PhysicsOutput& out)
+{
+    if (!IsEligible(input))
+        return false;
+
+    Key key;
+    BuildKey(input, key);
+    const uint64_t hash = HashKey(key);
+    Shard& shard = ShardFor(hash);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.entries.empty())
+        return false;
+    auto range = shard.entries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        Entry& e = it->second;
+        if (e.key != key)
+            continue;
+
+        // Stale world or slept long enough: drop it and let the full step
+        // decide (it re-stores the entry if the bot is still at rest).
+        if (e.world != world || e.sleptSeconds + dt > MAX_SLEEP_SECONDS)
+        {
+            shard.entries.erase(it);
+            return false;
+        }
+
+        e.sleptSeconds += dt;
+        e.lastUse = ++shard.useCounter;
+        out = e.output;
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void PhysicsSleepCache::Store(const PhysicsInput& input, const WorldState& world, const PhysicsOutput& output)
+{
+    Entry e;
+    BuildKey(input, e.key);
+    const uint64_t hash = HashKey(e.key);
+    e.world = world;
+    e.output = output;
+    Shard& shard = ShardFor(hash);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    e.lastUse = ++shard.useCounter;
+
+    auto range = shard.entries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second.key == e.key)
+        {
+            it->second = e;
+            return;
+        }
+    }
+
+    if (shard.entries.size() >= MAX_ENTRIES / SHARD_COUNT)
+        shard.EvictOldestLocked();
+    shard.entries.emplace(hash, e);
+}
+
+void PhysicsSleepCache::Shard::EvictOldestLocked()
+{
+    // Drop the least recently used quarter in one pass so a full shard does
+    // not pay a scan on every insert.
+    std::vector<uint64_t> uses;
+    uses.reserve(entries.size());
+    for (const auto& kv : entries)
+        uses.push_back(kv.second.lastUse);
+    const size_t drop = std::max<size_t>(1, uses.size() / 4);
+    std::nth_element(uses.begin(), uses.begin() + (drop - 1), uses.end());
+    const uint64_t cutoff = uses[drop - 1];
+
+    for (auto it = entries.begin(); it != entries.end(); )
+    {
+        if (it->second.lastUse <= cutoff)
+            it = entries.erase(it);
+        else
+            ++it;
+    }
+}
+
+void PhysicsSleepCache::Clear()
+{
+    for (Shard& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.clear();
+    }
+}
+
+size_t PhysicsSleepCache::Size() const
+{
+    size_t total = 0;
+    for (const Shard& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.entries.size();
+    }
+    return total;
+}
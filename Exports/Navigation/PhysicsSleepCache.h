@@ -0,0 +1,110 @@
+// PhysicsSleepCache.h - Fast path for bots standing still on stable ground
+#pragma once
+
+#include "PhysicsBridge.h"
+#include "DynamicObjectRegistry.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+// StepV2 is stateless, so an idle bot that feeds its output back every tick
+// pays for the full grounded pipeline (overlap recovery, ground probes,
+// wall checks) only to land on the same answer again. Once a full step
+// reports a resting state -- output equal to the fed-back input, zero
+// velocity, unchanged ground -- the result is remembered under an exact,
+// fixed-size key of every input field that can influence it (deltaTime,
+// frameCounter and the nearby object list excepted: nearby objects are
+// registered before the lookup, so they are covered by the region stamp).
+// Later steps with the same key and world state return the remembered output
+// without simulating.
+//
+// A sleeping entry wakes (the next step runs the full pipeline) when:
+//   - any keyed input field changes (movement flags, position, speeds, ...);
+//   - the world state around the bot changes: the map's scene generation, or
+//     the dynamic collision stamp of the region around the bot
+//     (DynamicObjectRegistry::RegionStamp), so objects moving elsewhere on
+//     the map do not wake it;
+//   - the entry has been asleep for MAX_SLEEP_SECONDS of simulated time,
+//     which bounds how long a subtle dt-dependent state can be masked.
+//
+// Entries are spread over SHARD_COUNT independently locked shards by key
+// hash, so bots stepping on different threads rarely share a lock.
+class PhysicsSleepCache
+{
+public:
+    static constexpr float MAX_SLEEP_SECONDS = 1.0f;
+    static constexpr size_t MAX_ENTRIES = 4096;
+    static constexpr size_t SHARD_COUNT = 16;
+    // Extra XY extent around the capsule whose dynamic collision a resting
+    // step may touch.
+    static constexpr float REGION_MARGIN = 4.0f;
+
+    /// What a resting result depends on besides its input.
+    struct WorldState
+    {
+        uint64_t sceneGeneration = 0;
+        uint32_t mapInstanceId = 0;   // region stamps of different instances are unrelated
+        DynamicObjectRegistry::RegionStamp region;
+
+        bool operator==(const WorldState& o) const
+        {
+            return sceneGeneration == o.sceneGeneration && mapInstanceId == o.mapInstanceId && region == o.region;
+        }
+        bool operator!=(const WorldState& o) const { return !(*this == o); }
+    };
+
+    /// True when the input describes a grounded, motionless, non-transport,
+    /// non-spline state whose step result does not depend on dt.
+    static bool IsEligible(const PhysicsInput& input);
+
+    /// True when a full step's output is a fixed point of the input: feeding
+    /// it back would produce the same input again.
+    static bool IsResting(const PhysicsInput& input, const PhysicsOutput& output);
+
+    /// Box whose dynamic collision the WorldState of the input stamps.
+    static G3D::AABox RegionBox(const PhysicsInput& input);
+
+    /// Returns true and fills `out` when a sleeping entry matches the input
+    /// and world state. Adds dt to the entry's sleep time.
+    bool TryGet(const PhysicsInput& input, float dt, const WorldState& world, PhysicsOutput& out);
+
+    /// Remembers a resting output. Callers check IsEligible/IsResting first.
+    void Store(const PhysicsInput& input, const WorldState& world, const PhysicsOutput& output);
+
+    void Clear();
+    size_t Size() const;
+
+    /// Diagnostics: steps answered from the cache.
+    uint64_t GetHitCount() const { return m_hits.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t KEY_WORDS = 31;
+    using Key = std::array<uint32_t, KEY_WORDS>;
+
+    struct Entry
+    {
+        Key key{};
+        WorldState world;
+        PhysicsOutput output{};
+        float sleptSeconds = 0.0f;
+        uint64_t lastUse = 0;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_multimap<uint64_t, Entry> entries;
+        uint64_t useCounter = 0;
+
+        void EvictOldestLocked();
+    };
+
+    static void BuildKey(const PhysicsInput& input, Key& key);
+    static uint64_t HashKey(const Key& key);
+    Shard& ShardFor(uint64_t hash) { return m_shards[(hash >> 59) % SHARD_COUNT]; }
+
+    std::array<Shard, SHARD_COUNT> m_shards;
+    std::atomic<uint64_t> m_hits{ 0 };
+};
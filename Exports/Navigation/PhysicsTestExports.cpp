@@ -477,6 +477,7 @@ static const VMAP::ModelInstance* FindStaticModelInstance(uint32_t mapId, uint32
 
     if (!vmapMgr->isMapInitialized(mapId))
         vmapMgr->initializeMap(mapId);
+    vmapMgr->ensureAllTilesLoaded(mapId);
     const VMAP::StaticMapTree* mapTree = vmapMgr->GetStaticMapTree(mapId);
     if (!mapTree || !mapTree->GetInstancesPtr())
         return nullptr;
@@ -566,7 +567,7 @@ static ResolvedStaticContactMetadata ResolveStaticContactMetadata(uint32_t mapId
         return metadata;
 
     if (metadata.modelFlags == 0u)
-        metadata.modelFlags = instance->iModel->getModelFlags();
+        metadata.modelFlags = instance->flags;
     if (metadata.resolvedModelFlags == 0u)
         metadata.resolvedModelFlags = metadata.modelFlags;
     if (metadata.rootId == -1)
@@ -837,7 +838,7 @@ extern "C"
 
         // Scene cache result (current behavior)
         float sceneZ = PhysicsConstants::INVALID_HEIGHT;
-        auto* cache = SceneQuery::GetSceneCache(mapId);
+        auto cache = SceneQuery::GetSceneCache(mapId);
         if (cache)
             sceneZ = cache->GetGroundZ(x, y, z, maxSearchDist);
         if (outSceneCacheZ) *outSceneCacheZ = sceneZ;
@@ -876,6 +877,8 @@ extern "C"
         float bihZ = PhysicsConstants::INVALID_HEIGHT;
         if (vmapMgr && vmapMgr->isMapInitialized(mapId))
         {
+            vmapMgr->ensureTilesLoaded(mapId, G3D::AABox(G3D::Vector3(x - 0.5f, y - 0.5f, z - maxSearchDist),
+                                                         G3D::Vector3(x + 0.5f, y + 0.5f, z + 0.5f)));
             const VMAP::StaticMapTree* mapTree = vmapMgr->GetStaticMapTree(mapId);
             if (mapTree && mapTree->GetInstancesPtr() && mapTree->GetInstanceCount() > 0)
                 bihZ = SceneQuery::GetGroundZByBIH(mapTree, x, y, z, maxSearchDist);
@@ -930,6 +933,7 @@ extern "C"
 
         if (!vmapMgr->isMapInitialized(mapId))
             return -1;
+        vmapMgr->ensureAllTilesLoaded(mapId);
         auto* mapTree = vmapMgr->GetStaticMapTree(mapId);
         if (!mapTree)
             return -3;
@@ -944,7 +948,7 @@ extern "C"
         uint32_t mapId, float x, float y,
         float* outZValues, uint32_t* outInstanceIds, int maxResults)
     {
-        auto* cache = SceneQuery::GetSceneCache(mapId);
+        auto cache = SceneQuery::GetSceneCache(mapId);
         if (!cache || maxResults <= 0 || !outZValues) return 0;
 
         // Access the scene cache internals directly
@@ -1052,6 +1056,10 @@ extern "C"
         if (!vmapMgr->isMapInitialized(mapId))
             return 0;
 
+        G3D::Vector3 p0(capsule->p0.x, capsule->p0.y, capsule->p0.z);
+        G3D::Vector3 p1(capsule->p1.x, capsule->p1.y, capsule->p1.z);
+        G3D::Vector3 pad(capsule->r + 1.0f, capsule->r + 1.0f, capsule->r + 1.0f);
+        vmapMgr->ensureTilesLoaded(mapId, G3D::AABox(p0.min(p1) - pad, p0.max(p1) + pad));
         const VMAP::StaticMapTree* mapTree = vmapMgr->GetStaticMapTree(mapId);
         if (!mapTree)
             return 0;
@@ -4470,6 +4478,16 @@ extern "C"
             guid, entry, displayId, mapId, scale);
     }
 
+    /// Register a dynamic object into one instance of a map (dungeon,
+    /// battleground). Only steps run in that instance collide with it.
+    __declspec(dllexport) bool RegisterDynamicObjectInInstance(
+        uint64_t guid, uint32_t entry, uint32_t displayId,
+        uint32_t mapId, uint32_t mapInstanceId, float scale)
+    {
+        return DynamicObjectRegistry::Instance()->RegisterObject(
+            guid, entry, displayId, mapId, scale, mapInstanceId);
+    }
+
     /// Update the world position and orientation of a dynamic object.
     __declspec(dllexport) void UpdateDynamicObjectPosition(
         uint64_t guid, float x, float y, float z, float orientation, uint32_t goState)
@@ -4477,18 +4495,61 @@ extern "C"
         DynamicObjectRegistry::Instance()->UpdatePosition(guid, x, y, z, orientation, goState);
     }
 
+    /// Drive a dynamic object (elevator, tram, boat) from a looping keyframed
+    /// path instead of per-tick position updates. See SetTransportTimeline.
+    __declspec(dllexport) bool SetDynamicObjectTimeline(
+        uint64_t guid, const DynamicObjectRegistry::TransportKeyframe* keyframes, int count, uint32_t periodMs)
+    {
+        if (!keyframes || count <= 0)
+            return false;
+        std::vector<DynamicObjectRegistry::TransportKeyframe> path(keyframes, keyframes + count);
+        return DynamicObjectRegistry::Instance()->SetTransportTimeline(guid, path, periodMs);
+    }
+
+    /// Return a dynamic object to position updates.
+    __declspec(dllexport) void ClearDynamicObjectTimeline(uint64_t guid)
+    {
+        DynamicObjectRegistry::Instance()->ClearTransportTimeline(guid);
+    }
+
+    /// Pose of a timeline-driven object at timeMs. False when it has no timeline.
+    __declspec(dllexport) bool GetDynamicObjectTimelinePose(
+        uint64_t guid, uint64_t timeMs, float* outX, float* outY, float* outZ, float* outOrientation)
+    {
+        DynamicObjectRegistry::TransportKeyframe pose{};
+        if (!DynamicObjectRegistry::Instance()->GetTransportPose(guid, timeMs, pose))
+            return false;
+        if (outX) *outX = pose.x;
+        if (outY) *outY = pose.y;
+        if (outZ) *outZ = pose.z;
+        if (outOrientation) *outOrientation = pose.orientation;
+        return true;
+    }
+
+    /// Transport time for queries outside PhysicsStepV2AtTime.
+    __declspec(dllexport) void SetTransportTime(uint64_t timeMs)
+    {
+        DynamicObjectRegistry::Instance()->SetTransportTime(timeMs);
+    }
+
     /// Remove a single dynamic object by GUID.
     __declspec(dllexport) void UnregisterDynamicObject(uint64_t guid)
     {
         DynamicObjectRegistry::Instance()->Unregister(guid);
     }
 
-    /// Remove all dynamic objects on a given map.
+    /// Remove all dynamic objects on a given map, in every instance.
     __declspec(dllexport) void ClearDynamicObjects(uint32_t mapId)
     {
         DynamicObjectRegistry::Instance()->ClearMap(mapId);
     }
 
+    /// Remove all dynamic objects of one map instance.
+    __declspec(dllexport) void ClearDynamicObjectsInInstance(uint32_t mapId, uint32_t mapInstanceId)
+    {
+        DynamicObjectRegistry::Instance()->ClearMapInstance(mapId, mapInstanceId);
+    }
+
     /// Remove all dynamic objects (keeps model cache).
     __declspec(dllexport) void ClearAllDynamicObjects()
     {
@@ -4507,6 +4568,33 @@ extern "C"
         return DynamicObjectRegistry::Instance()->CachedModelCount();
     }
 
+    /// World-space triangles of one map instance's dynamic collision that
+    /// overlap the box, in DynamicObjectRegistry::QueryTriangles order.
+    /// Returns the total number found; at most maxTriangles are written.
+    __declspec(dllexport) int QueryDynamicObjectTriangles(
+        uint32_t mapId, uint32_t mapInstanceId,
+        float minX, float minY, float minZ,
+        float maxX, float maxY, float maxZ,
+        MapFormat::TerrainTriangle* triangles, uint32_t* outInstanceIds, int maxTriangles)
+    {
+        auto* registry = DynamicObjectRegistry::Instance();
+        DynamicObjectRegistry::MapInstanceScope mapInstance(mapInstanceId);
+        std::vector<CapsuleCollision::Triangle> tris;
+        std::vector<uint32_t> instanceIds;
+        registry->QueryTriangles(mapId, G3D::AABox(G3D::Vector3(minX, minY, minZ), G3D::Vector3(maxX, maxY, maxZ)),
+                                 tris, &instanceIds);
+
+        const int count = triangles ? static_cast<int>(std::min<size_t>(tris.size(), std::max(maxTriangles, 0))) : 0;
+        for (int i = 0; i < count; ++i)
+        {
+            const auto& t = tris[i];
+            triangles[i] = { t.a.x, t.a.y, t.a.z, t.b.x, t.b.y, t.b.z, t.c.x, t.c.y, t.c.z };
+            if (outInstanceIds)
+                outInstanceIds[i] = instanceIds[i];
+        }
+        return static_cast<int>(tris.size());
+    }
+
     // ==========================================================================
     // SCENE CACHE (pre-processed collision geometry)
     // ==========================================================================
@@ -4534,6 +4622,25 @@ extern "C"
         catch (...) { return false; }
     }
 
+    /// Build a scene cache from triangles and save it as a .scene / .scenetile
+    /// file (for tests that need scene files without VMAP data).
+    __declspec(dllexport) bool WriteSceneCacheFile(
+        uint32_t mapId, const char* outPath,
+        float minX, float minY, float maxX, float maxY,
+        const SceneCache::InjectedTriangle* triangles, int triangleCount)
+    {
+        try
+        {
+            if (!outPath || !triangles || triangleCount <= 0)
+                return false;
+            SceneCache cache;
+            cache.mapId = mapId;
+            cache.InjectTriangles(minX, minY, maxX, maxY, triangles, triangleCount);
+            return cache.SaveToFile(outPath);
+        }
+        catch (...) { return false; }
+    }
+
     /// Load a pre-cached .scene file (fast, ~10ms).
     __declspec(dllexport) bool LoadSceneCache(uint32_t mapId, const char* path)
     {
@@ -0,0 +1,58 @@
+#pragma once
+
+// SceneArray.h - Owned-or-mapped flat array shared by the on-disk formats
+// that are queried in place.
+
+#include <cstddef>
+#include <vector>
+
+// Flat array that is either owned (built in memory / legacy load) or a
+// read-only view into a mapped file (.scene caches, .vmm models). Const
+// access never copies; any mutating call first detaches a view into an
+// owned copy.
+template<typename T>
+class SceneArray
+{
+public:
+    const T* data() const { return m_view ? m_view : m_owned.data(); }
+    size_t size() const { return m_view ? m_viewCount : m_owned.size(); }
+    bool empty() const { return size() == 0; }
+    const T& operator[](size_t i) const { return data()[i]; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size(); }
+    bool IsView() const { return m_view != nullptr; }
+
+    void SetView(const T* ptr, size_t count)
+    {
+        std::vector<T>().swap(m_owned);
+        m_view = ptr;
+        m_viewCount = count;
+    }
+
+    std::vector<T>& Mutable()
+    {
+        if (m_view)
+        {
+            m_owned.assign(m_view, m_view + m_viewCount);
+            m_view = nullptr;
+            m_viewCount = 0;
+        }
+        return m_owned;
+    }
+
+    T* data() { return Mutable().data(); }
+    T& operator[](size_t i) { return Mutable()[i]; }
+    T* begin() { return Mutable().data(); }
+    T* end() { return Mutable().data() + m_owned.size(); }
+    void clear() { m_view = nullptr; m_viewCount = 0; m_owned.clear(); }
+    void reserve(size_t n) { Mutable().reserve(n); }
+    void resize(size_t n) { Mutable().resize(n); }
+    void assign(size_t n, const T& value) { m_view = nullptr; m_viewCount = 0; m_owned.assign(n, value); }
+    void push_back(const T& value) { Mutable().push_back(value); }
+    void swap(std::vector<T>& other) { Mutable().swap(other); }
+
+private:
+    std::vector<T> m_owned;
+    const T* m_view = nullptr;
+    size_t m_viewCount = 0;
+};
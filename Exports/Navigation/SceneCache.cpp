@@ -2,19 +2,24 @@
 // Extracts VMAP + ADT triangles into world-space flat arrays with 2D spatial index.
 
 #include "SceneCache.h"
+#include "MappedFile.h"
+#include "SceneTileStreamer.h"
 #include "VMapManager2.h"
 #include "StaticMapTree.h"
 #include "ModelInstance.h"
 #include "WorldModel.h"
+#include "WorldModelStore.h"
 #include "MapLoader.h"
 #include "CoordinateTransforms.h"
 #include "SceneQuery.h"
 #include "WmoDoodadFormat.h"
+#include "ParallelFor.h"
 #include <cstdio>
 #include <cstring>
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <atomic>
 #include <unordered_set>
 #include <unordered_map>
 #include <filesystem>
@@ -23,81 +28,151 @@
 // FILE I/O
 // ============================================================================
 
-bool SceneCache::SaveToFile(const char* path) const
+namespace
 {
-    FILE* f = fopen(path, "wb");
-    if (!f) return false;
+    // .scene v3 layout: fixed 128-byte header, section table, then each array
+    // on a 64-byte boundary so a read-only mapping can be used in place.
+    enum SceneSection : uint32_t
+    {
+        SECTION_VERTICES = 0,
+        SECTION_TRIS,
+        SECTION_METADATA_TABLE,
+        SECTION_CELL_START,
+        SECTION_CELL_COUNT,
+        SECTION_TRI_INDICES,
+        SECTION_LIQUID,
+        SECTION_HEIGHT_LAYERS,
+        SECTION_LAYER_CELL_START,
+        SECTION_LAYER_REFS,
+        SECTION_COUNT
+    };
+
+    struct SceneFileSection
+    {
+        uint64_t offset;    // from start of file, SCENE_SECTION_ALIGN aligned
+        uint32_t count;     // element count
+        uint32_t elemSize;  // sizeof(element), checked on load
+    };
 
-    // Header (64 bytes)
-    uint32_t magic = FILE_MAGIC;
-    uint32_t version = FILE_VERSION;
-    uint32_t triCount = static_cast<uint32_t>(m_triangles.size());
-    uint32_t triIdxCount = static_cast<uint32_t>(m_triIndices.size());
-    uint32_t liqCellsX = m_liquidCellsX;
-    uint32_t liqCellsY = m_liquidCellsY;
-    uint32_t reserved = 0;
-
-    fwrite(&magic, 4, 1, f);
-    fwrite(&version, 4, 1, f);
-    fwrite(&mapId, 4, 1, f);
-    fwrite(&triCount, 4, 1, f);
-    fwrite(&m_cellSize, 4, 1, f);
-    fwrite(&m_cellsX, 4, 1, f);
-    fwrite(&m_cellsY, 4, 1, f);
-    fwrite(&triIdxCount, 4, 1, f);
-    fwrite(&m_liquidCellSize, 4, 1, f);
-    fwrite(&liqCellsX, 4, 1, f);
-    fwrite(&liqCellsY, 4, 1, f);
-    fwrite(&m_minX, 4, 1, f);
-    fwrite(&m_minY, 4, 1, f);
-    fwrite(&m_maxX, 4, 1, f);
-    fwrite(&m_maxY, 4, 1, f);
-    fwrite(&reserved, 4, 1, f);
-    // = 16 * 4 = 64 bytes
-
-    // Triangles
-    if (triCount > 0)
-        fwrite(m_triangles.data(), sizeof(SceneTri), triCount, f);
-    if (triCount > 0)
+    constexpr uint32_t SCENE_FLAG_TRIANGLE_METADATA = 0x1;   // metadata came from extraction, not synthesized
+
+    // Fixed header; sectionCount table entries follow it.
+    struct SceneFileHeader
     {
-        if (m_triangleMetadata.size() == m_triangles.size())
-        {
-            fwrite(m_triangleMetadata.data(), sizeof(SceneTriMetadata), triCount, f);
-        }
+        uint32_t magic;
+        uint32_t version;
+        uint32_t mapId;
+        uint32_t sectionCount;
+        float cellSize;
+        float minX, minY, maxX, maxY;
+        uint32_t cellsX, cellsY;
+        float liquidCellSize;
+        float liquidMinX, liquidMinY;
+        uint32_t liquidCellsX, liquidCellsY;
+        uint32_t flags;         // SCENE_FLAG_*
+        uint32_t reserved[15];
+    };
+    static_assert(sizeof(SceneFileHeader) == 128, "SceneFileHeader layout changed");
+
+    constexpr uint64_t SCENE_SECTION_ALIGN = 64;
+
+    uint64_t AlignSceneOffset(uint64_t offset)
+    {
+        return (offset + SCENE_SECTION_ALIGN - 1) & ~(SCENE_SECTION_ALIGN - 1);
+    }
+
+    template<typename T>
+    void BindSceneSection(SceneArray<T>& array, const uint8_t* base, const SceneFileSection& section)
+    {
+        if (section.count == 0)
+            array.clear();
         else
-        {
-            std::vector<SceneTriMetadata> synthesizedMetadata;
-            synthesizedMetadata.reserve(m_triangles.size());
-            for (const auto& tri : m_triangles)
-            {
-                SceneTriMetadata metadata;
-                metadata.sourceType = tri.sourceType;
-                metadata.instanceId = tri.instanceId;
-                synthesizedMetadata.push_back(metadata);
-            }
+            array.SetView(reinterpret_cast<const T*>(base + section.offset), section.count);
+    }
+}
 
-            fwrite(synthesizedMetadata.data(), sizeof(SceneTriMetadata), triCount, f);
-        }
+bool SceneCache::SaveToFile(const char* path) const
+{
+    if (IsComposite())
+    {
+        fprintf(stderr, "[SceneCache] Map %u is composed of tiles and cannot be saved as one scene\n", mapId);
+        return false;
     }
 
-    // Spatial index
-    uint32_t cellTotal = m_cellsX * m_cellsY;
-    if (cellTotal > 0)
+    // Write beside the target and rename over it: another process may have
+    // the current file mapped, and truncating it in place would fault them.
+    std::string tmpPath = std::string(path) + ".tmp";
+    FILE* f = fopen(tmpPath.c_str(), "wb");
+    if (!f) return false;
+
+    struct SectionSource { const void* data; size_t count; size_t elemSize; };
+    const SectionSource sources[SECTION_COUNT] = {
+        { m_vertices.data(),       m_vertices.size(),       sizeof(CompactVertex) },
+        { m_tris.data(),           m_tris.size(),           sizeof(CompactTri) },
+        { m_metadataTable.data(),  m_metadataTable.size(),  sizeof(SceneTriMetadata) },
+        { m_cellStart.data(),      m_cellStart.size(),      sizeof(uint32_t) },
+        { m_cellCount.data(),      m_cellCount.size(),      sizeof(uint32_t) },
+        { m_triIndices.data(),     m_triIndices.size(),     sizeof(uint32_t) },
+        { m_liquidGrid.data(),     m_liquidGrid.size(),     sizeof(LiquidCell) },
+        { m_heightLayers.data(),   m_heightLayers.size(),   sizeof(HeightLayer) },
+        { m_layerCellStart.data(), m_layerCellStart.size(), sizeof(uint32_t) },
+        { m_layerRefs.data(),      m_layerRefs.size(),      sizeof(uint16_t) },
+    };
+
+    SceneFileHeader header{};
+    header.magic = FILE_MAGIC;
+    header.version = FILE_VERSION;
+    header.mapId = mapId;
+    header.sectionCount = SECTION_COUNT;
+    header.cellSize = m_cellSize;
+    header.minX = m_minX;
+    header.minY = m_minY;
+    header.maxX = m_maxX;
+    header.maxY = m_maxY;
+    header.cellsX = m_cellsX;
+    header.cellsY = m_cellsY;
+    header.liquidCellSize = m_liquidCellSize;
+    header.liquidMinX = m_liquidMinX;
+    header.liquidMinY = m_liquidMinY;
+    header.liquidCellsX = m_liquidCellsX;
+    header.liquidCellsY = m_liquidCellsY;
+    header.flags = m_hasTriangleMetadata ? SCENE_FLAG_TRIANGLE_METADATA : 0u;
+
+    SceneFileSection sections[SECTION_COUNT] = {};
+    uint64_t offset = AlignSceneOffset(sizeof(header) + sizeof(sections));
+    for (uint32_t i = 0; i < SECTION_COUNT; ++i)
     {
-        fwrite(m_cellStart.data(), 4, cellTotal, f);
-        fwrite(m_cellCount.data(), 4, cellTotal, f);
+        sections[i].offset = offset;
+        sections[i].count = static_cast<uint32_t>(sources[i].count);
+        sections[i].elemSize = static_cast<uint32_t>(sources[i].elemSize);
+        offset = AlignSceneOffset(offset + sources[i].count * sources[i].elemSize);
     }
-    if (triIdxCount > 0)
-        fwrite(m_triIndices.data(), 4, triIdxCount, f);
 
-    // Liquid grid
-    fwrite(&m_liquidMinX, 4, 1, f);
-    fwrite(&m_liquidMinY, 4, 1, f);
-    uint32_t liqCount = liqCellsX * liqCellsY;
-    if (liqCount > 0)
-        fwrite(m_liquidGrid.data(), sizeof(LiquidCell), liqCount, f);
+    static const uint8_t kZeroPad[SCENE_SECTION_ALIGN] = {};
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(sections, sizeof(sections), 1, f) == 1;
+    uint64_t written = sizeof(header) + sizeof(sections);
+    for (uint32_t i = 0; ok && i < SECTION_COUNT; ++i)
+    {
+        uint64_t pad = sections[i].offset - written;
+        if (pad > 0)
+            ok = fwrite(kZeroPad, 1, static_cast<size_t>(pad), f) == pad;
+        written = sections[i].offset;
+        if (ok && sources[i].count > 0)
+            ok = fwrite(sources[i].data, sources[i].elemSize, sources[i].count, f) == sources[i].count;
+        written += sources[i].count * sources[i].elemSize;
+    }
 
-    fclose(f);
+    ok = (fclose(f) == 0) && ok;
+
+    std::error_code ec;
+    if (ok)
+        std::filesystem::rename(tmpPath, path, ec);
+    if (!ok || ec)
+    {
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
     return true;
 }
 
@@ -106,19 +181,270 @@ SceneCache* SceneCache::LoadFromFile(const char* path)
     FILE* f = fopen(path, "rb");
     if (!f) return nullptr;
 
-    // Header
-    uint32_t magic, version, triCount, triIdxCount, liqCellsX, liqCellsY, reserved;
-    auto* cache = new SceneCache();
+    uint32_t magic = 0, version = 0;
+    if (fread(&magic, 4, 1, f) != 1 || fread(&version, 4, 1, f) != 1 || magic != FILE_MAGIC)
+    {
+        fclose(f);
+        return nullptr;
+    }
+
+    if (version == FILE_VERSION)
+    {
+        fclose(f);
+        return LoadMapped(path);
+    }
 
-    fread(&magic, 4, 1, f);
-    fread(&version, 4, 1, f);
-    if (magic != FILE_MAGIC || (version != 1u && version != FILE_VERSION))
+    if (version != 1u && version != 2u)
     {
         fclose(f);
+        return nullptr;
+    }
+
+    SceneCache* cache = LoadLegacy(f, version);
+    fclose(f);
+    if (cache && !cache->ValidateIndices(path))
+    {
+        delete cache;
+        return nullptr;
+    }
+    return cache;
+}
+
+int SceneCache::ConvertDirectory(const char* scenesDir)
+{
+    std::error_code ec;
+    if (!scenesDir || !std::filesystem::is_directory(scenesDir, ec))
+        return -1;
+
+    std::vector<std::string> sources;
+    const auto collect = [&](const std::filesystem::path& dir, const char* extension)
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+        {
+            if (entry.is_regular_file(ec) && entry.path().extension() == extension)
+                sources.push_back(entry.path().string());
+        }
+    };
+    collect(scenesDir, ".scene");
+    const std::filesystem::path tilesDir = std::filesystem::path(scenesDir) / "tiles";
+    if (std::filesystem::is_directory(tilesDir, ec))
+        collect(tilesDir, ".scenetile");
+    std::sort(sources.begin(), sources.end());
+
+    // One file at a time: a whole-map scene can take several hundred MB
+    int count = 0;
+    for (const std::string& source : sources)
+    {
+        std::unique_ptr<SceneCache> cache(LoadFromFile(source.c_str()));
+        if (!cache)
+        {
+            fprintf(stderr, "[SceneCache] Failed to load %s for conversion\n", source.c_str());
+            continue;
+        }
+        if (cache->IsMapped())
+            continue;
+        if (cache->SaveToFile(source.c_str()))
+            ++count;
+        else
+            fprintf(stderr, "[SceneCache] Failed to convert %s\n", source.c_str());
+    }
+    return count;
+}
+
+SceneCache* SceneCache::LoadMapped(const char* path)
+{
+    auto mapping = std::make_shared<MappedFile>();
+    if (!mapping->Open(path) || mapping->Size() < sizeof(SceneFileHeader))
+        return nullptr;
+
+    SceneFileHeader header;
+    std::memcpy(&header, mapping->Data(), sizeof(header));
+    if (header.magic != FILE_MAGIC || header.version != FILE_VERSION ||
+        header.sectionCount != SECTION_COUNT ||
+        mapping->Size() < sizeof(header) + SECTION_COUNT * sizeof(SceneFileSection))
+        return nullptr;
+
+    SceneFileSection sections[SECTION_COUNT];
+    std::memcpy(sections, mapping->Data() + sizeof(header), sizeof(sections));
+
+    const uint32_t expectedElemSize[SECTION_COUNT] = {
+        sizeof(CompactVertex), sizeof(CompactTri), sizeof(SceneTriMetadata),
+        sizeof(uint32_t), sizeof(uint32_t), sizeof(uint32_t), sizeof(LiquidCell),
+        sizeof(HeightLayer), sizeof(uint32_t), sizeof(uint16_t) };
+
+    for (uint32_t i = 0; i < SECTION_COUNT; ++i)
+    {
+        const SceneFileSection& section = sections[i];
+        if (section.elemSize != expectedElemSize[i] ||
+            (section.offset % SCENE_SECTION_ALIGN) != 0 ||
+            section.offset > mapping->Size() ||
+            static_cast<uint64_t>(section.count) * section.elemSize > mapping->Size() - section.offset)
+        {
+            fprintf(stderr, "[SceneCache] %s: section %u out of bounds or wrong element size\n", path, i);
+            return nullptr;
+        }
+    }
+
+    const uint64_t cellTotal = static_cast<uint64_t>(header.cellsX) * header.cellsY;
+    const uint32_t triCount = sections[SECTION_TRIS].count;
+    if ((triCount > 0 && (sections[SECTION_VERTICES].count == 0 || sections[SECTION_METADATA_TABLE].count == 0)) ||
+        sections[SECTION_CELL_START].count != cellTotal ||
+        sections[SECTION_CELL_COUNT].count != cellTotal ||
+        sections[SECTION_LAYER_CELL_START].count != (cellTotal ? cellTotal + 1 : 0) ||
+        sections[SECTION_LIQUID].count != static_cast<uint64_t>(header.liquidCellsX) * header.liquidCellsY)
+    {
+        fprintf(stderr, "[SceneCache] %s: inconsistent section sizes\n", path);
+        return nullptr;
+    }
+
+    auto* cache = new SceneCache();
+    cache->mapId = header.mapId;
+    cache->m_cellSize = header.cellSize;
+    cache->m_minX = header.minX;
+    cache->m_minY = header.minY;
+    cache->m_maxX = header.maxX;
+    cache->m_maxY = header.maxY;
+    cache->m_cellsX = header.cellsX;
+    cache->m_cellsY = header.cellsY;
+    cache->m_liquidCellSize = header.liquidCellSize;
+    cache->m_liquidMinX = header.liquidMinX;
+    cache->m_liquidMinY = header.liquidMinY;
+    cache->m_liquidCellsX = header.liquidCellsX;
+    cache->m_liquidCellsY = header.liquidCellsY;
+
+    const uint8_t* base = mapping->Data();
+    BindSceneSection(cache->m_cellStart, base, sections[SECTION_CELL_START]);
+    BindSceneSection(cache->m_cellCount, base, sections[SECTION_CELL_COUNT]);
+    BindSceneSection(cache->m_triIndices, base, sections[SECTION_TRI_INDICES]);
+    BindSceneSection(cache->m_liquidGrid, base, sections[SECTION_LIQUID]);
+    BindSceneSection(cache->m_vertices, base, sections[SECTION_VERTICES]);
+    BindSceneSection(cache->m_tris, base, sections[SECTION_TRIS]);
+    BindSceneSection(cache->m_metadataTable, base, sections[SECTION_METADATA_TABLE]);
+    BindSceneSection(cache->m_heightLayers, base, sections[SECTION_HEIGHT_LAYERS]);
+    BindSceneSection(cache->m_layerCellStart, base, sections[SECTION_LAYER_CELL_START]);
+    BindSceneSection(cache->m_layerRefs, base, sections[SECTION_LAYER_REFS]);
+    cache->m_hasTriangleMetadata = triCount > 0 && (header.flags & SCENE_FLAG_TRIANGLE_METADATA) != 0;
+
+    // Queries index straight through these arrays (and the triangles through
+    // the vertex and metadata tables), so a damaged or hand-edited file must
+    // be rejected here rather than read out of bounds.
+    if (!cache->ValidateIndices(path))
+    {
         delete cache;
         return nullptr;
     }
 
+    cache->m_mapping = std::move(mapping);
+    return cache;
+}
+
+bool SceneCache::ValidateIndices(const char* path) const
+{
+    const size_t cellTotal = static_cast<size_t>(m_cellsX) * m_cellsY;
+    const size_t triCount = m_tris.size();
+    const size_t layerCount = m_heightLayers.size();
+    const bool layered = !m_layerCellStart.empty();
+    if (m_cellStart.size() != cellTotal || m_cellCount.size() != cellTotal ||
+        (layered && (m_layerCellStart.size() != cellTotal + 1 ||
+                     m_layerCellStart[0] != 0 || m_layerCellStart[cellTotal] != layerCount)))
+    {
+        fprintf(stderr, "[SceneCache] %s: grid or layer table size mismatch\n", path);
+        return false;
+    }
+
+    // Cells are checked in parallel chunks; each chunk covers its cells'
+    // triIndices runs, height layers and layer refs.
+    const size_t chunkCount = std::min<size_t>(cellTotal, Parallel::DefaultThreadCount() * 4);
+    std::atomic<bool> valid{ true };
+    Parallel::For(chunkCount, [&](size_t chunk)
+    {
+        const size_t cellBegin = cellTotal * chunk / chunkCount;
+        const size_t cellEnd = cellTotal * (chunk + 1) / chunkCount;
+        for (size_t ci = cellBegin; ci < cellEnd && valid.load(std::memory_order_relaxed); ++ci)
+        {
+            const uint64_t start = m_cellStart[ci];
+            const uint32_t count = m_cellCount[ci];
+            if (start + count > m_triIndices.size())
+            {
+                valid = false;
+                return;
+            }
+            for (uint32_t j = 0; j < count; ++j)
+            {
+                if (m_triIndices[start + j] >= triCount)
+                {
+                    valid = false;
+                    return;
+                }
+            }
+
+            if (!layered)
+                continue;
+            const uint32_t layerBegin = m_layerCellStart[ci];
+            const uint32_t layerEnd = m_layerCellStart[ci + 1];
+            if (layerBegin > layerEnd || layerEnd > layerCount)
+            {
+                valid = false;
+                return;
+            }
+            for (uint32_t li = layerBegin; li < layerEnd; ++li)
+            {
+                const HeightLayer& L = m_heightLayers[li];
+                if (static_cast<uint64_t>(L.firstRef) + L.refCount > m_layerRefs.size() || L.zLo > L.zHi)
+                {
+                    valid = false;
+                    return;
+                }
+                for (uint32_t r = L.firstRef; r < L.firstRef + L.refCount; ++r)
+                {
+                    if (m_layerRefs[r] >= count)
+                    {
+                        valid = false;
+                        return;
+                    }
+                }
+            }
+        }
+    });
+
+    if (!valid)
+    {
+        fprintf(stderr, "[SceneCache] %s: grid or height-layer index out of range\n", path);
+        return false;
+    }
+
+    // Every compact triangle must name existing vertices and metadata
+    const size_t vertexCount = m_vertices.size();
+    const size_t metaCount = m_metadataTable.size();
+    const size_t triChunks = std::min<size_t>(triCount, Parallel::DefaultThreadCount() * 4);
+    Parallel::For(triChunks, [&](size_t chunk)
+    {
+        const size_t end = triCount * (chunk + 1) / triChunks;
+        for (size_t ti = triCount * chunk / triChunks; ti < end; ++ti)
+        {
+            const CompactTri& t = m_tris[ti];
+            if (t.v[0] >= vertexCount || t.v[1] >= vertexCount || t.v[2] >= vertexCount || t.meta >= metaCount)
+            {
+                valid = false;
+                return;
+            }
+        }
+    });
+
+    if (!valid)
+    {
+        fprintf(stderr, "[SceneCache] %s: triangle vertex or metadata index out of range\n", path);
+        return false;
+    }
+    return true;
+}
+
+SceneCache* SceneCache::LoadLegacy(FILE* f, uint32_t version)
+{
+    // Versions 1/2: 64-byte header followed by tightly packed arrays.
+    uint32_t triCount, triIdxCount, liqCellsX, liqCellsY, reserved;
+    auto* cache = new SceneCache();
+
     fread(&cache->mapId, 4, 1, f);
     fread(&triCount, 4, 1, f);
     fread(&cache->m_cellSize, 4, 1, f);
@@ -137,20 +463,18 @@ SceneCache* SceneCache::LoadFromFile(const char* path)
     cache->m_liquidCellsX = liqCellsX;
     cache->m_liquidCellsY = liqCellsY;
 
-    // Triangles
-    cache->m_triangles.resize(triCount);
+    // Triangles (v1 has no metadata; SetTriangles synthesizes it)
+    std::vector<SceneTri> tris(triCount);
+    std::vector<SceneTriMetadata> metadata;
     if (triCount > 0)
-        fread(cache->m_triangles.data(), sizeof(SceneTri), triCount, f);
+        fread(tris.data(), sizeof(SceneTri), triCount, f);
     if (version >= 2u)
     {
-        cache->m_triangleMetadata.resize(triCount);
+        metadata.resize(triCount);
         if (triCount > 0)
-            fread(cache->m_triangleMetadata.data(), sizeof(SceneTriMetadata), triCount, f);
-    }
-    else
-    {
-        cache->m_triangleMetadata.clear();
+            fread(metadata.data(), sizeof(SceneTriMetadata), triCount, f);
     }
+    cache->SetTriangles(tris, metadata);
 
     // Spatial index
     uint32_t cellTotal = cache->m_cellsX * cache->m_cellsY;
@@ -173,10 +497,108 @@ SceneCache* SceneCache::LoadFromFile(const char* path)
     if (liqCount > 0)
         fread(cache->m_liquidGrid.data(), sizeof(LiquidCell), liqCount, f);
 
-    fclose(f);
+    // Legacy files do not carry the derived indices
+    cache->BuildHeightLayers();
     return cache;
 }
 
+// ============================================================================
+// COMPACT TRIANGLE STORAGE
+// ============================================================================
+
+namespace
+{
+    // Hash key over the raw bits of N 32-bit words (vertex positions,
+    // metadata records), so equal keys decode to bit-identical values.
+    template<size_t N>
+    struct BitsKey
+    {
+        uint32_t words[N];
+        bool operator==(const BitsKey& other) const { return std::memcmp(words, other.words, sizeof(words)) == 0; }
+    };
+
+    template<size_t N>
+    struct BitsKeyHash
+    {
+        size_t operator()(const BitsKey<N>& key) const
+        {
+            uint64_t h = 0xcbf29ce484222325ull;
+            for (uint32_t w : key.words)
+                h = (h ^ w) * 0x100000001b3ull;
+            return static_cast<size_t>(h ^ (h >> 29));
+        }
+    };
+
+    template<size_t N, typename T>
+    BitsKey<N> MakeBitsKey(const T& value)
+    {
+        static_assert(sizeof(T) == N * sizeof(uint32_t), "key must cover the value exactly");
+        BitsKey<N> key;
+        std::memcpy(key.words, &value, sizeof(key.words));
+        return key;
+    }
+}
+
+void SceneCache::SetTriangles(const std::vector<SceneTri>& tris, const std::vector<SceneTriMetadata>& metadata)
+{
+    const bool hasMetadata = !tris.empty() && metadata.size() == tris.size();
+
+    std::vector<CompactVertex> vertices;
+    std::vector<CompactTri> compact;
+    std::vector<SceneTriMetadata> table;
+    compact.reserve(tris.size());
+    vertices.reserve(tris.size());
+
+    // Ids are assigned in first-appearance order so the same input always
+    // produces the same arrays (and the same file bytes).
+    std::unordered_map<BitsKey<3>, uint32_t, BitsKeyHash<3>> vertexIds;
+    std::unordered_map<BitsKey<7>, uint32_t, BitsKeyHash<7>> metadataIds;
+    vertexIds.reserve(tris.size());
+
+    auto internVertex = [&](float x, float y, float z) -> uint32_t
+    {
+        const CompactVertex v{ x, y, z };
+        auto [it, inserted] = vertexIds.try_emplace(MakeBitsKey<3>(v), static_cast<uint32_t>(vertices.size()));
+        if (inserted)
+            vertices.push_back(v);
+        return it->second;
+    };
+
+    for (size_t i = 0; i < tris.size(); ++i)
+    {
+        const SceneTri& t = tris[i];
+        SceneTriMetadata meta;
+        if (hasMetadata)
+        {
+            meta = metadata[i];
+        }
+        else
+        {
+            meta.sourceType = t.sourceType;
+            meta.instanceId = t.instanceId;
+        }
+
+        CompactTri ct;
+        ct.v[0] = internVertex(t.ax, t.ay, t.az);
+        ct.v[1] = internVertex(t.bx, t.by, t.bz);
+        ct.v[2] = internVertex(t.cx, t.cy, t.cz);
+        auto [it, inserted] = metadataIds.try_emplace(MakeBitsKey<7>(meta), static_cast<uint32_t>(table.size()));
+        if (inserted)
+            table.push_back(meta);
+        ct.meta = it->second;
+        compact.push_back(ct);
+    }
+
+    vertices.shrink_to_fit();
+    m_vertices.clear();
+    m_vertices.swap(vertices);
+    m_tris.clear();
+    m_tris.swap(compact);
+    m_metadataTable.clear();
+    m_metadataTable.swap(table);
+    m_hasTriangleMetadata = hasMetadata;
+}
+
 // ============================================================================
 // DOODAD HELPERS (quaternion rotation, coordinate conversions)
 // ============================================================================
@@ -216,6 +638,58 @@ static G3D::Vector3 FixCoords(const G3D::Vector3& v)
 // EXTRACTION FROM LIVE VMAP + ADT DATA
 // ============================================================================
 
+namespace
+{
+    // Triangles produced by one extraction work item (a model instance or an
+    // ADT tile), plus their XY extent.
+    struct ExtractChunk
+    {
+        std::vector<SceneTri> tris;
+        std::vector<SceneTriMetadata> metadata;
+        float minX = 1e9f, minY = 1e9f;
+        float maxX = -1e9f, maxY = -1e9f;
+
+        void Reserve(size_t count)
+        {
+            tris.reserve(count);
+            metadata.reserve(count);
+        }
+
+        void Add(const G3D::Vector3& a, const G3D::Vector3& b, const G3D::Vector3& c,
+                 const SceneTriMetadata& meta)
+        {
+            SceneTri st;
+            st.ax = a.x; st.ay = a.y; st.az = a.z;
+            st.bx = b.x; st.by = b.y; st.bz = b.z;
+            st.cx = c.x; st.cy = c.y; st.cz = c.z;
+            st.sourceType = meta.sourceType;
+            st.instanceId = meta.instanceId;
+            tris.push_back(st);
+            metadata.push_back(meta);
+
+            minX = std::min(minX, std::min({ a.x, b.x, c.x }));
+            minY = std::min(minY, std::min({ a.y, b.y, c.y }));
+            maxX = std::max(maxX, std::max({ a.x, b.x, c.x }));
+            maxY = std::max(maxY, std::max({ a.y, b.y, c.y }));
+        }
+
+        // Append to the staged arrays and fold the extent into totals, then
+        // release this chunk's memory.
+        void MoveInto(std::vector<SceneTri>& outTris, std::vector<SceneTriMetadata>& outMetadata,
+                      ExtractChunk& totals)
+        {
+            outTris.insert(outTris.end(), tris.begin(), tris.end());
+            outMetadata.insert(outMetadata.end(), metadata.begin(), metadata.end());
+            totals.minX = std::min(totals.minX, minX);
+            totals.minY = std::min(totals.minY, minY);
+            totals.maxX = std::max(totals.maxX, maxX);
+            totals.maxY = std::max(totals.maxY, maxY);
+            std::vector<SceneTri>().swap(tris);
+            std::vector<SceneTriMetadata>().swap(metadata);
+        }
+    };
+}
+
 SceneCache* SceneCache::Extract(uint32_t mapId,
                                 VMAP::VMapManager2* vmapMgr,
                                 MapLoader* mapLoader,
@@ -228,9 +702,24 @@ SceneCache* SceneCache::Extract(uint32_t mapId,
     float bMaxX = bounds.maxX, bMaxY = bounds.maxY;
     bool hasBounds = !bounds.IsEmpty();
 
-    // Track actual triangle extents for spatial index
-    float actualMinX = 1e9f, actualMinY = 1e9f;
-    float actualMaxX = -1e9f, actualMaxY = -1e9f;
+    // The triangle phases fan out over independent work items (model
+    // instances, ADT tiles). Each item writes to its own chunk and chunks are
+    // appended in item order, so the triangle order - and the saved file - is
+    // the same whatever the thread count. Liquid is sampled on this thread.
+    std::vector<SceneTri> tris;
+    std::vector<SceneTriMetadata> triMetadata;
+    ExtractChunk totals;
+
+    const auto triOutsideBounds = [&](const G3D::Vector3& a, const G3D::Vector3& b, const G3D::Vector3& c)
+    {
+        if (!hasBounds)
+            return false;
+        const float txMin = std::min({ a.x, b.x, c.x });
+        const float txMax = std::max({ a.x, b.x, c.x });
+        const float tyMin = std::min({ a.y, b.y, c.y });
+        const float tyMax = std::max({ a.y, b.y, c.y });
+        return txMax < bMinX || txMin > bMaxX || tyMax < bMinY || tyMin > bMaxY;
+    };
 
     // 1) Extract VMAP model triangles to world space
     if (vmapMgr)
@@ -238,17 +727,20 @@ SceneCache* SceneCache::Extract(uint32_t mapId,
         // Ensure map is loaded
         if (!vmapMgr->isMapInitialized(mapId))
             vmapMgr->initializeMap(mapId);
+        // Extraction walks every instance, so a lazily tiled map loads all tiles
+        vmapMgr->ensureAllTilesLoaded(mapId);
 
         const VMAP::StaticMapTree* mapTree = vmapMgr->GetStaticMapTree(mapId);
         if (mapTree)
         {
             const VMAP::ModelInstance* instances = mapTree->GetInstancesPtr();
             uint32_t instanceCount = mapTree->GetInstanceCount();
+            std::vector<ExtractChunk> chunks(instanceCount);
 
-            for (uint32_t i = 0; i < instanceCount; ++i)
+            Parallel::For(instanceCount, [&](size_t i)
             {
                 const VMAP::ModelInstance& mi = instances[i];
-                if (!mi.iModel) continue;
+                if (!mi.iModel) return;
 
                 // Quick AABB filter: transform instance bounds to world space
                 if (hasBounds)
@@ -261,11 +753,12 @@ SceneCache* SceneCache::Extract(uint32_t mapId,
                     // Check XY overlap with extraction bounds (conservative)
                     if (instPosW.x + instRadius < bMinX || instPosW.x - instRadius > bMaxX ||
                         instPosW.y + instRadius < bMinY || instPosW.y - instRadius > bMaxY)
-                        continue;
+                        return;
                 }
 
+                ExtractChunk& chunk = chunks[i];
                 const uint32_t instanceFlags = mi.flags;
-                const uint32_t modelFlags = mi.iModel->getModelFlags();
+                const uint32_t modelFlags = mi.flags; // model flags are per spawn
                 const int32_t rootId = static_cast<int32_t>(mi.iModel->GetRootWmoId());
 
                 const auto emitTriangleWithMetadata = [&](const G3D::Vector3& a,
@@ -275,24 +768,8 @@ SceneCache* SceneCache::Extract(uint32_t mapId,
                                                           uint32_t groupFlags,
                                                           int32_t groupId)
                 {
-                    if (hasBounds)
-                    {
-                        const float txMin = std::min({ a.x, b.x, c.x });
-                        const float txMax = std::max({ a.x, b.x, c.x });
-                        const float tyMin = std::min({ a.y, b.y, c.y });
-                        const float tyMax = std::max({ a.y, b.y, c.y });
-                        if (txMax < bMinX || txMin > bMaxX ||
-                            tyMax < bMinY || tyMin > bMaxY)
-                            return;
-                    }
-
-                    SceneTri st;
-                    st.ax = a.x; st.ay = a.y; st.az = a.z;
-                    st.bx = b.x; st.by = b.y; st.bz = b.z;
-                    st.cx = c.x; st.cy = c.y; st.cz = c.z;
-                    st.sourceType = sourceType;
-                    st.instanceId = mi.ID;
-                    cache->m_triangles.push_back(st);
+                    if (triOutsideBounds(a, b, c))
+                        return;
 
                     SceneTriMetadata metadata;
                     metadata.sourceType = sourceType;
@@ -302,12 +779,7 @@ SceneCache* SceneCache::Extract(uint32_t mapId,
                     metadata.groupFlags = groupFlags;
                     metadata.rootId = rootId;
                     metadata.groupId = groupId;
-                    cache->m_triangleMetadata.push_back(metadata);
-
-                    actualMinX = std::min(actualMinX, std::min({ a.x, b.x, c.x }));
-                    actualMinY = std::min(actualMinY, std::min({ a.y, b.y, c.y }));
-                    actualMaxX = std::max(actualMaxX, std::max({ a.x, b.x, c.x }));
-                    actualMaxY = std::max(actualMaxY, std::max({ a.y, b.y, c.y }));
+                    chunk.Add(a, b, c, metadata);
                 };
 
                 if (mi.flags & VMAP::MOD_M2)
@@ -315,9 +787,9 @@ SceneCache* SceneCache::Extract(uint32_t mapId,
                     std::vector<G3D::Vector3> localVerts;
                     std::vector<uint32_t> indices;
                     if (!mi.iModel->GetAllMeshData(localVerts, indices))
-                        continue;
+                        return;
                     if (localVerts.empty() || indices.size() < 3)
-                        continue;
+                        return;
 
                     std::vector<G3D::Vector3> worldVerts(localVerts.size());
                     for (size_t v = 0; v < localVerts.size(); ++v)
@@ -335,8 +807,7 @@ SceneCache* SceneCache::Extract(uint32_t mapId,
                                                  0u,
                                                  -1);
                     }
-
-                    continue;
+                    return;
                 }
 
                 const uint32_t groupCount = mi.iModel->GetGroupModelCount();
@@ -368,60 +839,10 @@ SceneCache* SceneCache::Extract(uint32_t mapId,
                                                  static_cast<int32_t>(group->GetWmoID()));
                     }
                 }
+            });
 
-                continue;
-
-                // Get all mesh data from WorldModel (model-local vertices + indices)
-                std::vector<G3D::Vector3> localVerts;
-                std::vector<uint32_t> indices;
-                if (!mi.iModel->GetAllMeshData(localVerts, indices))
-                    continue;
-                if (localVerts.empty() || indices.size() < 3)
-                    continue;
-
-                // Transform all vertices to world space once
-                std::vector<G3D::Vector3> worldVerts(localVerts.size());
-                for (size_t v = 0; v < localVerts.size(); ++v)
-                {
-                    // model-local → internal: scale, rotate, translate
-                    G3D::Vector3 internal = mi.iRot * (localVerts[v] * mi.iScale) + mi.iPos;
-                    // internal → world
-                    worldVerts[v] = NavCoord::InternalToWorld(internal);
-                }
-
-                // Emit triangles (indices are flattened: 3 per triangle)
-                for (size_t t = 0; t + 2 < indices.size(); t += 3)
-                {
-                    const G3D::Vector3& a = worldVerts[indices[t]];
-                    const G3D::Vector3& b = worldVerts[indices[t + 1]];
-                    const G3D::Vector3& c = worldVerts[indices[t + 2]];
-
-                    // Bounds check on triangle
-                    if (hasBounds)
-                    {
-                        float txMin = std::min({a.x, b.x, c.x});
-                        float txMax = std::max({a.x, b.x, c.x});
-                        float tyMin = std::min({a.y, b.y, c.y});
-                        float tyMax = std::max({a.y, b.y, c.y});
-                        if (txMax < bMinX || txMin > bMaxX ||
-                            tyMax < bMinY || tyMin > bMaxY)
-                            continue;
-                    }
-
-                    SceneTri st;
-                    st.ax = a.x; st.ay = a.y; st.az = a.z;
-                    st.bx = b.x; st.by = b.y; st.bz = b.z;
-                    st.cx = c.x; st.cy = c.y; st.cz = c.z;
-                    st.sourceType = 0; // VMAP
-                    st.instanceId = mi.ID;
-                    cache->m_triangles.push_back(st);
-
-                    actualMinX = std::min(actualMinX, std::min({a.x, b.x, c.x}));
-                    actualMinY = std::min(actualMinY, std::min({a.y, b.y, c.y}));
-                    actualMaxX = std::max(actualMaxX, std::max({a.x, b.x, c.x}));
-                    actualMaxY = std::max(actualMaxY, std::max({a.y, b.y, c.y}));
-                }
-            }
+            for (ExtractChunk& chunk : chunks)
+                chunk.MoveInto(tris, triMetadata, totals);
         }
     }
 
@@ -450,24 +871,32 @@ SceneCache* SceneCache::Extract(uint32_t mapId,
         struct CachedM2 {
             std::vector<G3D::Vector3> verts;
             std::vector<uint32_t> indices;
-            bool valid;
+            bool valid = false;
+        };
+
+        // Default-set doodad spawns of one WMO instance, with each spawn's
+        // model resolved to an index into m2Models.
+        struct InstanceDoodads {
+            WmoDoodad::DoodadFile data;
+            std::vector<uint32_t> spawnIndices;
+            std::vector<uint32_t> modelIndices;
         };
-        std::unordered_map<std::string, CachedM2> m2Cache;
 
         const VMAP::StaticMapTree* mapTree = vmapMgr->GetStaticMapTree(mapId);
         if (mapTree)
         {
             const VMAP::ModelInstance* instances = mapTree->GetInstancesPtr();
             uint32_t instanceCount = mapTree->GetInstanceCount();
-            int doodadTrisAdded = 0;
+            std::vector<InstanceDoodads> doodads(instanceCount);
 
-            for (uint32_t i = 0; i < instanceCount; ++i)
+            // Read every WMO instance's .doodads file
+            Parallel::For(instanceCount, [&](size_t i)
             {
                 const VMAP::ModelInstance& mi = instances[i];
-                if (!mi.iModel) continue;
+                if (!mi.iModel) return;
 
                 // Only process WMO instances (not M2)
-                if (mi.flags & VMAP::MOD_M2) continue;
+                if (mi.flags & VMAP::MOD_M2) return;
 
                 // Check for .doodads file
                 std::string doodadsFile = vmapsPath + mi.name + ".doodads";
@@ -480,14 +909,14 @@ SceneCache* SceneCache::Extract(uint32_t mapId,
                     if (dit != vmapsFileLookup.end())
                         doodadsFile = vmapsPath + dit->second;
                     else
-                        continue;
+                        return;
                 }
 
-                WmoDoodad::DoodadFile doodadData;
+                WmoDoodad::DoodadFile& doodadData = doodads[i].data;
                 if (!WmoDoodad::DoodadFile::Read(doodadsFile, doodadData))
-                    continue;
+                    return;
                 if (doodadData.sets.empty() || doodadData.spawns.empty())
-                    continue;
+                    return;
 
                 // Use doodad set 0 (default set)
                 const auto& defaultSet = doodadData.sets[0];
@@ -503,45 +932,68 @@ SceneCache* SceneCache::Extract(uint32_t mapId,
                         continue;
                     if (spawn.nameOffset >= doodadData.nameTable.size())
                         continue;
+                    doodads[i].spawnIndices.push_back(si);
+                }
+            });
 
-                    const char* m2Name = &doodadData.nameTable[spawn.nameOffset];
-                    std::string m2Key(m2Name);
+            // Assign model indices in first-use order so loading is stable
+            std::unordered_map<std::string, uint32_t> m2Index;
+            std::vector<std::string> m2Names;
+            for (InstanceDoodads& inst : doodads)
+            {
+                inst.modelIndices.reserve(inst.spawnIndices.size());
+                for (uint32_t si : inst.spawnIndices)
+                {
+                    std::string m2Key(&inst.data.nameTable[inst.data.spawns[si].nameOffset]);
+                    auto [it, inserted] = m2Index.emplace(m2Key, static_cast<uint32_t>(m2Names.size()));
+                    if (inserted)
+                        m2Names.push_back(m2Key);
+                    inst.modelIndices.push_back(it->second);
+                }
+            }
 
-                    // Load M2 model (with caching)
-                    auto cacheIt = m2Cache.find(m2Key);
-                    if (cacheIt == m2Cache.end())
-                    {
-                        CachedM2 cm2;
-                        cm2.valid = false;
-                        std::string vmoPath = vmapsPath + m2Key + ".vmo";
-                        if (!std::filesystem::exists(vmoPath))
-                        {
-                            // Case-insensitive search
-                            std::string keyLower = m2Key + ".vmo";
-                            std::transform(keyLower.begin(), keyLower.end(), keyLower.begin(), ::tolower);
-                            auto vit = vmapsFileLookup.find(keyLower);
-                            if (vit != vmapsFileLookup.end())
-                                vmoPath = vmapsPath + vit->second;
-                        }
-
-                        if (std::filesystem::exists(vmoPath))
-                        {
-                            VMAP::WorldModel wm;
-                            if (wm.readFile(vmoPath))
-                            {
-                                if (wm.GetAllMeshData(cm2.verts, cm2.indices))
-                                    cm2.valid = !cm2.verts.empty() && cm2.indices.size() >= 3;
-                            }
-                        }
-                        m2Cache[m2Key] = std::move(cm2);
-                        cacheIt = m2Cache.find(m2Key);
-                    }
+            // Load each referenced M2 model once
+            std::vector<CachedM2> m2Models(m2Names.size());
+            Parallel::For(m2Names.size(), [&](size_t mi)
+            {
+                const std::string& m2Key = m2Names[mi];
+                CachedM2& cm2 = m2Models[mi];
+                std::string vmoPath = vmapsPath + m2Key + ".vmo";
+                if (!std::filesystem::exists(vmoPath))
+                {
+                    // Case-insensitive search
+                    std::string keyLower = m2Key + ".vmo";
+                    std::transform(keyLower.begin(), keyLower.end(), keyLower.begin(), ::tolower);
+                    auto vit = vmapsFileLookup.find(keyLower);
+                    if (vit != vmapsFileLookup.end())
+                        vmoPath = vmapsPath + vit->second;
+                }
+
+                if (std::filesystem::exists(vmoPath))
+                {
+                    std::shared_ptr<const VMAP::WorldModel> wm = VMAP::WorldModelStore::Instance().Acquire(vmoPath);
+                    if (wm && wm->GetAllMeshData(cm2.verts, cm2.indices))
+                        cm2.valid = !cm2.verts.empty() && cm2.indices.size() >= 3;
+                }
+            });
 
-                    if (!cacheIt->second.valid)
+            // Place the doodads of each WMO instance
+            std::vector<ExtractChunk> chunks(instanceCount);
+            Parallel::For(instanceCount, [&](size_t i)
+            {
+                const VMAP::ModelInstance& mi = instances[i];
+                const InstanceDoodads& inst = doodads[i];
+                ExtractChunk& chunk = chunks[i];
+
+                for (size_t d = 0; d < inst.spawnIndices.size(); ++d)
+                {
+                    const auto& spawn = inst.data.spawns[inst.spawnIndices[d]];
+                    const CachedM2& cm2 = m2Models[inst.modelIndices[d]];
+                    if (!cm2.valid)
                         continue;
 
-                    const auto& m2Verts = cacheIt->second.verts;
-                    const auto& m2Indices = cacheIt->second.indices;
+                    const auto& m2Verts = cm2.verts;
+                    const auto& m2Indices = cm2.indices;
 
                     // Transform M2 vertices:
                     // 1. Undo fixCoordSystem (VMAP internal → WoW M2 space)
@@ -583,46 +1035,30 @@ SceneCache* SceneCache::Extract(uint32_t mapId,
                         const G3D::Vector3& b = worldVerts[m2Indices[t + 1]];
                         const G3D::Vector3& c = worldVerts[m2Indices[t + 2]];
 
-                        if (hasBounds)
-                        {
-                            float txMin = std::min({a.x, b.x, c.x});
-                            float txMax = std::max({a.x, b.x, c.x});
-                            float tyMin = std::min({a.y, b.y, c.y});
-                            float tyMax = std::max({a.y, b.y, c.y});
-                            if (txMax < bMinX || txMin > bMaxX ||
-                                tyMax < bMinY || tyMin > bMaxY)
-                                continue;
-                        }
-
-                        SceneTri st;
-                        st.ax = a.x; st.ay = a.y; st.az = a.z;
-                        st.bx = b.x; st.by = b.y; st.bz = b.z;
-                        st.cx = c.x; st.cy = c.y; st.cz = c.z;
-                        st.sourceType = 2; // Doodad (M2 inside WMO)
-                        st.instanceId = mi.ID;
-                        cache->m_triangles.push_back(st);
+                        if (triOutsideBounds(a, b, c))
+                            continue;
 
                         SceneTriMetadata metadata;
-                        metadata.sourceType = 2u;
+                        metadata.sourceType = 2u; // Doodad (M2 inside WMO)
                         metadata.instanceId = mi.ID;
                         metadata.instanceFlags = mi.flags;
                         metadata.modelFlags = VMAP::MOD_M2;
                         metadata.rootId = mi.iModel ? static_cast<int32_t>(mi.iModel->GetRootWmoId()) : -1;
                         metadata.groupId = -1;
-                        cache->m_triangleMetadata.push_back(metadata);
-
-                        doodadTrisAdded++;
-
-                        actualMinX = std::min(actualMinX, std::min({a.x, b.x, c.x}));
-                        actualMinY = std::min(actualMinY, std::min({a.y, b.y, c.y}));
-                        actualMaxX = std::max(actualMaxX, std::max({a.x, b.x, c.x}));
-                        actualMaxY = std::max(actualMaxY, std::max({a.y, b.y, c.y}));
+                        chunk.Add(a, b, c, metadata);
                     }
                 }
+            });
+
+            size_t doodadTrisAdded = 0;
+            for (ExtractChunk& chunk : chunks)
+            {
+                doodadTrisAdded += chunk.tris.size();
+                chunk.MoveInto(tris, triMetadata, totals);
             }
 
             if (doodadTrisAdded > 0)
-                fprintf(stderr, "[SceneCache] Added %d doodad triangles for map %u\n", doodadTrisAdded, mapId);
+                fprintf(stderr, "[SceneCache] Added %zu doodad triangles for map %u\n", doodadTrisAdded, mapId);
         }
     }
 
@@ -643,42 +1079,55 @@ SceneCache* SceneCache::Extract(uint32_t mapId,
             tMaxX = 17067.0f; tMaxY = 17067.0f;
         }
 
-        std::vector<MapFormat::TerrainTriangle> terrainTris;
-        mapLoader->GetTerrainTriangles(mapId, tMinX, tMinY, tMaxX, tMaxY, terrainTris);
+        // One work item per ADT tile, in the order GetTerrainTriangles visits them
+        uint32_t minGX, minGY, maxGX, maxGY;
+        mapLoader->GetTerrainTileRange(tMinX, tMinY, tMaxX, tMaxY, minGX, minGY, maxGX, maxGY);
+        const uint32_t tilesX = maxGX - minGX + 1;
+        const size_t tileCount = static_cast<size_t>(tilesX) * (maxGY - minGY + 1);
+        std::vector<ExtractChunk> chunks(tileCount);
 
-        for (const auto& tw : terrainTris)
+        Parallel::For(tileCount, [&](size_t ti)
         {
-            SceneTri st;
-            st.ax = tw.ax; st.ay = tw.ay; st.az = tw.az;
-            st.bx = tw.bx; st.by = tw.by; st.bz = tw.bz;
-            st.cx = tw.cx; st.cy = tw.cy; st.cz = tw.cz;
-            st.sourceType = 1; // ADT
-            st.instanceId = 0;
-            cache->m_triangles.push_back(st);
-
-            SceneTriMetadata metadata;
-            metadata.sourceType = 1u;
-            metadata.instanceId = 0u;
-            cache->m_triangleMetadata.push_back(metadata);
-
-            actualMinX = std::min(actualMinX, std::min({tw.ax, tw.bx, tw.cx}));
-            actualMinY = std::min(actualMinY, std::min({tw.ay, tw.by, tw.cy}));
-            actualMaxX = std::max(actualMaxX, std::max({tw.ax, tw.bx, tw.cx}));
-            actualMaxY = std::max(actualMaxY, std::max({tw.ay, tw.by, tw.cy}));
-        }
+            const uint32_t tileY = minGY + static_cast<uint32_t>(ti / tilesX);
+            const uint32_t tileX = minGX + static_cast<uint32_t>(ti % tilesX);
+
+            std::vector<MapFormat::TerrainTriangle> terrainTris;
+            if (!mapLoader->GetTileTerrainTriangles(mapId, tileY, tileX, tMinX, tMinY, tMaxX, tMaxY, terrainTris))
+                return;
+
+            ExtractChunk& chunk = chunks[ti];
+            chunk.Reserve(terrainTris.size());
+            for (const auto& tw : terrainTris)
+            {
+                SceneTriMetadata metadata;
+                metadata.sourceType = 1u; // ADT
+                metadata.instanceId = 0u;
+                chunk.Add(G3D::Vector3(tw.ax, tw.ay, tw.az),
+                          G3D::Vector3(tw.bx, tw.by, tw.bz),
+                          G3D::Vector3(tw.cx, tw.cy, tw.cz),
+                          metadata);
+            }
+        });
+
+        for (ExtractChunk& chunk : chunks)
+            chunk.MoveInto(tris, triMetadata, totals);
     }
 
-    if (cache->m_triangles.empty())
+    if (tris.empty())
     {
         delete cache;
         return nullptr;
     }
 
+    cache->SetTriangles(tris, triMetadata);
+    std::vector<SceneTri>().swap(tris);
+    std::vector<SceneTriMetadata>().swap(triMetadata);
+
     // Set bounds from actual triangle extents (with small padding)
-    cache->m_minX = actualMinX - 1.0f;
-    cache->m_minY = actualMinY - 1.0f;
-    cache->m_maxX = actualMaxX + 1.0f;
-    cache->m_maxY = actualMaxY + 1.0f;
+    cache->m_minX = totals.minX - 1.0f;
+    cache->m_minY = totals.minY - 1.0f;
+    cache->m_maxX = totals.maxX + 1.0f;
+    cache->m_maxY = totals.maxY + 1.0f;
 
     // 3) Sample liquid grid
     {
@@ -694,30 +1143,42 @@ SceneCache* SceneCache::Extract(uint32_t mapId,
         uint32_t liqTotal = cache->m_liquidCellsX * cache->m_liquidCellsY;
         cache->m_liquidGrid.resize(liqTotal);
 
-        for (uint32_t cy = 0; cy < cache->m_liquidCellsY; ++cy)
+        // Workers lay out the sample points and clear the cells, one row per
+        // work item. EvaluateLiquidAt pages ADT and VMAP tiles in through
+        // loaders that are not safe to drive from several threads, so the
+        // samples themselves are taken on the calling thread, in row order.
+        struct LiquidSample { float x, y; };
+        std::vector<LiquidSample> samples(liqTotal);
+        Parallel::For(cache->m_liquidCellsY, [&](size_t row)
         {
+            const uint32_t cy = static_cast<uint32_t>(row);
             for (uint32_t cx = 0; cx < cache->m_liquidCellsX; ++cx)
             {
-                float sampleX = lMinX + (cx + 0.5f) * cache->m_liquidCellSize;
-                float sampleY = lMinY + (cy + 0.5f) * cache->m_liquidCellSize;
-                float sampleZ = 5000.0f; // query from high altitude
+                const size_t i = static_cast<size_t>(cy) * cache->m_liquidCellsX + cx;
+                samples[i] = { lMinX + (cx + 0.5f) * cache->m_liquidCellSize,
+                               lMinY + (cy + 0.5f) * cache->m_liquidCellSize };
 
-                LiquidCell& cell = cache->m_liquidGrid[cy * cache->m_liquidCellsX + cx];
+                LiquidCell& cell = cache->m_liquidGrid[i];
                 cell.level = 0.0f;
                 cell.type = 0;
                 cell.flags = 0;
                 std::memset(cell.pad, 0, sizeof(cell.pad));
+            }
+        });
 
-                // Query liquid from SceneQuery (which checks both ADT and VMAP)
-                auto info = SceneQuery::EvaluateLiquidAt(mapId, sampleX, sampleY, sampleZ);
-                if (info.hasLevel)
-                {
-                    cell.level = info.level;
-                    cell.type = info.type;
-                    cell.flags = 0x01; // hasLevel
-                    if (info.fromVmap)
-                        cell.flags |= 0x02;
-                }
+        const float sampleZ = 5000.0f; // query from high altitude
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            // Query liquid from SceneQuery (which checks both ADT and VMAP)
+            auto info = SceneQuery::EvaluateLiquidAt(mapId, samples[i].x, samples[i].y, sampleZ);
+            if (info.hasLevel)
+            {
+                LiquidCell& cell = cache->m_liquidGrid[i];
+                cell.level = info.level;
+                cell.type = info.type;
+                cell.flags = 0x01; // hasLevel
+                if (info.fromVmap)
+                    cell.flags |= 0x02;
             }
         }
     }
@@ -725,9 +1186,9 @@ SceneCache* SceneCache::Extract(uint32_t mapId,
     // 4) Build spatial index
     cache->BuildSpatialIndex();
 
-    fprintf(stderr, "[SceneCache] Extracted map %u: %zu triangles, %u x %u grid cells, %u x %u liquid cells\n",
-            mapId, cache->m_triangles.size(), cache->m_cellsX, cache->m_cellsY,
-            cache->m_liquidCellsX, cache->m_liquidCellsY);
+    fprintf(stderr, "[SceneCache] Extracted map %u: %zu triangles (%zu shared vertices, %zu metadata entries), %u x %u grid cells, %u x %u liquid cells\n",
+            mapId, cache->m_tris.size(), cache->m_vertices.size(), cache->m_metadataTable.size(),
+            cache->m_cellsX, cache->m_cellsY, cache->m_liquidCellsX, cache->m_liquidCellsY);
 
     return cache;
 }
@@ -745,61 +1206,402 @@ void SceneCache::BuildSpatialIndex()
     m_cellsX = std::max(1u, static_cast<uint32_t>(std::ceil(rangeX / m_cellSize)));
     m_cellsY = std::max(1u, static_cast<uint32_t>(std::ceil(rangeY / m_cellSize)));
 
-    uint32_t totalCells = m_cellsX * m_cellsY;
+    const uint32_t cellsX = m_cellsX;
+    const uint32_t cellsY = m_cellsY;
+    const size_t totalCells = static_cast<size_t>(cellsX) * cellsY;
+    const uint32_t triCount = static_cast<uint32_t>(m_tris.size());
 
-    // Count triangles per cell
-    std::vector<std::vector<uint32_t>> cellTriLists(totalCells);
+    // The grid is built as a count / prefix-sum / scatter into the flat
+    // arrays. Work is split into rows of cells ("bands"); a band owns a
+    // contiguous range of cells and visits its triangles in ascending order,
+    // so every cell lists its triangles ascending, whatever the thread count.
 
-    for (uint32_t ti = 0; ti < m_triangles.size(); ++ti)
-    {
-        const SceneTri& t = m_triangles[ti];
-        float txMin = std::min({t.ax, t.bx, t.cx});
-        float txMax = std::max({t.ax, t.bx, t.cx});
-        float tyMin = std::min({t.ay, t.by, t.cy});
-        float tyMax = std::max({t.ay, t.by, t.cy});
+    // 1) Clamped cell rectangle of every triangle
+    struct CellRect { uint32_t cxMin, cxMax, cyMin, cyMax; };
+    std::vector<CellRect> rects(triCount);
+    constexpr uint32_t BLOCK_SIZE = 16384;
+    const size_t blockCount = (static_cast<size_t>(triCount) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const auto blockEnd = [&](size_t block) { return std::min<uint32_t>(triCount, static_cast<uint32_t>((block + 1) * BLOCK_SIZE)); };
 
-        // Clamp to grid bounds
-        uint32_t cxMin = static_cast<uint32_t>(std::max(0.0f, (txMin - m_minX) / m_cellSize));
-        uint32_t cxMax = static_cast<uint32_t>(std::max(0.0f, (txMax - m_minX) / m_cellSize));
-        uint32_t cyMin = static_cast<uint32_t>(std::max(0.0f, (tyMin - m_minY) / m_cellSize));
-        uint32_t cyMax = static_cast<uint32_t>(std::max(0.0f, (tyMax - m_minY) / m_cellSize));
+    Parallel::For(blockCount, [&](size_t block)
+    {
+        for (uint32_t ti = static_cast<uint32_t>(block * BLOCK_SIZE); ti < blockEnd(block); ++ti)
+        {
+            const SceneTri t = GetTri(ti);
+            float txMin = std::min({t.ax, t.bx, t.cx});
+            float txMax = std::max({t.ax, t.bx, t.cx});
+            float tyMin = std::min({t.ay, t.by, t.cy});
+            float tyMax = std::max({t.ay, t.by, t.cy});
+
+            // Clamp to grid bounds
+            CellRect& r = rects[ti];
+            r.cxMin = static_cast<uint32_t>(std::max(0.0f, (txMin - m_minX) / m_cellSize));
+            r.cxMax = static_cast<uint32_t>(std::max(0.0f, (txMax - m_minX) / m_cellSize));
+            r.cyMin = static_cast<uint32_t>(std::max(0.0f, (tyMin - m_minY) / m_cellSize));
+            r.cyMax = static_cast<uint32_t>(std::max(0.0f, (tyMax - m_minY) / m_cellSize));
+
+            r.cxMax = std::min(r.cxMax, cellsX - 1);
+            r.cyMax = std::min(r.cyMax, cellsY - 1);
+            r.cxMin = std::min(r.cxMin, cellsX - 1);
+            r.cyMin = std::min(r.cyMin, cellsY - 1);
+        }
+    });
 
-        cxMax = std::min(cxMax, m_cellsX - 1);
-        cyMax = std::min(cyMax, m_cellsY - 1);
-        cxMin = std::min(cxMin, m_cellsX - 1);
-        cyMin = std::min(cyMin, m_cellsY - 1);
+    // 2) Bucket triangle ids by band (itself a blocks x bands counting sort)
+    const uint32_t targetBands = Parallel::DefaultThreadCount() * 4u;
+    const uint32_t rowsPerBand = (cellsY + targetBands - 1) / targetBands;
+    const uint32_t bandCount = (cellsY + rowsPerBand - 1) / rowsPerBand;
 
-        for (uint32_t cy = cyMin; cy <= cyMax; ++cy)
-            for (uint32_t cx = cxMin; cx <= cxMax; ++cx)
-                cellTriLists[cy * m_cellsX + cx].push_back(ti);
-    }
+    std::vector<size_t> blockBandSlot(blockCount * bandCount, 0);
+    Parallel::For(blockCount, [&](size_t block)
+    {
+        size_t* counts = &blockBandSlot[block * bandCount];
+        for (uint32_t ti = static_cast<uint32_t>(block * BLOCK_SIZE); ti < blockEnd(block); ++ti)
+            for (uint32_t band = rects[ti].cyMin / rowsPerBand; band <= rects[ti].cyMax / rowsPerBand; ++band)
+                ++counts[band];
+    });
+
+    std::vector<size_t> bandStart(bandCount + 1);
+    size_t bandedTotal = 0;
+    for (uint32_t band = 0; band < bandCount; ++band)
+    {
+        bandStart[band] = bandedTotal;
+        for (size_t block = 0; block < blockCount; ++block)
+        {
+            size_t count = blockBandSlot[block * bandCount + band];
+            blockBandSlot[block * bandCount + band] = bandedTotal;
+            bandedTotal += count;
+        }
+    }
+    bandStart[bandCount] = bandedTotal;
+
+    std::vector<uint32_t> bandTris(bandedTotal);
+    Parallel::For(blockCount, [&](size_t block)
+    {
+        size_t* cursor = &blockBandSlot[block * bandCount];
+        for (uint32_t ti = static_cast<uint32_t>(block * BLOCK_SIZE); ti < blockEnd(block); ++ti)
+            for (uint32_t band = rects[ti].cyMin / rowsPerBand; band <= rects[ti].cyMax / rowsPerBand; ++band)
+                bandTris[cursor[band]++] = ti;
+    });
+
+    // 3) Per band: count triangles per cell and prefix-sum them locally
+    m_cellStart.assign(totalCells, 0);
+    m_cellCount.assign(totalCells, 0);
+    uint32_t* cellStart = m_cellStart.Mutable().data();
+    uint32_t* cellCount = m_cellCount.Mutable().data();
+    std::vector<uint32_t> bandRefs(bandCount, 0);
+
+    const auto forEachBandCell = [&](uint32_t band, auto&& visit)
+    {
+        const uint32_t rowBegin = band * rowsPerBand;
+        const uint32_t rowEnd = std::min(cellsY, rowBegin + rowsPerBand);
+        for (size_t i = bandStart[band]; i < bandStart[band + 1]; ++i)
+        {
+            const uint32_t ti = bandTris[i];
+            const CellRect& r = rects[ti];
+            const uint32_t cyMin = std::max(r.cyMin, rowBegin);
+            const uint32_t cyMax = std::min(r.cyMax, rowEnd - 1);
+            for (uint32_t cy = cyMin; cy <= cyMax; ++cy)
+                for (uint32_t cx = r.cxMin; cx <= r.cxMax; ++cx)
+                    visit(static_cast<size_t>(cy) * cellsX + cx, ti);
+        }
+    };
+
+    Parallel::For(bandCount, [&](size_t bandIndex)
+    {
+        const uint32_t band = static_cast<uint32_t>(bandIndex);
+        forEachBandCell(band, [&](size_t ci, uint32_t) { ++cellCount[ci]; });
+
+        const size_t cellBegin = static_cast<size_t>(band) * rowsPerBand * cellsX;
+        const size_t cellEnd = std::min(totalCells, cellBegin + static_cast<size_t>(rowsPerBand) * cellsX);
+        uint32_t running = 0;
+        for (size_t ci = cellBegin; ci < cellEnd; ++ci)
+        {
+            cellStart[ci] = running;
+            running += cellCount[ci];
+        }
+        bandRefs[band] = running;
+    });
 
-    // Flatten into sorted arrays
-    m_cellStart.resize(totalCells);
-    m_cellCount.resize(totalCells);
-    m_triIndices.clear();
+    uint32_t totalRefs = 0;
+    for (uint32_t band = 0; band < bandCount; ++band)
+    {
+        uint32_t count = bandRefs[band];
+        bandRefs[band] = totalRefs;
+        totalRefs += count;
+    }
+
+    // 4) Per band: rebase the cell starts and scatter triangle ids
+    m_triIndices.assign(totalRefs, 0);
+    uint32_t* triIndices = m_triIndices.Mutable().data();
+    Parallel::For(bandCount, [&](size_t bandIndex)
+    {
+        const uint32_t band = static_cast<uint32_t>(bandIndex);
+        const size_t cellBegin = static_cast<size_t>(band) * rowsPerBand * cellsX;
+        const size_t cellEnd = std::min(totalCells, cellBegin + static_cast<size_t>(rowsPerBand) * cellsX);
+        std::vector<uint32_t> fill(cellEnd - cellBegin, 0);
+        for (size_t ci = cellBegin; ci < cellEnd; ++ci)
+            cellStart[ci] += bandRefs[band];
+
+        forEachBandCell(band, [&](size_t ci, uint32_t ti)
+        {
+            triIndices[cellStart[ci] + fill[ci - cellBegin]++] = ti;
+        });
+    });
+
+    BuildHeightLayers();
+}
+
+namespace
+{
+    // Layer spans must fit int16 LAYER_Z_STEP units, one step of slack each way
+    constexpr float LAYER_Z_LIMIT = 8000.0f;
+
+    // Vertical probe of a triangle at (x,y): barycentric point-in-triangle
+    // test in the XY projection, then plane interpolation. False when (x,y)
+    // is outside or the projection is degenerate (vertical walls).
+    bool SampleTriangleZ(const SceneTri& st, float x, float y, float& outZ)
+    {
+        // Quick AABB check: does triangle contain (x,y) in XY?
+        float txMin = std::min({st.ax, st.bx, st.cx});
+        float txMax = std::max({st.ax, st.bx, st.cx});
+        float tyMin = std::min({st.ay, st.by, st.cy});
+        float tyMax = std::max({st.ay, st.by, st.cy});
+        if (x < txMin || x > txMax || y < tyMin || y > tyMax)
+            return false;
+
+        float v0x = st.cx - st.ax, v0y = st.cy - st.ay;
+        float v1x = st.bx - st.ax, v1y = st.by - st.ay;
+        float v2x = x - st.ax, v2y = y - st.ay;
+
+        float d00 = v0x * v0x + v0y * v0y;
+        float d01 = v0x * v1x + v0y * v1y;
+        float d02 = v0x * v2x + v0y * v2y;
+        float d11 = v1x * v1x + v1y * v1y;
+        float d12 = v1x * v2x + v1y * v2y;
+
+        float denom = d00 * d11 - d01 * d01;
+        if (std::fabs(denom) < 1e-12f)
+            return false;
+
+        float invDenom = 1.0f / denom;
+        float u = (d11 * d02 - d01 * d12) * invDenom;
+        float v = (d00 * d12 - d01 * d02) * invDenom;
+        if (u < -1e-6f || v < -1e-6f || (u + v) > 1.0f + 1e-6f)
+            return false;
+
+        outZ = st.az + u * (st.cz - st.az) + v * (st.bz - st.az);
+        return true;
+    }
 
-    for (uint32_t ci = 0; ci < totalCells; ++ci)
+    // |unit normal z| of a triangle (e1 x e2); false when it has no area
+    bool TriangleNormalZ(const SceneTri& st, float& outNormalZ)
     {
-        m_cellStart[ci] = static_cast<uint32_t>(m_triIndices.size());
-        m_cellCount[ci] = static_cast<uint32_t>(cellTriLists[ci].size());
-        m_triIndices.insert(m_triIndices.end(), cellTriLists[ci].begin(), cellTriLists[ci].end());
+        float e1x = st.bx - st.ax, e1y = st.by - st.ay, e1z = st.bz - st.az;
+        float e2x = st.cx - st.ax, e2y = st.cy - st.ay, e2z = st.cz - st.az;
+        float nx = e1y * e2z - e1z * e2y;
+        float ny = e1z * e2x - e1x * e2z;
+        float nz = e1x * e2y - e1y * e2x;
+        float nLen = std::sqrt(nx * nx + ny * ny + nz * nz);
+        if (nLen < 1e-12f)
+            return false;
+        outNormalZ = std::fabs(nz / nLen);
+        return true;
+    }
+
+    // Rounded up, so a layer is only skipped when none of its triangles can
+    // pass the walkable threshold
+    uint8_t QuantizeNormalZ(float normalZ)
+    {
+        return static_cast<uint8_t>(std::min(255.0, std::ceil(static_cast<double>(normalZ) * 255.0)));
+    }
+}
+
+void SceneCache::BuildHeightLayers()
+{
+    m_heightLayers.clear();
+    m_layerCellStart.clear();
+    m_layerRefs.clear();
+
+    const uint32_t totalCells = m_cellsX * m_cellsY;
+    if (totalCells == 0 || m_cellStart.size() < totalCells || m_cellCount.size() < totalCells)
+        return;
+
+    // 1) Z extent and |unit normal z| of every triangle, decoded once
+    struct TriSpan { float zLo, zHi; uint8_t normalZ; };
+    const uint32_t triCount = static_cast<uint32_t>(m_tris.size());
+    std::vector<TriSpan> spans(triCount);
+    constexpr uint32_t BLOCK_SIZE = 16384;
+    Parallel::For((static_cast<size_t>(triCount) + BLOCK_SIZE - 1) / BLOCK_SIZE, [&](size_t block)
+    {
+        const uint32_t end = std::min<uint32_t>(triCount, static_cast<uint32_t>((block + 1) * BLOCK_SIZE));
+        for (uint32_t ti = static_cast<uint32_t>(block * BLOCK_SIZE); ti < end; ++ti)
+        {
+            const SceneTri t = GetTri(ti);
+            spans[ti].zLo = std::min({ t.az, t.bz, t.cz });
+            spans[ti].zHi = std::max({ t.az, t.bz, t.cz });
+            float normalZ;
+            spans[ti].normalZ = TriangleNormalZ(t, normalZ) ? QuantizeNormalZ(normalZ) : 0;
+        }
+    });
+
+    // 2) Per cell: cluster the triangles into layers. Cells are split into
+    //    contiguous chunks built independently and concatenated in order.
+    struct Chunk
+    {
+        std::vector<HeightLayer> layers;
+        std::vector<uint16_t> refs;
+        std::vector<uint32_t> cellLayers;   // layers per cell
+    };
+    const size_t chunkCount = std::min<size_t>(totalCells, Parallel::DefaultThreadCount() * 4u);
+    const size_t cellsPerChunk = (totalCells + chunkCount - 1) / chunkCount;
+    std::vector<Chunk> chunks(chunkCount);
+
+    Parallel::For(chunkCount, [&](size_t chunkIndex)
+    {
+        Chunk& chunk = chunks[chunkIndex];
+        const size_t cellBegin = chunkIndex * cellsPerChunk;
+        const size_t cellEnd = std::min<size_t>(totalCells, cellBegin + cellsPerChunk);
+        chunk.cellLayers.assign(cellEnd - cellBegin, 0);
+
+        std::vector<uint16_t> order;
+        std::vector<uint16_t> tall;
+        std::vector<HeightLayer> cellLayers;
+        for (size_t ci = cellBegin; ci < cellEnd; ++ci)
+        {
+            const uint32_t start = m_cellStart[ci];
+            const uint32_t count = m_cellCount[ci];
+            if (count == 0 || count > std::numeric_limits<uint16_t>::max())
+                continue; // scanned whole
+
+            const auto spanOf = [&](uint16_t offset) -> const TriSpan& { return spans[m_triIndices[start + offset]]; };
+            order.clear();
+            tall.clear();
+            bool quantizable = true;
+            for (uint32_t j = 0; j < count; ++j)
+            {
+                const TriSpan& span = spanOf(static_cast<uint16_t>(j));
+                quantizable = quantizable && span.zLo > -LAYER_Z_LIMIT && span.zHi < LAYER_Z_LIMIT;
+                (span.zHi - span.zLo > LAYER_TALL_SPAN ? tall : order).push_back(static_cast<uint16_t>(j));
+            }
+            if (!quantizable)
+                continue;
+            std::stable_sort(order.begin(), order.end(),
+                [&](uint16_t a, uint16_t b) { return spanOf(a).zLo < spanOf(b).zLo; });
+
+            // Close a layer over refs [first, chunk.refs.size()), kept in cell order
+            cellLayers.clear();
+            const auto closeLayer = [&](size_t first, float zLo, float zHi)
+            {
+                std::sort(chunk.refs.begin() + first, chunk.refs.end());
+                HeightLayer layer{};
+                layer.zLo = static_cast<int16_t>(std::floor(zLo / LAYER_Z_STEP) - 1.0f);
+                layer.zHi = static_cast<int16_t>(std::ceil(zHi / LAYER_Z_STEP) + 1.0f);
+                layer.refCount = static_cast<uint16_t>(chunk.refs.size() - first);
+                layer.firstRef = static_cast<uint32_t>(first);
+                for (size_t r = first; r < chunk.refs.size(); ++r)
+                    layer.maxNormalZ = std::max(layer.maxNormalZ, spanOf(chunk.refs[r]).normalZ);
+                cellLayers.push_back(layer);
+            };
+
+            size_t first = chunk.refs.size();
+            float zLo = 0.0f, zHi = 0.0f;
+            for (uint16_t offset : order)
+            {
+                const TriSpan& span = spanOf(offset);
+                if (chunk.refs.size() > first && span.zLo > zHi)
+                {
+                    closeLayer(first, zLo, zHi);
+                    first = chunk.refs.size();
+                }
+                if (chunk.refs.size() == first)
+                {
+                    zLo = span.zLo;
+                    zHi = span.zHi;
+                }
+                else
+                {
+                    zHi = std::max(zHi, span.zHi);
+                }
+                chunk.refs.push_back(offset);
+            }
+            if (chunk.refs.size() > first)
+                closeLayer(first, zLo, zHi);
+
+            if (!tall.empty())
+            {
+                first = chunk.refs.size();
+                zLo = std::numeric_limits<float>::max();
+                zHi = -std::numeric_limits<float>::max();
+                for (uint16_t offset : tall)
+                {
+                    zLo = std::min(zLo, spanOf(offset).zLo);
+                    zHi = std::max(zHi, spanOf(offset).zHi);
+                    chunk.refs.push_back(offset);
+                }
+                closeLayer(first, zLo, zHi);
+            }
+
+            std::stable_sort(cellLayers.begin(), cellLayers.end(),
+                [](const HeightLayer& a, const HeightLayer& b) { return a.zHi > b.zHi; });
+            chunk.layers.insert(chunk.layers.end(), cellLayers.begin(), cellLayers.end());
+            chunk.cellLayers[ci - cellBegin] = static_cast<uint32_t>(cellLayers.size());
+        }
+    });
+
+    // 3) Concatenate the chunks, rebasing layer ref offsets
+    size_t layerTotal = 0, refTotal = 0;
+    for (const Chunk& chunk : chunks)
+    {
+        layerTotal += chunk.layers.size();
+        refTotal += chunk.refs.size();
+    }
+    std::vector<HeightLayer> layers;
+    std::vector<uint16_t> refs;
+    std::vector<uint32_t> cellStart(static_cast<size_t>(totalCells) + 1);
+    layers.reserve(layerTotal);
+    refs.reserve(refTotal);
+    size_t ci = 0;
+    for (const Chunk& chunk : chunks)
+    {
+        const uint32_t refBase = static_cast<uint32_t>(refs.size());
+        for (HeightLayer layer : chunk.layers)
+        {
+            layer.firstRef += refBase;
+            layers.push_back(layer);
+        }
+        refs.insert(refs.end(), chunk.refs.begin(), chunk.refs.end());
+
+        uint32_t layerCursor = static_cast<uint32_t>(layers.size() - chunk.layers.size());
+        for (uint32_t cellLayerCount : chunk.cellLayers)
+        {
+            cellStart[ci++] = layerCursor;
+            layerCursor += cellLayerCount;
+        }
     }
+    cellStart[totalCells] = static_cast<uint32_t>(layers.size());
+
+    m_heightLayers.swap(layers);
+    m_layerRefs.swap(refs);
+    m_layerCellStart.swap(cellStart);
 }
 
 void SceneCache::InjectTriangles(float minX, float minY, float maxX, float maxY,
                                   const InjectedTriangle* triangles, int count)
 {
+    m_streamer.reset();
+    m_injectedTiles.clear();
+    m_hasInjectedTiles = false;
     m_minX = minX;
     m_minY = minY;
     m_maxX = maxX;
     m_maxY = maxY;
     m_cellSize = 4.0f;
 
-    m_triangles.clear();
-    m_triangles.reserve(count);
-    m_triangleMetadata.clear();
-    m_triangleMetadata.reserve(count);
+    std::vector<SceneTri> tris;
+    std::vector<SceneTriMetadata> metadata;
+    tris.reserve(count);
+    metadata.reserve(count);
 
     for (int i = 0; i < count; ++i)
     {
@@ -810,14 +1612,15 @@ void SceneCache::InjectTriangles(float minX, float minY, float maxX, float maxY,
         tri.cx = t.v2x; tri.cy = t.v2y; tri.cz = t.v2z;
         tri.sourceType = t.sourceType;
         tri.instanceId = t.instanceId;
-        m_triangles.push_back(tri);
+        tris.push_back(tri);
 
         SceneTriMetadata meta{};
         meta.sourceType = t.sourceType;
         meta.instanceId = t.instanceId;
         meta.groupFlags = t.groupFlags;
-        m_triangleMetadata.push_back(meta);
+        metadata.push_back(meta);
     }
+    SetTriangles(tris, metadata);
 
     BuildSpatialIndex();
 }
@@ -826,6 +1629,70 @@ void SceneCache::InjectTriangles(float minX, float minY, float maxX, float maxY,
 // QUERY METHODS
 // ============================================================================
 
+namespace
+{
+    // Composite AABB queries visit every tile overlapping the box, and tiles
+    // repeat the triangles that cross their edges. Each triangle is kept
+    // only from the tile holding the min corner of (triangle XY AABB clipped
+    // to the box), unless that tile is not loaded at all. Tile is anything
+    // with tileX / tileY (SceneTileRef, LocalView::TileView).
+    template<typename Tile, typename TileQuery>
+    void GatherTileTriangles(const std::vector<Tile>& tiles,
+                             float minX, float minY, float maxX, float maxY,
+                             std::vector<CapsuleCollision::Triangle>& outTris,
+                             std::vector<uint32_t>* outInstanceIds,
+                             std::vector<uint32_t>* outSourceTypes,
+                             std::vector<SceneTriMetadata>* outMetadata,
+                             TileQuery&& query)
+    {
+        if (tiles.size() == 1)
+        {
+            query(tiles[0], outTris, outInstanceIds, outSourceTypes, outMetadata);
+            return;
+        }
+
+        std::unordered_set<uint32_t> present;
+        for (const Tile& tile : tiles)
+            present.insert(SceneTileStreamer::MakeKey(tile.tileX, tile.tileY));
+
+        std::vector<CapsuleCollision::Triangle> tris;
+        std::vector<uint32_t> ids, types;
+        std::vector<SceneTriMetadata> meta;
+        for (const Tile& tile : tiles)
+        {
+            query(tile, tris, outInstanceIds ? &ids : nullptr, outSourceTypes ? &types : nullptr,
+                  outMetadata ? &meta : nullptr);
+
+            for (size_t i = 0; i < tris.size(); ++i)
+            {
+                const CapsuleCollision::Triangle& t = tris[i];
+                const float tMinX = std::min({ t.a.x, t.b.x, t.c.x });
+                const float tMaxX = std::max({ t.a.x, t.b.x, t.c.x });
+                const float tMinY = std::min({ t.a.y, t.b.y, t.c.y });
+                const float tMaxY = std::max({ t.a.y, t.b.y, t.c.y });
+                if (tMaxX < minX || tMinX > maxX || tMaxY < minY || tMinY > maxY)
+                    continue; // grid-cell slop outside the box
+
+                const int ownerX = SceneTileStreamer::WorldToTileX(std::max(tMinX, minX));
+                const int ownerY = SceneTileStreamer::WorldToTileY(std::max(tMinY, minY));
+                if ((ownerX != tile.tileX || ownerY != tile.tileY) && present.count(SceneTileStreamer::MakeKey(ownerX, ownerY)))
+                    continue;
+
+                outTris.push_back(t);
+                if (outInstanceIds) outInstanceIds->push_back(ids[i]);
+                if (outSourceTypes) outSourceTypes->push_back(types[i]);
+                if (outMetadata) outMetadata->push_back(meta[i]);
+            }
+        }
+    }
+
+    template<typename T>
+    size_t SceneArrayBytes(const SceneArray<T>& array)
+    {
+        return array.size() * sizeof(T);
+    }
+}
+
 void SceneCache::QueryTrianglesInAABB(float minX, float minY, float maxX, float maxY,
                                       std::vector<CapsuleCollision::Triangle>& outTris,
                                       std::vector<uint32_t>* outInstanceIds,
@@ -836,6 +1703,15 @@ void SceneCache::QueryTrianglesInAABB(float minX, float minY, float maxX, float
     if (outInstanceIds) outInstanceIds->clear();
     if (outSourceTypes) outSourceTypes->clear();
     if (outMetadata) outMetadata->clear();
+    if (IsComposite())
+    {
+        std::vector<SceneTileRef> tiles;
+        CollectTiles(minX, minY, maxX, maxY, tiles);
+        GatherTileTriangles(tiles, minX, minY, maxX, maxY, outTris, outInstanceIds, outSourceTypes, outMetadata,
+            [&](const SceneTileRef& tile, auto& tris, auto* ids, auto* types, auto* meta)
+            { tile.cache->QueryTrianglesInAABB(minX, minY, maxX, maxY, tris, ids, types, meta); });
+        return;
+    }
     if (m_cellsX == 0 || m_cellsY == 0) return;
 
     // Compute cell range
@@ -865,43 +1741,415 @@ void SceneCache::QueryTrianglesInAABB(float minX, float minY, float maxX, float
                 uint32_t ti = m_triIndices[start + j];
                 if (!seen.insert(ti).second) continue;
 
-                const SceneTri& st = m_triangles[ti];
-
-                CapsuleCollision::Triangle tri;
-                tri.a = { st.ax, st.ay, st.az };
-                tri.b = { st.bx, st.by, st.bz };
-                tri.c = { st.cx, st.cy, st.cz };
-                tri.doubleSided = false;
-                tri.collisionMask = 0xFFFFFFFFu;
-                outTris.push_back(tri);
-
-                if (outInstanceIds)
-                    outInstanceIds->push_back(st.instanceId);
-                if (outSourceTypes)
-                    outSourceTypes->push_back(st.sourceType);
-                if (outMetadata)
-                {
-                    if (ti < m_triangleMetadata.size())
-                    {
-                        outMetadata->push_back(m_triangleMetadata[ti]);
-                    }
-                    else
-                    {
-                        SceneTriMetadata metadata;
-                        metadata.sourceType = st.sourceType;
-                        metadata.instanceId = st.instanceId;
-                        outMetadata->push_back(metadata);
-                    }
-                }
+                AppendQueryTriangle(ti, outTris, outInstanceIds, outSourceTypes, outMetadata);
             }
         }
     }
 }
 
+void SceneCache::QueryTrianglesInAABB3D(float minX, float minY, float minZ,
+                                        float maxX, float maxY, float maxZ,
+                                        std::vector<CapsuleCollision::Triangle>& outTris,
+                                        std::vector<uint32_t>* outInstanceIds,
+                                        std::vector<uint32_t>* outSourceTypes,
+                                        std::vector<SceneTriMetadata>* outMetadata) const
+{
+    outTris.clear();
+    if (outInstanceIds) outInstanceIds->clear();
+    if (outSourceTypes) outSourceTypes->clear();
+    if (outMetadata) outMetadata->clear();
+    if (IsComposite())
+    {
+        std::vector<SceneTileRef> tiles;
+        CollectTiles(minX, minY, maxX, maxY, tiles);
+        GatherTileTriangles(tiles, minX, minY, maxX, maxY, outTris, outInstanceIds, outSourceTypes, outMetadata,
+            [&](const SceneTileRef& tile, auto& tris, auto* ids, auto* types, auto* meta)
+            { tile.cache->QueryTrianglesInAABB3D(minX, minY, minZ, maxX, maxY, maxZ, tris, ids, types, meta); });
+        return;
+    }
+    if (m_cellsX == 0 || m_cellsY == 0) return;
+
+    int cxMin = std::max(0, static_cast<int>((minX - m_minX) / m_cellSize));
+    int cxMax = std::min(static_cast<int>(m_cellsX) - 1, static_cast<int>((maxX - m_minX) / m_cellSize));
+    int cyMin = std::max(0, static_cast<int>((minY - m_minY) / m_cellSize));
+    int cyMax = std::min(static_cast<int>(m_cellsY) - 1, static_cast<int>((maxY - m_minY) / m_cellSize));
+
+    // A layer's quantized span contains every triangle in it, so layers
+    // disjoint from [minZ, maxZ] are skipped whole; layers are sorted by top,
+    // so the first one entirely below the box ends the cell.
+    std::vector<uint32_t> indices;
+    const auto consider = [&](uint32_t ti)
+    {
+        const SceneTri t = GetTri(ti);
+        if (std::max({t.ax, t.bx, t.cx}) < minX || std::min({t.ax, t.bx, t.cx}) > maxX ||
+            std::max({t.ay, t.by, t.cy}) < minY || std::min({t.ay, t.by, t.cy}) > maxY ||
+            std::max({t.az, t.bz, t.cz}) < minZ || std::min({t.az, t.bz, t.cz}) > maxZ)
+            return;
+        indices.push_back(ti);
+    };
+
+    for (int cy = cyMin; cy <= cyMax; ++cy)
+    {
+        for (int cx = cxMin; cx <= cxMax; ++cx)
+        {
+            uint32_t ci = cy * m_cellsX + cx;
+            uint32_t start = m_cellStart[ci];
+            const uint32_t layerBegin = m_layerCellStart.empty() ? 0 : m_layerCellStart[ci];
+            const uint32_t layerEnd = m_layerCellStart.empty() ? 0 : m_layerCellStart[ci + 1];
+            if (layerBegin == layerEnd)
+            {
+                // Unlayered (oversized) cell
+                for (uint32_t j = 0; j < m_cellCount[ci]; ++j)
+                    consider(m_triIndices[start + j]);
+                continue;
+            }
+
+            for (uint32_t li = layerBegin; li < layerEnd; ++li)
+            {
+                const HeightLayer& L = m_heightLayers[li];
+                if (L.zHi * LAYER_Z_STEP < minZ)
+                    break;
+                if (L.zLo * LAYER_Z_STEP > maxZ)
+                    continue;
+                for (uint32_t r = L.firstRef; r < L.firstRef + L.refCount; ++r)
+                    consider(m_triIndices[start + m_layerRefs[r]]);
+            }
+        }
+    }
+
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+    outTris.reserve(indices.size());
+    for (uint32_t ti : indices)
+        AppendQueryTriangle(ti, outTris, outInstanceIds, outSourceTypes, outMetadata);
+}
+
+void SceneCache::AppendQueryTriangle(uint32_t ti,
+                                     std::vector<CapsuleCollision::Triangle>& outTris,
+                                     std::vector<uint32_t>* outInstanceIds,
+                                     std::vector<uint32_t>* outSourceTypes,
+                                     std::vector<SceneTriMetadata>* outMetadata) const
+{
+    const CompactTri& ct = m_tris[ti];
+    const CompactVertex& a = m_vertices[ct.v[0]];
+    const CompactVertex& b = m_vertices[ct.v[1]];
+    const CompactVertex& c = m_vertices[ct.v[2]];
+
+    CapsuleCollision::Triangle tri;
+    tri.a = { a.x, a.y, a.z };
+    tri.b = { b.x, b.y, b.z };
+    tri.c = { c.x, c.y, c.z };
+    tri.doubleSided = false;
+    tri.collisionMask = 0xFFFFFFFFu;
+    outTris.push_back(tri);
+
+    if (outInstanceIds || outSourceTypes || outMetadata)
+    {
+        const SceneTriMetadata& metadata = m_metadataTable[ct.meta];
+        if (outInstanceIds)
+            outInstanceIds->push_back(metadata.instanceId);
+        if (outSourceTypes)
+            outSourceTypes->push_back(metadata.sourceType);
+        if (outMetadata)
+            outMetadata->push_back(metadata);
+    }
+}
+
+// ============================================================================
+// LOCAL VIEW
+// ============================================================================
+
+void SceneCache::BuildLocalView(const std::shared_ptr<const SceneCache>& cache,
+                                float minX, float minY, float maxX, float maxY, LocalView& out)
+{
+    out.Clear();
+    if (!cache)
+        return;
+    FillLocalView(*cache, minX, minY, maxX, maxY, out);
+    out.m_source = cache;
+}
+
+void SceneCache::FillLocalView(const SceneCache& cache, float minX, float minY, float maxX, float maxY, LocalView& out)
+{
+    out.m_built = true;
+    out.m_composite = cache.IsComposite();
+    out.m_minX = minX;
+    out.m_minY = minY;
+    out.m_maxX = maxX;
+    out.m_maxY = maxY;
+
+    if (out.m_composite)
+    {
+        // Tiles are decoded into their own views and not referenced, so a
+        // tile the streamer evicts is freed even while the view lives.
+        std::vector<SceneTileRef> tiles;
+        cache.CollectTiles(minX, minY, maxX, maxY, tiles);
+        out.m_tiles.reserve(tiles.size());
+        for (const SceneTileRef& tile : tiles)
+        {
+            LocalView::TileView tv;
+            tv.tileX = tile.tileX;
+            tv.tileY = tile.tileY;
+            tv.view = std::make_shared<LocalView>();
+            if (tile.cache)
+                FillLocalView(*tile.cache, minX, minY, maxX, maxY, *tv.view);
+            out.m_tiles.push_back(std::move(tv));
+        }
+        return;
+    }
+    out.m_srcMinX = cache.m_minX;
+    out.m_srcMinY = cache.m_minY;
+    out.m_srcCellSize = cache.m_cellSize;
+    out.m_srcCellsX = static_cast<int>(cache.m_cellsX);
+    out.m_srcCellsY = static_cast<int>(cache.m_cellsY);
+    if (cache.m_cellsX == 0 || cache.m_cellsY == 0)
+        return;
+
+    out.CellRange(minX, minY, maxX, maxY, out.m_cx0, out.m_cx1, out.m_cy0, out.m_cy1);
+    const int viewCellsX = out.m_cx1 - out.m_cx0 + 1;
+    const int viewCellsY = out.m_cy1 - out.m_cy0 + 1;
+    if (viewCellsX <= 0 || viewCellsY <= 0)
+        return;
+
+    // Every triangle listed by a covered cell becomes one slot; slots are in
+    // ascending triangle order so the 3D query can sort slots instead of ids.
+    std::vector<uint32_t> triIds;
+    for (int cy = out.m_cy0; cy <= out.m_cy1; ++cy)
+    {
+        for (int cx = out.m_cx0; cx <= out.m_cx1; ++cx)
+        {
+            const uint32_t ci = cy * cache.m_cellsX + cx;
+            const uint32_t start = cache.m_cellStart[ci];
+            const uint32_t count = cache.m_cellCount[ci];
+            triIds.insert(triIds.end(), cache.m_triIndices.begin() + start, cache.m_triIndices.begin() + start + count);
+        }
+    }
+    std::sort(triIds.begin(), triIds.end());
+    triIds.erase(std::unique(triIds.begin(), triIds.end()), triIds.end());
+
+    out.m_slots.resize(triIds.size());
+    for (size_t i = 0; i < triIds.size(); ++i)
+    {
+        const CompactTri& ct = cache.m_tris[triIds[i]];
+        const CompactVertex& a = cache.m_vertices[ct.v[0]];
+        const CompactVertex& b = cache.m_vertices[ct.v[1]];
+        const CompactVertex& c = cache.m_vertices[ct.v[2]];
+
+        LocalView::Slot& slot = out.m_slots[i];
+        slot.tri.a = { a.x, a.y, a.z };
+        slot.tri.b = { b.x, b.y, b.z };
+        slot.tri.c = { c.x, c.y, c.z };
+        slot.tri.doubleSided = false;
+        slot.tri.collisionMask = 0xFFFFFFFFu;
+        slot.lo[0] = std::min({ a.x, b.x, c.x }); slot.hi[0] = std::max({ a.x, b.x, c.x });
+        slot.lo[1] = std::min({ a.y, b.y, c.y }); slot.hi[1] = std::max({ a.y, b.y, c.y });
+        slot.lo[2] = std::min({ a.z, b.z, c.z }); slot.hi[2] = std::max({ a.z, b.z, c.z });
+        slot.metadata = cache.m_metadataTable[ct.meta];
+    }
+
+    out.m_cellStart.assign(static_cast<size_t>(viewCellsX) * viewCellsY + 1, 0);
+    size_t vi = 0;
+    for (int cy = out.m_cy0; cy <= out.m_cy1; ++cy)
+    {
+        for (int cx = out.m_cx0; cx <= out.m_cx1; ++cx, ++vi)
+        {
+            out.m_cellStart[vi] = static_cast<uint32_t>(out.m_cellSlots.size());
+            const uint32_t ci = cy * cache.m_cellsX + cx;
+            const uint32_t start = cache.m_cellStart[ci];
+            const uint32_t count = cache.m_cellCount[ci];
+            for (uint32_t j = 0; j < count; ++j)
+            {
+                const uint32_t ti = cache.m_triIndices[start + j];
+                const auto it = std::lower_bound(triIds.begin(), triIds.end(), ti);
+                out.m_cellSlots.push_back(static_cast<uint32_t>(it - triIds.begin()));
+            }
+        }
+    }
+    out.m_cellStart[vi] = static_cast<uint32_t>(out.m_cellSlots.size());
+}
+
+void SceneCache::LocalView::Clear()
+{
+    m_source.reset();
+    m_built = false;
+    m_composite = false;
+    m_srcMinX = m_srcMinY = 0;
+    m_srcCellSize = 1.0f;
+    m_srcCellsX = m_srcCellsY = 0;
+    m_minX = m_minY = m_maxX = m_maxY = 0;
+    m_cx0 = 0; m_cx1 = -1; m_cy0 = 0; m_cy1 = -1;
+    m_cellStart.clear();
+    m_cellSlots.clear();
+    m_slots.clear();
+    m_tiles.clear();
+}
+
+size_t SceneCache::LocalView::GetTriangleCount() const
+{
+    size_t total = m_slots.size();
+    for (const TileView& tile : m_tiles)
+        total += tile.view->GetTriangleCount();
+    return total;
+}
+
+void SceneCache::LocalView::CellRange(float minX, float minY, float maxX, float maxY,
+                                      int& cx0, int& cx1, int& cy0, int& cy1) const
+{
+    // Same arithmetic as SceneCache::QueryTrianglesInAABB so ranges agree
+    cx0 = std::max(0, static_cast<int>((minX - m_srcMinX) / m_srcCellSize));
+    cx1 = std::min(m_srcCellsX - 1, static_cast<int>((maxX - m_srcMinX) / m_srcCellSize));
+    cy0 = std::max(0, static_cast<int>((minY - m_srcMinY) / m_srcCellSize));
+    cy1 = std::min(m_srcCellsY - 1, static_cast<int>((maxY - m_srcMinY) / m_srcCellSize));
+}
+
+void SceneCache::LocalView::AppendSlot(uint32_t slot,
+                                       std::vector<CapsuleCollision::Triangle>& outTris,
+                                       std::vector<uint32_t>* outInstanceIds,
+                                       std::vector<uint32_t>* outSourceTypes,
+                                       std::vector<SceneTriMetadata>* outMetadata) const
+{
+    const Slot& s = m_slots[slot];
+    outTris.push_back(s.tri);
+    if (outInstanceIds) outInstanceIds->push_back(s.metadata.instanceId);
+    if (outSourceTypes) outSourceTypes->push_back(s.metadata.sourceType);
+    if (outMetadata) outMetadata->push_back(s.metadata);
+}
+
+void SceneCache::LocalView::CollectTiles(float minX, float minY, float maxX, float maxY, std::vector<TileView>& out) const
+{
+    // The tiles SceneCache::CollectTiles would return for this box: the
+    // view's tiles are that list for a larger box, in the same order.
+    const int txLo = SceneTileStreamer::WorldToTileX(maxX);
+    const int txHi = SceneTileStreamer::WorldToTileX(minX);
+    const int tyLo = SceneTileStreamer::WorldToTileY(maxY);
+    const int tyHi = SceneTileStreamer::WorldToTileY(minY);
+    for (const TileView& tile : m_tiles)
+    {
+        if (tile.tileX >= txLo && tile.tileX <= txHi && tile.tileY >= tyLo && tile.tileY <= tyHi)
+            out.push_back(tile);
+    }
+}
+
+void SceneCache::LocalView::QueryTrianglesInAABB(float minX, float minY, float maxX, float maxY,
+                                                 std::vector<CapsuleCollision::Triangle>& outTris,
+                                                 std::vector<uint32_t>* outInstanceIds,
+                                                 std::vector<uint32_t>* outSourceTypes,
+                                                 std::vector<SceneTriMetadata>* outMetadata) const
+{
+    outTris.clear();
+    if (outInstanceIds) outInstanceIds->clear();
+    if (outSourceTypes) outSourceTypes->clear();
+    if (outMetadata) outMetadata->clear();
+    if (!m_built)
+        return;
+    if (m_composite)
+    {
+        std::vector<TileView> tiles;
+        CollectTiles(minX, minY, maxX, maxY, tiles);
+        GatherTileTriangles(tiles, minX, minY, maxX, maxY, outTris, outInstanceIds, outSourceTypes, outMetadata,
+            [&](const TileView& tile, auto& tris, auto* ids, auto* types, auto* meta)
+            { tile.view->QueryTrianglesInAABB(minX, minY, maxX, maxY, tris, ids, types, meta); });
+        return;
+    }
+    if (m_slots.empty())
+        return;
+
+    int cx0, cx1, cy0, cy1;
+    CellRange(minX, minY, maxX, maxY, cx0, cx1, cy0, cy1);
+    cx0 = std::max(cx0, m_cx0); cx1 = std::min(cx1, m_cx1);
+    cy0 = std::max(cy0, m_cy0); cy1 = std::min(cy1, m_cy1);
+
+    // Cell-major, first occurrence wins -- the source query's order
+    const int viewCellsX = m_cx1 - m_cx0 + 1;
+    std::vector<uint8_t> seen(m_slots.size(), 0);
+    for (int cy = cy0; cy <= cy1; ++cy)
+    {
+        for (int cx = cx0; cx <= cx1; ++cx)
+        {
+            const size_t vi = static_cast<size_t>(cy - m_cy0) * viewCellsX + (cx - m_cx0);
+            for (uint32_t j = m_cellStart[vi]; j < m_cellStart[vi + 1]; ++j)
+            {
+                const uint32_t slot = m_cellSlots[j];
+                if (seen[slot])
+                    continue;
+                seen[slot] = 1;
+                AppendSlot(slot, outTris, outInstanceIds, outSourceTypes, outMetadata);
+            }
+        }
+    }
+}
+
+void SceneCache::LocalView::QueryTrianglesInAABB3D(float minX, float minY, float minZ,
+                                                   float maxX, float maxY, float maxZ,
+                                                   std::vector<CapsuleCollision::Triangle>& outTris,
+                                                   std::vector<uint32_t>* outInstanceIds,
+                                                   std::vector<uint32_t>* outSourceTypes,
+                                                   std::vector<SceneTriMetadata>* outMetadata) const
+{
+    outTris.clear();
+    if (outInstanceIds) outInstanceIds->clear();
+    if (outSourceTypes) outSourceTypes->clear();
+    if (outMetadata) outMetadata->clear();
+    if (!m_built)
+        return;
+    if (m_composite)
+    {
+        std::vector<TileView> tiles;
+        CollectTiles(minX, minY, maxX, maxY, tiles);
+        GatherTileTriangles(tiles, minX, minY, maxX, maxY, outTris, outInstanceIds, outSourceTypes, outMetadata,
+            [&](const TileView& tile, auto& tris, auto* ids, auto* types, auto* meta)
+            { tile.view->QueryTrianglesInAABB3D(minX, minY, minZ, maxX, maxY, maxZ, tris, ids, types, meta); });
+        return;
+    }
+    if (m_slots.empty())
+        return;
+
+    int cx0, cx1, cy0, cy1;
+    CellRange(minX, minY, maxX, maxY, cx0, cx1, cy0, cy1);
+    cx0 = std::max(cx0, m_cx0); cx1 = std::min(cx1, m_cx1);
+    cy0 = std::max(cy0, m_cy0); cy1 = std::min(cy1, m_cy1);
+
+    // The source skips cells' out-of-range height layers, but any triangle
+    // whose AABB overlaps the box is listed by a covered cell, so filtering
+    // the covered cells yields the same set. Slots are in triangle order.
+    const int viewCellsX = m_cx1 - m_cx0 + 1;
+    std::vector<uint32_t> hits;
+    for (int cy = cy0; cy <= cy1; ++cy)
+    {
+        for (int cx = cx0; cx <= cx1; ++cx)
+        {
+            const size_t vi = static_cast<size_t>(cy - m_cy0) * viewCellsX + (cx - m_cx0);
+            for (uint32_t j = m_cellStart[vi]; j < m_cellStart[vi + 1]; ++j)
+            {
+                const uint32_t slot = m_cellSlots[j];
+                const Slot& s = m_slots[slot];
+                if (s.hi[0] < minX || s.lo[0] > maxX ||
+                    s.hi[1] < minY || s.lo[1] > maxY ||
+                    s.hi[2] < minZ || s.lo[2] > maxZ)
+                    continue;
+                hits.push_back(slot);
+            }
+        }
+    }
+    std::sort(hits.begin(), hits.end());
+    hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+
+    outTris.reserve(hits.size());
+    for (uint32_t slot : hits)
+        AppendSlot(slot, outTris, outInstanceIds, outSourceTypes, outMetadata);
+}
+
 float SceneCache::GetGroundZ(float x, float y, float z, float maxSearchDist) const
 {
-    // Find the cell at (x,y) and check all triangles for vertical ray intersection
-    if (m_cellsX == 0 || m_cellsY == 0)
+    if (IsComposite())
+    {
+        auto tile = GetTileAt(x, y);
+        return tile ? tile->GetGroundZ(x, y, z, maxSearchDist) : -200000.0f;
+    }
+
+    // Find the cell at (x,y) and walk its height layers top-down
+    if (m_cellsX == 0 || m_cellsY == 0 || m_layerCellStart.empty())
         return -200000.0f;
 
     int cx = static_cast<int>((x - m_minX) / m_cellSize);
@@ -912,7 +2160,6 @@ float SceneCache::GetGroundZ(float x, float y, float z, float maxSearchDist) con
 
     uint32_t ci = cy * m_cellsX + cx;
     uint32_t start = m_cellStart[ci];
-    uint32_t count = m_cellCount[ci];
 
     // Pick the surface CLOSEST to the query Z (absolute distance). This is
     // order-independent and matches the test/probe use case: "which surface
@@ -926,53 +2173,52 @@ float SceneCache::GetGroundZ(float x, float y, float z, float maxSearchDist) con
     // was iterated FIRST, the else-if branch (gated on bestZ uninit) stored
     // it; subsequent below-z triangles could not override because the
     // strict-greater check failed. Result was order-dependent.
+    //
+    // Layers are sorted by zHi descending, so once a layer's top is below
+    // the window (or cannot beat the current error) nothing after it can.
+    // Exact ties go to the lowest triangle index, as the ascending scan did.
     float bestZ = -200000.0f;
     float bestErr = std::numeric_limits<float>::max();
+    uint32_t bestTri = std::numeric_limits<uint32_t>::max();
     float zMax = z + maxSearchDist; // symmetric search: accept ground above too
     float zMin = z - maxSearchDist; // search below
 
-    for (uint32_t j = 0; j < count; ++j)
+    const auto consider = [&](uint32_t ti)
     {
-        const SceneTri& st = m_triangles[m_triIndices[start + j]];
-
-        // Quick AABB check: does triangle contain (x,y) in XY?
-        float txMin = std::min({st.ax, st.bx, st.cx});
-        float txMax = std::max({st.ax, st.bx, st.cx});
-        float tyMin = std::min({st.ay, st.by, st.cy});
-        float tyMax = std::max({st.ay, st.by, st.cy});
-        if (x < txMin || x > txMax || y < tyMin || y > tyMax)
-            continue;
-
-        // Barycentric test: is (x,y) inside triangle in XY projection?
-        float v0x = st.cx - st.ax, v0y = st.cy - st.ay;
-        float v1x = st.bx - st.ax, v1y = st.by - st.ay;
-        float v2x = x - st.ax, v2y = y - st.ay;
-
-        float d00 = v0x * v0x + v0y * v0y;
-        float d01 = v0x * v1x + v0y * v1y;
-        float d02 = v0x * v2x + v0y * v2y;
-        float d11 = v1x * v1x + v1y * v1y;
-        float d12 = v1x * v2x + v1y * v2y;
-
-        float denom = d00 * d11 - d01 * d01;
-        if (std::fabs(denom) < 1e-12f) continue;
-
-        float invDenom = 1.0f / denom;
-        float u = (d11 * d02 - d01 * d12) * invDenom;
-        float v = (d00 * d12 - d01 * d02) * invDenom;
-
-        if (u < -1e-6f || v < -1e-6f || (u + v) > 1.0f + 1e-6f)
-            continue;
-
-        // Interpolate Z
-        float triZ = st.az + u * (st.cz - st.az) + v * (st.bz - st.az);
-
-        if (triZ < zMin || triZ > zMax) continue;
+        float triZ;
+        if (!SampleTriangleZ(GetTri(ti), x, y, triZ))
+            return;
+        if (triZ < zMin || triZ > zMax)
+            return;
         float err = std::fabs(triZ - z);
-        if (err < bestErr) {
+        if (err < bestErr || (err == bestErr && ti < bestTri)) {
             bestErr = err;
             bestZ = triZ;
+            bestTri = ti;
         }
+    };
+
+    const uint32_t layerBegin = m_layerCellStart[ci];
+    const uint32_t layerEnd = m_layerCellStart[ci + 1];
+    if (layerBegin == layerEnd)
+    {
+        // Unlayered (oversized) cell
+        for (uint32_t j = 0; j < m_cellCount[ci]; ++j)
+            consider(m_triIndices[start + j]);
+        return bestZ;
+    }
+
+    for (uint32_t li = layerBegin; li < layerEnd; ++li)
+    {
+        const HeightLayer& L = m_heightLayers[li];
+        const float layerTop = L.zHi * LAYER_Z_STEP;
+        if (layerTop < zMin || layerTop < z - bestErr)
+            break;
+        if (L.zLo * LAYER_Z_STEP > zMax)
+            continue;
+
+        for (uint32_t r = L.firstRef; r < L.firstRef + L.refCount; ++r)
+            consider(m_triIndices[start + m_layerRefs[r]]);
     }
 
     return bestZ;
@@ -981,12 +2227,18 @@ float SceneCache::GetGroundZ(float x, float y, float z, float maxSearchDist) con
 float SceneCache::GetWalkableGroundZ(float x, float y, float z, float maxSearchDist,
                                      float walkableMinNormalZ) const
 {
-    // Walkable-only variant of GetGroundZ. Mirrors that function's barycentric
-    // point-in-triangle scan but rejects candidates whose computed plane normal
-    // is steeper than walkableMinNormalZ (|n.z| < threshold). Used by BG
-    // post-teleport ground probes to avoid snapping to cliff-edge / WMO-doodad
-    // geometry that real WoW's CMovement_AdjustPositionToGround correctly rejects.
-    if (m_cellsX == 0 || m_cellsY == 0)
+    // Walkable-only variant of GetGroundZ. Uses the same height layers but
+    // rejects candidates whose plane normal is steeper than walkableMinNormalZ
+    // (|n.z| < threshold). Used by BG post-teleport ground probes to avoid
+    // snapping to cliff-edge / WMO-doodad geometry that real WoW's
+    // CMovement_AdjustPositionToGround correctly rejects.
+    if (IsComposite())
+    {
+        auto tile = GetTileAt(x, y);
+        return tile ? tile->GetWalkableGroundZ(x, y, z, maxSearchDist, walkableMinNormalZ) : -200000.0f;
+    }
+
+    if (m_cellsX == 0 || m_cellsY == 0 || m_layerCellStart.empty())
         return -200000.0f;
 
     int cx = static_cast<int>((x - m_minX) / m_cellSize);
@@ -997,7 +2249,6 @@ float SceneCache::GetWalkableGroundZ(float x, float y, float z, float maxSearchD
 
     uint32_t ci = cy * m_cellsX + cx;
     uint32_t start = m_cellStart[ci];
-    uint32_t count = m_cellCount[ci];
 
     // NOTE: this function intentionally keeps the legacy "first-wins" behavior
     // on the closest-above fallback (see OgZeppelinCliffFallParityTests). The
@@ -1007,83 +2258,80 @@ float SceneCache::GetWalkableGroundZ(float x, float y, float z, float maxSearchD
     // semantic here regresses those parity tests even though the change is
     // mechanically the same as the GetGroundZ fix above. Track that as a
     // separate FG/BG physics parity workstream.
-    float bestZ = -200000.0f;
-    float bestErr = std::numeric_limits<float>::max();
+    //
+    // The legacy scan ran in ascending triangle order: if the first in-window
+    // walkable candidate was above z it won outright, otherwise the highest
+    // candidate at or below z won. Layers are Z-sorted, so reproduce that by
+    // tracking the lowest-index candidate alongside the best below-z height.
+    float bestBelowZ = -200000.0f;
+    float firstZ = -200000.0f;
+    uint32_t firstTri = std::numeric_limits<uint32_t>::max();
     float zMax = z + maxSearchDist;
     float zMin = z - maxSearchDist;
 
-    for (uint32_t j = 0; j < count; ++j)
+    const auto consider = [&](uint32_t ti)
     {
-        const SceneTri& st = m_triangles[m_triIndices[start + j]];
-
-        // Quick AABB check
-        float txMin = std::min({st.ax, st.bx, st.cx});
-        float txMax = std::max({st.ax, st.bx, st.cx});
-        float tyMin = std::min({st.ay, st.by, st.cy});
-        float tyMax = std::max({st.ay, st.by, st.cy});
-        if (x < txMin || x > txMax || y < tyMin || y > tyMax)
-            continue;
-
-        // Barycentric XY test (same convention as GetGroundZ)
-        float v0x = st.cx - st.ax, v0y = st.cy - st.ay;
-        float v1x = st.bx - st.ax, v1y = st.by - st.ay;
-        float v2x = x - st.ax, v2y = y - st.ay;
-
-        float d00 = v0x * v0x + v0y * v0y;
-        float d01 = v0x * v1x + v0y * v1y;
-        float d02 = v0x * v2x + v0y * v2y;
-        float d11 = v1x * v1x + v1y * v1y;
-        float d12 = v1x * v2x + v1y * v2y;
-
-        float denom = d00 * d11 - d01 * d01;
-        if (std::fabs(denom) < 1e-12f) continue;
+        const SceneTri st = GetTri(ti);
+        float triZ;
+        if (!SampleTriangleZ(st, x, y, triZ))
+            return;
+
+        // Walkable filter on |n.z|. Triangles with very small XY footprint
+        // degenerate to |n.z| ~ 0 and are correctly rejected. Absolute value
+        // matches the convention used throughout PhysicsGroundSnap.cpp
+        // (overlap normals can point downward when the capsule center is
+        // above the contact).
+        float normalZ;
+        if (!TriangleNormalZ(st, normalZ) || normalZ < walkableMinNormalZ)
+            return;
+
+        if (triZ < zMin || triZ > zMax)
+            return;
+        if (triZ <= z && triZ > bestBelowZ)
+            bestBelowZ = triZ;
+        if (ti < firstTri) {
+            firstTri = ti;
+            firstZ = triZ;
+        }
+    };
 
-        float invDenom = 1.0f / denom;
-        float u = (d11 * d02 - d01 * d12) * invDenom;
-        float v = (d00 * d12 - d01 * d02) * invDenom;
+    const uint32_t layerBegin = m_layerCellStart[ci];
+    const uint32_t layerEnd = m_layerCellStart[ci + 1];
+    if (layerBegin == layerEnd)
+    {
+        for (uint32_t j = 0; j < m_cellCount[ci]; ++j)
+            consider(m_triIndices[start + j]);
+    }
 
-        if (u < -1e-6f || v < -1e-6f || (u + v) > 1.0f + 1e-6f)
+    // Layers record their flattest triangle's |n.z|, so a layer of walls
+    // and steep slopes is skipped whole
+    const double minNormalQ = static_cast<double>(walkableMinNormalZ) * 255.0;
+    for (uint32_t li = layerBegin; li < layerEnd; ++li)
+    {
+        const HeightLayer& L = m_heightLayers[li];
+        if (L.zHi * LAYER_Z_STEP < zMin)
+            break;
+        if (L.zLo * LAYER_Z_STEP > zMax || L.maxNormalZ < minNormalQ)
             continue;
 
-        // Walkable filter: compute triangle normal via cross product (e1 x e2)
-        // and reject when |n.z| < walkableMinNormalZ. Triangles with very small
-        // XY footprint will degenerate to |n.z| ≈ 0 here and are correctly
-        // rejected. Absolute value matches the convention used throughout
-        // PhysicsGroundSnap.cpp (overlap normals can point downward when the
-        // capsule center is above the contact).
-        float e1x = st.bx - st.ax, e1y = st.by - st.ay, e1z = st.bz - st.az;
-        float e2x = st.cx - st.ax, e2y = st.cy - st.ay, e2z = st.cz - st.az;
-        float nx = e1y * e2z - e1z * e2y;
-        float ny = e1z * e2x - e1x * e2z;
-        float nz = e1x * e2y - e1y * e2x;
-        float nLen = std::sqrt(nx * nx + ny * ny + nz * nz);
-        if (nLen < 1e-12f) continue;
-        float nzNorm = std::fabs(nz / nLen);
-        if (nzNorm < walkableMinNormalZ) continue;
-
-        // Interpolate Z
-        float triZ = st.az + u * (st.cz - st.az) + v * (st.bz - st.az);
-
-        if (triZ >= zMin && triZ <= z) {
-            if (triZ > bestZ) {
-                bestZ = triZ;
-                bestErr = z - triZ;
-            }
-        } else if (triZ > z && triZ <= zMax && bestZ <= -200000.0f + 1.0f) {
-            float err = triZ - z;
-            if (err < bestErr) {
-                bestZ = triZ;
-                bestErr = err;
-            }
-        }
+        for (uint32_t r = L.firstRef; r < L.firstRef + L.refCount; ++r)
+            consider(m_triIndices[start + m_layerRefs[r]]);
     }
 
-    return bestZ;
+    if (firstTri != std::numeric_limits<uint32_t>::max() && firstZ > z)
+        return firstZ;
+    return bestBelowZ;
 }
 
 LiquidCell SceneCache::GetLiquidAt(float x, float y) const
 {
     LiquidCell empty{};
+    if (IsComposite())
+    {
+        auto tile = GetTileAt(x, y);
+        return tile ? tile->GetLiquidAt(x, y) : empty;
+    }
+
     if (m_liquidGrid.empty() || m_liquidCellsX == 0 || m_liquidCellsY == 0)
         return empty;
 
@@ -1096,3 +2344,186 @@ LiquidCell SceneCache::GetLiquidAt(float x, float y) const
 
     return m_liquidGrid[cy * m_liquidCellsX + cx];
 }
+
+// ============================================================================
+// TILE STREAMING
+// ============================================================================
+
+SceneCache* SceneCache::CreateStreamed(uint32_t mapId, std::shared_ptr<SceneTileStreamer> streamer)
+{
+    if (!streamer)
+        return nullptr;
+
+    auto* cache = new SceneCache();
+    cache->mapId = mapId;
+    cache->m_streamer = std::move(streamer);
+    return cache;
+}
+
+SceneCache* SceneCache::CreateFromInjectedTiles(uint32_t mapId, InjectedTileMap tiles)
+{
+    auto* cache = new SceneCache();
+    cache->mapId = mapId;
+    cache->m_injectedTiles = std::move(tiles);
+    cache->m_hasInjectedTiles = true;
+    return cache;
+}
+
+void SceneCache::CollectTiles(float minX, float minY, float maxX, float maxY, std::vector<SceneTileRef>& out) const
+{
+    if (m_streamer)
+    {
+        m_streamer->AcquireTiles(minX, minY, maxX, maxY, out);
+        return;
+    }
+
+    const int txLo = SceneTileStreamer::WorldToTileX(maxX);
+    const int txHi = SceneTileStreamer::WorldToTileX(minX);
+    const int tyLo = SceneTileStreamer::WorldToTileY(maxY);
+    const int tyHi = SceneTileStreamer::WorldToTileY(minY);
+    for (const auto& [key, tile] : m_injectedTiles)
+    {
+        const int tx = static_cast<int>(key >> 16);
+        const int ty = static_cast<int>(key & 0xFFFF);
+        if (tx >= txLo && tx <= txHi && ty >= tyLo && ty <= tyHi)
+            out.push_back({ tx, ty, tile });
+    }
+}
+
+std::shared_ptr<const SceneCache> SceneCache::GetTileAt(float x, float y) const
+{
+    if (m_streamer)
+        return m_streamer->AcquireTileAt(x, y);
+
+    const int tx = SceneTileStreamer::WorldToTileX(x);
+    const int ty = SceneTileStreamer::WorldToTileY(y);
+    if (tx < 0 || ty < 0)
+        return nullptr;
+    auto it = m_injectedTiles.find(SceneTileStreamer::MakeKey(tx, ty));
+    return it != m_injectedTiles.end() ? it->second : nullptr;
+}
+
+void SceneCache::GetLoadedTiles(std::vector<SceneTileRef>& out) const
+{
+    if (m_streamer)
+    {
+        m_streamer->GetResidentTiles(out);
+        return;
+    }
+
+    for (const auto& [key, tile] : m_injectedTiles)
+        out.push_back({ static_cast<int>(key >> 16), static_cast<int>(key & 0xFFFF), tile });
+}
+
+size_t SceneCache::GetMemoryUsage() const
+{
+    if (m_streamer)
+        return m_streamer->GetResidentBytes();
+    if (m_hasInjectedTiles)
+    {
+        size_t total = 0;
+        for (const auto& [key, tile] : m_injectedTiles)
+            total += tile->GetMemoryUsage();
+        return total;
+    }
+    if (m_mapping)
+        return m_mapping->Size();
+
+    return SceneArrayBytes(m_vertices) + SceneArrayBytes(m_tris) + SceneArrayBytes(m_metadataTable) +
+           SceneArrayBytes(m_cellStart) + SceneArrayBytes(m_cellCount) + SceneArrayBytes(m_triIndices) +
+           SceneArrayBytes(m_heightLayers) + SceneArrayBytes(m_layerCellStart) + SceneArrayBytes(m_layerRefs) +
+           SceneArrayBytes(m_liquidGrid);
+}
+
+bool SceneCache::HasLiquidData() const
+{
+    // Tiles carry their own liquid grids; GetLiquidAt returns an empty cell
+    // where the tile has none.
+    if (m_streamer)
+        return true;
+    if (m_hasInjectedTiles)
+    {
+        for (const auto& [key, tile] : m_injectedTiles)
+            if (tile->HasLiquidData())
+                return true;
+        return false;
+    }
+    return !m_liquidGrid.empty();
+}
+
+size_t SceneCache::GetTriangleCount() const
+{
+    if (!IsComposite())
+        return m_tris.size();
+
+    std::vector<SceneTileRef> tiles;
+    GetLoadedTiles(tiles);
+    size_t total = 0;
+    for (const SceneTileRef& tile : tiles)
+        total += tile.cache->GetTriangleCount();
+    return total;
+}
+
+size_t SceneCache::GetCellCount() const
+{
+    if (!IsComposite())
+        return static_cast<size_t>(m_cellsX) * m_cellsY;
+
+    std::vector<SceneTileRef> tiles;
+    GetLoadedTiles(tiles);
+    size_t total = 0;
+    for (const SceneTileRef& tile : tiles)
+        total += tile.cache->GetCellCount();
+    return total;
+}
+
+bool SceneCache::HasTriangleMetadata() const
+{
+    if (!IsComposite())
+        return m_hasTriangleMetadata;
+
+    std::vector<SceneTileRef> tiles;
+    GetLoadedTiles(tiles);
+    for (const SceneTileRef& tile : tiles)
+    {
+        if (tile.cache->GetTriangleCount() > 0 && !tile.cache->HasTriangleMetadata())
+            return false;
+    }
+    return true;
+}
+
+SceneCache::ExtractBounds SceneCache::GetExtractBounds() const
+{
+    ExtractBounds bounds;
+    if (m_streamer)
+    {
+        // Every tile is reachable on demand, so the cache covers the whole map
+        const float half = 32.0f * SceneTileStreamer::TILE_SIZE;
+        bounds.minX = -half;
+        bounds.minY = -half;
+        bounds.maxX = half;
+        bounds.maxY = half;
+        return bounds;
+    }
+    if (m_hasInjectedTiles)
+    {
+        // Union of the injected regions, like the old merged injection
+        bool first = true;
+        for (const auto& [key, tile] : m_injectedTiles)
+        {
+            const ExtractBounds tb = tile->GetExtractBounds();
+            bounds.minX = first ? tb.minX : std::min(bounds.minX, tb.minX);
+            bounds.minY = first ? tb.minY : std::min(bounds.minY, tb.minY);
+            bounds.maxX = first ? tb.maxX : std::max(bounds.maxX, tb.maxX);
+            bounds.maxY = first ? tb.maxY : std::max(bounds.maxY, tb.maxY);
+            first = false;
+        }
+        return bounds;
+    }
+
+    bounds.minX = m_minX;
+    bounds.minY = m_minY;
+    bounds.maxX = m_maxX;
+    bounds.maxY = m_maxY;
+    return bounds;
+}
@@ -7,11 +7,18 @@
 #include <vector>
 #include <cstdint>
 #include <string>
+#include <memory>
+#include <map>
+#include <cstdio>
 #include "CapsuleCollision.h"
+#include "SceneArray.h"
 
 // Forward declarations
 namespace VMAP { class VMapManager2; }
 class MapLoader;
+class MappedFile;
+class SceneTileStreamer;
+struct SceneTileRef;
 
 // Triangle stored in SceneCache (world-space, pre-transformed)
 struct SceneTri
@@ -58,9 +65,43 @@ public:
     // Save to binary .scene file
     bool SaveToFile(const char* path) const;
 
-    // Load from binary .scene file (returns nullptr on failure)
+    // Load from binary .scene file (returns nullptr on failure).
+    // Version 3 files are memory-mapped and queried in place; versions 1-2
+    // are read into owned compact arrays and their derived indices rebuilt.
     static SceneCache* LoadFromFile(const char* path);
 
+    // True when the cache serves queries straight from a mapped v3 file
+    bool IsMapped() const { return m_mapping != nullptr; }
+
+    // Rewrite every older .scene in scenesDir, and every .scenetile in its
+    // tiles/ subdirectory, in the current mappable format (offline, after
+    // scene data changes; the runtime never rewrites them). Returns the
+    // number of files rewritten, or -1 when the directory does not exist.
+    static int ConvertDirectory(const char* scenesDir);
+
+    // --- Tile streaming ---
+
+    // Create a cache that holds no geometry itself and answers every query
+    // from the per-tile caches of streamer (loaded on demand, evicted under
+    // the streamer's memory budget). Such a cache cannot be saved.
+    static SceneCache* CreateStreamed(uint32_t mapId, std::shared_ptr<SceneTileStreamer> streamer);
+
+    bool IsStreamed() const { return m_streamer != nullptr; }
+    SceneTileStreamer* GetStreamer() const { return m_streamer.get(); }
+
+    // Composite over tiles injected one at a time (SceneDataService regions),
+    // keyed by SceneTileStreamer::MakeKey. A composite is never modified:
+    // adding or dropping a tile builds a new one that shares the untouched
+    // tiles, so the map's cache can be swapped without re-indexing them.
+    using InjectedTileMap = std::map<uint32_t, std::shared_ptr<const SceneCache>>;
+    static SceneCache* CreateFromInjectedTiles(uint32_t mapId, InjectedTileMap tiles);
+    bool HasInjectedTiles() const { return m_hasInjectedTiles; }
+    const InjectedTileMap& GetInjectedTiles() const { return m_injectedTiles; }
+
+    // Bytes of geometry and indices held by this cache (mapped file size for
+    // v3 loads). Streamed caches report their resident tiles.
+    size_t GetMemoryUsage() const;
+
     // --- Extraction from live VMAP + ADT data ---
 
     // Extract collision geometry for a map.
@@ -91,8 +132,107 @@ public:
                               std::vector<uint32_t>* outSourceTypes = nullptr,
                               std::vector<SceneTriMetadata>* outMetadata = nullptr) const;
 
-    // Ground Z query via barycentric point-in-triangle on cached geometry.
-    // Returns highest Z at (x,y) that is at or below z, within maxSearchDist.
+    // Z-aware variant of QueryTrianglesInAABB: returns triangles whose 3D AABB
+    // overlaps the query box, in ascending triangle order. Each cell visits
+    // only the height layers that reach into [minZ, maxZ], so a sweep on one
+    // floor does not test every floor above and below it. The layers are the
+    // only Z index: a surface-area BVH per stacked region ran within a few
+    // percent of this walk at every box size, so it does not earn a place
+    // in the .scene file.
+    void QueryTrianglesInAABB3D(float minX, float minY, float minZ,
+                                float maxX, float maxY, float maxZ,
+                                std::vector<CapsuleCollision::Triangle>& outTris,
+                                std::vector<uint32_t>* outInstanceIds = nullptr,
+                                std::vector<uint32_t>* outSourceTypes = nullptr,
+                                std::vector<SceneTriMetadata>* outMetadata = nullptr) const;
+
+    // Snapshot of the grid cells (or, for composites, the tiles) around an XY
+    // box. For any query box inside it the view answers both AABB queries
+    // exactly as the cache would -- same triangles, same order -- from
+    // triangles decoded once at build time, without the grid walk, tile
+    // lookup or locking. SceneContactCache keeps one per bot so consecutive
+    // frames reuse it. The view copies what it answers from and only holds a
+    // weak reference to its cache, so bot views never keep a replaced cache
+    // or streamed tiles past the streamer's budget alive; callers rebuild the
+    // view when IsViewOf fails for the map's current cache.
+    class LocalView
+    {
+    public:
+        bool IsBuilt() const { return m_built; }
+        bool IsViewOf(const std::shared_ptr<const SceneCache>& cache) const
+        {
+            return m_built && !m_source.owner_before(cache) && !cache.owner_before(m_source);
+        }
+        bool Covers(float minX, float minY, float maxX, float maxY) const
+        {
+            return m_built && minX >= m_minX && minY >= m_minY && maxX <= m_maxX && maxY <= m_maxY;
+        }
+        size_t GetTriangleCount() const;
+        void Clear();
+
+        // Same contracts as SceneCache's; the box must be Covers()-ed.
+        void QueryTrianglesInAABB(float minX, float minY, float maxX, float maxY,
+                                  std::vector<CapsuleCollision::Triangle>& outTris,
+                                  std::vector<uint32_t>* outInstanceIds = nullptr,
+                                  std::vector<uint32_t>* outSourceTypes = nullptr,
+                                  std::vector<SceneTriMetadata>* outMetadata = nullptr) const;
+        void QueryTrianglesInAABB3D(float minX, float minY, float minZ,
+                                    float maxX, float maxY, float maxZ,
+                                    std::vector<CapsuleCollision::Triangle>& outTris,
+                                    std::vector<uint32_t>* outInstanceIds = nullptr,
+                                    std::vector<uint32_t>* outSourceTypes = nullptr,
+                                    std::vector<SceneTriMetadata>* outMetadata = nullptr) const;
+
+    private:
+        friend class SceneCache;
+
+        struct Slot
+        {
+            CapsuleCollision::Triangle tri;
+            float lo[3], hi[3];          // triangle AABB
+            SceneTriMetadata metadata;
+        };
+
+        struct TileView
+        {
+            int tileX = 0;
+            int tileY = 0;
+            std::shared_ptr<LocalView> view;
+        };
+
+        std::weak_ptr<const SceneCache> m_source; // top-level view only
+        bool m_built = false;
+        bool m_composite = false;
+        float m_minX = 0, m_minY = 0, m_maxX = 0, m_maxY = 0;
+
+        // Single cache: the source grid's geometry, and its cells in
+        // [m_cx0, m_cx1] x [m_cy0, m_cy1]
+        float m_srcMinX = 0, m_srcMinY = 0, m_srcCellSize = 1.0f;
+        int m_srcCellsX = 0, m_srcCellsY = 0;
+        int m_cx0 = 0, m_cx1 = -1, m_cy0 = 0, m_cy1 = -1;
+        std::vector<uint32_t> m_cellStart;   // per view cell + 1 sentinel: offset into m_cellSlots
+        std::vector<uint32_t> m_cellSlots;   // slot indices in the source cell's order
+        std::vector<Slot> m_slots;           // ascending source triangle index
+
+        // Composite: one view per tile, in the source's tile order
+        std::vector<TileView> m_tiles;
+
+        // Source cell range for a query box (clamped like the source query)
+        void CellRange(float minX, float minY, float maxX, float maxY, int& cx0, int& cx1, int& cy0, int& cy1) const;
+        void AppendSlot(uint32_t slot,
+                        std::vector<CapsuleCollision::Triangle>& outTris,
+                        std::vector<uint32_t>* outInstanceIds,
+                        std::vector<uint32_t>* outSourceTypes,
+                        std::vector<SceneTriMetadata>* outMetadata) const;
+        void CollectTiles(float minX, float minY, float maxX, float maxY, std::vector<TileView>& out) const;
+    };
+
+    // Build a view of cache over the XY box (replacing out's contents)
+    static void BuildLocalView(const std::shared_ptr<const SceneCache>& cache,
+                               float minX, float minY, float maxX, float maxY, LocalView& out);
+
+    // Ground Z query via the per-cell height layers.
+    // Returns the surface Z at (x,y) closest to z, within maxSearchDist.
     float GetGroundZ(float x, float y, float z, float maxSearchDist) const;
 
     // Walkable-only variant of GetGroundZ. Filters candidate triangles by
@@ -106,7 +246,7 @@ public:
 
     // Liquid level at (x,y) from pre-sampled grid.
     LiquidCell GetLiquidAt(float x, float y) const;
-    bool HasLiquidData() const { return !m_liquidGrid.empty(); }
+    bool HasLiquidData() const;
 
     // Inject triangles from an external source (SceneDataService).
     // Builds the spatial grid from the injected triangle data.
@@ -122,43 +262,135 @@ public:
     void InjectTriangles(float minX, float minY, float maxX, float maxY,
                          const InjectedTriangle* triangles, int count);
 
-    // Diagnostics
-    size_t GetTriangleCount() const { return m_triangles.size(); }
-    size_t GetCellCount() const { return m_cellsX * m_cellsY; }
-    bool HasTriangleMetadata() const { return m_triangleMetadata.size() == m_triangles.size() && !m_triangleMetadata.empty(); }
-    ExtractBounds GetExtractBounds() const
-    {
-        ExtractBounds bounds;
-        bounds.minX = m_minX;
-        bounds.minY = m_minY;
-        bounds.maxX = m_maxX;
-        bounds.maxY = m_maxY;
-        return bounds;
-    }
+    // Diagnostics (streamed caches sum over resident tiles)
+    size_t GetTriangleCount() const;
+    size_t GetCellCount() const;
+    bool HasTriangleMetadata() const;
+    ExtractBounds GetExtractBounds() const;
 
 private:
-    // Collision geometry (world-space)
-    std::vector<SceneTri> m_triangles;
-    std::vector<SceneTriMetadata> m_triangleMetadata;
+    // BuildLocalView without the source reference (tile views have none).
+    static void FillLocalView(const SceneCache& cache, float minX, float minY, float maxX, float maxY, LocalView& out);
+
+    // Collision geometry (world-space), stored compactly: vertices shared
+    // between triangles are kept once (deduplicated on exact float bits, so
+    // decoding is lossless) and the metadata that repeats for every triangle
+    // of an instance / WMO group lives once in a table the triangle indexes.
+    struct CompactVertex
+    {
+        float x, y, z;
+    };
+    static_assert(sizeof(CompactVertex) == 12, "CompactVertex must stay 12 bytes");
+
+    struct CompactTri
+    {
+        uint32_t v[3];   // indices into m_vertices (a, b, c)
+        uint32_t meta;   // index into m_metadataTable
+    };
+    static_assert(sizeof(CompactTri) == 16, "CompactTri must stay 16 bytes");
+
+    SceneArray<CompactVertex> m_vertices;
+    SceneArray<CompactTri> m_tris;
+    SceneArray<SceneTriMetadata> m_metadataTable;
+    bool m_hasTriangleMetadata = false;   // false when built from metadata-less (v1) triangles
+
+    // Replace the geometry with tris. metadata is parallel to tris; when the
+    // sizes differ it is ignored and entries are synthesized from the
+    // triangles' sourceType/instanceId.
+    void SetTriangles(const std::vector<SceneTri>& tris, const std::vector<SceneTriMetadata>& metadata);
+
+    // Decode triangle ti
+    SceneTri GetTri(uint32_t ti) const
+    {
+        const CompactTri& ct = m_tris[ti];
+        const CompactVertex& a = m_vertices[ct.v[0]];
+        const CompactVertex& b = m_vertices[ct.v[1]];
+        const CompactVertex& c = m_vertices[ct.v[2]];
+        const SceneTriMetadata& meta = m_metadataTable[ct.meta];
+        return SceneTri{ a.x, a.y, a.z, b.x, b.y, b.z, c.x, c.y, c.z, meta.sourceType, meta.instanceId };
+    }
 
     // 2D uniform grid spatial index
     float m_cellSize = 4.0f;
     float m_minX = 0, m_minY = 0, m_maxX = 0, m_maxY = 0;
     uint32_t m_cellsX = 0, m_cellsY = 0;
-    std::vector<uint32_t> m_cellStart;   // per cell: offset into m_triIndices
-    std::vector<uint32_t> m_cellCount;   // per cell: count of triangles
-    std::vector<uint32_t> m_triIndices;  // triangle indices sorted by cell
+    SceneArray<uint32_t> m_cellStart;    // per cell: offset into m_triIndices
+    SceneArray<uint32_t> m_cellCount;    // per cell: count of triangles
+    SceneArray<uint32_t> m_triIndices;   // triangle indices sorted by cell
+
+    // Multi-layer height field for ground probes and Z-ranged AABB queries. Each grid cell splits its
+    // triangles into Z layers: triangles whose Z extents overlap share a
+    // layer (a floor, a ramp, a stretch of terrain), and triangles taller
+    // than LAYER_TALL_SPAN (walls crossing several floors) share one of
+    // their own so they do not fuse the floors they cross. A layer keeps its
+    // Z span, quantized outward, and the offsets of its triangles in the
+    // cell's m_triIndices run. Probes walk a cell's layers from the top,
+    // skip those outside the window and stop at the first layer that cannot
+    // beat the best surface so far. Cells with more triangles than a layer
+    // offset can address get no layers and are scanned whole. There is no
+    // finer per-cell plane table: a plane only answers inside its triangle,
+    // so 1-yard cells still hold ~4.5 candidates each and cost ~5x the whole
+    // cache in memory.
+    struct HeightLayer
+    {
+        int16_t zLo, zHi;      // Z span in LAYER_Z_STEP units
+        uint16_t refCount;     // triangles in the layer
+        uint8_t maxNormalZ;    // largest |unit normal z| of its triangles, x255 rounded up
+        uint8_t pad;
+        uint32_t firstRef;     // offset into m_layerRefs
+    };
+    static_assert(sizeof(HeightLayer) == 12, "HeightLayer must stay 12 bytes");
+
+    static constexpr float LAYER_Z_STEP = 0.25f;     // yards per quantized Z unit
+    static constexpr float LAYER_TALL_SPAN = 8.0f;   // yards; roughly two floors
+
+    SceneArray<HeightLayer> m_heightLayers;   // per cell, by zHi descending
+    SceneArray<uint32_t> m_layerCellStart;    // per cell + 1 sentinel: offset into m_heightLayers
+    SceneArray<uint16_t> m_layerRefs;         // per layer, ascending: offsets into the cell's m_triIndices run
 
     // Liquid grid
     float m_liquidCellSize = 4.17f;      // matches ADT liquid resolution
     float m_liquidMinX = 0, m_liquidMinY = 0;
     uint32_t m_liquidCellsX = 0, m_liquidCellsY = 0;
-    std::vector<LiquidCell> m_liquidGrid;
+    SceneArray<LiquidCell> m_liquidGrid;
 
-    // Build spatial index from m_triangles (called after extraction or load)
+    // Build spatial index from m_tris (called after extraction or load)
     void BuildSpatialIndex();
 
+    // Build the per-cell height layers from the grid
+    void BuildHeightLayers();
+
+    // Convert triangle ti into query outputs
+    void AppendQueryTriangle(uint32_t ti,
+                             std::vector<CapsuleCollision::Triangle>& outTris,
+                             std::vector<uint32_t>* outInstanceIds,
+                             std::vector<uint32_t>* outSourceTypes,
+                             std::vector<SceneTriMetadata>* outMetadata) const;
+
+    // Backing mapping for v3 files (arrays above are views into it)
+    std::shared_ptr<MappedFile> m_mapping;
+
+    // Tile sources for composite caches; all arrays above stay empty
+    std::shared_ptr<SceneTileStreamer> m_streamer;
+    InjectedTileMap m_injectedTiles;
+    bool m_hasInjectedTiles = false;
+
+    bool IsComposite() const { return m_streamer || m_hasInjectedTiles; }
+    // Tiles overlapping the XY box / containing (x,y) / currently loaded
+    void CollectTiles(float minX, float minY, float maxX, float maxY, std::vector<SceneTileRef>& out) const;
+    std::shared_ptr<const SceneCache> GetTileAt(float x, float y) const;
+    void GetLoadedTiles(std::vector<SceneTileRef>& out) const;
+
+    // Version 3 is mapped in place; the version 1/2 reader expects f
+    // positioned after magic + version.
+    static SceneCache* LoadMapped(const char* path);
+    static SceneCache* LoadLegacy(FILE* f, uint32_t version);
+
+    // Reject loaded grid, layer, vertex and metadata indices that point
+    // outside their arrays (path is only used in the log message)
+    bool ValidateIndices(const char* path) const;
+
     // File format magic and version
     static constexpr uint32_t FILE_MAGIC = 0x454E4353;   // "SCNE"
-    static constexpr uint32_t FILE_VERSION = 2;  // bump when scene cache format changes
+    static constexpr uint32_t FILE_VERSION = 3;  // bump when scene cache format changes
 };
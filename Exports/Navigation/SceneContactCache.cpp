@@ -0,0 +1,100 @@
+// SceneContactCache.cpp - Per-bot collision geometry reused between frames
+#include "SceneContactCache.h"
+
+namespace
+{
+    thread_local SceneContactCache* t_activeCache = nullptr;
+}
+
+SceneContactCache::Scope::Scope(SceneContactCache* cache, uint32_t mapId)
+    : m_previous(t_activeCache)
+{
+    if (cache)
+    {
+        m_lock = std::unique_lock<std::mutex>(cache->m_mutex);
+        if (cache->m_mapId != mapId)
+        {
+            cache->Clear();
+            cache->m_mapId = mapId;
+        }
+    }
+    t_activeCache = cache;
+}
+
+SceneContactCache::Scope::~Scope()
+{
+    t_activeCache = m_previous;
+}
+
+SceneContactCache* SceneContactCache::Active()
+{
+    return t_activeCache;
+}
+
+bool SceneContactCache::EnsureView(const std::shared_ptr<SceneCache>& scene,
+                                   float minX, float minY, float maxX, float maxY)
+{
+    if (!scene || TooLarge(minX, minY, maxX, maxY))
+        return false;
+    if (m_view.IsViewOf(scene) && m_view.Covers(minX, minY, maxX, maxY))
+        return true;
+
+    SceneCache::BuildLocalView(scene, minX - VIEW_MARGIN, minY - VIEW_MARGIN,
+                               maxX + VIEW_MARGIN, maxY + VIEW_MARGIN, m_view);
+    ++m_viewBuilds;
+    return true;
+}
+
+bool SceneContactCache::QueryScene(const std::shared_ptr<SceneCache>& scene,
+                                   float minX, float minY, float maxX, float maxY,
+                                   std::vector<CapsuleCollision::Triangle>& outTris,
+                                   std::vector<uint32_t>* outInstanceIds,
+                                   std::vector<uint32_t>* outSourceTypes,
+                                   std::vector<SceneTriMetadata>* outMetadata)
+{
+    if (!EnsureView(scene, minX, minY, maxX, maxY))
+        return false;
+    m_view.QueryTrianglesInAABB(minX, minY, maxX, maxY, outTris, outInstanceIds, outSourceTypes, outMetadata);
+    return true;
+}
+
+bool SceneContactCache::QueryScene3D(const std::shared_ptr<SceneCache>& scene,
+                                     float minX, float minY, float minZ,
+                                     float maxX, float maxY, float maxZ,
+                                     std::vector<CapsuleCollision::Triangle>& outTris,
+                                     std::vector<uint32_t>* outInstanceIds,
+                                     std::vector<uint32_t>* outSourceTypes,
+                                     std::vector<SceneTriMetadata>* outMetadata)
+{
+    if (!EnsureView(scene, minX, minY, maxX, maxY))
+        return false;
+    m_view.QueryTrianglesInAABB3D(minX, minY, minZ, maxX, maxY, maxZ,
+                                  outTris, outInstanceIds, outSourceTypes, outMetadata);
+    return true;
+}
+
+bool SceneContactCache::QueryDynamic(DynamicObjectRegistry* registry, uint32_t mapId, const G3D::AABox& box,
+                                     std::vector<CapsuleCollision::Triangle>& outTris,
+                                     std::vector<uint32_t>* outInstanceIds)
+{
+    if (!registry || TooLarge(box.low().x, box.low().y, box.high().x, box.high().y))
+        return false;
+
+    if (!m_dynamic.Covers(mapId, registry->CurrentMapInstance(), box, registry->CurrentTransportTime()) ||
+        m_dynamic.generation != registry->GetMapGeneration(mapId))
+    {
+        registry->CaptureRegion(mapId,
+                                box.low().x - VIEW_MARGIN, box.low().y - VIEW_MARGIN,
+                                box.high().x + VIEW_MARGIN, box.high().y + VIEW_MARGIN,
+                                m_dynamic);
+        ++m_dynamicCaptures;
+    }
+    m_dynamic.QueryTriangles(box, outTris, outInstanceIds);
+    return true;
+}
+
+void SceneContactCache::Clear()
+{
+    m_view.Clear();
+    m_dynamic = DynamicObjectRegistry::RegionSnapshot();
+}
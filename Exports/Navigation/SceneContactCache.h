@@ -0,0 +1,98 @@
+// SceneContactCache.h - Per-bot collision geometry reused between frames
+#pragma once
+
+#include "SceneCache.h"
+#include "DynamicObjectRegistry.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// A bot moves a fraction of a yard per tick, yet every sweep and overlap test
+// in StepV2 walks the scene grid (or the streamed tiles) and locks the dynamic
+// object registry again. A SceneContactCache remembers, for one bot, the
+// static triangles of an area VIEW_MARGIN larger than the last query box
+// (SceneCache::LocalView) and a snapshot of the dynamic objects over the same
+// kind of area (DynamicObjectRegistry::RegionSnapshot). While later query
+// boxes stay inside those areas they are answered from the copies.
+//
+// Answers are exactly what the uncached queries return -- same triangles, same
+// order -- so stepping with or without a cache gives identical results. The
+// copies are rebuilt when:
+//   - a query box leaves the covered area;
+//   - the map's scene cache is replaced (InjectSceneTile, SetSceneCache,
+//     eviction): the view is tied to the cache object it was built from;
+//   - the map's dynamic generation changes (objects registered, moved,
+//     removed, doors toggled, variant pools loaded);
+//   - the transport time changes while a timeline-driven transport is in
+//     the snapshot.
+//
+// SceneQuery consults the cache of the step running on the current thread,
+// installed with a Scope (see PhysicsEngine::StepV2ForAgent). Without one,
+// queries go straight to the scene cache and registry as before.
+class SceneContactCache
+{
+public:
+    static constexpr float VIEW_MARGIN = 8.0f;
+    // Queries wider than this (long sweeps, teleports) bypass the cache.
+    static constexpr float MAX_QUERY_EXTENT = 32.0f;
+
+    // Makes cache the active one for this thread until destroyed. Holds the
+    // cache's lock, so one bot's cache is never used by two steps at once.
+    class Scope
+    {
+    public:
+        Scope(SceneContactCache* cache, uint32_t mapId);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        SceneContactCache* m_previous = nullptr;
+        std::unique_lock<std::mutex> m_lock;
+    };
+
+    // Cache installed on this thread, or null.
+    static SceneContactCache* Active();
+
+    // Cached forms of SceneCache::QueryTrianglesInAABB / QueryTrianglesInAABB3D
+    // on scene and DynamicObjectRegistry::QueryTriangles. Each returns false
+    // (outputs untouched) when the caller should run the uncached query.
+    bool QueryScene(const std::shared_ptr<SceneCache>& scene,
+                    float minX, float minY, float maxX, float maxY,
+                    std::vector<CapsuleCollision::Triangle>& outTris,
+                    std::vector<uint32_t>* outInstanceIds = nullptr,
+                    std::vector<uint32_t>* outSourceTypes = nullptr,
+                    std::vector<SceneTriMetadata>* outMetadata = nullptr);
+    bool QueryScene3D(const std::shared_ptr<SceneCache>& scene,
+                      float minX, float minY, float minZ,
+                      float maxX, float maxY, float maxZ,
+                      std::vector<CapsuleCollision::Triangle>& outTris,
+                      std::vector<uint32_t>* outInstanceIds = nullptr,
+                      std::vector<uint32_t>* outSourceTypes = nullptr,
+                      std::vector<SceneTriMetadata>* outMetadata = nullptr);
+    bool QueryDynamic(DynamicObjectRegistry* registry, uint32_t mapId, const G3D::AABox& box,
+                      std::vector<CapsuleCollision::Triangle>& outTris,
+                      std::vector<uint32_t>* outInstanceIds = nullptr);
+
+    void Clear();
+
+    // Diagnostics: how often the static view / dynamic snapshot was rebuilt.
+    uint64_t GetViewBuildCount() const { return m_viewBuilds; }
+    uint64_t GetDynamicCaptureCount() const { return m_dynamicCaptures; }
+
+private:
+    static bool TooLarge(float minX, float minY, float maxX, float maxY)
+    {
+        return maxX - minX > MAX_QUERY_EXTENT || maxY - minY > MAX_QUERY_EXTENT;
+    }
+
+    bool EnsureView(const std::shared_ptr<SceneCache>& scene, float minX, float minY, float maxX, float maxY);
+
+    std::mutex m_mutex;
+    uint32_t m_mapId = 0;
+    SceneCache::LocalView m_view;
+    DynamicObjectRegistry::RegionSnapshot m_dynamic;
+    uint64_t m_viewBuilds = 0;
+    uint64_t m_dynamicCaptures = 0;
+};
@@ -1,5 +1,6 @@
 #include "SceneQuery.h"
 #include "SceneCache.h"
+#include "SceneTileStreamer.h"
 #include "StaticMapTree.h"
 #include "ModelInstance.h"
 #include "WorldModel.h"
@@ -10,6 +11,7 @@
 #include "VMapManager2.h"
 #include "VMapFactory.h"
 #include "DynamicObjectRegistry.h"
+#include "SceneContactCache.h"
 #include <filesystem>
 #include "PhysicsEngine.h"
 #include <algorithm>
@@ -27,6 +29,16 @@
 #include "PhysicsLiquidHelpers.h"
 #include "PhysicsShapeHelpers.h"
 #include "PhysicsTolerances.h"
+#include "ParallelFor.h"
+
+// Underground interiors (Undercity, mines, caves) can be 40-50y below the
+// terrain surface. The default 10y search distance fails to find the WMO
+// floor when the query starts underground. Increase search distance for
+// positions significantly below sea level.
+static float GroundSearchDistance(float z, float maxSearchDist)
+{
+    return (z < -10.0f && maxSearchDist < 60.0f) ? 60.0f : maxSearchDist;
+}
 
 static bool TryResolveSceneCacheAreaInfo(const SceneCache& cache,
     float x,
@@ -250,6 +262,11 @@ SceneQuery::SweepResults SceneQuery::ComputeCapsuleSweep(
 }
 
 bool SceneQuery::LineOfSight(uint32_t mapId, const G3D::Vector3& from, const G3D::Vector3& to)
+{
+    return IsVmapLineOfSightClear(mapId, from, to) && IsTerrainAndDynamicLineOfSightClear(mapId, from, to);
+}
+
+bool SceneQuery::IsVmapLineOfSightClear(uint32_t mapId, const G3D::Vector3& from, const G3D::Vector3& to)
 {
     // VMAP LOS (WMO/M2 geometry)
     bool vmapClear = true;
@@ -265,9 +282,11 @@ bool SceneQuery::LineOfSight(uint32_t mapId, const G3D::Vector3& from, const G3D
         catch (...) {}
     }
 
-    if (!vmapClear)
-        return false;
+    return vmapClear;
+}
 
+bool SceneQuery::IsTerrainAndDynamicLineOfSightClear(uint32_t mapId, const G3D::Vector3& from, const G3D::Vector3& to)
+{
     // ADT terrain raycast using MapLoader triangles
     if (m_mapLoader)
     {
@@ -420,6 +439,8 @@ void SceneQuery::Initialize()
         if (!m_mapLoader)
         {
             m_mapLoader = new MapLoader();
+            if (m_mapTileMemoryBudget)
+                m_mapLoader->SetMemoryBudget(m_mapTileMemoryBudget);
             // Try WWOW_DATA_DIR first, then common relative paths
             std::vector<std::string> mps;
             if (!dataRoot.empty())
@@ -457,7 +478,21 @@ void SceneQuery::EnsureMapLoaded(uint32_t mapId)
     if (!IsSceneAutoloadEnabled())
         return;
 
-    // 2. Check for .scene file on disk (fast path)
+    // 2. Per-tile scene files stream in on demand (preferred over a whole-map .scene)
+    if (!m_scenesDir.empty())
+    {
+        const std::string tilesDir = m_scenesDir + "tiles/";
+        if (SceneTileStreamer::HasTilesForMap(tilesDir, mapId))
+        {
+            auto streamer = std::make_shared<SceneTileStreamer>(mapId, tilesDir);
+            if (m_sceneTileMemoryBudget)
+                streamer->SetMemoryBudget(m_sceneTileMemoryBudget);
+            SetSceneCache(mapId, SceneCache::CreateStreamed(mapId, std::move(streamer)));
+            return;
+        }
+    }
+
+    // 3. Check for .scene file on disk (fast path)
     if (!m_scenesDir.empty())
     {
         std::string scenePath = m_scenesDir + std::to_string(mapId) + ".scene";
@@ -468,6 +503,15 @@ void SceneQuery::EnsureMapLoaded(uint32_t mapId)
             {
                 if (cache->HasTriangleMetadata())
                 {
+                    // Older formats load into private memory. Scene files are
+                    // converted offline (tools/NavDataConvert), never rewritten
+                    // here: other processes may be mapping the same file.
+                    if (!cache->IsMapped())
+                    {
+                        fprintf(stderr,
+                                "[SceneQuery] %s is an older scene cache format and is loaded into private memory; run NavDataConvert scenes <scenes dir> to make it mappable.\n",
+                                scenePath.c_str());
+                    }
                     SetSceneCache(mapId, cache);
                     return;
                 }
@@ -507,7 +551,7 @@ void SceneQuery::EnsureMapLoaded(uint32_t mapId)
         }
     }
 
-    // 3. Fall back to live VMAP loading (slow, 30-60s per map)
+    // 4. Fall back to live VMAP loading (slow, 30-60s per map)
     if (m_vmapManager && !m_vmapManager->isMapInitialized(mapId))
     {
         m_vmapManager->initializeMap(mapId);
@@ -517,20 +561,89 @@ void SceneQuery::EnsureMapLoaded(uint32_t mapId)
 // --- SceneCache management ---
 void SceneQuery::SetSceneCache(uint32_t mapId, SceneCache* cache)
 {
+    // Swap the published pointer only; queries already holding the previous
+    // cache keep it alive until they return.
+    std::shared_ptr<SceneCache> next(cache);
+    std::lock_guard<std::recursive_mutex> lock(m_sceneCachesMutex);
+    m_sceneCaches[mapId].swap(next);
+    ++m_sceneGenerations[mapId];
+}
+
+void SceneQuery::InjectSceneTile(uint32_t mapId, int tileX, int tileY, SceneCache* tile)
+{
+    std::shared_ptr<const SceneCache> tilePtr(tile);
     std::lock_guard<std::recursive_mutex> lock(m_sceneCachesMutex);
+
+    SceneCache::InjectedTileMap tiles;
     auto it = m_sceneCaches.find(mapId);
-    if (it != m_sceneCaches.end())
+    if (it != m_sceneCaches.end() && it->second && it->second->HasInjectedTiles())
+        tiles = it->second->GetInjectedTiles();
+    tiles[SceneTileStreamer::MakeKey(tileX, tileY)] = std::move(tilePtr);
+
+    SetSceneCache(mapId, SceneCache::CreateFromInjectedTiles(mapId, std::move(tiles)));
+}
+
+bool SceneQuery::EvictSceneTile(uint32_t mapId, int tileX, int tileY)
+{
+    // Keeps the previous cache, and with it the evicted tile, alive until
+    // after unlocking.
+    std::shared_ptr<SceneCache> released;
+    std::lock_guard<std::recursive_mutex> lock(m_sceneCachesMutex);
+    auto it = m_sceneCaches.find(mapId);
+    if (it == m_sceneCaches.end() || !it->second || !it->second->HasInjectedTiles())
+        return false;
+    released = it->second;
+
+    SceneCache::InjectedTileMap tiles = it->second->GetInjectedTiles();
+    if (tiles.erase(SceneTileStreamer::MakeKey(tileX, tileY)) == 0)
+        return false;
+
+    if (tiles.empty())
     {
-        delete it->second;
-        it->second = cache;
+        m_sceneCaches.erase(it);
+        ++m_sceneGenerations[mapId];
     }
     else
+        SetSceneCache(mapId, SceneCache::CreateFromInjectedTiles(mapId, std::move(tiles)));
+    return true;
+}
+
+bool SceneQuery::HasInjectedSceneTile(uint32_t mapId, int tileX, int tileY)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_sceneCachesMutex);
+    auto it = m_sceneCaches.find(mapId);
+    if (it == m_sceneCaches.end() || !it->second || !it->second->HasInjectedTiles())
+        return false;
+    return it->second->GetInjectedTiles().count(SceneTileStreamer::MakeKey(tileX, tileY)) != 0;
+}
+
+void SceneQuery::PrefetchSceneTiles(uint32_t mapId, float x, float y, float vx, float vy)
+{
+    auto cache = GetSceneCache(mapId);
+    if (!cache || !cache->IsStreamed())
+        return;
+    cache->GetStreamer()->Prefetch(x, y, vx, vy);
+}
+
+void SceneQuery::SetSceneTileMemoryBudget(size_t bytes)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_sceneCachesMutex);
+    m_sceneTileMemoryBudget = bytes;
+    for (auto& [id, cache] : m_sceneCaches)
     {
-        m_sceneCaches[mapId] = cache;
+        if (cache && cache->IsStreamed())
+            cache->GetStreamer()->SetMemoryBudget(bytes ? bytes : SceneTileStreamer::DEFAULT_MEMORY_BUDGET);
     }
 }
 
-SceneCache* SceneQuery::GetSceneCache(uint32_t mapId)
+void SceneQuery::SetMapTileMemoryBudget(size_t bytes)
+{
+    m_mapTileMemoryBudget = bytes;
+    if (m_mapLoader)
+        m_mapLoader->SetMemoryBudget(bytes ? bytes : MapLoader::DEFAULT_MEMORY_BUDGET);
+}
+
+std::shared_ptr<SceneCache> SceneQuery::GetSceneCache(uint32_t mapId)
 {
     std::lock_guard<std::recursive_mutex> lock(m_sceneCachesMutex);
     auto it = m_sceneCaches.find(mapId);
@@ -539,21 +652,32 @@ SceneCache* SceneQuery::GetSceneCache(uint32_t mapId)
 
 void SceneQuery::ClearSceneCaches()
 {
+    std::unordered_map<uint32_t, std::shared_ptr<SceneCache>> released;
     std::lock_guard<std::recursive_mutex> lock(m_sceneCachesMutex);
-    for (auto& [id, cache] : m_sceneCaches)
-        delete cache;
-    m_sceneCaches.clear();
+    released.swap(m_sceneCaches);
+    for (const auto& [id, cache] : released)
+        ++m_sceneGenerations[id];
 }
 
 void SceneQuery::ClearSceneCache(uint32_t mapId)
 {
+    // Move the cache out and let it be destroyed after unlocking, so freeing
+    // a large map does not stall queries on other maps.
+    std::shared_ptr<SceneCache> released;
     std::lock_guard<std::recursive_mutex> lock(m_sceneCachesMutex);
     auto it = m_sceneCaches.find(mapId);
-    if (it != m_sceneCaches.end())
-    {
-        delete it->second;
-        m_sceneCaches.erase(it);
-    }
+    if (it == m_sceneCaches.end())
+        return;
+    released.swap(it->second);
+    m_sceneCaches.erase(it);
+    ++m_sceneGenerations[mapId];
+}
+
+uint64_t SceneQuery::GetSceneGeneration(uint32_t mapId)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_sceneCachesMutex);
+    auto it = m_sceneGenerations.find(mapId);
+    return it != m_sceneGenerations.end() ? it->second : 0;
 }
 
 float SceneQuery::GetLiquidHeight(uint32_t mapId, float x, float y, float z, uint32_t& liquidType)
@@ -585,70 +709,78 @@ float SceneQuery::GetLiquidHeight(uint32_t mapId, float x, float y, float z, uin
 float SceneQuery::GetGroundZ(uint32_t mapId, float x, float y, float z, float maxSearchDist)
 {
     EnsureMapLoaded(mapId);
-
-    // Underground interiors (Undercity, mines, caves) can be 40-50y below the
-    // terrain surface. The default 10y search distance fails to find the WMO
-    // floor when the query starts underground. Increase search distance for
-    // positions significantly below sea level.
-    if (z < -10.0f && maxSearchDist < 60.0f)
-        maxSearchDist = 60.0f;
+    maxSearchDist = GroundSearchDistance(z, maxSearchDist);
 
     // Scene cache fast path: pre-processed triangles with spatial index.
     // More precise than raw VMAP ray on slopes due to exact barycentric interpolation.
     // Falls through to VMAP+ADT+BIH for positions not covered by scene cache
     // (e.g., Undercity underground at Z < -10).
-    if (auto* cache = GetSceneCache(mapId))
-    {
-        float sceneZ = cache->GetGroundZ(x, y, z, maxSearchDist);
-
-        // Also check dynamic objects (elevators, doors) — their meshes
-        // aren't in the pre-cached scene file.
-        float dynZ = GetDynamicGroundZ(mapId, x, y, z, maxSearchDist);
-        const float zMax = z + maxSearchDist;
-        const float zMin = z - maxSearchDist;
-        const bool sceneOk = sceneZ > PhysicsConstants::INVALID_HEIGHT + 1.0f
-            && sceneZ >= zMin
-            && sceneZ <= zMax;
-        const bool dynOk = dynZ > PhysicsConstants::INVALID_HEIGHT + 1.0f
-            && dynZ >= zMin
-            && dynZ <= zMax;
-
-        // If only one source has a valid result, return it
-        if (!dynOk) {
-            // Scene cache returned a result — but verify it is within the caller's
-            // search window. Underground/WMO edge queries can otherwise return a
-            // floor from another level (for example Z=0 instead of the Undercity
-            // floor at Z≈-43), which is worse than falling through to VMAP/BIH.
-            if (sceneOk)
-                return sceneZ;
-            // else: fall through to VMAP+ADT+BIH below
-        } else if (!sceneOk) {
-            return dynZ;
-        } else {
-            // Both valid — pick closest to query Z within acceptance window
-            if (sceneOk && dynOk)
-                return (std::fabs(sceneZ - z) <= std::fabs(dynZ - z)) ? sceneZ : dynZ;
-            if (dynOk) return dynZ;
-            return sceneZ;
-        }
+    if (auto cache = GetSceneCache(mapId))
+    {
+        float sceneResult;
+        if (TryGetSceneGroundZ(*cache, mapId, x, y, z, maxSearchDist, sceneResult))
+            return sceneResult;
+        // else: fall through to VMAP+ADT+BIH below
+    }
+
+    return GetGroundZFromMapData(mapId, x, y, z, maxSearchDist);
+}
+
+bool SceneQuery::TryGetSceneGroundZ(const SceneCache& cache, uint32_t mapId, float x, float y, float z,
+                                    float maxSearchDist, float& outZ)
+{
+    float sceneZ = cache.GetGroundZ(x, y, z, maxSearchDist);
 
+    // Also check dynamic objects (elevators, doors) — their meshes
+    // aren't in the pre-cached scene file.
+    float dynZ = GetDynamicGroundZ(mapId, x, y, z, maxSearchDist);
+    const float zMax = z + maxSearchDist;
+    const float zMin = z - maxSearchDist;
+    const bool sceneOk = sceneZ > PhysicsConstants::INVALID_HEIGHT + 1.0f
+        && sceneZ >= zMin
+        && sceneZ <= zMax;
+    const bool dynOk = dynZ > PhysicsConstants::INVALID_HEIGHT + 1.0f
+        && dynZ >= zMin
+        && dynZ <= zMax;
+
+    // If only one source has a valid result, return it
+    if (!dynOk) {
+        // Scene cache returned a result — but verify it is within the caller's
+        // search window. Underground/WMO edge queries can otherwise return a
+        // floor from another level (for example Z=0 instead of the Undercity
+        // floor at Z≈-43), which is worse than falling through to VMAP/BIH.
+        if (!sceneOk)
+            return false;
+        outZ = sceneZ;
+    } else if (!sceneOk) {
+        outZ = dynZ;
+    } else {
+        // Both valid — pick closest to query Z within acceptance window
+        outZ = (std::fabs(sceneZ - z) <= std::fabs(dynZ - z)) ? sceneZ : dynZ;
     }
+    return true;
+}
+
+float SceneQuery::GetGroundZFromMapData(uint32_t mapId, float x, float y, float z, float maxSearchDist)
+{
+    float vmapZ = PhysicsConstants::INVALID_HEIGHT;
+    if (m_vmapManager)
+        vmapZ = m_vmapManager->getHeight(mapId, x, y, z, maxSearchDist);
+    return GetGroundZFromMapData(mapId, x, y, z, maxSearchDist, vmapZ);
+}
 
+float SceneQuery::GetGroundZFromMapData(uint32_t mapId, float x, float y, float z, float maxSearchDist, float vmapZ)
+{
     // Collect candidate ground heights from all sources, then pick the one
     // closest to z. "Closest to z" correctly handles:
     //   - Outdoor: ADT ground is closest, VMAP roof is above (farther from z)
     //   - Underground interiors: BIH WMO floor is closest, ADT terrain above is farther
     //   - Multi-level buildings: correct floor is closest to current Z
-    float vmapZ = PhysicsConstants::INVALID_HEIGHT;
     float adtZ  = PhysicsConstants::INVALID_HEIGHT;
     float bihZ  = PhysicsConstants::INVALID_HEIGHT;
 
-    // 1. VMAP ray (WMO/M2 models — buildings, bridges, ramps)
-    if (m_vmapManager)
-    {
-        vmapZ = m_vmapManager->getHeight(mapId, x, y, z, maxSearchDist);
-        if (!VMAP::IsValidHeight(vmapZ)) vmapZ = PhysicsConstants::INVALID_HEIGHT;
-    }
+    // 1. VMAP ray (WMO/M2 models — buildings, bridges, ramps), traced by the caller
+    if (!VMAP::IsValidHeight(vmapZ)) vmapZ = PhysicsConstants::INVALID_HEIGHT;
 
     // 2. ADT terrain (triangle-based Z for consistency with capsule sweep)
     if (m_mapLoader && m_mapLoader->IsInitialized())
@@ -662,6 +794,8 @@ float SceneQuery::GetGroundZ(uint32_t mapId, float x, float y, float z, float ma
     //    find walkable triangles via AABB overlap against the BIH tree.
     if (vmapZ <= PhysicsConstants::INVALID_HEIGHT + 1.0f && m_vmapManager)
     {
+        m_vmapManager->ensureTilesLoaded(mapId, G3D::AABox(G3D::Vector3(x - 0.5f, y - 0.5f, z - maxSearchDist),
+                                                            G3D::Vector3(x + 0.5f, y + 0.5f, z + 0.5f)));
         const VMAP::StaticMapTree* map = m_vmapManager->GetStaticMapTree(mapId);
         if (map && map->GetInstancesPtr() && map->GetInstanceCount() > 0)
             bihZ = GetGroundZByBIH(map, x, y, z, maxSearchDist);
@@ -699,8 +833,7 @@ float SceneQuery::GetWalkableGroundZ(uint32_t mapId, float x, float y, float z,
     // Mirror GetGroundZ's underground search expansion so caves/interiors still
     // probe a wide enough vertical window. The walkable filter only narrows the
     // set of acceptable triangles, not the search range.
-    if (z < -10.0f && maxSearchDist < 60.0f)
-        maxSearchDist = 60.0f;
+    maxSearchDist = GroundSearchDistance(z, maxSearchDist);
 
     // Scene-cache fast path is the only path BG uses in tile-mode (the WWoW
     // bake-validation harness's BG accounts hit only this branch). Other
@@ -710,12 +843,216 @@ float SceneQuery::GetWalkableGroundZ(uint32_t mapId, float x, float y, float z,
     // server-side preload-failure cases), return INVALID_HEIGHT so the caller
     // can decide its own fallback (typically "treat as no support, let bot
     // fall").
-    if (auto* cache = GetSceneCache(mapId))
+    if (auto cache = GetSceneCache(mapId))
         return cache->GetWalkableGroundZ(x, y, z, maxSearchDist, walkableMinNormalZ);
 
     return PhysicsConstants::INVALID_HEIGHT;
 }
 
+namespace
+{
+    // Queries handed to a worker at a time: small enough to balance a
+    // 500-point path over the workers, large enough to amortize the hand-out.
+    constexpr size_t kBatchBlock = 32;
+
+    // Visit order for a batch: Morton order of 8-yard XY cells, so
+    // consecutive queries touch the same scene cells, tiles and terrain.
+    template <typename PointAt>
+    void SpatialOrder(int count, PointAt&& pointAt, std::vector<uint32_t>& order)
+    {
+        auto spread = [](uint32_t v)
+        {
+            v &= 0xFFFFu;
+            v = (v | (v << 8)) & 0x00FF00FFu;
+            v = (v | (v << 4)) & 0x0F0F0F0Fu;
+            v = (v | (v << 2)) & 0x33333333u;
+            v = (v | (v << 1)) & 0x55555555u;
+            return v;
+        };
+        auto cell = [](float c)
+        {
+            // World coordinates lie within +-17066.66; shift to positive cells.
+            const float shifted = (c + 17066.67f) / 8.0f;
+            return static_cast<uint32_t>(std::clamp(shifted, 0.0f, 65535.0f));
+        };
+
+        std::vector<std::pair<uint32_t, uint32_t>> keyed(static_cast<size_t>(count));
+        for (int i = 0; i < count; ++i)
+        {
+            const G3D::Vector3 p = pointAt(i);
+            keyed[i] = { spread(cell(p.x)) | (spread(cell(p.y)) << 1), static_cast<uint32_t>(i) };
+        }
+        std::stable_sort(keyed.begin(), keyed.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+        order.resize(keyed.size());
+        for (size_t i = 0; i < keyed.size(); ++i)
+            order[i] = keyed[i].second;
+    }
+
+    // fn(begin, n) for consecutive blocks covering [0, count), spread over
+    // the workers.
+    template <typename Fn>
+    void ForEachBlock(size_t count, Fn&& fn)
+    {
+        const size_t blocks = (count + kBatchBlock - 1) / kBatchBlock;
+        Parallel::For(blocks, [&](size_t b)
+        {
+            const size_t begin = b * kBatchBlock;
+            fn(begin, std::min(count, begin + kBatchBlock) - begin);
+        });
+    }
+
+    // fn(index) for every index in order; each worker takes a block of
+    // consecutive entries.
+    template <typename Fn>
+    void ForEachInOrder(const std::vector<uint32_t>& order, Fn&& fn)
+    {
+        const size_t blocks = (order.size() + kBatchBlock - 1) / kBatchBlock;
+        Parallel::For(blocks, [&](size_t b)
+        {
+            const size_t end = std::min(order.size(), (b + 1) * kBatchBlock);
+            for (size_t i = b * kBatchBlock; i < end; ++i)
+                fn(order[i]);
+        });
+    }
+}
+
+void SceneQuery::GetGroundZBatch(uint32_t mapId, const G3D::Vector3* points, int count,
+                                 float maxSearchDist, float* outZ)
+{
+    if (!points || !outZ || count <= 0)
+        return;
+
+    EnsureMapLoaded(mapId);
+
+    std::vector<uint32_t> order;
+    SpatialOrder(count, [&](int i) { return points[i]; }, order);
+
+    std::vector<uint8_t> resolved(static_cast<size_t>(count), 0);
+    if (auto cache = GetSceneCache(mapId))
+    {
+        ForEachInOrder(order, [&](uint32_t i)
+        {
+            const G3D::Vector3& p = points[i];
+            if (TryGetSceneGroundZ(*cache, mapId, p.x, p.y, p.z, GroundSearchDistance(p.z, maxSearchDist), outZ[i]))
+                resolved[i] = 1;
+        });
+    }
+
+    // Whatever the scene cache could not answer goes through VMAP/ADT/BIH.
+    // The VMAP rays of all of them are traced first, as ray packets on the
+    // workers; the ADT and BIH stage is not safe to drive from several threads.
+    std::vector<uint32_t> remaining;
+    std::vector<G3D::Vector3> remainingPoints;
+    std::vector<float> searchDist;
+    for (uint32_t i : order)
+    {
+        if (resolved[i])
+            continue;
+        remaining.push_back(i);
+        remainingPoints.push_back(points[i]);
+        searchDist.push_back(GroundSearchDistance(points[i].z, maxSearchDist));
+    }
+    if (remaining.empty())
+        return;
+
+    std::vector<float> vmapZ(remaining.size(), PhysicsConstants::INVALID_HEIGHT);
+    if (m_vmapManager)
+    {
+        // Lazily loaded tiles are paged in here, not on the workers
+        m_vmapManager->ensureBatchTilesLoaded(mapId, remainingPoints.data(), nullptr,
+                                              static_cast<uint32_t>(remainingPoints.size()));
+        ForEachBlock(remaining.size(), [&](size_t begin, size_t n)
+        {
+            m_vmapManager->getHeightBatch(mapId, remainingPoints.data() + begin, searchDist.data() + begin,
+                                          static_cast<uint32_t>(n), vmapZ.data() + begin);
+        });
+    }
+
+    for (size_t k = 0; k < remaining.size(); ++k)
+    {
+        const G3D::Vector3& p = remainingPoints[k];
+        outZ[remaining[k]] = GetGroundZFromMapData(mapId, p.x, p.y, p.z, searchDist[k], vmapZ[k]);
+    }
+}
+
+void SceneQuery::GetWalkableGroundZBatch(uint32_t mapId, const G3D::Vector3* points, int count,
+                                         float maxSearchDist, float walkableMinNormalZ, float* outZ)
+{
+    if (!points || !outZ || count <= 0)
+        return;
+
+    EnsureMapLoaded(mapId);
+
+    auto cache = GetSceneCache(mapId);
+    if (!cache)
+    {
+        std::fill(outZ, outZ + count, PhysicsConstants::INVALID_HEIGHT);
+        return;
+    }
+
+    std::vector<uint32_t> order;
+    SpatialOrder(count, [&](int i) { return points[i]; }, order);
+    ForEachInOrder(order, [&](uint32_t i)
+    {
+        const G3D::Vector3& p = points[i];
+        outZ[i] = cache->GetWalkableGroundZ(p.x, p.y, p.z, GroundSearchDistance(p.z, maxSearchDist), walkableMinNormalZ);
+    });
+}
+
+void SceneQuery::LineOfSightBatch(uint32_t mapId, const G3D::Vector3* from, const G3D::Vector3* to,
+                                  int count, bool* outClear)
+{
+    if (!from || !to || !outClear || count <= 0)
+        return;
+
+    std::vector<uint32_t> order;
+    SpatialOrder(count, [&](int i) { return (from[i] + to[i]) * 0.5f; }, order);
+
+    // VMAP model rays, traced as ray packets on the workers; only segments
+    // they leave clear need the terrain and dynamic object tests.
+    std::vector<G3D::Vector3> orderedFrom(order.size()), orderedTo(order.size());
+    for (size_t k = 0; k < order.size(); ++k)
+    {
+        orderedFrom[k] = from[order[k]];
+        orderedTo[k] = to[order[k]];
+    }
+    std::unique_ptr<bool[]> vmapClear(new bool[order.size()]);
+    std::fill(vmapClear.get(), vmapClear.get() + order.size(), true);
+    if (m_vmapManager)
+    {
+        try
+        {
+            if (!m_vmapManager->isMapInitialized(mapId))
+                m_vmapManager->initializeMap(mapId);
+
+            // Lazily loaded tiles are paged in here, not on the workers
+            m_vmapManager->ensureBatchTilesLoaded(mapId, orderedFrom.data(), orderedTo.data(),
+                                                  static_cast<uint32_t>(order.size()));
+            ForEachBlock(order.size(), [&](size_t begin, size_t n)
+            {
+                m_vmapManager->isInLineOfSightBatch(mapId, orderedFrom.data() + begin, orderedTo.data() + begin,
+                                                    static_cast<uint32_t>(n), false, vmapClear.get() + begin);
+            });
+        }
+        catch (...) {}
+    }
+
+    std::vector<uint32_t> pending;
+    pending.reserve(order.size());
+    for (size_t k = 0; k < order.size(); ++k)
+    {
+        outClear[order[k]] = vmapClear[k];
+        if (vmapClear[k])
+            pending.push_back(order[k]);
+    }
+
+    ForEachInOrder(pending, [&](uint32_t i)
+    {
+        outClear[i] = IsTerrainAndDynamicLineOfSightClear(mapId, from[i], to[i]);
+    });
+}
+
 bool SceneQuery::GetAreaInfo(uint32_t mapId,
                              float x,
                              float y,
@@ -732,7 +1069,7 @@ bool SceneQuery::GetAreaInfo(uint32_t mapId,
 
     if (!m_vmapManager)
     {
-        if (auto* cache = GetSceneCache(mapId))
+        if (auto cache = GetSceneCache(mapId))
             return TryResolveSceneCacheAreaInfo(*cache, x, y, z, flags, rootId, groupId);
 
         return false;
@@ -746,7 +1083,7 @@ bool SceneQuery::GetAreaInfo(uint32_t mapId,
             return true;
     }
 
-    if (auto* cache = GetSceneCache(mapId))
+    if (auto cache = GetSceneCache(mapId))
         return TryResolveSceneCacheAreaInfo(*cache, x, y, z, flags, rootId, groupId);
 
     return false;
@@ -1046,7 +1383,7 @@ SceneQuery::LiquidInfo SceneQuery::EvaluateLiquidAt(uint32_t mapId, float x, flo
     LiquidInfo out{};
 
     // Scene cache fast path
-    if (auto* cache = GetSceneCache(mapId))
+    if (auto cache = GetSceneCache(mapId))
     {
         if (cache->HasLiquidData())
         {
@@ -1848,7 +2185,7 @@ int SceneQuery::TestTerrainAABB(uint32_t mapId,
     // older replace-with-fresh-extract behaviour.
     constexpr float kUnionMaxSpanY = 512.0f;
 
-    auto* scCache = GetSceneCache(mapId);
+    auto scCache = GetSceneCache(mapId);
     if (scCache)
     {
         const SceneCache::ExtractBounds bounds = scCache->GetExtractBounds();
@@ -1900,7 +2237,7 @@ int SceneQuery::TestTerrainAABB(uint32_t mapId,
                         extractBounds.maxX - extractBounds.minX,
                         extractBounds.maxY - extractBounds.minY);
                 SetSceneCache(mapId, newCache);
-                scCache = newCache;
+                scCache = GetSceneCache(mapId);
             }
         }
     }
@@ -1922,17 +2259,21 @@ int SceneQuery::TestTerrainAABB(uint32_t mapId,
                     boxMax.x,
                     boxMax.y);
             SetSceneCache(mapId, newCache);
-            scCache = newCache;
+            scCache = GetSceneCache(mapId);
         }
     }
 
     if (!scCache) return 0;
 
-    // Query all triangles in the XY footprint
+    // Query triangles overlapping the box (Z-aware, so stacked floors are culled early)
     std::vector<CapsuleCollision::Triangle> tris;
     std::vector<uint32_t> instanceIds;
     std::vector<SceneTriMetadata> triangleMetadata;
-    scCache->QueryTrianglesInAABB(boxMin.x, boxMin.y, boxMax.x, boxMax.y, tris, &instanceIds, nullptr, &triangleMetadata);
+    SceneContactCache* contactCache = SceneContactCache::Active();
+    if (!contactCache || !contactCache->QueryScene3D(scCache, boxMin.x, boxMin.y, boxMin.z, boxMax.x, boxMax.y, boxMax.z,
+                                                     tris, &instanceIds, nullptr, &triangleMetadata))
+        scCache->QueryTrianglesInAABB3D(boxMin.x, boxMin.y, boxMin.z, boxMax.x, boxMax.y, boxMax.z,
+                                        tris, &instanceIds, nullptr, &triangleMetadata);
 
     G3D::Vector3 center = (boxMin + boxMax) * 0.5f;
     G3D::Vector3 halfExt = (boxMax - boxMin) * 0.5f;
@@ -1980,7 +2321,9 @@ int SceneQuery::TestTerrainAABB(uint32_t mapId,
     {
         std::vector<CapsuleCollision::Triangle> dynTris;
         std::vector<uint32_t> dynInstanceIds;
-        dynReg->QueryTriangles(mapId, G3D::AABox(boxMin, boxMax), dynTris, &dynInstanceIds);
+        const G3D::AABox dynBox(boxMin, boxMax);
+        if (!contactCache || !contactCache->QueryDynamic(dynReg, mapId, dynBox, dynTris, &dynInstanceIds))
+            dynReg->QueryTriangles(mapId, dynBox, dynTris, &dynInstanceIds);
 
         for (size_t i = 0; i < dynTris.size(); ++i) {
             const auto& t = dynTris[i];
@@ -2032,7 +2375,7 @@ int SceneQuery::SweepAABB(uint32_t mapId,
     EnsureMapLoaded(mapId);
     outContacts.clear();
 
-    auto* scCache = GetSceneCache(mapId);
+    auto scCache = GetSceneCache(mapId);
     if (!scCache) return 0;
 
     // Compute swept AABB (union of start and end AABBs)
@@ -2047,7 +2390,10 @@ int SceneQuery::SweepAABB(uint32_t mapId,
     std::vector<CapsuleCollision::Triangle> tris;
     std::vector<uint32_t> instanceIds;
     std::vector<SceneTriMetadata> triangleMetadata;
-    scCache->QueryTrianglesInAABB(queryMinX, queryMinY, queryMaxX, queryMaxY, tris, &instanceIds, nullptr, &triangleMetadata);
+    SceneContactCache* contactCache = SceneContactCache::Active();
+    if (!contactCache || !contactCache->QueryScene(scCache, queryMinX, queryMinY, queryMaxX, queryMaxY,
+                                                   tris, &instanceIds, nullptr, &triangleMetadata))
+        scCache->QueryTrianglesInAABB(queryMinX, queryMinY, queryMaxX, queryMaxY, tris, &instanceIds, nullptr, &triangleMetadata);
 
     G3D::Vector3 center = (boxMin + boxMax) * 0.5f;
     G3D::Vector3 halfExt = (boxMax - boxMin) * 0.5f;
@@ -2104,7 +2450,9 @@ int SceneQuery::SweepAABB(uint32_t mapId,
         G3D::Vector3 queryMax(queryMaxX, queryMaxY, std::max(boxMax.z, endMax.z));
         std::vector<CapsuleCollision::Triangle> dynTris;
         std::vector<uint32_t> dynInstanceIds;
-        dynReg->QueryTriangles(mapId, G3D::AABox(queryMin, queryMax), dynTris, &dynInstanceIds);
+        const G3D::AABox dynBox(queryMin, queryMax);
+        if (!contactCache || !contactCache->QueryDynamic(dynReg, mapId, dynBox, dynTris, &dynInstanceIds))
+            dynReg->QueryTriangles(mapId, dynBox, dynTris, &dynInstanceIds);
 
         for (size_t i = 0; i < dynTris.size(); ++i) {
             const auto& t = dynTris[i];
@@ -2172,7 +2520,7 @@ int SceneQuery::SweepCapsule(uint32_t mapId,
     // When a pre-processed SceneCache is loaded, use it for all static geometry
     // queries instead of BIH tree traversal + MapLoader terrain.
     // Dynamic objects are still handled separately via DynamicObjectRegistry.
-    if (auto* scCache = GetSceneCache(mapId))
+    if (auto scCache = GetSceneCache(mapId))
     {
         outHits.clear();
         G3D::Vector3 wP0(capsuleStart.p0.x, capsuleStart.p0.y, capsuleStart.p0.z);
@@ -2189,8 +2537,11 @@ int SceneQuery::SweepCapsule(uint32_t mapId,
         // Query cached triangles
         std::vector<CapsuleCollision::Triangle> cachedTris;
         std::vector<uint32_t> cachedInstIds;
-        scCache->QueryTrianglesInAABB(queryMinX, queryMinY, queryMaxX, queryMaxY,
-                                       cachedTris, &cachedInstIds);
+        SceneContactCache* contactCache = SceneContactCache::Active();
+        if (!contactCache || !contactCache->QueryScene(scCache, queryMinX, queryMinY, queryMaxX, queryMaxY,
+                                                       cachedTris, &cachedInstIds))
+            scCache->QueryTrianglesInAABB(queryMinX, queryMinY, queryMaxX, queryMaxY,
+                                           cachedTris, &cachedInstIds);
 
         // Z window for vertical gating
         float capMinZWorld, capMaxZWorld;
@@ -2254,7 +2605,8 @@ int SceneQuery::SweepCapsule(uint32_t mapId,
                     G3D::Vector3(queryMaxX, queryMaxY, std::max(wP0.z, wP1.z) + capsuleStart.r));
                 std::vector<CapsuleCollision::Triangle> dynTris;
                 std::vector<uint32_t> dynInstanceIds;
-                dynReg->QueryTriangles(mapId, dynAABB, dynTris, &dynInstanceIds);
+                if (!contactCache || !contactCache->QueryDynamic(dynReg, mapId, dynAABB, dynTris, &dynInstanceIds))
+                    dynReg->QueryTriangles(mapId, dynAABB, dynTris, &dynInstanceIds);
                 for (size_t di = 0; di < dynTris.size(); ++di)
                 {
                     CapsuleCollision::Hit chD;
@@ -2292,10 +2644,19 @@ int SceneQuery::SweepCapsule(uint32_t mapId,
     }
     // ---- End Scene Cache fast path ----
 
-    // Acquire map tree from injected manager
+    // Acquire map tree from injected manager, with the tiles the sweep can reach loaded
     const VMAP::StaticMapTree* map = nullptr;
     if (m_vmapManager)
+    {
+        G3D::Vector3 sweepP0(capsuleStart.p0.x, capsuleStart.p0.y, capsuleStart.p0.z);
+        G3D::Vector3 sweepP1(capsuleStart.p1.x, capsuleStart.p1.y, capsuleStart.p1.z);
+        G3D::Vector3 pad(capsuleStart.r + 1.0f, capsuleStart.r + 1.0f, capsuleStart.r + 1.0f);
+        G3D::Vector3 sweepEnd = dir * std::max(distance, 0.0f);
+        G3D::Vector3 wLo = sweepP0.min(sweepP1).min((sweepP0 + sweepEnd).min(sweepP1 + sweepEnd)) - pad;
+        G3D::Vector3 wHi = sweepP0.max(sweepP1).max((sweepP0 + sweepEnd).max(sweepP1 + sweepEnd)) + pad;
+        m_vmapManager->ensureTilesLoaded(mapId, G3D::AABox(wLo, wHi));
         map = m_vmapManager->GetStaticMapTree(mapId);
+    }
     if (!map) {
         outHits.clear();
         return 0;
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <string>
 #include <mutex>
+#include <memory>
 #include <unordered_map>
 #include "Vector3.h"
 #include "AABox.h"
@@ -183,6 +184,7 @@ class SceneQuery
         // Inject an externally-managed MapLoader (for test contexts where
         // SceneQuery::Initialize() can't auto-discover the maps directory).
         static void SetMapLoader(MapLoader* loader) { m_mapLoader = loader; }
+        static MapLoader* GetMapLoader() { return m_mapLoader; }
 
         // Unified liquid info result used by liquid evaluation helpers
         struct LiquidInfo
@@ -292,6 +294,18 @@ class SceneQuery
         static float GetWalkableGroundZ(uint32_t mapId, float x, float y, float z,
                                         float maxSearchDist, float walkableMinNormalZ);
 
+        // Batched forms of GetGroundZ / GetWalkableGroundZ / LineOfSight for
+        // path validation and tile audits: out[i] is exactly what the single
+        // query returns for element i. Queries are visited in spatial order
+        // and the scene-cache and VMAP work is spread over worker threads,
+        // VMAP rays traced as BIH ray packets.
+        static void GetGroundZBatch(uint32_t mapId, const G3D::Vector3* points, int count,
+                                    float maxSearchDist, float* outZ);
+        static void GetWalkableGroundZBatch(uint32_t mapId, const G3D::Vector3* points, int count,
+                                            float maxSearchDist, float walkableMinNormalZ, float* outZ);
+        static void LineOfSightBatch(uint32_t mapId, const G3D::Vector3* from, const G3D::Vector3* to,
+                                     int count, bool* outClear);
+
         // Query VMAP area/group flags at a world position when full VMAP data is available.
         // Returns false when the map has no VMAP tree loaded (for example scene-slice-only bots).
         static bool GetAreaInfo(uint32_t mapId,
@@ -315,10 +329,25 @@ class SceneQuery
             float radius);
 
         // --- Scene Cache (pre-processed collision geometry) ---
+        // SetSceneCache takes ownership and publishes the cache atomically;
+        // GetSceneCache returns a snapshot that stays valid even if the map's
+        // cache is replaced or cleared while the caller is using it.
         static void SetSceneCache(uint32_t mapId, SceneCache* cache);
-        static SceneCache* GetSceneCache(uint32_t mapId);
+        static std::shared_ptr<SceneCache> GetSceneCache(uint32_t mapId);
+        // Tile-keyed injection: add (or replace) one tile of a map's injected
+        // geometry, or drop one, without touching the map's other tiles. Only
+        // the given tile is indexed. A map whose cache did not come from
+        // InjectSceneTile starts a fresh tiled cache.
+        static void InjectSceneTile(uint32_t mapId, int tileX, int tileY, SceneCache* tile);
+        static bool EvictSceneTile(uint32_t mapId, int tileX, int tileY);
+        // True while the map's published cache holds the tile from InjectSceneTile
+        static bool HasInjectedSceneTile(uint32_t mapId, int tileX, int tileY);
         static void ClearSceneCaches();
         static void ClearSceneCache(uint32_t mapId);
+        // Bumped whenever a map's published scene cache is set, replaced,
+        // re-tiled or cleared. Streamed tiles paging in and out do not count:
+        // they reload the same geometry.
+        static uint64_t GetSceneGeneration(uint32_t mapId);
         static void SetSceneAutoloadEnabled(bool enabled) { m_sceneAutoloadEnabled = enabled; }
         static bool IsSceneAutoloadEnabled() { return m_sceneAutoloadEnabled; }
         // Scene slice mode removed — Physics.dll (PHYSICS_DLL_ONLY) has no VMAP/mmap
@@ -329,6 +358,18 @@ class SceneQuery
         static void SetScenesDir(const std::string& dir) { m_scenesDir = dir; }
         static const std::string& GetScenesDir() { return m_scenesDir; }
 
+        // Tile streaming: maps with <scenesDir>/tiles/<mapId>_XX_YY.scenetile files
+        // load per-tile caches on demand instead of one whole-map .scene.
+        // Prefetch queues background loads around a bot and along its velocity;
+        // it is a no-op for maps that are not streamed.
+        static void PrefetchSceneTiles(uint32_t mapId, float x, float y, float vx, float vy);
+        // Per-map resident byte budget for streamed tiles (applies to maps
+        // already streaming and to ones loaded later).
+        static void SetSceneTileMemoryBudget(size_t bytes);
+        // Resident byte budget for ADT (.map) tiles held by the MapLoader,
+        // kept for a loader created later (0 = MapLoader default).
+        static void SetMapTileMemoryBudget(size_t bytes);
+
         // BIH-based ground Z query: uses AABB overlap against the BIH tree to find
         // walkable triangles when getHeight's downward ray misses (e.g. WMO interiors).
         static float GetGroundZByBIH(const VMAP::StaticMapTree* map, float x, float y, float z, float maxSearchDist);
@@ -341,16 +382,33 @@ class SceneQuery
         static float GetDynamicGroundZ(uint32_t mapId, float x, float y, float z, float maxSearchDist);
 
     private:
+        // GetGroundZ stages. The scene-cache stage (scene + dynamic objects)
+        // may run concurrently; returns false when the map data stage has to
+        // answer instead. The map data stage (VMAP + ADT + BIH) may not.
+        static bool TryGetSceneGroundZ(const SceneCache& cache, uint32_t mapId, float x, float y, float z,
+                                       float maxSearchDist, float& outZ);
+        static float GetGroundZFromMapData(uint32_t mapId, float x, float y, float z, float maxSearchDist);
+        // Same, with the VMAP height at (x, y, z) already traced by the caller.
+        static float GetGroundZFromMapData(uint32_t mapId, float x, float y, float z, float maxSearchDist, float vmapZ);
+
+        // LineOfSight stages: VMAP models, then ADT terrain and dynamic
+        // objects. Both may run concurrently once the VMAP map is initialized.
+        static bool IsVmapLineOfSightClear(uint32_t mapId, const G3D::Vector3& from, const G3D::Vector3& to);
+        static bool IsTerrainAndDynamicLineOfSightClear(uint32_t mapId, const G3D::Vector3& from, const G3D::Vector3& to);
+
         inline static VMAP::VMapManager2* m_vmapManager = nullptr;
         inline static MapLoader* m_mapLoader = nullptr;
         inline static bool m_initialized = false;
         inline static bool m_sceneAutoloadEnabled = true;
         // m_sceneSliceMode removed — Physics.dll naturally has no VMAP/mmap data
         inline static std::string m_scenesDir;
+        inline static size_t m_sceneTileMemoryBudget = 0;   // 0 = SceneTileStreamer default
+        inline static size_t m_mapTileMemoryBudget = 0;     // 0 = MapLoader default
 
         // Per-map scene caches (pre-processed collision geometry)
         // Protected by m_sceneCachesMutex — accessed concurrently by ProtobufSocketServer client threads
         inline static std::recursive_mutex m_sceneCachesMutex;
-        inline static std::unordered_map<uint32_t, SceneCache*> m_sceneCaches;
+        inline static std::unordered_map<uint32_t, std::shared_ptr<SceneCache>> m_sceneCaches;
+        inline static std::unordered_map<uint32_t, uint64_t> m_sceneGenerations;
 
 };
@@ -0,0 +1,376 @@
+// SceneTileStreamer.cpp - On-demand / background loading of per-tile SceneCaches.
+
+#include "SceneTileStreamer.h"
+#include "SceneCache.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+SceneTileStreamer::SceneTileStreamer(uint32_t mapId, std::string tilesDir)
+    : m_mapId(mapId), m_tilesDir(std::move(tilesDir)),
+      m_slots(std::make_unique<TileSlot[]>(TILES_PER_MAP * TILES_PER_MAP))
+{
+}
+
+SceneTileStreamer::~SceneTileStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_worker.joinable())
+        m_worker.join();
+
+    // No reader can be running any more
+    for (auto& [key, entry] : m_tiles)
+        delete entry;
+    for (auto& [epoch, entry] : m_retired)
+        delete entry;
+}
+
+bool SceneTileStreamer::HasTilesForMap(const std::string& tilesDir, uint32_t mapId)
+{
+    std::error_code ec;
+    if (tilesDir.empty() || !std::filesystem::is_directory(tilesDir, ec))
+        return false;
+
+    const std::string prefix = std::to_string(mapId) + "_";
+    for (const auto& entry : std::filesystem::directory_iterator(tilesDir, ec))
+    {
+        const std::filesystem::path& p = entry.path();
+        if (p.extension() == ".scenetile" && p.filename().string().rfind(prefix, 0) == 0)
+            return true;
+    }
+    return false;
+}
+
+std::string SceneTileStreamer::TilePath(int tileX, int tileY) const
+{
+    char name[64];
+    snprintf(name, sizeof(name), "%u_%02d_%02d.scenetile", m_mapId, tileX, tileY);
+    return m_tilesDir + name;
+}
+
+std::shared_ptr<const SceneCache> SceneTileStreamer::LoadTile(int tileX, int tileY) const
+{
+    const std::string path = TilePath(tileX, tileY);
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec))
+        return nullptr;
+
+    SceneCache* cache = SceneCache::LoadFromFile(path.c_str());
+    if (!cache)
+    {
+        fprintf(stderr, "[SceneTileStreamer] Failed to load %s\n", path.c_str());
+        return nullptr;
+    }
+    return std::shared_ptr<const SceneCache>(cache);
+}
+
+std::shared_ptr<const SceneCache> SceneTileStreamer::TryAcquireResident(uint32_t key, bool* known) const
+{
+    TileSlot& slot = Slot(key);
+    EpochReclaim::ReadGuard guard;
+    if (const TileEntry* entry = slot.entry.load(std::memory_order_acquire))
+    {
+        slot.lastUse.store(m_useClock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        *known = true;
+        return entry->cache;
+    }
+    *known = slot.missing.load(std::memory_order_acquire);
+    return nullptr;
+}
+
+void SceneTileStreamer::AcquireTiles(float minX, float minY, float maxX, float maxY, std::vector<SceneTileRef>& out)
+{
+    // World X grows as tileX shrinks, so the max corner gives the low index.
+    int txLo = std::max(0, WorldToTileX(maxX));
+    int txHi = std::min(TILES_PER_MAP - 1, WorldToTileX(minX));
+    int tyLo = std::max(0, WorldToTileY(maxY));
+    int tyHi = std::min(TILES_PER_MAP - 1, WorldToTileY(minY));
+    if (txLo > txHi || tyLo > tyHi)
+        return;
+
+    // Resident and known-missing tiles are answered without the lock; only
+    // the rest are loaded (and the budget enforced) under it.
+    std::vector<uint32_t> unknown;
+    const size_t firstOut = out.size();
+    for (int tx = txLo; tx <= txHi; ++tx)
+    {
+        for (int ty = tyLo; ty <= tyHi; ++ty)
+        {
+            const uint32_t key = MakeKey(tx, ty);
+            bool known = false;
+            if (auto cache = TryAcquireResident(key, &known))
+                out.push_back({ tx, ty, std::move(cache) });
+            else if (!known)
+                unknown.push_back(key);
+        }
+    }
+    if (unknown.empty())
+        return;
+
+    std::unordered_set<uint32_t> pinned;
+    for (size_t i = firstOut; i < out.size(); ++i)
+        pinned.insert(MakeKey(out[i].tileX, out[i].tileY));
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (uint32_t key : unknown)
+    {
+        pinned.insert(key);
+        if (auto cache = EnsureResidentLocked(key, lock))
+            out.push_back({ static_cast<int>(key >> 16), static_cast<int>(key & 0xFFFF), std::move(cache) });
+    }
+
+    EvictOverBudgetLocked(pinned);
+}
+
+std::shared_ptr<const SceneCache> SceneTileStreamer::AcquireTileAt(float x, float y)
+{
+    const int tx = WorldToTileX(x);
+    const int ty = WorldToTileY(y);
+    if (tx < 0 || tx >= TILES_PER_MAP || ty < 0 || ty >= TILES_PER_MAP)
+        return nullptr;
+
+    const uint32_t key = MakeKey(tx, ty);
+    bool known = false;
+    if (auto cache = TryAcquireResident(key, &known); cache || known)
+        return cache;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    std::shared_ptr<const SceneCache> cache = EnsureResidentLocked(key, lock);
+    EvictOverBudgetLocked({ key });
+    return cache;
+}
+
+void SceneTileStreamer::Prefetch(float x, float y, float vx, float vy)
+{
+    const float aheadX = x + vx * PREFETCH_LOOKAHEAD_SEC;
+    const float aheadY = y + vy * PREFETCH_LOOKAHEAD_SEC;
+    const float minX = std::min(x, aheadX) - PREFETCH_RADIUS;
+    const float maxX = std::max(x, aheadX) + PREFETCH_RADIUS;
+    const float minY = std::min(y, aheadY) - PREFETCH_RADIUS;
+    const float maxY = std::max(y, aheadY) + PREFETCH_RADIUS;
+
+    int txLo = std::max(0, WorldToTileX(maxX));
+    int txHi = std::min(TILES_PER_MAP - 1, WorldToTileX(minX));
+    int tyLo = std::max(0, WorldToTileY(maxY));
+    int tyHi = std::min(TILES_PER_MAP - 1, WorldToTileY(minY));
+
+    // Refresh resident tiles without the lock; queue the rest under it
+    std::vector<uint32_t> unknown;
+    for (int tx = txLo; tx <= txHi; ++tx)
+    {
+        for (int ty = tyLo; ty <= tyHi; ++ty)
+        {
+            const uint32_t key = MakeKey(tx, ty);
+            bool known = false;
+            if (!TryAcquireResident(key, &known) && !known)
+                unknown.push_back(key);
+        }
+    }
+    if (unknown.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool queued = false;
+    for (uint32_t key : unknown)
+    {
+        if (m_tiles.count(key) || Slot(key).missing.load(std::memory_order_relaxed))
+            continue;
+        EnqueueLocked(static_cast<int>(key >> 16), static_cast<int>(key & 0xFFFF));
+        queued = true;
+    }
+
+    if (queued)
+    {
+        EnsureWorkerLocked();
+        m_cv.notify_one();
+    }
+}
+
+void SceneTileStreamer::GetResidentTiles(std::vector<SceneTileRef>& out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& [key, entry] : m_tiles)
+        out.push_back({ static_cast<int>(key >> 16), static_cast<int>(key & 0xFFFF), entry->cache });
+}
+
+void SceneTileStreamer::SetMemoryBudget(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = bytes;
+    EvictOverBudgetLocked({});
+}
+
+size_t SceneTileStreamer::GetMemoryBudget() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_budget;
+}
+
+size_t SceneTileStreamer::GetResidentBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_residentBytes;
+}
+
+size_t SceneTileStreamer::GetResidentTileCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tiles.size();
+}
+
+SceneTileStreamer::Stats SceneTileStreamer::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.residentTiles = m_tiles.size();
+    stats.residentBytes = m_residentBytes;
+    stats.budget = m_budget;
+    stats.missingTiles = m_missingTiles;
+    stats.loads = m_loadCount;
+    stats.evictions = m_evictionCount;
+    return stats;
+}
+
+std::shared_ptr<const SceneCache> SceneTileStreamer::EnsureResidentLocked(uint32_t key, std::unique_lock<std::mutex>& lock)
+{
+    while (true)
+    {
+        auto it = m_tiles.find(key);
+        if (it != m_tiles.end())
+        {
+            Slot(key).lastUse.store(m_useClock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return it->second->cache;
+        }
+        if (Slot(key).missing.load(std::memory_order_relaxed))
+            return nullptr;
+
+        if (m_loading.count(key))
+        {
+            // Another thread is already reading it; wait rather than load twice.
+            // Loop afterwards in case it was evicted again before we woke.
+            m_loadedCv.wait(lock, [&] { return !m_loading.count(key); });
+            continue;
+        }
+
+        m_loading.insert(key);
+        lock.unlock();
+        std::shared_ptr<const SceneCache> cache = LoadTile(static_cast<int>(key >> 16), static_cast<int>(key & 0xFFFF));
+        lock.lock();
+        m_loading.erase(key);
+        InsertLocked(key, std::move(cache));
+        m_loadedCv.notify_all();
+    }
+}
+
+void SceneTileStreamer::InsertLocked(uint32_t key, std::shared_ptr<const SceneCache> cache)
+{
+    TileSlot& slot = Slot(key);
+    if (!cache)
+    {
+        // Remember the missing file in the slot; the grid bounds how many
+        if (!slot.missing.exchange(true, std::memory_order_release))
+            ++m_missingTiles;
+        return;
+    }
+
+    auto* entry = new TileEntry();
+    entry->bytes = cache->GetMemoryUsage();
+    entry->cache = std::move(cache);
+    m_residentBytes += entry->bytes;
+    m_tiles[key] = entry;
+    ++m_loadCount;
+    slot.lastUse.store(m_useClock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    slot.entry.store(entry, std::memory_order_release);
+}
+
+void SceneTileStreamer::EvictOverBudgetLocked(const std::unordered_set<uint32_t>& pinned)
+{
+    while (m_residentBytes > m_budget)
+    {
+        auto victim = m_tiles.end();
+        uint64_t victimUse = 0;
+        for (auto it = m_tiles.begin(); it != m_tiles.end(); ++it)
+        {
+            if (pinned.count(it->first))
+                continue;
+            const uint64_t use = Slot(it->first).lastUse.load(std::memory_order_relaxed);
+            if (victim == m_tiles.end() || use < victimUse)
+            {
+                victim = it;
+                victimUse = use;
+            }
+        }
+        if (victim == m_tiles.end())
+            break; // everything left is in use by the current query
+
+        // Queries that already copied the cache keep their snapshot
+        TileEntry* entry = victim->second;
+        Slot(victim->first).entry.store(nullptr);
+        m_residentBytes -= entry->bytes;
+        m_tiles.erase(victim);
+        m_retired.emplace_back(EpochReclaim::RetireEpoch(), entry);
+        ++m_evictionCount;
+    }
+    ReclaimLocked();
+}
+
+void SceneTileStreamer::ReclaimLocked()
+{
+    if (m_retired.empty())
+        return;
+
+    const uint64_t oldest = EpochReclaim::OldestActiveEpoch();
+    auto keep = std::remove_if(m_retired.begin(), m_retired.end(), [&](const std::pair<uint64_t, TileEntry*>& retired) {
+        if (retired.first > oldest)
+            return false;
+        delete retired.second;
+        return true;
+    });
+    m_retired.erase(keep, m_retired.end());
+}
+
+void SceneTileStreamer::EnqueueLocked(int tileX, int tileY)
+{
+    const uint32_t key = MakeKey(tileX, tileY);
+    if (m_loading.count(key) || std::find(m_queue.begin(), m_queue.end(), key) != m_queue.end())
+        return;
+    m_queue.push_back(key);
+}
+
+void SceneTileStreamer::EnsureWorkerLocked()
+{
+    if (!m_worker.joinable())
+        m_worker = std::thread(&SceneTileStreamer::WorkerLoop, this);
+}
+
+void SceneTileStreamer::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+        if (m_stop)
+            return;
+
+        const uint32_t key = m_queue.front();
+        m_queue.pop_front();
+        if (m_tiles.count(key) || m_loading.count(key) || Slot(key).missing.load(std::memory_order_relaxed))
+            continue;
+
+        m_loading.insert(key);
+        lock.unlock();
+        std::shared_ptr<const SceneCache> cache = LoadTile(static_cast<int>(key >> 16), static_cast<int>(key & 0xFFFF));
+        lock.lock();
+        m_loading.erase(key);
+        InsertLocked(key, std::move(cache));
+        m_loadedCv.notify_all();
+
+        // Prefetched tiles are the first to go if they push us over budget,
+        // except the one just loaded.
+        EvictOverBudgetLocked({ key });
+    }
+}
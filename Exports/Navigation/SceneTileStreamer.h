@@ -0,0 +1,163 @@
+#pragma once
+
+// SceneTileStreamer.h - Per-map streaming of ADT-tile-sized SceneCaches.
+// Tiles live in <scenesDir>/tiles/<mapId>_<tileX:02>_<tileY:02>.scenetile (same
+// binary format as .scene) and are loaded on demand or ahead of bots by a
+// background worker. Resident tiles are evicted least-recently-used once the
+// map exceeds its memory budget. Callers receive shared_ptr snapshots, so an
+// evicted tile stays valid until the last in-flight query releases it.
+//
+// Every tile of the 64x64 grid has a fixed slot that publishes its resident
+// entry atomically, so queries that hit a resident tile (or one already known
+// to have no file) take no lock. Loads, evictions and the byte accounting are
+// serialized on m_mutex; an evicted entry is retired and freed once no reader
+// can still see it (EpochReclaim.h, as MapLoader does). A tile without a file
+// is remembered by a flag in its slot, so missing tiles cost no map entries.
+//
+// SceneQuery::EnsureMapLoaded prefers a map's .scenetile files over a
+// whole-map .scene whenever tiles/ holds at least one tile for the map.
+//
+// Tile coordinates follow the SceneDataService / MaNGOS convention:
+//   tileX = 32 - floor(worldX / TILE_SIZE), tileY = 32 - floor(worldY / TILE_SIZE)
+
+#include <atomic>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <unordered_map>
+#include <unordered_set>
+#include "EpochReclaim.h"
+
+class SceneCache;
+
+struct SceneTileRef
+{
+    int tileX = 0;
+    int tileY = 0;
+    std::shared_ptr<const SceneCache> cache;
+};
+
+class SceneTileStreamer
+{
+public:
+    static constexpr float TILE_SIZE = 533.33333f;
+    static constexpr int TILES_PER_MAP = 64;
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 512ull * 1024ull * 1024ull;
+
+    // Prefetch window: tiles within PREFETCH_RADIUS of the bot and of the
+    // point it reaches after PREFETCH_LOOKAHEAD_SEC at its current velocity.
+    static constexpr float PREFETCH_RADIUS = 160.0f;
+    static constexpr float PREFETCH_LOOKAHEAD_SEC = 8.0f;
+
+    SceneTileStreamer(uint32_t mapId, std::string tilesDir);
+    ~SceneTileStreamer();
+
+    SceneTileStreamer(const SceneTileStreamer&) = delete;
+    SceneTileStreamer& operator=(const SceneTileStreamer&) = delete;
+
+    // True when tilesDir holds at least one tile file for mapId.
+    static bool HasTilesForMap(const std::string& tilesDir, uint32_t mapId);
+
+    static int WorldToTileX(float worldX) { return 32 - static_cast<int>(std::floor(worldX / TILE_SIZE)); }
+    static int WorldToTileY(float worldY) { return 32 - static_cast<int>(std::floor(worldY / TILE_SIZE)); }
+    static float TileMinX(int tileX) { return (32 - tileX) * TILE_SIZE; }
+    static float TileMinY(int tileY) { return (32 - tileY) * TILE_SIZE; }
+    static uint32_t MakeKey(int tileX, int tileY) { return (static_cast<uint32_t>(tileX) << 16) | static_cast<uint32_t>(tileY); }
+
+    uint32_t GetMapId() const { return m_mapId; }
+
+    // Make every tile overlapping the XY box resident (loading synchronously
+    // when the worker has not got there yet) and append them to out. Tiles
+    // without a file on disk are skipped.
+    void AcquireTiles(float minX, float minY, float maxX, float maxY, std::vector<SceneTileRef>& out);
+
+    // Single-tile variant for point probes; null when (x,y) has no tile file.
+    std::shared_ptr<const SceneCache> AcquireTileAt(float x, float y);
+
+    // Queue background loads around (x,y) and along the velocity lookahead.
+    // Cheap when everything is already resident; never blocks on file I/O.
+    void Prefetch(float x, float y, float vx, float vy);
+
+    // Resident tiles right now (no loading).
+    void GetResidentTiles(std::vector<SceneTileRef>& out) const;
+
+    void SetMemoryBudget(size_t bytes);
+    size_t GetMemoryBudget() const;
+    size_t GetResidentBytes() const;
+    size_t GetResidentTileCount() const;
+
+    struct Stats
+    {
+        size_t residentTiles = 0;
+        size_t residentBytes = 0;
+        size_t budget = 0;
+        size_t missingTiles = 0;    // tiles looked up that have no file
+        uint64_t loads = 0;
+        uint64_t evictions = 0;
+    };
+    Stats GetStats() const;
+
+private:
+    // Immutable once published
+    struct TileEntry
+    {
+        std::shared_ptr<const SceneCache> cache;
+        size_t bytes = 0;
+    };
+
+    struct TileSlot
+    {
+        std::atomic<TileEntry*> entry{ nullptr };   // null unless resident
+        std::atomic<uint64_t> lastUse{ 0 };
+        std::atomic<bool> missing{ false };         // no file on disk
+    };
+
+    static size_t SlotIndex(uint32_t key) { return (key >> 16) * TILES_PER_MAP + (key & 0xFFFF); }
+    TileSlot& Slot(uint32_t key) const { return m_slots[SlotIndex(key)]; }
+
+    // Resident cache of key with its use stamp refreshed, or null when the
+    // tile is not resident; *known is set when the tile is resident or has
+    // no file. Takes no lock.
+    std::shared_ptr<const SceneCache> TryAcquireResident(uint32_t key, bool* known) const;
+
+    std::string TilePath(int tileX, int tileY) const;
+    std::shared_ptr<const SceneCache> LoadTile(int tileX, int tileY) const;
+
+    // All helpers below expect m_mutex to be held.
+    // Load key if needed (dropping the lock around file I/O) and return its
+    // cache with lastUse refreshed; null when the tile has no file.
+    std::shared_ptr<const SceneCache> EnsureResidentLocked(uint32_t key, std::unique_lock<std::mutex>& lock);
+    void InsertLocked(uint32_t key, std::shared_ptr<const SceneCache> cache);
+    void EvictOverBudgetLocked(const std::unordered_set<uint32_t>& pinned);
+    // Frees retired entries no reader can still hold.
+    void ReclaimLocked();
+    void EnqueueLocked(int tileX, int tileY);
+    void EnsureWorkerLocked();
+    void WorkerLoop();
+
+    uint32_t m_mapId;
+    std::string m_tilesDir;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;           // work queued / stop requested
+    std::condition_variable m_loadedCv;     // a load finished
+    std::unique_ptr<TileSlot[]> m_slots;
+    std::unordered_map<uint32_t, TileEntry*> m_tiles;   // published entries (writer-side index)
+    std::vector<std::pair<uint64_t, TileEntry*>> m_retired;   // unpublished entries and their retire epoch
+    std::unordered_set<uint32_t> m_loading;
+    std::deque<uint32_t> m_queue;
+    std::thread m_worker;
+    bool m_stop = false;
+    mutable std::atomic<uint64_t> m_useClock{ 0 };
+    size_t m_budget = DEFAULT_MEMORY_BUDGET;
+    size_t m_residentBytes = 0;
+    size_t m_missingTiles = 0;
+    uint64_t m_loadCount = 0;
+    uint64_t m_evictionCount = 0;
+};
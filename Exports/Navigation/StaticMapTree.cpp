@@ -13,9 +13,22 @@
 #include <vector>
 #include "CapsuleCollision.h"
 #include "CoordinateTransforms.h"
+#include "ParallelFor.h"
+#include <cmath>
+#include <unordered_set>
 
 namespace VMAP
 {
+    // .vmtile grid. As with the ADT grid (see MmapGen's TerrainBuilder), a
+    // tile's first index runs along internal Y and its second along internal X.
+    static const uint32_t TILES_PER_SIDE = 64;
+    static const float TILE_SIZE = 533.33333f;
+
+    // Last-use stamps of resident tiles, shared by all maps so eviction can
+    // compare tiles of different maps
+    static std::atomic<uint64_t> sTileUseClock{ 0 };
+    static uint64_t NextTileUse() { return sTileUseClock.fetch_add(1, std::memory_order_relaxed) + 1; }
+
     // Helper: squared distance from point to AABox
     static inline float PointToAABBDistSq(const G3D::Vector3& p, const G3D::AABox& box)
     {
@@ -120,14 +133,19 @@ namespace VMAP
     };
 
     StaticMapTree::StaticMapTree(uint32_t mapId, const std::string& basePath)
-        : iMapID(mapId), iBasePath(basePath), iIsTiled(false), iTreeValues(nullptr), iNTreeValues(0)
+        : iMapID(mapId), iBasePath(basePath), iIsTiled(false), iTreeValues(nullptr), iNTreeValues(0),
+        iVMapManager(nullptr), iLazyTiles(false), iTileResolved(new std::atomic<bool>[TILES_PER_SIDE * TILES_PER_SIDE]),
+        iAllTilesResolved(false), iResidentModelBytes(0), iResidencyGeneration(0)
     {
+        for (uint32_t i = 0; i < TILES_PER_SIDE * TILES_PER_SIDE; ++i)
+            iTileResolved[i].store(false, std::memory_order_relaxed);
         if (!iBasePath.empty() && iBasePath.back() != '/' && iBasePath.back() != '\\') iBasePath += "/";
     }
     StaticMapTree::~StaticMapTree() { UnloadMap(nullptr); delete[] iTreeValues; }
 
     bool StaticMapTree::InitMap(const std::string& fname, VMapManager2* vm)
     {
+        iVMapManager = vm; iLazyTiles = vm && vm->isLazyTileLoading();
         bool success = true; std::string fullPath = iBasePath + fname; FILE* rf = fopen(fullPath.c_str(), "rb"); if (!rf) return false; char chunk[8];
         if (!readChunk(rf, chunk, VMAP_MAGIC, 8)) success = false; char tiled = 0; if (success && fread(&tiled, sizeof(char), 1, rf) != 1) success = false; iIsTiled = bool(tiled);
         if (success && !readChunk(rf, chunk, "NODE", 4)) success = false; if (success) success = iTree.readFromFile(rf);
@@ -137,32 +155,300 @@ namespace VMAP
         {
             ModelSpawn spawn; while (ModelSpawn::readFromFile(rf, spawn))
             {
-                std::shared_ptr<WorldModel> model = nullptr; if (!spawn.name.empty()) { model = vm->acquireModelInstance(iBasePath, spawn.name); if (model) model->setModelFlags(spawn.flags); }
+                std::shared_ptr<const WorldModel> model = nullptr; if (!spawn.name.empty()) model = vm->acquireModelInstance(iBasePath, spawn.name);
                 uint32_t referencedVal; if (fread(&referencedVal, sizeof(uint32_t), 1, rf) != 1) break; uint32_t mapped = iTree.mapObjectIndex(referencedVal); if (mapped == 0xFFFFFFFFu) continue; if (!iLoadedSpawns.count(mapped)) { if (mapped >= iNTreeValues) continue; iTreeValues[mapped] = ModelInstance(spawn, model); iLoadedSpawns[mapped] = 1; }
                 else { ++iLoadedSpawns[mapped]; }
             }
         }
-        fclose(rf); if (success && iIsTiled) { PreloadAllTiles(vm); } return success;
+        fclose(rf); if (success && iIsTiled && !iLazyTiles) { PreloadAllTiles(vm); } return success;
     }
 
     bool StaticMapTree::PreloadAllTiles(VMapManager2* vm)
     {
-        if (!iIsTiled) return true; int tilesLoaded = 0, tilesFailed = 0; for (uint32_t x = 0; x < 64; ++x) for (uint32_t y = 0; y < 64; ++y) { std::string tilefile = getTileFileName(iMapID, x, y); std::string fullPath = iBasePath + tilefile; if (std::filesystem::exists(fullPath)) { if (LoadMapTile(x, y, vm)) tilesLoaded++; else { tilesFailed++; std::cerr << "[StaticMapTree] Failed to load tile " << tilefile << std::endl; } } } size_t totalModels = 0; for (uint32_t i = 0; i < iNTreeValues; ++i) if (iTreeValues[i].iModel) totalModels++; return tilesFailed == 0;
+        if (!iIsTiled) return true;
+
+        // 1) Read every tile file not resolved yet into its own slot
+        struct TileData
+        {
+            bool pending = false;
+            TileFileStatus status = TileFileStatus::Missing;
+            std::vector<TileSpawn> spawns;
+        };
+        const uint32_t tileCount = TILES_PER_SIDE * TILES_PER_SIDE;
+        std::vector<TileData> tiles(tileCount);
+        Parallel::For(tileCount, [&](size_t i)
+        {
+            if (iTileResolved[i].load(std::memory_order_acquire)) return;
+            tiles[i].pending = true;
+            tiles[i].status = ReadTileSpawns(uint32_t(i / TILES_PER_SIDE), uint32_t(i % TILES_PER_SIDE), tiles[i].spawns);
+        });
+
+        // 2) Parse each model those tiles reference once, also in parallel
+        std::vector<std::string> names;
+        std::unordered_set<std::string> seen;
+        for (const TileData& tile : tiles)
+            for (const TileSpawn& ts : tile.spawns)
+                if (!ts.spawn.name.empty() && seen.insert(ts.spawn.name).second) names.push_back(ts.spawn.name);
+        std::vector<std::shared_ptr<const WorldModel>> loaded(names.size());
+        Parallel::For(names.size(), [&](size_t i) { loaded[i] = vm->acquireModelInstance(iBasePath, names[i]); });
+        std::unordered_map<std::string, std::shared_ptr<const WorldModel>> models;
+        for (size_t i = 0; i < names.size(); ++i) models.emplace(names[i], loaded[i]);
+
+        // 3) Merge in tile order, holding the lock for one tile at a time
+        int tilesFailed = 0;
+        for (uint32_t i = 0; i < tileCount; ++i)
+        {
+            if (!tiles[i].pending) continue;
+            uint32_t x = i / TILES_PER_SIDE, y = i % TILES_PER_SIDE;
+            std::lock_guard<std::mutex> lock(iTileLoadLock);
+            if (iTileResolved[i].load(std::memory_order_relaxed)) continue; // paged in by a query meanwhile
+            if (tiles[i].status == TileFileStatus::Missing) { MarkTileResolved(x, y); continue; }
+            if (!MergeTile(x, y, tiles[i].status, tiles[i].spawns, vm, &models))
+            {
+                tilesFailed++;
+                std::cerr << "[StaticMapTree] Failed to load tile " << getTileFileName(iMapID, x, y) << std::endl;
+            }
+        }
+        iAllTilesResolved.store(true, std::memory_order_release);
+        return tilesFailed == 0;
+    }
+
+    StaticMapTree::TileFileStatus StaticMapTree::ReadTileSpawns(uint32_t tileX, uint32_t tileY, std::vector<TileSpawn>& spawns) const
+    {
+        std::string fullPath = iBasePath + getTileFileName(iMapID, tileX, tileY);
+        if (!std::filesystem::exists(fullPath)) return TileFileStatus::Missing;
+        FILE* rf = fopen(fullPath.c_str(), "rb");
+        if (!rf) return TileFileStatus::Unreadable;
+
+        bool success = true; char chunk[8]; uint32_t numSpawns = 0;
+        if (!readChunk(rf, chunk, VMAP_MAGIC, 8) || fread(&numSpawns, sizeof(uint32_t), 1, rf) != 1) success = false;
+        for (uint32_t i = 0; i < numSpawns && success; ++i)
+        {
+            TileSpawn ts; uint32_t referencedVal;
+            if (!ModelSpawn::readFromFile(rf, ts.spawn) || fread(&referencedVal, sizeof(uint32_t), 1, rf) != 1 || !iTreeValues) { success = false; break; }
+            ts.mapped = iTree.mapObjectIndex(referencedVal);
+            if (ts.mapped == 0xFFFFFFFFu || ts.mapped >= iNTreeValues) continue;
+            spawns.push_back(std::move(ts));
+        }
+        fclose(rf);
+        return success ? TileFileStatus::Ok : TileFileStatus::Truncated;
+    }
+
+    bool StaticMapTree::MergeTile(uint32_t tileX, uint32_t tileY, TileFileStatus status, const std::vector<TileSpawn>& spawns,
+        VMapManager2* vm, const std::unordered_map<std::string, std::shared_ptr<const WorldModel>>* models)
+    {
+        uint32_t tileID = packTileID(tileX, tileY);
+        ResidentTile& resident = iResidentTiles[tileID];
+        std::unordered_set<const WorldModel*> counted;
+        for (const auto& [model, bytes] : resident.models) counted.insert(model);
+        for (const TileSpawn& ts : spawns)
+        {
+            resident.spawns.push_back(ts.mapped);
+            auto loadedSpawn = iLoadedSpawns.find(ts.mapped);
+            if (loadedSpawn != iLoadedSpawns.end()) ++loadedSpawn->second;
+            else
+            {
+                std::shared_ptr<const WorldModel> model = nullptr;
+                if (!ts.spawn.name.empty())
+                {
+                    if (models && models->count(ts.spawn.name)) model = models->at(ts.spawn.name);
+                    else model = vm->acquireModelInstance(iBasePath, ts.spawn.name);
+                }
+                iTreeValues[ts.mapped] = ModelInstance(ts.spawn, model);
+                iLoadedSpawns[ts.mapped] = 1;
+            }
+            const WorldModel* model = iTreeValues[ts.mapped].iModel.get();
+            if (!model || !counted.insert(model).second) continue;
+            const size_t bytes = model->GetMemoryUsage();
+            resident.models.emplace_back(model, bytes);
+            if (++iModelTileRefs[model] == 1) iResidentModelBytes.fetch_add(bytes, std::memory_order_relaxed);
+        }
+        resident.lastUse = NextTileUse();
+        iResidencyGeneration.fetch_add(1, std::memory_order_relaxed);
+        if (status == TileFileStatus::Ok) iLoadedTiles[tileID] = true;
+        else if (status == TileFileStatus::Unreadable) iLoadedTiles[tileID] = false;
+        MarkTileResolved(tileX, tileY);
+        return status == TileFileStatus::Ok;
+    }
+
+    void StaticMapTree::MarkTileResolved(uint32_t tileX, uint32_t tileY)
+    {
+        if (tileX < TILES_PER_SIDE && tileY < TILES_PER_SIDE)
+            iTileResolved[tileX * TILES_PER_SIDE + tileY].store(true, std::memory_order_release);
     }
 
     bool StaticMapTree::LoadMapTile(uint32_t tileX, uint32_t tileY, VMapManager2* vm)
     {
-        if (!iIsTiled) { iLoadedTiles[packTileID(tileX, tileY)] = false; return true; } uint32_t tileID = packTileID(tileX, tileY); if (iLoadedTiles.find(tileID) != iLoadedTiles.end()) return true; std::string tilefile = getTileFileName(iMapID, tileX, tileY); std::string fullPath = iBasePath + tilefile; bool fileExists = std::filesystem::exists(fullPath); if (!fileExists) { iLoadedTiles[tileID] = false; return true; } auto fileSize = std::filesystem::file_size(fullPath); FILE* rf = fopen(fullPath.c_str(), "rb"); if (!rf) { iLoadedTiles[tileID] = false; return false; } bool success = true; char chunk[8]; if (!readChunk(rf, chunk, VMAP_MAGIC, 8)) success = false; if (success) { uint32_t numSpawns; if (fread(&numSpawns, sizeof(uint32_t), 1, rf) != 1) success = false; else { for (uint32_t i = 0; i < numSpawns && success; ++i) { ModelSpawn spawn; if (!ModelSpawn::readFromFile(rf, spawn)) { success = false; break; } uint32_t referencedVal; if (fread(&referencedVal, sizeof(uint32_t), 1, rf) != 1) { success = false; break; } if (!iTreeValues) { success = false; break; } uint32_t mapped = iTree.mapObjectIndex(referencedVal); if (mapped == 0xFFFFFFFFu) continue; if (mapped >= iNTreeValues) continue; if (!iLoadedSpawns.count(mapped)) { std::shared_ptr<WorldModel> model = nullptr; if (!spawn.name.empty()) { model = vm->acquireModelInstance(iBasePath, spawn.name); if (model) model->setModelFlags(spawn.flags); } iTreeValues[mapped] = ModelInstance(spawn, model); iLoadedSpawns[mapped] = 1; } else { ++iLoadedSpawns[mapped]; } } } }
-        fclose(rf); if (success) { iLoadedTiles[tileID] = true; int totalLoadedModels = 0; for (uint32_t i = 0; i < iNTreeValues; ++i) if (iTreeValues[i].iModel) totalLoadedModels++; } return success;
+        std::lock_guard<std::mutex> lock(iTileLoadLock);
+        uint32_t tileID = packTileID(tileX, tileY);
+        if (!iIsTiled) { iLoadedTiles[tileID] = false; return true; }
+        if (iLoadedTiles.find(tileID) != iLoadedTiles.end()) return true;
+        std::vector<TileSpawn> spawns;
+        TileFileStatus status = ReadTileSpawns(tileX, tileY, spawns);
+        if (status == TileFileStatus::Missing) { iLoadedTiles[tileID] = false; MarkTileResolved(tileX, tileY); return true; }
+        return MergeTile(tileX, tileY, status, spawns, vm, nullptr);
+    }
+
+    bool StaticMapTree::GetTileRange(const G3D::AABox& bounds, uint32_t& x0, uint32_t& x1, uint32_t& y0, uint32_t& y1)
+    {
+        const G3D::Vector3& lo = bounds.low();
+        const G3D::Vector3& hi = bounds.high();
+        if (std::isnan(lo.x) || std::isnan(lo.y) || std::isnan(hi.x) || std::isnan(hi.y)) return false;
+        auto tileIndex = [](float c) { return uint32_t(std::clamp(std::floor(c / TILE_SIZE), 0.0f, float(TILES_PER_SIDE - 1))); };
+        x0 = tileIndex(lo.y); x1 = tileIndex(hi.y); y0 = tileIndex(lo.x); y1 = tileIndex(hi.x);
+        return true;
+    }
+
+    void StaticMapTree::LoadTileLocked(uint32_t tileX, uint32_t tileY)
+    {
+        if (iTileResolved[tileX * TILES_PER_SIDE + tileY].load(std::memory_order_relaxed)) return;
+        if (iLoadedTiles.count(packTileID(tileX, tileY))) { MarkTileResolved(tileX, tileY); return; }
+        std::vector<TileSpawn> spawns;
+        TileFileStatus status = ReadTileSpawns(tileX, tileY, spawns);
+        if (status == TileFileStatus::Missing) { MarkTileResolved(tileX, tileY); return; }
+        // Failed tiles stay resolved so a bad file is not re-read on every query
+        if (!MergeTile(tileX, tileY, status, spawns, iVMapManager, nullptr))
+            std::cerr << "[StaticMapTree] Failed to load tile " << getTileFileName(iMapID, tileX, tileY) << std::endl;
+    }
+
+    void StaticMapTree::EnsureTilesLoaded(const G3D::AABox& bounds)
+    {
+        if (!iIsTiled || !iLazyTiles || iAllTilesResolved.load(std::memory_order_acquire)) return;
+        uint32_t x0, x1, y0, y1;
+        if (!GetTileRange(bounds, x0, x1, y0, y1)) return;
+        for (uint32_t x = x0; x <= x1; ++x)
+        {
+            for (uint32_t y = y0; y <= y1; ++y)
+            {
+                if (iTileResolved[x * TILES_PER_SIDE + y].load(std::memory_order_acquire)) continue;
+                std::lock_guard<std::mutex> lock(iTileLoadLock);
+                LoadTileLocked(x, y);
+            }
+        }
+    }
+
+    void StaticMapTree::EnsureTilesLoaded(const G3D::AABox* bounds, uint32_t count)
+    {
+        if (!iIsTiled || !iLazyTiles || iAllTilesResolved.load(std::memory_order_acquire)) return;
+        std::vector<uint32_t> pending;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t x0, x1, y0, y1;
+            if (!GetTileRange(bounds[i], x0, x1, y0, y1)) continue;
+            for (uint32_t x = x0; x <= x1; ++x)
+                for (uint32_t y = y0; y <= y1; ++y)
+                    if (!iTileResolved[x * TILES_PER_SIDE + y].load(std::memory_order_acquire))
+                        pending.push_back(x * TILES_PER_SIDE + y);
+        }
+        if (pending.empty()) return;
+        std::sort(pending.begin(), pending.end());
+        pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+        std::lock_guard<std::mutex> lock(iTileLoadLock);
+        for (uint32_t tile : pending)
+            LoadTileLocked(tile / TILES_PER_SIDE, tile % TILES_PER_SIDE);
+    }
+
+    void StaticMapTree::EnsureAllTilesLoaded()
+    {
+        if (!iIsTiled || !iLazyTiles || iAllTilesResolved.load(std::memory_order_acquire)) return;
+        PreloadAllTiles(iVMapManager);
     }
 
     void StaticMapTree::UnloadMapTile(uint32_t tileX, uint32_t tileY, VMapManager2* vm)
     {
-        if (!iIsTiled) return; uint32_t tileID = packTileID(tileX, tileY); auto itr = iLoadedTiles.find(tileID); if (itr == iLoadedTiles.end()) return; iLoadedTiles.erase(itr);
+        if (!iIsTiled) return;
+        std::lock_guard<std::mutex> lock(iTileLoadLock);
+        uint32_t tileID = packTileID(tileX, tileY);
+        auto resident = iResidentTiles.find(tileID);
+        if (!iLoadedTiles.erase(tileID) && resident == iResidentTiles.end()) return;
+        if (resident != iResidentTiles.end())
+        {
+            for (uint32_t mapped : resident->second.spawns)
+            {
+                auto loadedSpawn = iLoadedSpawns.find(mapped);
+                if (loadedSpawn == iLoadedSpawns.end() || --loadedSpawn->second > 0) continue;
+                iTreeValues[mapped].setUnloaded();
+                iLoadedSpawns.erase(loadedSpawn);
+            }
+            for (const auto& [model, bytes] : resident->second.models)
+            {
+                auto refs = iModelTileRefs.find(model);
+                if (refs == iModelTileRefs.end() || --refs->second > 0) continue;
+                iModelTileRefs.erase(refs);
+                iResidentModelBytes.fetch_sub(bytes, std::memory_order_relaxed);
+            }
+            iResidentTiles.erase(resident);
+            iResidencyGeneration.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (tileX < TILES_PER_SIDE && tileY < TILES_PER_SIDE) iTileResolved[tileX * TILES_PER_SIDE + tileY].store(false, std::memory_order_release);
+        iAllTilesResolved.store(false, std::memory_order_release);
+        iLazyTiles = true;
+    }
+
+    void StaticMapTree::AcquireTile(uint32_t tileX, uint32_t tileY)
+    {
+        if (!iIsTiled || tileX >= TILES_PER_SIDE || tileY >= TILES_PER_SIDE) return;
+        std::lock_guard<std::mutex> lock(iTileLoadLock);
+        uint32_t tileID = packTileID(tileX, tileY);
+        ++iTilePins[tileID];
+        LoadTileLocked(tileX, tileY);
+        auto resident = iResidentTiles.find(tileID);
+        if (resident != iResidentTiles.end()) resident->second.lastUse = NextTileUse();
+    }
+
+    void StaticMapTree::ReleaseTile(uint32_t tileX, uint32_t tileY)
+    {
+        std::lock_guard<std::mutex> lock(iTileLoadLock);
+        uint32_t tileID = packTileID(tileX, tileY);
+        auto pin = iTilePins.find(tileID);
+        if (pin == iTilePins.end()) return;
+        if (--pin->second == 0) { iTilePins.erase(pin); iResidencyGeneration.fetch_add(1, std::memory_order_relaxed); }
+        // A tile a bot just left is the last idle one to go
+        auto resident = iResidentTiles.find(tileID);
+        if (resident != iResidentTiles.end()) resident->second.lastUse = NextTileUse();
+    }
+
+    void StaticMapTree::TouchTile(uint32_t tileX, uint32_t tileY)
+    {
+        std::lock_guard<std::mutex> lock(iTileLoadLock);
+        auto resident = iResidentTiles.find(packTileID(tileX, tileY));
+        if (resident != iResidentTiles.end()) resident->second.lastUse = NextTileUse();
+    }
+
+    void StaticMapTree::GetIdleTiles(std::vector<IdleTile>& out)
+    {
+        std::lock_guard<std::mutex> lock(iTileLoadLock);
+        for (const auto& [tileID, resident] : iResidentTiles)
+        {
+            // Tiles without models (missing files) free nothing
+            if (iTilePins.count(tileID) || resident.models.empty()) continue;
+            IdleTile idle;
+            unpackTileID(tileID, idle.tileX, idle.tileY);
+            idle.lastUse = resident.lastUse;
+            out.push_back(idle);
+        }
+    }
+
+    uint32_t StaticMapTree::GetResidentTileCount()
+    {
+        std::lock_guard<std::mutex> lock(iTileLoadLock);
+        return (uint32_t)iResidentTiles.size();
+    }
+
+    uint32_t StaticMapTree::GetPinnedTileCount()
+    {
+        std::lock_guard<std::mutex> lock(iTileLoadLock);
+        return (uint32_t)iTilePins.size();
     }
+
     void StaticMapTree::UnloadMap(VMapManager2* vm)
     {
+        std::lock_guard<std::mutex> lock(iTileLoadLock);
         if (iTreeValues) { for (uint32_t i = 0; i < iNTreeValues; ++i) iTreeValues[i].setUnloaded(); } iLoadedTiles.clear(); iLoadedSpawns.clear();
+        iResidentTiles.clear(); iModelTileRefs.clear(); iResidentModelBytes.store(0, std::memory_order_relaxed);
+        iResidencyGeneration.fetch_add(1, std::memory_order_relaxed);
+        for (uint32_t i = 0; i < TILES_PER_SIDE * TILES_PER_SIDE; ++i) iTileResolved[i].store(false, std::memory_order_release);
+        iAllTilesResolved.store(false, std::memory_order_release);
     }
 
     bool StaticMapTree::isInLineOfSight(const G3D::Vector3& pos1, const G3D::Vector3& pos2, bool ignoreM2Model) const
@@ -256,6 +542,99 @@ namespace VMAP
 
     // Removed extended getIntersectionTime overload for WoW emulator compatibility
 
+    void StaticMapTree::getIntersectionTimeBatch(const G3D::Ray* rays, float* maxDist, bool* outHit, uint32_t count,
+        bool stopAtFirstHit, bool ignoreM2Model) const
+    {
+        const int packetSize = BIH::RAY_PACKET_SIZE;
+        static_assert(BIH::RAY_PACKET_SIZE == 4, "callback initializer below lists one entry per lane");
+
+        // One partly filled packet per direction octant; a packet is traced
+        // as soon as it is full, the leftovers at the end.
+        uint32_t pending[8][BIH::RAY_PACKET_SIZE];
+        int pendingCount[8] = {};
+
+        auto trace = [&](const uint32_t* indices, int n)
+        {
+            G3D::Ray packetRays[BIH::RAY_PACKET_SIZE];
+            float distance[BIH::RAY_PACKET_SIZE];
+            MapRayCallback callbacks[BIH::RAY_PACKET_SIZE] = {
+                MapRayCallback(iTreeValues), MapRayCallback(iTreeValues),
+                MapRayCallback(iTreeValues), MapRayCallback(iTreeValues) };
+            for (int k = 0; k < n; ++k)
+            {
+                packetRays[k] = rays[indices[k]];
+                distance[k] = maxDist[indices[k]];
+            }
+            iTree.intersectRayPacket(packetRays, callbacks, distance, n, stopAtFirstHit, ignoreM2Model);
+            for (int k = 0; k < n; ++k)
+            {
+                outHit[indices[k]] = callbacks[k].didHit();
+                if (callbacks[k].didHit()) maxDist[indices[k]] = distance[k];
+            }
+        };
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t octant = BIH::directionOctant(rays[i].direction());
+            pending[octant][pendingCount[octant]++] = i;
+            if (pendingCount[octant] == packetSize)
+            {
+                trace(pending[octant], packetSize);
+                pendingCount[octant] = 0;
+            }
+        }
+        for (int octant = 0; octant < 8; ++octant)
+        {
+            if (pendingCount[octant] > 0) trace(pending[octant], pendingCount[octant]);
+        }
+    }
+
+    void StaticMapTree::isInLineOfSightBatch(const G3D::Vector3* pos1, const G3D::Vector3* pos2, uint32_t count,
+        bool ignoreM2Model, bool* outClear) const
+    {
+        std::fill(outClear, outClear + count, true);
+        if (!iTreeValues || iNTreeValues == 0) return;
+
+        // Same rays as isInLineOfSight; segments too short to trace stay clear
+        std::vector<G3D::Ray> rays; std::vector<float> distance; std::vector<uint32_t> index;
+        rays.reserve(count); distance.reserve(count); index.reserve(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float maxDist = (pos2[i] - pos1[i]).magnitude();
+            if (maxDist < 0.001f) continue;
+            rays.push_back(G3D::Ray::fromOriginAndDirection(pos1[i], (pos2[i] - pos1[i]) / maxDist));
+            distance.push_back(maxDist);
+            index.push_back(i);
+        }
+        if (rays.empty()) return;
+
+        std::unique_ptr<bool[]> hit(new bool[rays.size()]);
+        getIntersectionTimeBatch(rays.data(), distance.data(), hit.get(), (uint32_t)rays.size(), true, ignoreM2Model);
+        for (size_t k = 0; k < rays.size(); ++k)
+            outClear[index[k]] = !hit[k];
+    }
+
+    void StaticMapTree::getHeightBatch(const G3D::Vector3* pos, const float* maxSearchDist, uint32_t count,
+        float* outHeight) const
+    {
+        std::fill(outHeight, outHeight + count, -std::numeric_limits<float>::infinity());
+        if (!iTreeValues || iNTreeValues == 0 || count == 0) return;
+
+        // Same downward rays as getHeight
+        std::vector<G3D::Ray> rays; std::vector<float> distance;
+        rays.reserve(count); distance.reserve(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            rays.push_back(G3D::Ray(pos[i], G3D::Vector3(0, 0, -1)));
+            distance.push_back(maxSearchDist[i] * 2);
+        }
+
+        std::unique_ptr<bool[]> hit(new bool[count]);
+        getIntersectionTimeBatch(rays.data(), distance.data(), hit.get(), count, false, false);
+        for (uint32_t i = 0; i < count; ++i)
+            if (hit[i]) outHeight[i] = pos[i].z - distance[i];
+    }
+
     uint32_t StaticMapTree::packTileID(uint32_t tileX, uint32_t tileY) { return (tileX << 16) | tileY; }
     void StaticMapTree::unpackTileID(uint32_t ID, uint32_t& tileX, uint32_t& tileY) { tileX = (ID >> 16); tileY = (ID & 0xFFFF); }
     std::string StaticMapTree::getTileFileName(uint32_t mapID, uint32_t tileX, uint32_t tileY) { char buffer[256]; snprintf(buffer, sizeof(buffer), "%03u_%02u_%02u.vmtile", mapID, tileX, tileY); return std::string(buffer); }
@@ -5,6 +5,8 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <atomic>
+#include <mutex>
 #include "BIH.h"
 #include "Vector3.h"
 #include "Ray.h"
@@ -31,7 +33,59 @@ namespace VMAP
         std::unordered_map<uint32_t, uint32_t> iLoadedSpawns;
         std::unordered_map<uint32_t, bool> iLoadedTiles;
 
-        // Preload all tiles for maximum performance
+        // Tile paging. Every tile read and merge into iTreeValues happens under
+        // iTileLoadLock; iTileResolved marks tiles that were already attempted
+        // (loaded, missing or unreadable) so EnsureTilesLoaded can skip them
+        // without taking the lock.
+        VMapManager2* iVMapManager;
+        bool iLazyTiles;
+        std::mutex iTileLoadLock;
+        std::unique_ptr<std::atomic<bool>[]> iTileResolved;
+        std::atomic<bool> iAllTilesResolved;
+
+        // Tile residency, under iTileLoadLock. For each tile whose spawns were
+        // merged: the instance slots it references, the distinct models
+        // behind them with their sizes and a stamp of its last use.
+        // iModelTileRefs counts the resident tiles using each model, so
+        // iResidentModelBytes counts a model once however many tiles share
+        // it. iTilePins counts the bots holding a tile; VMapManager2 only
+        // evicts tiles nobody pins. iResidencyGeneration moves whenever a
+        // tile is merged, unloaded or loses its last pin.
+        struct ResidentTile
+        {
+            std::vector<uint32_t> spawns;
+            std::vector<std::pair<const WorldModel*, size_t>> models;
+            uint64_t lastUse = 0;
+        };
+        std::unordered_map<uint32_t, ResidentTile> iResidentTiles;
+        std::unordered_map<const WorldModel*, uint32_t> iModelTileRefs;
+        std::unordered_map<uint32_t, uint32_t> iTilePins;
+        std::atomic<size_t> iResidentModelBytes;
+        std::atomic<uint64_t> iResidencyGeneration;
+
+        struct TileSpawn
+        {
+            ModelSpawn spawn;
+            uint32_t mapped;
+        };
+        enum class TileFileStatus { Missing, Unreadable, Truncated, Ok };
+
+        // Reads a tile's spawns without touching the tree; safe to call from
+        // several threads. A truncated tile returns the spawns read before the
+        // error, which are still merged like the serial loader always did.
+        TileFileStatus ReadTileSpawns(uint32_t tileX, uint32_t tileY, std::vector<TileSpawn>& spawns) const;
+        // Merges one read tile into iTreeValues; iTileLoadLock must be held.
+        // Models come from `models` when given, otherwise from the manager.
+        bool MergeTile(uint32_t tileX, uint32_t tileY, TileFileStatus status, const std::vector<TileSpawn>& spawns,
+            VMapManager2* vm, const std::unordered_map<std::string, std::shared_ptr<const WorldModel>>* models);
+        void MarkTileResolved(uint32_t tileX, uint32_t tileY);
+        // Reads and merges one tile unless it is already resolved;
+        // iTileLoadLock must be held.
+        void LoadTileLocked(uint32_t tileX, uint32_t tileY);
+
+        // Loads every tile not yet resolved: tile files are read and their
+        // models parsed in parallel, then merged one tile at a time in tile
+        // order, so the result matches loading the tiles one by one.
         bool PreloadAllTiles(VMapManager2* vm);
 
     public:
@@ -43,6 +97,50 @@ namespace VMAP
         void UnloadMapTile(uint32_t tileX, uint32_t tileY, VMapManager2* vm);
         void UnloadMap(VMapManager2* vm);
 
+        // Lazy tile mode (VMapManager2::setLazyTileLoading): InitMap loads no
+        // tiles and queries page in the tiles overlapping their internal-space
+        // bounds on first use. Loads happen on the calling thread and write
+        // into the instance array other queries read, so a caller that fans a
+        // query out over worker threads ensures its region beforehand. Both
+        // are no-ops when the map was preloaded.
+        void EnsureTilesLoaded(const G3D::AABox& bounds);
+        // EnsureTilesLoaded for every box of a batch: the union of their
+        // unresolved tiles is loaded in tile order under one lock.
+        void EnsureTilesLoaded(const G3D::AABox* bounds, uint32_t count);
+        void EnsureAllTilesLoaded();
+        bool IsLazyTileLoading() const { return iLazyTiles; }
+
+        // Tile residency (see VMapManager2::setTileMemoryBudget). AcquireTile
+        // pins a tile, loading it if it is not resident; ReleaseTile drops
+        // the pin and TouchTile refreshes a resident tile's last use.
+        // UnloadMapTile releases the tile's spawns, and with them the models
+        // only those spawns used; a spawn another loaded tile also references
+        // stays. Once a tile has been unloaded the map pages tiles back in on
+        // demand like a lazy one. Unloading writes the instance array, so
+        // nothing may query the map meanwhile.
+        void AcquireTile(uint32_t tileX, uint32_t tileY);
+        void ReleaseTile(uint32_t tileX, uint32_t tileY);
+        void TouchTile(uint32_t tileX, uint32_t tileY);
+
+        struct IdleTile
+        {
+            uint32_t tileX;
+            uint32_t tileY;
+            uint64_t lastUse;
+        };
+        // Resident tiles with models that no bot pins
+        void GetIdleTiles(std::vector<IdleTile>& out);
+        // Bytes of the distinct models the resident tiles use
+        size_t GetResidentModelBytes() const { return iResidentModelBytes.load(std::memory_order_relaxed); }
+        // Changes whenever the set of resident or evictable tiles may have
+        uint64_t GetResidencyGeneration() const { return iResidencyGeneration.load(std::memory_order_relaxed); }
+        uint32_t GetResidentTileCount();
+        uint32_t GetPinnedTileCount();
+
+        // Inclusive range of tiles overlapping internal-space bounds; false
+        // when the bounds are NaN
+        static bool GetTileRange(const G3D::AABox& bounds, uint32_t& x0, uint32_t& x1, uint32_t& y0, uint32_t& y1);
+
         // Original collision and height queries
         bool isInLineOfSight(const G3D::Vector3& pos1, const G3D::Vector3& pos2, bool ignoreM2Model) const;
         bool getObjectHitPos(const G3D::Vector3& pos1, const G3D::Vector3& pos2,
@@ -57,6 +155,16 @@ namespace VMAP
             bool stopAtFirstHit, bool ignoreM2Model) const;
         // Removed extended variant with extra output parameters for WoW emulator compatibility
 
+        // Batched forms of getIntersectionTime / isInLineOfSight / getHeight.
+        // Rays are traced as BIH ray packets of the same direction octant, in
+        // the order given; element i gets exactly the single-ray answer.
+        void getIntersectionTimeBatch(const G3D::Ray* rays, float* maxDist, bool* outHit, uint32_t count,
+            bool stopAtFirstHit, bool ignoreM2Model) const;
+        void isInLineOfSightBatch(const G3D::Vector3* pos1, const G3D::Vector3* pos2, uint32_t count,
+            bool ignoreM2Model, bool* outClear) const;
+        void getHeightBatch(const G3D::Vector3* pos, const float* maxSearchDist, uint32_t count,
+            float* outHeight) const;
+
         ModelInstance* FindCollisionModel(const G3D::Vector3& pos1, const G3D::Vector3& pos2);
 
         // Utility functions
@@ -4,6 +4,7 @@
 #include <filesystem>
 #include <string>
 #include <iostream>
+#include <cstdlib>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -23,6 +24,17 @@ namespace VMAP
 
             std::string vmapsPath = getVMapsPath();
             gVMapManager->setBasePath(vmapsPath);
+
+            // WWOW_VMAP_LAZY_TILES=1 loads VMAP tiles on first query in their
+            // area instead of preloading whole maps
+            const char* lazyTiles = std::getenv("WWOW_VMAP_LAZY_TILES");
+            gVMapManager->setLazyTileLoading(lazyTiles && lazyTiles[0] == '1');
+
+            // WWOW_VMAP_TILE_BUDGET_MB caps the model memory of loaded tiles;
+            // tiles no bot is near are unloaded beyond it
+            const char* tileBudget = std::getenv("WWOW_VMAP_TILE_BUDGET_MB");
+            if (tileBudget && tileBudget[0])
+                gVMapManager->setTileMemoryBudget(static_cast<size_t>(std::strtoull(tileBudget, nullptr, 10)) * 1024ull * 1024ull);
         }
         return gVMapManager;
     }
@@ -1,6 +1,7 @@
 #include "VMapManager2.h"
 #include "StaticMapTree.h"
 #include "WorldModel.h"
+#include "WorldModelStore.h"
 #include "VMapDefinitions.h"
 #include "VMapLog.h"
 #include <sstream>
@@ -16,6 +17,7 @@
 #include "CoordinateTransforms.h"
 #include "SceneQuery.h"
 #include "CapsuleCollision.h"
+#include "ParallelFor.h"
 
 namespace VMAP
 {
@@ -261,6 +263,29 @@ namespace VMAP
         return "";
     }
 
+    // Pages in the tiles under a query spanning internal-space points a..b
+    // when its map loads tiles lazily
+    static void EnsureQueryTiles(StaticMapTree* tree, const G3D::Vector3& a, const G3D::Vector3& b)
+    {
+        if (tree->IsLazyTileLoading())
+            tree->EnsureTilesLoaded(G3D::AABox(a.min(b), a.max(b)));
+    }
+
+    // EnsureQueryTiles for a batch of internal-space segments a[i]..b[i]
+    // (points when b is null), loading the union of their tiles at once
+    static void EnsureBatchTiles(StaticMapTree* tree, const G3D::Vector3* a, const G3D::Vector3* b, uint32_t count)
+    {
+        if (!tree->IsLazyTileLoading())
+            return;
+        std::vector<G3D::AABox> bounds(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const G3D::Vector3& end = b ? b[i] : a[i];
+            bounds[i] = G3D::AABox(a[i].min(end), a[i].max(end));
+        }
+        tree->EnsureTilesLoaded(bounds.data(), count);
+    }
+
     // Constructor
     VMapManager2::VMapManager2()
     {
@@ -340,6 +365,226 @@ namespace VMAP
         }
     }
 
+    void VMapManager2::ensureTilesLoaded(uint32_t mapId, const G3D::AABox& worldBounds) const
+    {
+        StaticMapTree* tree = GetStaticMapTree(mapId);
+        if (!tree)
+            return;
+        // WORLD -> INTERNAL mirrors X/Y, so the corners swap
+        EnsureQueryTiles(tree, NavCoord::WorldToInternal(worldBounds.low()), NavCoord::WorldToInternal(worldBounds.high()));
+    }
+
+    void VMapManager2::ensureBatchTilesLoaded(uint32_t mapId, const G3D::Vector3* from, const G3D::Vector3* to,
+        uint32_t count) const
+    {
+        StaticMapTree* tree = GetStaticMapTree(mapId);
+        if (!tree || !tree->IsLazyTileLoading())
+            return;
+        std::vector<G3D::Vector3> a(count), b(to ? count : 0);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            a[i] = NavCoord::WorldToInternal(from[i]);
+            if (to)
+                b[i] = NavCoord::WorldToInternal(to[i]);
+        }
+        EnsureBatchTiles(tree, a.data(), to ? b.data() : nullptr, count);
+    }
+
+    void VMapManager2::ensureAllTilesLoaded(uint32_t mapId) const
+    {
+        if (StaticMapTree* tree = GetStaticMapTree(mapId))
+            tree->EnsureAllTilesLoaded();
+    }
+
+    // Tiles within BOT_TILE_RADIUS of world (x, y); false when the map is
+    // not loaded, not tiled or the position is NaN
+    bool VMapManager2::botTileRange(uint32_t mapId, float x, float y, BotTiles& out) const
+    {
+        StaticMapTree* tree = GetStaticMapTree(mapId);
+        if (!tree || !tree->isTiled())
+            return false;
+        G3D::Vector3 a = NavCoord::WorldToInternal(x - BOT_TILE_RADIUS, y - BOT_TILE_RADIUS, 0.0f);
+        G3D::Vector3 b = NavCoord::WorldToInternal(x + BOT_TILE_RADIUS, y + BOT_TILE_RADIUS, 0.0f);
+        out.mapId = mapId;
+        return StaticMapTree::GetTileRange(G3D::AABox(a.min(b), a.max(b)), out.x0, out.x1, out.y0, out.y1);
+    }
+
+    void VMapManager2::releaseBotTileRange(const BotTiles& tiles)
+    {
+        StaticMapTree* tree = GetStaticMapTree(tiles.mapId);
+        if (!tree)
+            return;
+        for (uint32_t x = tiles.x0; x <= tiles.x1; ++x)
+            for (uint32_t y = tiles.y0; y <= tiles.y1; ++y)
+                tree->ReleaseTile(x, y);
+    }
+
+    void VMapManager2::updateBotTiles(uint64_t botId, uint32_t mapId, float x, float y)
+    {
+        BotTiles tiles;
+        const bool inTiledMap = botTileRange(mapId, x, y, tiles);
+        StaticMapTree* tree = inTiledMap ? GetStaticMapTree(mapId) : nullptr;
+        if (botId == 0)
+        {
+            if (tree)
+                for (uint32_t tx = tiles.x0; tx <= tiles.x1; ++tx)
+                    for (uint32_t ty = tiles.y0; ty <= tiles.y1; ++ty)
+                        tree->TouchTile(tx, ty);
+            return;
+        }
+
+        tiles.lastUpdate = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(m_residencyLock);
+        auto previous = iBotTiles.find(botId);
+        if (previous != iBotTiles.end() && inTiledMap && previous->second == tiles)
+        {
+            previous->second.lastUpdate = tiles.lastUpdate;
+            return;
+        }
+
+        // Pin the new range before releasing the old one, so a tile in both
+        // keeps its pin throughout
+        if (tree)
+            for (uint32_t tx = tiles.x0; tx <= tiles.x1; ++tx)
+                for (uint32_t ty = tiles.y0; ty <= tiles.y1; ++ty)
+                    tree->AcquireTile(tx, ty);
+        if (previous != iBotTiles.end())
+        {
+            releaseBotTileRange(previous->second);
+            iBotTiles.erase(previous);
+        }
+        if (tree)
+            iBotTiles.emplace(botId, tiles);
+    }
+
+    void VMapManager2::releaseBotTiles(uint64_t botId)
+    {
+        std::lock_guard<std::mutex> lock(m_residencyLock);
+        auto it = iBotTiles.find(botId);
+        if (it == iBotTiles.end())
+            return;
+        releaseBotTileRange(it->second);
+        iBotTiles.erase(it);
+    }
+
+    void VMapManager2::setBotTilePinTimeout(uint32_t ms)
+    {
+        std::lock_guard<std::mutex> lock(m_residencyLock);
+        iBotTilePinTimeout = std::chrono::milliseconds(ms);
+        iNextPinSweep = {};
+    }
+
+    // Releases the pins of bots that have not updated them within the pin
+    // timeout. Sweeps at most once per timeout (and once a second), so a
+    // trim after every step does not walk every bot; m_residencyLock held.
+    void VMapManager2::expireBotTiles()
+    {
+        if (iBotTilePinTimeout.count() == 0 || iBotTiles.empty())
+            return;
+        const auto now = std::chrono::steady_clock::now();
+        if (now < iNextPinSweep)
+            return;
+        iNextPinSweep = now + std::min<std::chrono::steady_clock::duration>(iBotTilePinTimeout, std::chrono::seconds(1));
+        for (auto it = iBotTiles.begin(); it != iBotTiles.end();)
+        {
+            if (now - it->second.lastUpdate < iBotTilePinTimeout)
+            {
+                ++it;
+                continue;
+            }
+            releaseBotTileRange(it->second);
+            it = iBotTiles.erase(it);
+        }
+    }
+
+    void VMapManager2::setTileMemoryBudget(size_t bytes)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_residencyLock);
+            iTileMemoryBudget = bytes;
+            iTrimmedGeneration = UINT64_MAX;
+        }
+        trimTileResidency();
+    }
+
+    size_t VMapManager2::getTileMemoryBudget() const
+    {
+        std::lock_guard<std::mutex> lock(m_residencyLock);
+        return iTileMemoryBudget;
+    }
+
+    size_t VMapManager2::trimTileResidency()
+    {
+        std::lock_guard<std::mutex> lock(m_residencyLock);
+        expireBotTiles();
+        if (iTileMemoryBudget == 0)
+            return 0;
+        // Nothing to do while the resident and evictable tiles are the ones
+        // the last trim left
+        uint64_t generation = 0;
+        for (const auto& [mapId, tree] : iInstanceMapTrees)
+            generation += tree->GetResidencyGeneration();
+        if (generation == iTrimmedGeneration)
+            return 0;
+        size_t resident = 0;
+        for (const auto& [mapId, tree] : iInstanceMapTrees)
+            resident += tree->GetResidentModelBytes();
+        if (resident <= iTileMemoryBudget)
+        {
+            iTrimmedGeneration = generation;
+            return 0;
+        }
+
+        struct Candidate
+        {
+            StaticMapTree* tree;
+            StaticMapTree::IdleTile tile;
+        };
+        std::vector<Candidate> candidates;
+        std::vector<StaticMapTree::IdleTile> idle;
+        for (const auto& [mapId, tree] : iInstanceMapTrees)
+        {
+            idle.clear();
+            tree->GetIdleTiles(idle);
+            for (const StaticMapTree::IdleTile& tile : idle)
+                candidates.push_back({ tree, tile });
+        }
+        std::sort(candidates.begin(), candidates.end(),
+            [](const Candidate& a, const Candidate& b) { return a.tile.lastUse < b.tile.lastUse; });
+
+        size_t evicted = 0;
+        for (const Candidate& candidate : candidates)
+        {
+            if (resident <= iTileMemoryBudget)
+                break;
+            // Models another resident tile still uses free nothing yet
+            const size_t before = candidate.tree->GetResidentModelBytes();
+            candidate.tree->UnloadMapTile(candidate.tile.tileX, candidate.tile.tileY, this);
+            resident -= std::min(resident, before - candidate.tree->GetResidentModelBytes());
+            ++evicted;
+        }
+        iTileEvictions += evicted;
+        iTrimmedGeneration = 0;
+        for (const auto& [mapId, tree] : iInstanceMapTrees)
+            iTrimmedGeneration += tree->GetResidencyGeneration();
+        return evicted;
+    }
+
+    VMapManager2::TileResidencyStats VMapManager2::getTileResidencyStats() const
+    {
+        TileResidencyStats stats;
+        std::lock_guard<std::mutex> lock(m_residencyLock);
+        for (const auto& [mapId, tree] : iInstanceMapTrees)
+        {
+            stats.residentTiles += tree->GetResidentTileCount();
+            stats.pinnedTiles += tree->GetPinnedTileCount();
+            stats.residentBytes += tree->GetResidentModelBytes();
+        }
+        stats.budget = iTileMemoryBudget;
+        stats.evictions = iTileEvictions;
+        return stats;
+    }
+
     bool VMapManager2::isUnderModel(unsigned int pMapId, float x, float y, float z,
         float* outDist, float* inDist) const
     {
@@ -348,6 +593,7 @@ namespace VMAP
         if (instanceTree != iInstanceMapTrees.end())
         {
             G3D::Vector3 pos = convertPositionToInternalRep(x, y, z);
+            EnsureQueryTiles(instanceTree->second, pos, pos);
             bool res = instanceTree->second->isUnderModel(pos, outDist, inDist);
             return res;
         }
@@ -457,6 +703,7 @@ namespace VMAP
         {
             G3D::Vector3 pos1 = convertPositionToInternalRep(x1, y1, z1);
             G3D::Vector3 pos2 = convertPositionToInternalRep(x2, y2, z2);
+            EnsureQueryTiles(instanceTree->second, pos1, pos2);
             bool r = instanceTree->second->isInLineOfSight(pos1, pos2, ignoreM2Model);
             PHYS_TRACE(PHYS_PERF, "EXIT VMapManager2::isInLineOfSight -> " << (r ? 1 : 0));
             return r;
@@ -474,6 +721,7 @@ namespace VMAP
         {
             G3D::Vector3 pos1 = convertPositionToInternalRep(x0, y0, z0);
             G3D::Vector3 pos2 = convertPositionToInternalRep(x1, y1, z1);
+            EnsureQueryTiles(instanceTree->second, pos1, pos2);
             ModelInstance* m = instanceTree->second->FindCollisionModel(pos1, pos2);
             PHYS_TRACE(PHYS_PERF, "EXIT VMapManager2::FindCollisionModel -> " << (m ? "hit" : "null"));
             return m;
@@ -492,6 +740,7 @@ namespace VMAP
         {
             G3D::Vector3 pos1 = convertPositionToInternalRep(x1, y1, z1);
             G3D::Vector3 pos2 = convertPositionToInternalRep(x2, y2, z2);
+            EnsureQueryTiles(instanceTree->second, pos1, pos2);
             G3D::Vector3 resultPos;
             bool hit = instanceTree->second->getObjectHitPos(pos1, pos2, resultPos, pModifyDist);
             if (hit)
@@ -526,6 +775,7 @@ namespace VMAP
         if (instanceTree != iInstanceMapTrees.end())
         {
             G3D::Vector3 pos = convertPositionToInternalRep(x, y, z); // WORLD -> INTERNAL (X/Y mirrored, Z preserved)
+            EnsureQueryTiles(instanceTree->second, pos, pos);
             // Modern raycast: only accept closest walkable hit (performed in INTERNAL space)
             h = instanceTree->second->getHeight(pos, maxSearchDist); // returns INTERNAL Z (== WORLD Z)
             if (!std::isfinite(h)) h = PhysicsConstants::INVALID_HEIGHT;
@@ -534,6 +784,48 @@ namespace VMAP
         return h;
     }
 
+    void VMapManager2::isInLineOfSightBatch(unsigned int pMapId, const G3D::Vector3* from, const G3D::Vector3* to,
+        uint32_t count, bool ignoreM2Model, bool* outClear)
+    {
+        std::fill(outClear, outClear + count, true);
+        if (!isLineOfSightCalcEnabled())
+            return;
+        auto instanceTree = iInstanceMapTrees.find(pMapId);
+        if (instanceTree == iInstanceMapTrees.end())
+            return;
+
+        std::vector<G3D::Vector3> pos1(count), pos2(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            pos1[i] = convertPositionToInternalRep(from[i].x, from[i].y, from[i].z);
+            pos2[i] = convertPositionToInternalRep(to[i].x, to[i].y, to[i].z);
+        }
+        if (!Parallel::InLoopItem())
+            EnsureBatchTiles(instanceTree->second, pos1.data(), pos2.data(), count);
+        instanceTree->second->isInLineOfSightBatch(pos1.data(), pos2.data(), count, ignoreM2Model, outClear);
+    }
+
+    void VMapManager2::getHeightBatch(unsigned int pMapId, const G3D::Vector3* pos, const float* maxSearchDist,
+        uint32_t count, float* outHeight)
+    {
+        std::fill(outHeight, outHeight + count, PhysicsConstants::INVALID_HEIGHT);
+        if (!isHeightCalcEnabled())
+            return;
+        auto instanceTree = iInstanceMapTrees.find(pMapId);
+        if (instanceTree == iInstanceMapTrees.end())
+            return;
+
+        // Same WORLD -> INTERNAL conversion as getHeight; Z is preserved
+        std::vector<G3D::Vector3> internal(count);
+        for (uint32_t i = 0; i < count; ++i)
+            internal[i] = convertPositionToInternalRep(pos[i].x, pos[i].y, pos[i].z);
+        if (!Parallel::InLoopItem())
+            EnsureBatchTiles(instanceTree->second, internal.data(), nullptr, count);
+        instanceTree->second->getHeightBatch(internal.data(), maxSearchDist, count, outHeight);
+        for (uint32_t i = 0; i < count; ++i)
+            if (!std::isfinite(outHeight[i])) outHeight[i] = PhysicsConstants::INVALID_HEIGHT;
+    }
+
     bool VMapManager2::getAreaInfo(unsigned int pMapId, float x, float y, float& z,
         uint32_t& flags, int32_t& adtId, int32_t& rootId, int32_t& groupId) const
     {
@@ -542,6 +834,7 @@ namespace VMAP
         if (instanceTree != iInstanceMapTrees.end())
         {
             G3D::Vector3 pos = NavCoord::WorldToInternal(x, y, z);
+            EnsureQueryTiles(instanceTree->second, pos, pos);
             bool res = instanceTree->second->getAreaInfo(pos, flags, adtId, rootId, groupId);
             if (res)
             {
@@ -570,6 +863,7 @@ namespace VMAP
         {
             // Use the same conversion helper as getHeight to keep coordinate spaces consistent
             G3D::Vector3 pos = convertPositionToInternalRep(x, y, z);
+            EnsureQueryTiles(instanceTree->second, pos, pos);
 
             LocationInfo info; bool gotLoc = instanceTree->second->GetLocationInfo(pos, info);
             if (gotLoc && info.hitModel)
@@ -597,30 +891,45 @@ namespace VMAP
         return false;
     }
 
-    std::shared_ptr<WorldModel> VMapManager2::acquireModelInstance(const std::string& basepath, const std::string& filename)
+    std::shared_ptr<const WorldModel> VMapManager2::acquireModelInstance(const std::string& basepath, const std::string& filename)
     {
         try
         {
-            std::lock_guard<std::shared_mutex> lock(m_modelsLock);
-            auto it = iLoadedModelFiles.find(filename);
-            if (it != iLoadedModelFiles.end())
             {
-                return it->second;
+                std::shared_lock<std::shared_mutex> lock(m_modelsLock);
+                auto it = iLoadedModelFiles.find(filename);
+                if (it != iLoadedModelFiles.end())
+                {
+                    if (std::shared_ptr<const WorldModel> model = it->second.lock())
+                        return model;
+                }
+            }
+            std::string fullPath;
+            {
+                std::lock_guard<std::shared_mutex> lock(m_modelsLock);
+                if (!modelMappingLoaded)
+                    BuildCompleteModelMapping(basepath);
+                fullPath = ResolveModelPath(basepath, filename);
             }
-            if (!modelMappingLoaded)
-                BuildCompleteModelMapping(basepath);
-            std::string fullPath = ResolveModelPath(basepath, filename);
 
             if (fullPath.empty() || !std::filesystem::exists(fullPath))
             {
                 return nullptr;
             }
-            std::shared_ptr<WorldModel> wm = std::make_shared<WorldModel>();
-            if (!wm->readFile(fullPath))
+            // Loaded outside the lock so parallel tile loads do not queue
+            // behind each other; the store shares one parse per file content
+            // across maps and subsystems. If two threads race on one name
+            // the first copy inserted wins.
+            std::shared_ptr<const WorldModel> wm = WorldModelStore::Instance().Acquire(fullPath);
+            if (!wm)
             {
                 return nullptr;
             }
-            iLoadedModelFiles[filename] = wm;
+            std::lock_guard<std::shared_mutex> lock(m_modelsLock);
+            std::weak_ptr<const WorldModel>& slot = iLoadedModelFiles[filename];
+            if (std::shared_ptr<const WorldModel> existing = slot.lock())
+                return existing;
+            slot = wm;
             return wm;
         }
         catch (const std::exception& e)
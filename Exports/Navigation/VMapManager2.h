@@ -4,10 +4,13 @@
 #include "IVMapManager.h"
 #include <unordered_map>
 #include <unordered_set>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <shared_mutex>
 #include <string>
 #include "Vector3.h"
+#include "AABox.h"
 #include "CapsuleCollision.h"
 #include "SceneQuery.h"
 
@@ -18,7 +21,9 @@ namespace VMAP
     class ModelInstance;
 
     typedef std::unordered_map<uint32_t, StaticMapTree*> InstanceTreeMap;
-    typedef std::unordered_map<std::string, std::shared_ptr<WorldModel>> ModelFileMap;
+    // Models by spawn name. Only the spawns using a model keep it alive, so a
+    // model goes as soon as the last tile referencing it is unloaded.
+    typedef std::unordered_map<std::string, std::weak_ptr<const WorldModel>> ModelFileMap;
 
     class VMapManager2 : public IVMapManager
     {
@@ -28,11 +33,35 @@ namespace VMAP
         InstanceTreeMap iInstanceMapTrees;
         std::unordered_set<uint32_t> iLoadedMaps;
         std::string iBasePath;
+        bool iLazyTileLoading = false;
 
         bool _loadMap(uint32_t pMapId, const std::string& basePath, uint32_t tileX, uint32_t tileY);
 
         mutable std::shared_mutex m_modelsLock;
 
+        // Tile residency, under m_residencyLock: the tile range each bot
+        // pins and when it last updated it. iTrimmedGeneration is the sum of
+        // the trees' residency generations after the last trim, or UINT64_MAX
+        // when the next trim must run.
+        struct BotTiles
+        {
+            uint32_t mapId;
+            uint32_t x0, x1, y0, y1;
+            std::chrono::steady_clock::time_point lastUpdate;
+            bool operator==(const BotTiles& o) const { return mapId == o.mapId && x0 == o.x0 && x1 == o.x1 && y0 == o.y0 && y1 == o.y1; }
+        };
+        std::unordered_map<uint64_t, BotTiles> iBotTiles;
+        size_t iTileMemoryBudget = 0;
+        uint64_t iTileEvictions = 0;
+        std::chrono::milliseconds iBotTilePinTimeout{ BOT_TILE_PIN_TIMEOUT_MS };
+        std::chrono::steady_clock::time_point iNextPinSweep;
+        uint64_t iTrimmedGeneration = UINT64_MAX;
+        mutable std::mutex m_residencyLock;
+
+        bool botTileRange(uint32_t mapId, float x, float y, BotTiles& out) const;
+        void releaseBotTileRange(const BotTiles& tiles);
+        void expireBotTiles();
+
     public:
         // public for debug
         G3D::Vector3 convertPositionToInternalRep(float x, float y, float z) const;
@@ -49,6 +78,55 @@ namespace VMAP
             return iLoadedMaps.count(mapId) > 0;
         }
 
+        // Tiled maps initialized after this call load their tiles on first
+        // query in their area instead of all at once (see
+        // StaticMapTree::EnsureTilesLoaded). The query methods below page in
+        // what they touch; code that reads a StaticMapTree directly, or fans
+        // a batch out over worker threads, calls ensureTilesLoaded /
+        // ensureBatchTilesLoaded / ensureAllTilesLoaded first.
+        void setLazyTileLoading(bool lazy) { iLazyTileLoading = lazy; }
+        bool isLazyTileLoading() const { return iLazyTileLoading; }
+        void ensureTilesLoaded(uint32_t mapId, const G3D::AABox& worldBounds) const;
+        // Tiles under world-space segments from[i]..to[i] (points when to is
+        // null), loaded as one union
+        void ensureBatchTilesLoaded(uint32_t mapId, const G3D::Vector3* from, const G3D::Vector3* to,
+            uint32_t count) const;
+        void ensureAllTilesLoaded(uint32_t mapId) const;
+
+        // Tile residency. Each bot pins the tiles within BOT_TILE_RADIUS of
+        // its position (updateBotTiles, keyed by its agent id; id 0 only
+        // refreshes the tiles' last use) until it moves on, is released or
+        // goes the pin timeout without an update (a bot that stopped
+        // stepping without being released). Timeout 0 keeps pins until
+        // released.
+        // trimTileResidency unloads the least recently used unpinned tiles
+        // of tiled maps until the models the resident tiles use fit the
+        // budget; models no loaded spawn uses any more are freed with them
+        // and evicted tiles page back in on the next query in their area.
+        // A model shared by several maps is counted once per map. Budget 0
+        // (the default) never evicts. These unload instances queries read: callers run them
+        // between queries, never alongside one.
+        static constexpr float BOT_TILE_RADIUS = 160.0f;
+        static constexpr uint32_t BOT_TILE_PIN_TIMEOUT_MS = 60000;
+        void updateBotTiles(uint64_t botId, uint32_t mapId, float x, float y);
+        void releaseBotTiles(uint64_t botId);
+        void setBotTilePinTimeout(uint32_t ms);
+        void setTileMemoryBudget(size_t bytes);
+        size_t getTileMemoryBudget() const;
+        // Expires idle pins, then evicts unless nothing was loaded, unloaded
+        // or unpinned since the last trim. Number of tiles evicted
+        size_t trimTileResidency();
+
+        struct TileResidencyStats
+        {
+            size_t residentTiles = 0;
+            size_t pinnedTiles = 0;
+            size_t residentBytes = 0;
+            size_t budget = 0;
+            uint64_t evictions = 0;
+        };
+        TileResidencyStats getTileResidencyStats() const;
+
         // IVMapManager interface implementation
         VMAPLoadResult loadMap(const char* pBasePath, unsigned int pMapId, int x, int y) override;
         void unloadMap(unsigned int pMapId, int x, int y) override;
@@ -63,6 +141,17 @@ namespace VMAP
             float& rx, float& ry, float& rz, float pModifyDist) override;
         float getHeight(unsigned int pMapId, float x, float y, float z, float maxSearchDist) override;
 
+        // Batched isInLineOfSight / getHeight for many world-space queries on
+        // one map (see StaticMapTree::isInLineOfSightBatch / getHeightBatch).
+        // The union of the batch's tiles is paged in up front, except on a
+        // Parallel::For item: tile loads write the instance array the other
+        // items read, so a caller fanning batches out loads their tiles with
+        // ensureBatchTilesLoaded beforehand.
+        void isInLineOfSightBatch(unsigned int pMapId, const G3D::Vector3* from, const G3D::Vector3* to,
+            uint32_t count, bool ignoreM2Model, bool* outClear);
+        void getHeightBatch(unsigned int pMapId, const G3D::Vector3* pos, const float* maxSearchDist,
+            uint32_t count, float* outHeight);
+
         bool processCommand(char* /*pCommand*/) override { return false; }
 
         bool getAreaInfo(unsigned int pMapId, float x, float y, float& z,
@@ -72,7 +161,7 @@ namespace VMAP
         bool GetLiquidLevel(uint32_t pMapId, float x, float y, float z,
             uint8_t ReqLiquidTypeMask, float& level, float& floor, uint32_t& type) const override;
 
-        std::shared_ptr<WorldModel> acquireModelInstance(const std::string& basepath, const std::string& filename);
+        std::shared_ptr<const WorldModel> acquireModelInstance(const std::string& basepath, const std::string& filename);
 
         // Capsule sweep via VMapManager is not supported; use `SceneQuery::SweepCapsule` directly with a `StaticMapTree`.
 
@@ -9,6 +9,9 @@
 #include <algorithm>
 #include "VMapLog.h"
 #include "CoordinateTransforms.h"
+#include "MappedFile.h"
+#include "WorldModelStore.h"
+#include <filesystem>
 
 namespace VMAP
 {
@@ -121,6 +124,12 @@ namespace VMAP
         return *this;
     }
 
+    size_t WmoLiquid::GetMemoryUsage() const
+    {
+        return sizeof(WmoLiquid) + (iHeight ? (iTilesX + 1) * (iTilesY + 1) * sizeof(float) : 0) +
+            (iFlags ? iTilesX * iTilesY * sizeof(uint8_t) : 0);
+    }
+
     bool WmoLiquid::GetLiquidHeight(const G3D::Vector3& pos, float& liqHeight) const
     {
         if (!iHeight || !iFlags)
@@ -231,33 +240,35 @@ namespace VMAP
         return false;
     }
 
-    uint32_t GroupModel::IntersectRay(const G3D::Ray& ray, float& distance, bool stopAtFirstHit, bool ignoreM2Model) const
+    uint32_t GroupModel::IntersectRay(const G3D::Ray& ray, float& distance, bool stopAtFirstHit, bool ignoreM2Model,
+        int* outHitTriangle) const
     {
+        if (outHitTriangle)
+            *outHitTriangle = -1;
         if (triangles.empty())
             return 0;
 
-        // Reset last hit tracking
-        m_lastHitTriangle = -1;
-
-        GModelRayCallback callback(triangles, vertices, const_cast<GroupModel*>(this));
+        GModelRayCallback callback(*this);
         // Restore original traversal behavior: honor caller's stopAtFirstHit flag.
         meshTree.intersectRay(ray, callback, distance, stopAtFirstHit, ignoreM2Model);
+        if (outHitTriangle)
+            *outHitTriangle = callback.lastHitIndex;
 
         // Emit PHYS_TRACE so it shows in same channel as other raycast summaries
-        if (m_lastHitTriangle >= 0)
+        if (callback.lastHitIndex >= 0)
         {
-            PHYS_TRACE(PHYS_CYL, "[GroupModel::IntersectRay] hits=" << callback.hit << " lastTri=" << m_lastHitTriangle << " dist=" << distance << " wmoId=" << iGroupWMOID);
+            PHYS_TRACE(PHYS_CYL, "[GroupModel::IntersectRay] hits=" << callback.hit << " lastTri=" << callback.lastHitIndex << " dist=" << distance << " wmoId=" << iGroupWMOID);
 
             // Additional per-triangle diagnostics in model space: hit point, normal.z and barycentric
-            const MeshTriangle& mt = triangles[(size_t)m_lastHitTriangle];
+            const MeshTriangle& mt = triangles[(size_t)callback.lastHitIndex];
             const G3D::Vector3& v0 = vertices[(size_t)mt.idx0];
             const G3D::Vector3& v1 = vertices[(size_t)mt.idx1];
             const G3D::Vector3& v2 = vertices[(size_t)mt.idx2];
-            G3D::Vector3 n = (v1 - v0).cross(v2 - v0).directionOrZero();
+            const G3D::Vector3 n = GetTriangleNormal((uint32_t)callback.lastHitIndex);
             float cosZ = n.z; // model-space z component
             G3D::Vector3 p = ray.origin() + ray.direction() * distance;
             G3D::Vector3 bary = ComputeBarycentric(p, v0, v1, v2);
-            PHYS_TRACE(PHYS_CYL, "[GroupModel::IntersectRayTri] tri=" << m_lastHitTriangle
+            PHYS_TRACE(PHYS_CYL, "[GroupModel::IntersectRayTri] tri=" << callback.lastHitIndex
                 << " pM=(" << p.x << "," << p.y << "," << p.z << ") nM=(" << n.x << "," << n.y << "," << n.z
                 << ") cosZ_M=" << cosZ << " bary=(" << bary.x << "," << bary.y << "," << bary.z << ")");
         }
@@ -269,17 +280,19 @@ namespace VMAP
         return callback.hit;
     }
 
-    bool GroupModel::IntersectTriangle(const MeshTriangle& tri, std::vector<G3D::Vector3>::const_iterator vertices,
+    bool GroupModel::IntersectTriangle(const MeshTriangle& tri, const G3D::Vector3* vertices,
         const G3D::Ray& ray, float& distance)
     {
         const G3D::Vector3& v0 = vertices[tri.idx0];
         const G3D::Vector3& v1 = vertices[tri.idx1];
         const G3D::Vector3& v2 = vertices[tri.idx2];
+        return IntersectTriangleEdges(v0, v1 - v0, v2 - v0, ray, distance);
+    }
 
+    bool GroupModel::IntersectTriangleEdges(const G3D::Vector3& v0, const G3D::Vector3& edge1,
+        const G3D::Vector3& edge2, const G3D::Ray& ray, float& distance)
+    {
         // Ray-triangle intersection (Mller-Trumbore algorithm)
-        G3D::Vector3 edge1 = v1 - v0;
-        G3D::Vector3 edge2 = v2 - v0;
-
         G3D::Vector3 h = ray.direction().cross(edge2);
         float a = edge1.dot(h);
 
@@ -317,6 +330,15 @@ namespace VMAP
         return false;
     }
 
+    G3D::Vector3 GroupModel::GetTriangleNormal(uint32_t index) const
+    {
+        const MeshTriangle& mt = triangles[index];
+        if (mt.idx0 >= vertices.size() || mt.idx1 >= vertices.size() || mt.idx2 >= vertices.size())
+            return G3D::Vector3(0, 0, 0);
+        const G3D::Vector3& v0 = vertices[mt.idx0];
+        return (vertices[mt.idx1] - v0).cross(vertices[mt.idx2] - v0).directionOrZero();
+    }
+
     bool GroupModel::GetLiquidLevel(const G3D::Vector3& pos, float& liqHeight) const
     {
         if (iLiquid)
@@ -334,6 +356,13 @@ namespace VMAP
         return 0;
     }
 
+    size_t GroupModel::GetMemoryUsage() const
+    {
+        return vertices.size() * sizeof(G3D::Vector3) + triangles.size() * sizeof(MeshTriangle) +
+            (meshTree.tree.size() + meshTree.objects.size()) * sizeof(uint32_t) +
+            (iLiquid ? iLiquid->GetMemoryUsage() : 0);
+    }
+
     bool GroupModel::readFromFile(FILE* rf)
     {
         char chunk[8];
@@ -414,9 +443,6 @@ namespace VMAP
             }
         }
 
-        // Reset last hit tracking
-        m_lastHitTriangle = -1;
-
         // Read MBIH chunk (mesh BIH tree)
         if (!readChunk(rf, chunk, "MBIH", 4))
         {
@@ -456,9 +482,6 @@ namespace VMAP
 
     bool WorldModel::IntersectRay(const G3D::Ray& ray, float& distance, bool stopAtFirstHit, bool ignoreM2Model) const
     {
-        if (ignoreM2Model && (modelFlags & MOD_M2))
-            return false;
-
         // Small M2 workaround, maybe better make separate class with virtual intersection funcs
         // In any case, there's no need to use a bound tree if we only have one submodel
         if (groupModels.size() == 1)
@@ -469,6 +492,15 @@ namespace VMAP
         return isc.hit;
     }
 
+    size_t WorldModel::GetMemoryUsage() const
+    {
+        size_t bytes = sizeof(WorldModel) + groupModels.size() * sizeof(GroupModel) +
+            (groupTree.tree.size() + groupTree.objects.size()) * sizeof(uint32_t);
+        for (const GroupModel& group : groupModels)
+            bytes += group.GetMemoryUsage();
+        return bytes;
+    }
+
     bool WorldModel::GetAllMeshData(std::vector<G3D::Vector3>& outVertices,
         std::vector<uint32_t>& outIndices) const
     {
@@ -483,8 +515,8 @@ namespace VMAP
         auto groupIt = groupModels.begin();
         while (groupIt != groupModels.end())
         {
-            const std::vector<G3D::Vector3>& groupVerts = groupIt->GetVertices();
-            const std::vector<MeshTriangle>& groupTris = groupIt->GetTriangles();
+            const SceneArray<G3D::Vector3>& groupVerts = groupIt->GetVertices();
+            const SceneArray<MeshTriangle>& groupTris = groupIt->GetTriangles();
 
             // Copy vertices
             auto vertIt = groupVerts.begin();
@@ -529,8 +561,8 @@ namespace VMAP
             // Check if group intersects bounds
             if (groupIt->GetBound().intersects(bounds))
             {
-                const std::vector<G3D::Vector3>& groupVerts = groupIt->GetVertices();
-                const std::vector<MeshTriangle>& groupTris = groupIt->GetTriangles();
+                const SceneArray<G3D::Vector3>& groupVerts = groupIt->GetVertices();
+                const SceneArray<MeshTriangle>& groupTris = groupIt->GetTriangles();
 
                 // Copy vertices
                 auto vertIt = groupVerts.begin();
@@ -740,12 +772,9 @@ namespace VMAP
         return hit;
     }
 
-    bool WorldModel::IsUnderObject(const G3D::Vector3& p, const G3D::Vector3& up, bool m2,
+    bool WorldModel::IsUnderObject(const G3D::Vector3& p, const G3D::Vector3& up,
         float* outDist, float* inDist) const
     {
-        if (m2 && (modelFlags & MOD_M2))
-            return false;
-
         if (groupModels.empty())
             return false;
 
@@ -856,4 +885,353 @@ namespace VMAP
         LOG_TRACE("[WorldModel::GetLocationInfo] EXIT - Hit:" << hit);
         return hit;
     }
+
+    // ======================== Mapped (.vmm) format ========================
+    //
+    // One model as flat arrays: a header, a section table, then 64-byte
+    // aligned sections. Each group addresses its slice of the shared arrays
+    // through first/count pairs, so vertices, triangles and both BIH levels
+    // are used straight from the mapping. Liquids are small and are copied out on load.
+
+    namespace
+    {
+        constexpr uint32_t VMM_MAGIC = 0x464D4D56;   // "VMMF"
+        constexpr uint32_t VMM_VERSION = 3;          // bump when the layout changes
+        constexpr uint64_t VMM_SECTION_ALIGN = 64;
+        constexpr uint32_t VMM_NO_LIQUID = 0xFFFFFFFFu;
+
+        enum VmmSection : uint32_t
+        {
+            VMM_GROUPS,
+            VMM_VERTICES,
+            VMM_TRIANGLES,
+            VMM_MESH_NODES,
+            VMM_MESH_OBJECTS,
+            VMM_GROUP_NODES,
+            VMM_GROUP_OBJECTS,
+            VMM_LIQUIDS,
+            VMM_LIQUID_HEIGHTS,
+            VMM_LIQUID_FLAGS,
+            VMM_SECTION_COUNT
+        };
+
+        struct VmmSectionEntry
+        {
+            uint64_t offset;    // from start of file, VMM_SECTION_ALIGN aligned
+            uint32_t count;     // element count
+            uint32_t elemSize;  // sizeof(element), checked on load
+        };
+
+        struct VmmHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t sectionCount;
+            uint32_t rootWmoId;
+            uint64_t sourceSize;        // size of the .vmo this was converted from
+            uint64_t contentHash;       // WorldModelStore::HashContent of everything after the header
+            uint64_t sourceHash;        // WorldModelStore::HashContent of that .vmo
+            float groupTreeBounds[6];
+            uint32_t groupTreePrimCount;
+            uint32_t reserved[15];
+        };
+        static_assert(sizeof(VmmHeader) == 128, "VmmHeader layout changed");
+
+        struct VmmGroup
+        {
+            float bound[6];
+            float meshTreeBounds[6];
+            uint32_t mogpFlags;
+            uint32_t groupWmoId;
+            uint32_t firstVertex, vertexCount;
+            uint32_t firstTriangle, triangleCount;
+            uint32_t firstNode, nodeCount;
+            uint32_t firstObject, objectCount;
+            uint32_t meshPrimCount;
+            uint32_t liquid;                        // index into VMM_LIQUIDS or VMM_NO_LIQUID
+        };
+        static_assert(sizeof(VmmGroup) == 96, "VmmGroup layout changed");
+
+        struct VmmLiquid
+        {
+            uint32_t tilesX, tilesY;
+            float corner[3];
+            uint32_t type;
+            uint32_t firstHeight;   // (tilesX + 1) * (tilesY + 1) floats
+            uint32_t firstFlag;     // tilesX * tilesY bytes
+        };
+        static_assert(sizeof(VmmLiquid) == 32, "VmmLiquid layout changed");
+
+        void StoreBox(const G3D::AABox& box, float out[6])
+        {
+            out[0] = box.low().x; out[1] = box.low().y; out[2] = box.low().z;
+            out[3] = box.high().x; out[4] = box.high().y; out[5] = box.high().z;
+        }
+
+        G3D::AABox LoadBox(const float in[6])
+        {
+            return G3D::AABox(G3D::Vector3(in[0], in[1], in[2]), G3D::Vector3(in[3], in[4], in[5]));
+        }
+
+        // Slice [first, first + count) of a section; callers validated the range
+        template<typename T>
+        void BindVmmSlice(SceneArray<T>& array, const T* section, uint32_t first, uint32_t count)
+        {
+            if (count == 0)
+                array.clear();
+            else
+                array.SetView(section + first, count);
+        }
+
+        bool VmmRangeValid(uint32_t first, uint32_t count, uint32_t total)
+        {
+            return static_cast<uint64_t>(first) + count <= total;
+        }
+    }
+
+    bool WorldModel::writeMappedFile(const std::string& filename, uint64_t sourceSize, uint64_t sourceHash) const
+    {
+        std::vector<VmmGroup> groups;
+        std::vector<G3D::Vector3> vertices;
+        std::vector<MeshTriangle> triangles;
+        std::vector<uint32_t> meshNodes, meshObjects;
+        std::vector<VmmLiquid> liquids;
+        std::vector<float> liquidHeights;
+        std::vector<uint8_t> liquidFlags;
+
+        for (const GroupModel& group : groupModels)
+        {
+            VmmGroup record{};
+            StoreBox(group.iBound, record.bound);
+            StoreBox(group.meshTree.bounds, record.meshTreeBounds);
+            record.mogpFlags = group.iMogpFlags;
+            record.groupWmoId = group.iGroupWMOID;
+            record.firstVertex = static_cast<uint32_t>(vertices.size());
+            record.vertexCount = static_cast<uint32_t>(group.vertices.size());
+            record.firstTriangle = static_cast<uint32_t>(triangles.size());
+            record.triangleCount = static_cast<uint32_t>(group.triangles.size());
+            record.firstNode = static_cast<uint32_t>(meshNodes.size());
+            record.nodeCount = static_cast<uint32_t>(group.meshTree.tree.size());
+            record.firstObject = static_cast<uint32_t>(meshObjects.size());
+            record.objectCount = static_cast<uint32_t>(group.meshTree.objects.size());
+            record.meshPrimCount = group.meshTree.primCount();
+            record.liquid = VMM_NO_LIQUID;
+
+            vertices.insert(vertices.end(), group.vertices.begin(), group.vertices.end());
+            triangles.insert(triangles.end(), group.triangles.begin(), group.triangles.end());
+            meshNodes.insert(meshNodes.end(), group.meshTree.tree.begin(), group.meshTree.tree.end());
+            meshObjects.insert(meshObjects.end(), group.meshTree.objects.begin(), group.meshTree.objects.end());
+
+            if (const WmoLiquid* liquid = group.iLiquid)
+            {
+                VmmLiquid liquidRecord{};
+                liquidRecord.tilesX = liquid->iTilesX;
+                liquidRecord.tilesY = liquid->iTilesY;
+                liquidRecord.corner[0] = liquid->iCorner.x;
+                liquidRecord.corner[1] = liquid->iCorner.y;
+                liquidRecord.corner[2] = liquid->iCorner.z;
+                liquidRecord.type = liquid->iType;
+                liquidRecord.firstHeight = static_cast<uint32_t>(liquidHeights.size());
+                liquidRecord.firstFlag = static_cast<uint32_t>(liquidFlags.size());
+                const size_t heightCount = size_t(liquid->iTilesX + 1) * (liquid->iTilesY + 1);
+                const size_t flagCount = size_t(liquid->iTilesX) * liquid->iTilesY;
+                if (liquid->iHeight)
+                    liquidHeights.insert(liquidHeights.end(), liquid->iHeight, liquid->iHeight + heightCount);
+                else
+                    liquidHeights.insert(liquidHeights.end(), heightCount, 0.0f);
+                if (liquid->iFlags)
+                    liquidFlags.insert(liquidFlags.end(), liquid->iFlags, liquid->iFlags + flagCount);
+                else
+                    liquidFlags.insert(liquidFlags.end(), flagCount, uint8_t(0x0F));
+                record.liquid = static_cast<uint32_t>(liquids.size());
+                liquids.push_back(liquidRecord);
+            }
+            groups.push_back(record);
+        }
+
+        struct SectionSource { const void* data; size_t count; size_t elemSize; };
+        const SectionSource sources[VMM_SECTION_COUNT] = {
+            { groups.data(),             groups.size(),             sizeof(VmmGroup) },
+            { vertices.data(),           vertices.size(),           sizeof(G3D::Vector3) },
+            { triangles.data(),          triangles.size(),          sizeof(MeshTriangle) },
+            { meshNodes.data(),          meshNodes.size(),          sizeof(uint32_t) },
+            { meshObjects.data(),        meshObjects.size(),        sizeof(uint32_t) },
+            { groupTree.tree.data(),     groupTree.tree.size(),     sizeof(uint32_t) },
+            { groupTree.objects.data(),  groupTree.objects.size(),  sizeof(uint32_t) },
+            { liquids.data(),            liquids.size(),            sizeof(VmmLiquid) },
+            { liquidHeights.data(),      liquidHeights.size(),      sizeof(float) },
+            { liquidFlags.data(),        liquidFlags.size(),        sizeof(uint8_t) },
+        };
+
+        // Lay the file out in memory first: the header carries a hash of the rest
+        VmmSectionEntry sections[VMM_SECTION_COUNT] = {};
+        std::vector<uint8_t> image(sizeof(VmmHeader) + sizeof(sections));
+        for (uint32_t i = 0; i < VMM_SECTION_COUNT; ++i)
+        {
+            if (sources[i].count > UINT32_MAX)
+                return false;
+            const uint64_t offset = (image.size() + VMM_SECTION_ALIGN - 1) & ~(VMM_SECTION_ALIGN - 1);
+            const size_t bytes = sources[i].count * sources[i].elemSize;
+            image.resize(static_cast<size_t>(offset) + bytes);
+            if (bytes)
+                std::memcpy(image.data() + offset, sources[i].data, bytes);
+            sections[i].offset = offset;
+            sections[i].count = static_cast<uint32_t>(sources[i].count);
+            sections[i].elemSize = static_cast<uint32_t>(sources[i].elemSize);
+        }
+        std::memcpy(image.data() + sizeof(VmmHeader), sections, sizeof(sections));
+
+        VmmHeader header{};
+        header.magic = VMM_MAGIC;
+        header.version = VMM_VERSION;
+        header.sectionCount = VMM_SECTION_COUNT;
+        header.rootWmoId = RootWMOID;
+        header.sourceSize = sourceSize;
+        header.sourceHash = sourceHash;
+        StoreBox(groupTree.bounds, header.groupTreeBounds);
+        header.groupTreePrimCount = groupTree.primCount();
+        header.contentHash = WorldModelStore::HashContent(image.data() + sizeof(VmmHeader), image.size() - sizeof(VmmHeader));
+        std::memcpy(image.data(), &header, sizeof(header));
+
+        // Write beside the target and rename over it: other processes may
+        // have the current file mapped.
+        const std::string tmpPath = filename + ".tmp";
+        FILE* wf = fopen(tmpPath.c_str(), "wb");
+        if (!wf)
+            return false;
+        bool ok = fwrite(image.data(), 1, image.size(), wf) == image.size();
+        ok = (fclose(wf) == 0) && ok;
+
+        std::error_code ec;
+        if (ok)
+            std::filesystem::rename(tmpPath, filename, ec);
+        if (!ok || ec)
+        {
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+        return true;
+    }
+
+    bool WorldModel::readMappedFile(const std::string& filename, uint64_t sourceSize, uint64_t sourceHash)
+    {
+        auto mapping = std::make_shared<MappedFile>();
+        const size_t tableEnd = sizeof(VmmHeader) + VMM_SECTION_COUNT * sizeof(VmmSectionEntry);
+        if (!mapping->Open(filename.c_str()) || mapping->Size() < tableEnd)
+            return false;
+
+        const uint8_t* base = mapping->Data();
+        VmmHeader header;
+        std::memcpy(&header, base, sizeof(header));
+        if (header.magic != VMM_MAGIC || header.version != VMM_VERSION || header.sectionCount != VMM_SECTION_COUNT)
+        {
+            std::cerr << "[WorldModel] " << filename << ": not a version " << VMM_VERSION << " mapped model" << std::endl;
+            return false;
+        }
+        if (header.sourceSize != sourceSize || header.sourceHash != sourceHash)
+        {
+            std::cerr << "[WorldModel] " << filename << ": stale, converted from a different .vmo" << std::endl;
+            return false;
+        }
+        if (WorldModelStore::HashContent(base + sizeof(VmmHeader), mapping->Size() - sizeof(VmmHeader)) != header.contentHash)
+        {
+            std::cerr << "[WorldModel] " << filename << ": content hash mismatch" << std::endl;
+            return false;
+        }
+
+        VmmSectionEntry sections[VMM_SECTION_COUNT];
+        std::memcpy(sections, base + sizeof(VmmHeader), sizeof(sections));
+        const uint32_t expectedElemSize[VMM_SECTION_COUNT] = {
+            sizeof(VmmGroup), sizeof(G3D::Vector3), sizeof(MeshTriangle),
+            sizeof(uint32_t), sizeof(uint32_t), sizeof(uint32_t), sizeof(uint32_t),
+            sizeof(VmmLiquid), sizeof(float), sizeof(uint8_t) };
+        for (uint32_t i = 0; i < VMM_SECTION_COUNT; ++i)
+        {
+            const VmmSectionEntry& section = sections[i];
+            if (section.elemSize != expectedElemSize[i] ||
+                (section.offset % VMM_SECTION_ALIGN) != 0 ||
+                section.offset > mapping->Size() ||
+                static_cast<uint64_t>(section.count) * section.elemSize > mapping->Size() - section.offset)
+            {
+                std::cerr << "[WorldModel] " << filename << ": section " << i << " out of bounds or wrong element size" << std::endl;
+                return false;
+            }
+        }
+
+        const uint32_t triangleTotal = sections[VMM_TRIANGLES].count;
+        bool consistent = true;
+
+        auto sectionData = [&](VmmSection id) { return base + sections[id].offset; };
+        const auto* groupRecords = reinterpret_cast<const VmmGroup*>(sectionData(VMM_GROUPS));
+        const auto* liquidRecords = reinterpret_cast<const VmmLiquid*>(sectionData(VMM_LIQUIDS));
+        for (uint32_t i = 0; consistent && i < sections[VMM_GROUPS].count; ++i)
+        {
+            const VmmGroup& record = groupRecords[i];
+            consistent = VmmRangeValid(record.firstVertex, record.vertexCount, sections[VMM_VERTICES].count) &&
+                VmmRangeValid(record.firstTriangle, record.triangleCount, triangleTotal) &&
+                VmmRangeValid(record.firstNode, record.nodeCount, sections[VMM_MESH_NODES].count) &&
+                VmmRangeValid(record.firstObject, record.objectCount, sections[VMM_MESH_OBJECTS].count) &&
+                (record.liquid == VMM_NO_LIQUID || record.liquid < sections[VMM_LIQUIDS].count);
+        }
+        for (uint32_t i = 0; consistent && i < sections[VMM_LIQUIDS].count; ++i)
+        {
+            const VmmLiquid& liquid = liquidRecords[i];
+            const uint64_t heightCount = uint64_t(liquid.tilesX + 1ull) * (liquid.tilesY + 1ull);
+            const uint64_t flagCount = uint64_t(liquid.tilesX) * liquid.tilesY;
+            consistent = liquid.firstHeight + heightCount <= sections[VMM_LIQUID_HEIGHTS].count &&
+                liquid.firstFlag + flagCount <= sections[VMM_LIQUID_FLAGS].count;
+        }
+        if (!consistent)
+        {
+            std::cerr << "[WorldModel] " << filename << ": inconsistent group or liquid records" << std::endl;
+            return false;
+        }
+
+        const auto* vertexData = reinterpret_cast<const G3D::Vector3*>(sectionData(VMM_VERTICES));
+        const auto* triangleData = reinterpret_cast<const MeshTriangle*>(sectionData(VMM_TRIANGLES));
+        const auto* meshNodes = reinterpret_cast<const uint32_t*>(sectionData(VMM_MESH_NODES));
+        const auto* meshObjects = reinterpret_cast<const uint32_t*>(sectionData(VMM_MESH_OBJECTS));
+        const auto* heightData = reinterpret_cast<const float*>(sectionData(VMM_LIQUID_HEIGHTS));
+        const auto* flagData = reinterpret_cast<const uint8_t*>(sectionData(VMM_LIQUID_FLAGS));
+
+        std::vector<GroupModel> groups(sections[VMM_GROUPS].count);
+        for (uint32_t i = 0; i < groups.size(); ++i)
+        {
+            const VmmGroup& record = groupRecords[i];
+            GroupModel& group = groups[i];
+            group.iBound = LoadBox(record.bound);
+            group.iMogpFlags = record.mogpFlags;
+            group.iGroupWMOID = record.groupWmoId;
+            BindVmmSlice(group.vertices, vertexData, record.firstVertex, record.vertexCount);
+            BindVmmSlice(group.triangles, triangleData, record.firstTriangle, record.triangleCount);
+            group.meshTree.bindView(LoadBox(record.meshTreeBounds), meshNodes + record.firstNode, record.nodeCount,
+                meshObjects + record.firstObject, record.objectCount, record.meshPrimCount);
+
+            if (record.liquid != VMM_NO_LIQUID)
+            {
+                const VmmLiquid& source = liquidRecords[record.liquid];
+                WmoLiquid* liquid = new WmoLiquid();
+                liquid->iTilesX = source.tilesX;
+                liquid->iTilesY = source.tilesY;
+                liquid->iCorner = G3D::Vector3(source.corner[0], source.corner[1], source.corner[2]);
+                liquid->iType = source.type;
+                const size_t heightCount = size_t(source.tilesX + 1) * (source.tilesY + 1);
+                const size_t flagCount = size_t(source.tilesX) * source.tilesY;
+                liquid->iHeight = new float[heightCount];
+                liquid->iFlags = new uint8_t[flagCount];
+                std::memcpy(liquid->iHeight, heightData + source.firstHeight, heightCount * sizeof(float));
+                std::memcpy(liquid->iFlags, flagData + source.firstFlag, flagCount);
+                group.setLiquidData(liquid);
+            }
+        }
+
+        groupTree.bindView(LoadBox(header.groupTreeBounds),
+            reinterpret_cast<const uint32_t*>(sectionData(VMM_GROUP_NODES)), sections[VMM_GROUP_NODES].count,
+            reinterpret_cast<const uint32_t*>(sectionData(VMM_GROUP_OBJECTS)), sections[VMM_GROUP_OBJECTS].count,
+            header.groupTreePrimCount);
+        RootWMOID = header.rootWmoId;
+        groupModels = std::move(groups);
+        mappedFile = std::move(mapping);
+        return true;
+    }
 } // namespace VMAP
\ No newline at end of file
@@ -8,9 +8,12 @@
 #include "AABox.h"
 #include "Ray.h"
 #include "BIH.h"
+#include "SceneArray.h"
 #include "G3D/BoundsTrait.h"
 #include "CoordinateTransforms.h"
 
+class MappedFile;
+
 namespace VMAP
 {
     // Forward declarations
@@ -64,10 +67,13 @@ namespace VMAP
 
         bool GetLiquidHeight(const G3D::Vector3& pos, float& liqHeight) const;
         uint32_t GetType() const { return iType; }
+        size_t GetMemoryUsage() const;
 
         static bool readFromFile(FILE* rf, WmoLiquid*& liquid);
 
     private:
+        friend class WorldModel; // .vmm reader/writer
+
         WmoLiquid() : iTilesX(0), iTilesY(0), iCorner(), iType(0), iHeight(nullptr), iFlags(nullptr) {}
     };
 
@@ -78,17 +84,16 @@ namespace VMAP
         G3D::AABox iBound;
         uint32_t iMogpFlags;
         uint32_t iGroupWMOID;
-        std::vector<G3D::Vector3> vertices;
-        std::vector<MeshTriangle> triangles;
+        SceneArray<G3D::Vector3> vertices;
+        SceneArray<MeshTriangle> triangles;
         BIH meshTree;
         WmoLiquid* iLiquid;
 
+        friend class WorldModel; // .vmm reader/writer
+
         GroupModel(const GroupModel& other) = delete;
         GroupModel& operator=(const GroupModel& other) = delete;
 
-        // Last triangle index hit by the most recent IntersectRay call (local to this group's triangles)
-        mutable int m_lastHitTriangle = -1;
-
     public:
         GroupModel() : iMogpFlags(0), iGroupWMOID(0), iLiquid(nullptr) {}
         GroupModel(uint32_t mogpFlags, uint32_t groupWMOID, const G3D::AABox& bound)
@@ -111,41 +116,53 @@ namespace VMAP
         ~GroupModel() { delete iLiquid; }
 
         void setLiquidData(WmoLiquid* liquid) { iLiquid = liquid; }
-        uint32_t IntersectRay(const G3D::Ray& ray, float& distance, bool stopAtFirstHit, bool ignoreM2Model) const;
+        // Returns the number of accepted hits; outHitTriangle (optional) receives
+        // the index of the triangle that set the final distance, or -1.
+        uint32_t IntersectRay(const G3D::Ray& ray, float& distance, bool stopAtFirstHit, bool ignoreM2Model,
+            int* outHitTriangle = nullptr) const;
         bool IsInsideObject(const G3D::Vector3& pos, const G3D::Vector3& down, float& z_dist) const;
         bool GetLiquidLevel(const G3D::Vector3& pos, float& liqHeight) const;
         uint32_t GetLiquidType() const;
+        // Bytes of the mesh, mesh BIH and liquid (mapped arrays included)
+        size_t GetMemoryUsage() const;
         bool readFromFile(FILE* rf);
         const G3D::AABox& GetBound() const { return iBound; }
         uint32_t GetMogpFlags() const { return iMogpFlags; }
         uint32_t GetWmoID() const { return iGroupWMOID; }
 
         // Mesh data access for external collision testing
-        const std::vector<G3D::Vector3>& GetVertices() const { return vertices; }
-        const std::vector<MeshTriangle>& GetTriangles() const { return triangles; }
+        const SceneArray<G3D::Vector3>& GetVertices() const { return vertices; }
+        const SceneArray<MeshTriangle>& GetTriangles() const { return triangles; }
+
+        // Unit normal of a triangle (zero for a degenerate or malformed one),
+        // computed on demand.
+        G3D::Vector3 GetTriangleNormal(uint32_t index) const;
 
         static bool IntersectTriangle(const MeshTriangle& tri,
-            std::vector<G3D::Vector3>::const_iterator vertices,
+            const G3D::Vector3* vertices,
             const G3D::Ray& ray, float& distance);
 
+        // Moller-Trumbore against a triangle given by its first vertex and
+        // the edges to the other two; IntersectTriangle computes the edges
+        // and calls this.
+        static bool IntersectTriangleEdges(const G3D::Vector3& v0, const G3D::Vector3& edge1,
+            const G3D::Vector3& edge2, const G3D::Ray& ray, float& distance);
+
+        // Mesh BIH callback. Edges are formed from the shared vertex table per
+        // candidate, which costs two subtractions but no per-triangle storage;
+        // a triangle indexing past the table never hits. Hit state lives in
+        // the callback, so concurrent rays never share anything.
         struct GModelRayCallback
         {
-            GModelRayCallback(std::vector<MeshTriangle> const& tris, std::vector<G3D::Vector3> const& vert, GroupModel* parentPtr) :
-                vertices(vert.begin()), triangles(tris.begin()), hit(0), parent(parentPtr), lastHitIndex(-1) {
-            }
+            explicit GModelRayCallback(const GroupModel& model)
+                : vertices(model.vertices.data()), triangles(model.triangles.data()),
+                vertexCount(static_cast<uint32_t>(model.vertices.size())), hit(0), lastHitIndex(-1) {}
 
             bool operator()(G3D::Ray const& ray, uint32_t entry, float& distance, bool /*stopAtFirstHit*/, bool /*ignoreM2Model*/)
             {
                 const MeshTriangle& mt = triangles[entry];
-                G3D::Vector3 mv0 = vertices[mt.idx0];
-                G3D::Vector3 mv1 = vertices[mt.idx1];
-                G3D::Vector3 mv2 = vertices[mt.idx2];
-
-                // Compute triangle normal and area (kept for potential future use)
-                G3D::Vector3 triNormal = (mv1 - mv0).cross(mv2 - mv0);
-                float triArea = triNormal.magnitude() * 0.5f;
-                if (triArea > 0.00001f) triNormal = triNormal / (2.0f * triArea);
-                else triNormal = { 0,0,0 };
+                if (mt.idx0 >= vertexCount || mt.idx1 >= vertexCount || mt.idx2 >= vertexCount)
+                    return false;
 
                 bool result = GroupModel::IntersectTriangle(mt, vertices, ray, distance);
 
@@ -153,38 +170,46 @@ namespace VMAP
                 {
                     ++hit;
                     lastHitIndex = (int)entry;
-                    if (parent) parent->m_lastHitTriangle = lastHitIndex;
                 }
 
                 return result;
             }
 
-            std::vector<G3D::Vector3>::const_iterator vertices;
-            std::vector<MeshTriangle>::const_iterator triangles;
+            const G3D::Vector3* vertices;
+            const MeshTriangle* triangles;
+            uint32_t vertexCount;
             uint32_t hit;
             int lastHitIndex;
-            GroupModel* parent;
         };
-
-        int GetLastHitTriangle() const { return m_lastHitTriangle; }
     };
 
     // WorldModel class with cylinder collision support
     class WorldModel
     {
     public:
-        WorldModel() : RootWMOID(0), modelFlags(0) {}
+        WorldModel() : RootWMOID(0) {}
 
         void setRootWmoID(uint32_t id) { RootWMOID = id; }
         bool IntersectRay(const G3D::Ray& ray, float& distance, bool stopAtFirstHit, bool ignoreM2Model) const;
         bool IntersectPoint(const G3D::Vector3& p, const G3D::Vector3& down, float& dist, AreaInfo& info) const;
-        bool IsUnderObject(const G3D::Vector3& p, const G3D::Vector3& up, bool m2,
+        bool IsUnderObject(const G3D::Vector3& p, const G3D::Vector3& up,
             float* outDist = nullptr, float* inDist = nullptr) const;
         bool GetLocationInfo(const G3D::Vector3& p, const G3D::Vector3& down, float& dist,
             GroupLocationInfo& info) const;
         bool readFile(const std::string& filename);
-        void setModelFlags(uint32_t newFlags) { modelFlags = newFlags; }
-        uint32_t getModelFlags() const { return modelFlags; }
+
+        // Memory-mapped form (.vmm, see WorldModelStore): the arrays of every
+        // group and both BIH levels are used in place from the mapping.
+        // The header records the size and WorldModelStore::HashContent of
+        // the .vmo it was converted from. readMappedFile validates the
+        // header, the section table and the file's own content hash, and
+        // rejects files converted from a .vmo other than the one given by
+        // sourceSize and sourceHash.
+        bool readMappedFile(const std::string& filename, uint64_t sourceSize, uint64_t sourceHash);
+        bool writeMappedFile(const std::string& filename, uint64_t sourceSize, uint64_t sourceHash) const;
+        bool IsMapped() const { return mappedFile != nullptr; }
+        // Bytes held by all groups and the group BIH, whether owned or mapped
+        size_t GetMemoryUsage() const;
 
         // Mesh data extraction for external use
         bool GetAllMeshData(std::vector<G3D::Vector3>& outVertices,
@@ -205,7 +230,7 @@ namespace VMAP
         uint32_t RootWMOID;
         std::vector<GroupModel> groupModels;
         BIH groupTree;
-        uint32_t modelFlags;
+        std::shared_ptr<MappedFile> mappedFile; // backing for mapped models
     };
 } // namespace VMAP
 
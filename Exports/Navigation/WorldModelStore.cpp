@@ -0,0 +1,215 @@
+// WorldModelStore.cpp - Content-deduplicated, refcounted .vmo model store.
+
+#include "WorldModelStore.h"
+#include "WorldModel.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+namespace VMAP
+{
+    namespace
+    {
+        bool ReadFileBytes(const std::string& path, std::vector<char>& bytes)
+        {
+            FILE* rf = fopen(path.c_str(), "rb");
+            if (!rf)
+                return false;
+            bool ok = fseek(rf, 0, SEEK_END) == 0;
+            long size = ok ? ftell(rf) : -1;
+            ok = ok && size >= 0 && fseek(rf, 0, SEEK_SET) == 0;
+            if (ok)
+            {
+                bytes.resize(static_cast<size_t>(size));
+                ok = bytes.empty() || fread(bytes.data(), 1, bytes.size(), rf) == bytes.size();
+            }
+            fclose(rf);
+            return ok;
+        }
+    }
+
+    WorldModelStore::WorldModelStore()
+    {
+        const char* mapped = std::getenv("WWOW_VMAP_MAPPED_MODELS");
+        m_useMappedModels = !(mapped && mapped[0] == '0');
+    }
+
+    WorldModelStore& WorldModelStore::Instance()
+    {
+        static WorldModelStore store;
+        return store;
+    }
+
+    // 64-bit words folded with a multiply and a high-to-low xor-shift,
+    // then the tail bytes. Keys also carry the file size.
+    uint64_t WorldModelStore::HashContent(const void* data, size_t size)
+    {
+        const char* p = static_cast<const char*>(data);
+        uint64_t h = 1469598103934665603ull;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t w;
+            std::memcpy(&w, p + i, 8);
+            h ^= w;
+            h *= 0x9E3779B97F4A7C15ull;
+            h ^= h >> 32;
+        }
+        for (; i < size; ++i)
+            h = (h ^ static_cast<unsigned char>(p[i])) * 1099511628211ull;
+        return h;
+    }
+
+    std::string WorldModelStore::MappedPathFor(const std::string& vmoPath)
+    {
+        return std::filesystem::path(vmoPath).replace_extension(".vmm").string();
+    }
+
+    std::shared_ptr<const WorldModel> WorldModelStore::FindLocked(const ContentKey& key)
+    {
+        auto it = m_models.find(key);
+        if (it == m_models.end())
+            return nullptr;
+        std::shared_ptr<const WorldModel> model = it->second.lock();
+        if (!model)
+            m_models.erase(it); // last user released it
+        return model;
+    }
+
+    std::shared_ptr<const WorldModel> WorldModelStore::Acquire(const std::string& path)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto known = m_pathKeys.find(path);
+            if (known != m_pathKeys.end())
+            {
+                if (std::shared_ptr<const WorldModel> model = FindLocked(known->second))
+                    return model;
+            }
+        }
+
+        // A file with the same contents as a live model shares that model
+        std::vector<char> bytes;
+        if (!ReadFileBytes(path, bytes))
+            return nullptr;
+        const ContentKey key{ HashContent(bytes.data(), bytes.size()), static_cast<uint64_t>(bytes.size()) };
+        bytes = std::vector<char>();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pathKeys[path] = key;
+            if (std::shared_ptr<const WorldModel> model = FindLocked(key))
+                return model;
+        }
+
+        if (m_useMappedModels)
+        {
+            if (std::shared_ptr<const WorldModel> model = AcquireMapped(path, key))
+                return model;
+        }
+
+        std::shared_ptr<WorldModel> parsed = std::make_shared<WorldModel>();
+        if (!parsed->readFile(path))
+            return nullptr;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_parsedFiles;
+        // Another thread may have parsed the same contents meanwhile; keep the first
+        if (std::shared_ptr<const WorldModel> existing = FindLocked(key))
+            return existing;
+        m_models[key] = parsed;
+        return parsed;
+    }
+
+    // nullptr when there is no usable .vmm for the .vmo with content key
+    // `key`; a stale or damaged one is reported by the reader and the caller
+    // parses the .vmo instead. A mapped model is keyed by its .vmo, so it
+    // is shared with files of the same contents however they were loaded.
+    std::shared_ptr<const WorldModel> WorldModelStore::AcquireMapped(const std::string& path, const ContentKey& key)
+    {
+        std::error_code ec;
+        const std::string mappedPath = MappedPathFor(path);
+        if (mappedPath == path || !std::filesystem::exists(mappedPath, ec))
+            return nullptr;
+
+        std::shared_ptr<WorldModel> mapped = std::make_shared<WorldModel>();
+        if (!mapped->readMappedFile(mappedPath, key.size, key.hash))
+            return nullptr;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_mappedFiles;
+        if (std::shared_ptr<const WorldModel> existing = FindLocked(key))
+            return existing;
+        m_models[key] = mapped;
+        return mapped;
+    }
+
+    bool WorldModelStore::ConvertToMapped(const std::string& vmoPath)
+    {
+        std::vector<char> bytes;
+        if (!ReadFileBytes(vmoPath, bytes))
+            return false;
+        const uint64_t sourceHash = HashContent(bytes.data(), bytes.size());
+        const uint64_t sourceSize = bytes.size();
+        bytes = std::vector<char>();
+        WorldModel model;
+        if (!model.readFile(vmoPath))
+            return false;
+        return model.writeMappedFile(MappedPathFor(vmoPath), sourceSize, sourceHash);
+    }
+
+    int WorldModelStore::ConvertDirectory(const std::string& directory)
+    {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(directory, ec))
+            return -1;
+
+        std::vector<std::string> sources;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, ec))
+        {
+            std::string ext = entry.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (entry.is_regular_file(ec) && ext == ".vmo")
+                sources.push_back(entry.path().string());
+        }
+
+        std::vector<char> converted(sources.size(), 0);
+        Parallel::For(sources.size(), [&](size_t i) { converted[i] = ConvertToMapped(sources[i]) ? 1 : 0; });
+
+        int count = 0;
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            if (converted[i])
+                ++count;
+            else
+                std::cerr << "[WorldModelStore] Failed to convert " << sources[i] << std::endl;
+        }
+        return count;
+    }
+
+    size_t WorldModelStore::LiveModelCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t live = 0;
+        for (const auto& entry : m_models)
+            if (!entry.second.expired())
+                ++live;
+        return live;
+    }
+
+    uint64_t WorldModelStore::ParsedFileCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_parsedFiles;
+    }
+
+    uint64_t WorldModelStore::MappedFileCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_mappedFiles;
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+// WorldModelStore.h - Process-wide store of parsed .vmo models.
+// VMapManager2, DynamicObjectRegistry and SceneCache extraction all load
+// their models through here, so a model is parsed and held in memory once
+// no matter how many maps, subsystems or file names refer to it. Models are
+// deduplicated by a hash of the file contents and handed out as immutable
+// shared_ptrs; the store only keeps weak references, so a model is freed
+// when its last user releases it and reparsed if it is needed again.
+//
+// A .vmm file beside a .vmo (written offline by ConvertToMapped) is the same
+// model laid out as flat, aligned arrays, stamped with the size and content
+// hash of its .vmo. When one is present and matches its .vmo it is
+// memory-mapped and used in place instead of parsing, so loading costs two
+// hash checks and processes on one host share its pages through the OS
+// page cache. WWOW_VMAP_MAPPED_MODELS=0 ignores .vmm files.
+//
+// Per-spawn state such as the M2 flag lives on ModelInstance, never on the
+// shared model.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace VMAP
+{
+    class WorldModel;
+
+    class WorldModelStore
+    {
+    public:
+        static WorldModelStore& Instance();
+
+        // Model loaded from the .vmo at `path` (or its .vmm), or nullptr when
+        // the file is missing or does not parse. Thread-safe; files are read
+        // and parsed outside the store lock.
+        std::shared_ptr<const WorldModel> Acquire(const std::string& path);
+
+        // Unique models currently alive, .vmo files parsed and .vmm files
+        // mapped since start-up (a file whose contents were already loaded
+        // is neither parsed nor mapped again).
+        size_t LiveModelCount() const;
+        uint64_t ParsedFileCount() const;
+        uint64_t MappedFileCount() const;
+
+        // Offline conversion: write the .vmm for one .vmo, or for every .vmo
+        // in a directory (in parallel). ConvertDirectory returns the number
+        // of files converted, or -1 when the directory does not exist.
+        static bool ConvertToMapped(const std::string& vmoPath);
+        static int ConvertDirectory(const std::string& directory);
+        static std::string MappedPathFor(const std::string& vmoPath);
+
+        // Content hash used for deduplication and to validate .vmm files
+        static uint64_t HashContent(const void* data, size_t size);
+
+    private:
+        WorldModelStore();
+
+        struct ContentKey
+        {
+            uint64_t hash;
+            uint64_t size;
+            bool operator==(const ContentKey& o) const { return hash == o.hash && size == o.size; }
+        };
+        struct ContentKeyHash
+        {
+            size_t operator()(const ContentKey& k) const { return static_cast<size_t>(k.hash ^ (k.size * 0x9E3779B97F4A7C15ull)); }
+        };
+
+        std::shared_ptr<const WorldModel> FindLocked(const ContentKey& key);
+        std::shared_ptr<const WorldModel> AcquireMapped(const std::string& path, const ContentKey& key);
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string, ContentKey> m_pathKeys;
+        std::unordered_map<ContentKey, std::weak_ptr<const WorldModel>, ContentKeyHash> m_models;
+        uint64_t m_parsedFiles = 0;
+        uint64_t m_mappedFiles = 0;
+        bool m_useMappedModels = true;
+    };
+}
@@ -817,9 +817,15 @@ namespace WoWSharpClient.Movement
             // Physics is always local — NativeLocalPhysics.Step calls Navigation.dll directly.
             // No remote fallback. WoW.exe runs physics locally; so do we.
             _ = EnsureLocalSceneDataFresh();
-            return NativeLocalPhysics.Step(input);
+            return NativeLocalPhysics.Step(input, _player.Guid);
         }
 
+        /// <summary>
+        /// Releases the collision geometry Navigation.dll keeps for this player
+        /// between steps. Call when the player logs out, disconnects or leaves the world.
+        /// </summary>
+        public void ReleasePhysicsAgent() => NativeLocalPhysics.ReleaseAgent(_player.Guid);
+
         private bool EnsureLocalSceneDataFresh()
         {
             if (_sceneDataClient == null)
@@ -835,6 +841,9 @@ namespace WoWSharpClient.Movement
                 _lastSceneRefreshY = float.NaN;
             }
 
+            // Put back tiles a native reset dropped without waiting for the next refresh
+            _sceneDataClient.ResyncNativeTilesIfReset(_player.MapId);
+
             float dx = _player.Position.X - _lastSceneRefreshX;
             float dy = _player.Position.Y - _lastSceneRefreshY;
             if (!float.IsNaN(_lastSceneRefreshX)
@@ -1,4 +1,5 @@
 using System;
+using System.Collections.Concurrent;
 using System.IO;
 using System.Runtime.InteropServices;
 using System.Collections.Generic;
@@ -17,6 +18,8 @@ public static class NativeLocalPhysics
     private static readonly object _preloadLock = new();
     private static List<uint> _preloadedMapIds = [];
     private static HashSet<uint> _preloadedMapIdSet = [];
+    // Agents Navigation.dll holds a geometry cache for, until ReleaseAgent
+    private static readonly ConcurrentDictionary<ulong, byte> _nativeAgents = new();
     internal static Func<NativePhysics.PhysicsInput, NativePhysics.PhysicsOutput>? TestStepOverride { get; set; }
     public static Action<uint>? TestClearSceneCacheOverride { get; set; }
     public static Action<uint>? TestPreloadMapOverride { get; set; }
@@ -26,9 +29,14 @@ public static class NativeLocalPhysics
     public static Func<uint, float, float, float, float, float, (float groundZ, bool found)>? TestGetWalkableGroundZOverride { get; set; }
     public static Func<uint, float, float, float, float, float, float, bool>? TestLineOfSightOverride { get; set; }
     public static Func<uint, float, float, float, float, float, float, bool>? TestSegmentIntersectsDynamicObjectsOverride { get; set; }
+    public static Action<ulong>? TestReleaseAgentOverride { get; set; }
     public static IReadOnlyList<uint> PreloadedMapIds => _preloadedMapIds;
 
-    public static PhysicsOutput Step(PhysicsInput proto)
+    /// <param name="agentGuid">
+    /// GUID of the bot being stepped. When non-zero, Navigation.dll keeps the
+    /// collision geometry around the bot between steps.
+    /// </param>
+    public static PhysicsOutput Step(PhysicsInput proto, ulong agentGuid = 0)
     {
         if (TestStepOverride == null || TestPreloadMapOverride != null)
             EnsureMapPreloaded(proto.MapId);
@@ -100,9 +108,14 @@ public static class NativeLocalPhysics
                 input.NearbyObjectCount = nearbyObjects.Length;
             }
 
+            if (TestStepOverride == null && agentGuid != 0 && !_nativeAgents.ContainsKey(agentGuid))
+                _nativeAgents.TryAdd(agentGuid, 0);
+
             var output = TestStepOverride != null
                 ? TestStepOverride(input)
-                : NativePhysics.PhysicsStepV2(ref input);
+                : agentGuid != 0
+                    ? NativePhysics.PhysicsStepV2ForAgent(agentGuid, ref input)
+                    : NativePhysics.PhysicsStepV2(ref input);
 
             var outFlags = (MovementFlags)output.MoveFlags;
             outFlags &= ~MovementFlags.MOVEFLAG_MOVED;
@@ -153,6 +166,25 @@ public static class NativeLocalPhysics
         }
     }
 
+    /// <summary>
+    /// Drop the geometry Navigation.dll caches for <paramref name="agentGuid"/>
+    /// between steps (logout, disconnect, leaving the world). A GUID that never
+    /// stepped natively is ignored.
+    /// </summary>
+    public static void ReleaseAgent(ulong agentGuid)
+    {
+        if (TestReleaseAgentOverride != null)
+        {
+            TestReleaseAgentOverride(agentGuid);
+            return;
+        }
+
+        if (agentGuid == 0 || !_nativeAgents.TryRemove(agentGuid, out _))
+            return;
+
+        NativePhysics.ReleasePhysicsAgent(agentGuid);
+    }
+
     public static void ClearSceneCache(uint mapId)
     {
         if (TestClearSceneCacheOverride != null)
@@ -452,5 +484,6 @@ public static class NativeLocalPhysics
         _mapsPreloaded = false;
         _preloadedMapIds = [];
         _preloadedMapIdSet = [];
+        _nativeAgents.Clear();
     }
 }
@@ -20,6 +20,16 @@ internal static class NativePhysics
     [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
     public static extern PhysicsOutput PhysicsStepV2(ref PhysicsInput input);
 
+    /// <summary>
+    /// PhysicsStepV2 for a bot stepped every tick: agentId (the bot's GUID) keys
+    /// a native cache of the collision geometry around it. Same results.
+    /// </summary>
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern PhysicsOutput PhysicsStepV2ForAgent(ulong agentId, ref PhysicsInput input);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern void ReleasePhysicsAgent(ulong agentId);
+
     [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
     public static extern float GetGroundZ(uint mapId, float x, float y, float queryZ, float maxSearchDist);
 
@@ -40,6 +50,25 @@ internal static class NativePhysics
     public static extern bool InjectSceneTriangles(uint mapId, float minX, float minY, float maxX, float maxY,
         IntPtr triangles, int triangleCount);
 
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool InjectSceneTile(uint mapId, int tileX, int tileY,
+        float minX, float minY, float maxX, float maxY, IntPtr triangles, int triangleCount);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool EvictSceneTile(uint mapId, int tileX, int tileY);
+
+    /// <summary>
+    /// Bumped whenever the map's native scene cache is replaced, re-tiled or cleared.
+    /// </summary>
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern ulong GetSceneGeneration(uint mapId);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool IsSceneTileInjected(uint mapId, int tileX, int tileY);
+
     [StructLayout(LayoutKind.Sequential)]
     public struct XYZ
     {
@@ -12,6 +12,10 @@ namespace WoWSharpClient.Movement;
 /// it into the local Navigation.dll SceneCache. Uses 533y ADT tiles with a 3x3
 /// neighborhood around the bot's position. Tiles are cached locally and only
 /// requested when missing. Tiles outside a 5x5 eviction radius are unloaded.
+/// Each tile is injected into (and evicted from) the native cache on its own, so
+/// tiles that stay loaded while the bot moves are never re-sent or re-indexed.
+/// Only tiles the native cache accepted stay cached here; when something else
+/// resets the native cache, the tiles it lost are injected again.
 /// </summary>
 public sealed class SceneDataClient : ProtobufSocketClient<SceneTileRequest, SceneTileResponse>, IDisposable
 {
@@ -33,11 +37,18 @@ public sealed class SceneDataClient : ProtobufSocketClient<SceneTileRequest, Sce
     /// <summary>The tile key of the last injected center tile (for dedup).</summary>
     private string? _lastCenterTileKey;
 
+    /// <summary>Native scene generation per map, read right after this client's last tile sync.</summary>
+    private readonly Dictionary<uint, ulong> _syncedGenerations = new();
+
     internal static Func<uint, float, float, bool>? TestEnsureSceneDataAroundOverride { get; set; }
     internal static Func<SceneTileRequest, SceneTileResponse>? TestSendTileRequestOverride { get; set; }
     internal static Func<DateTime>? TestUtcNowOverride { get; set; }
     /// <summary>Test override: captures injected triangles instead of P/Invoking InjectSceneTriangles.</summary>
     internal static Func<uint, float, float, float, float, NativePhysics.InjectedTriangle[], bool>? TestInjectOverride { get; set; }
+    /// <summary>Test overrides for the per-tile native sync: InjectSceneTile, GetSceneGeneration, IsSceneTileInjected.</summary>
+    internal static Func<uint, uint, uint, NativePhysics.InjectedTriangle[], bool>? TestInjectTileOverride { get; set; }
+    internal static Func<uint, ulong>? TestSceneGenerationOverride { get; set; }
+    internal static Func<uint, uint, uint, bool>? TestTileInjectedOverride { get; set; }
     private DateTime _nextRetryUtc = DateTime.MinValue;
 
     public SceneDataClient(string ipAddress, int port, ILogger logger)
@@ -83,6 +94,8 @@ public sealed class SceneDataClient : ProtobufSocketClient<SceneTileRequest, Sce
         if (TestEnsureSceneDataAroundOverride != null)
             return TestEnsureSceneDataAroundOverride(mapId, x, y);
 
+        ResyncNativeTilesIfReset(mapId);
+
         var (centerTileX, centerTileY) = WorldToTile(x, y);
         string centerKey = $"{mapId}_{centerTileX}_{centerTileY}";
 
@@ -112,7 +125,7 @@ public sealed class SceneDataClient : ProtobufSocketClient<SceneTileRequest, Sce
         }
 
         // Request missing tiles
-        bool anyNewTile = false;
+        var newTiles = new List<CachedTile>();
         bool anyFailure = false;
         foreach (var (tx, ty, key) in neededTiles)
         {
@@ -161,9 +174,10 @@ public sealed class SceneDataClient : ProtobufSocketClient<SceneTileRequest, Sce
                     maxY = response.MaxY;
                 }
 
-                _tileCache[key] = new CachedTile(mapId, tx, ty,
+                var tile = new CachedTile(mapId, tx, ty,
                     UnpackTriangles(response), minX, minY, maxX, maxY);
-                anyNewTile = true;
+                _tileCache[key] = tile;
+                newTiles.Add(tile);
 
                 _logger.LogInformation("[SceneData] Cached tile ({TileX},{TileY}): {Count} triangles",
                     tx, ty, response.TriangleCount);
@@ -178,12 +192,15 @@ public sealed class SceneDataClient : ProtobufSocketClient<SceneTileRequest, Sce
         }
 
         // Evict tiles outside 5x5 radius
-        EvictDistantTiles(mapId, centerTileX, centerTileY);
+        var evictedTiles = EvictDistantTiles(mapId, centerTileX, centerTileY);
 
-        // If we got new tiles, merge and inject all loaded tiles
-        if (anyNewTile || !string.Equals(_lastCenterTileKey, centerKey, StringComparison.Ordinal))
+        // Push only the tile changes to Navigation.dll
+        if (TestInjectOverride != null)
+            InjectMergedTiles(mapId, TestInjectOverride);
+        else if (!SyncNativeTiles(mapId, newTiles, evictedTiles))
         {
-            InjectMergedTiles(mapId);
+            anyFailure = true;
+            MarkRetryAfterFailure(now);
         }
 
         if (anyFailure)
@@ -200,9 +217,10 @@ public sealed class SceneDataClient : ProtobufSocketClient<SceneTileRequest, Sce
     public bool EnsureSceneDataAt(uint mapId, float x, float y)
         => EnsureSceneDataAround(mapId, x, y);
 
-    private void EvictDistantTiles(uint mapId, uint centerTileX, uint centerTileY)
+    private List<CachedTile> EvictDistantTiles(uint mapId, uint centerTileX, uint centerTileY)
     {
         var toRemove = new List<string>();
+        var evicted = new List<CachedTile>();
         foreach (var (key, tile) in _tileCache)
         {
             // Evict all tiles from other maps (continent crossing)
@@ -220,12 +238,121 @@ public sealed class SceneDataClient : ProtobufSocketClient<SceneTileRequest, Sce
 
         foreach (var key in toRemove)
         {
+            evicted.Add(_tileCache[key]);
             _tileCache.Remove(key);
             _logger.LogDebug("[SceneData] Evicted tile {Key}", key);
         }
+
+        return evicted;
+    }
+
+    /// <summary>
+    /// Re-injects this client's tiles for <paramref name="mapId"/> that Navigation.dll
+    /// no longer holds because its scene cache was cleared or replaced (ClearSceneCache,
+    /// a .scene load, InjectSceneTriangles). One generation read when nothing changed.
+    /// </summary>
+    public void ResyncNativeTilesIfReset(uint mapId)
+    {
+        if (!_syncedGenerations.TryGetValue(mapId, out var synced))
+            return;
+        ulong generation = ReadSceneGeneration(mapId);
+        if (generation == synced)
+            return;
+
+        var lostTiles = new List<CachedTile>();
+        foreach (var tile in _tileCache.Values)
+        {
+            if (tile.MapId == mapId && tile.Triangles.Length > 0 && !IsTileInjected(tile))
+                lostTiles.Add(tile);
+        }
+
+        if (lostTiles.Count == 0)
+        {
+            // Another client changed the map; this client's tiles are all still there
+            _syncedGenerations[mapId] = generation;
+            return;
+        }
+
+        _logger.LogWarning("[SceneData] Native scene cache for map {MapId} lost {Count} tiles; re-injecting",
+            mapId, lostTiles.Count);
+
+        // Rejected tiles are dropped from the cache; the next refresh requests them again
+        if (!SyncNativeTiles(mapId, lostTiles, []))
+            _lastCenterTileKey = null;
     }
 
-    private void InjectMergedTiles(uint mapId)
+    /// <summary>
+    /// Evicts and injects tiles in Navigation.dll. A tile the native cache rejects is
+    /// removed from <see cref="_tileCache"/> so it is requested again. Returns false
+    /// when any tile was rejected.
+    /// </summary>
+    private bool SyncNativeTiles(uint mapId, List<CachedTile> newTiles, List<CachedTile> evictedTiles)
+    {
+        bool touched = false;
+        foreach (var tile in evictedTiles)
+        {
+            if (tile.Triangles.Length == 0)
+                continue;
+            NativePhysics.EvictSceneTile(tile.MapId, (int)tile.TileX, (int)tile.TileY);
+            touched = true;
+        }
+
+        bool allAccepted = true;
+        foreach (var tile in newTiles)
+        {
+            if (tile.Triangles.Length == 0)
+                continue;
+            touched = true;
+
+            if (!InjectTile(tile))
+            {
+                _tileCache.Remove($"{tile.MapId}_{tile.TileX}_{tile.TileY}");
+                allAccepted = false;
+                _logger.LogWarning("[SceneData] Navigation.dll rejected tile ({TileX},{TileY}) for map {MapId}",
+                    tile.TileX, tile.TileY, tile.MapId);
+                continue;
+            }
+
+            _logger.LogInformation("[SceneData] Injected tile ({TileX},{TileY}) for map {MapId}: {Count} triangles",
+                tile.TileX, tile.TileY, tile.MapId, tile.Triangles.Length);
+        }
+
+        if (touched)
+            _syncedGenerations[mapId] = ReadSceneGeneration(mapId);
+        return allAccepted;
+    }
+
+    private static bool InjectTile(CachedTile tile)
+    {
+        if (TestInjectTileOverride != null)
+            return TestInjectTileOverride(tile.MapId, tile.TileX, tile.TileY, tile.Triangles);
+
+        var handle = GCHandle.Alloc(tile.Triangles, GCHandleType.Pinned);
+        try
+        {
+            return NativePhysics.InjectSceneTile(tile.MapId, (int)tile.TileX, (int)tile.TileY,
+                tile.MinX, tile.MinY, tile.MaxX, tile.MaxY,
+                handle.AddrOfPinnedObject(), tile.Triangles.Length);
+        }
+        finally
+        {
+            handle.Free();
+        }
+    }
+
+    private static bool IsTileInjected(CachedTile tile)
+        => TestTileInjectedOverride?.Invoke(tile.MapId, tile.TileX, tile.TileY)
+           ?? NativePhysics.IsSceneTileInjected(tile.MapId, (int)tile.TileX, (int)tile.TileY);
+
+    private static ulong ReadSceneGeneration(uint mapId)
+        => TestSceneGenerationOverride?.Invoke(mapId) ?? NativePhysics.GetSceneGeneration(mapId);
+
+    /// <summary>
+    /// Test seam: hands the merged view of every loaded tile (what the native
+    /// cache now holds for the map) to <paramref name="inject"/>.
+    /// </summary>
+    private void InjectMergedTiles(uint mapId,
+        Func<uint, float, float, float, float, NativePhysics.InjectedTriangle[], bool> inject)
     {
         // Compute merged bounds and total triangle count
         float mergedMinX = float.MaxValue, mergedMinY = float.MaxValue;
@@ -262,26 +389,7 @@ public sealed class SceneDataClient : ProtobufSocketClient<SceneTileRequest, Sce
             offset += tile.Triangles.Length;
         }
 
-        // Inject into Navigation.dll
-        if (TestInjectOverride != null)
-        {
-            TestInjectOverride(mapId, mergedMinX, mergedMinY, mergedMaxX, mergedMaxY, merged);
-            return;
-        }
-
-        var handle = GCHandle.Alloc(merged, GCHandleType.Pinned);
-        try
-        {
-            NativePhysics.InjectSceneTriangles(mapId, mergedMinX, mergedMinY, mergedMaxX, mergedMaxY,
-                handle.AddrOfPinnedObject(), totalCount);
-        }
-        finally
-        {
-            handle.Free();
-        }
-
-        _logger.LogInformation("[SceneData] Injected {Count} merged triangles for map {MapId} ({Tiles} tiles)",
-            totalCount, mapId, _tileCache.Count);
+        inject(mapId, mergedMinX, mergedMinY, mergedMaxX, mergedMaxY, merged);
     }
 
     private static NativePhysics.InjectedTriangle[] UnpackTriangles(SceneTileResponse response)
@@ -243,6 +243,7 @@ namespace WoWSharpClient
                 && _woWClient != null
                 && (_useLocalPhysics || _sceneDataClient != null))
             {
+                _movementController?.ReleasePhysicsAgent();
                 _movementController = new MovementController(
                     _woWClient,
                     (WoWLocalPlayer)Player,
@@ -841,6 +842,7 @@ namespace WoWSharpClient
             _lastResolvedSceneEnvironmentFlags = SceneEnvironmentFlags.None;
             _lastResolvedSceneEnvironmentMapId = uint.MaxValue;
             _lastResolvedSceneEnvironmentPosition = null;
+            _movementController?.ReleasePhysicsAgent();
             _movementController = null;
 
             _pendingUpdates.Clear();
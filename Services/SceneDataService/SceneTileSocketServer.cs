@@ -156,44 +156,22 @@ public sealed class SceneTileSocketServer : ProtobufSocketServer<SceneTileReques
         using var fs = File.OpenRead(path);
         using var reader = new BinaryReader(fs);
 
-        // Read header (64 bytes)
-        uint magic = reader.ReadUInt32();
-        if (magic != 0x454E4353) // "SCNE"
-        {
-            _logger.LogWarning("[SceneTileServer] Invalid magic in {Path}: 0x{Magic:X8}", path, magic);
-            return null;
-        }
-
-        uint version = reader.ReadUInt32();
-        uint fileMapId = reader.ReadUInt32();
-        if (version != 1u && version != 2u)
-        {
-            _logger.LogWarning("[SceneTileServer] Unsupported version in {Path}: {Version}", path, version);
+        if (!TryReadSceneHeader(reader, path, out var header))
             return null;
-        }
 
-        if (fileMapId != mapId)
+        if (header.MapId != mapId)
         {
             _logger.LogWarning("[SceneTileServer] Tile header map mismatch in {Path}: expected {ExpectedMapId}, got {ActualMapId}",
-                path, mapId, fileMapId);
+                path, mapId, header.MapId);
             return null;
         }
 
-        uint triCount = reader.ReadUInt32();
-        float cellSize = reader.ReadSingle();
-        uint cellsX = reader.ReadUInt32();
-        uint cellsY = reader.ReadUInt32();
-        uint triIdxCount = reader.ReadUInt32();
-        float liquidCellSize = reader.ReadSingle();
-        uint liquidCellsX = reader.ReadUInt32();
-        uint liquidCellsY = reader.ReadUInt32();
-        float minX = reader.ReadSingle();
-        float minY = reader.ReadSingle();
-        float maxX = reader.ReadSingle();
-        float maxY = reader.ReadSingle();
-        uint reserved = reader.ReadUInt32();
+        uint triCount = header.TriangleCount;
+        float minX = header.MinX;
+        float minY = header.MinY;
+        float maxX = header.MaxX;
+        float maxY = header.MaxY;
 
-        // Read SceneTri payloads: 9 vertex floats plus sourceType + instanceId.
         var response = new SceneTileResponse
         {
             MapId = mapId,
@@ -214,54 +192,22 @@ public sealed class SceneTileSocketServer : ProtobufSocketServer<SceneTileReques
         var metadataBytes = new byte[checked((int)triCount * 3 * sizeof(uint))];
         int byteOffset = 0;
         int metadataByteOffset = 0;
-        var sourceTypes = new uint[checked((int)triCount)];
-        var instanceIds = new uint[checked((int)triCount)];
 
-        for (int i = 0; i < (int)triCount; i++)
+        ReadSceneTriangles(reader, header, (_, vertices, sourceType, instanceId, groupFlags) =>
         {
-            for (int f = 0; f < 9; f++)
+            foreach (float val in vertices)
             {
-                float val = reader.ReadSingle();
                 BitConverter.TryWriteBytes(rawBytes.AsSpan(byteOffset), val);
                 byteOffset += sizeof(float);
             }
 
-            sourceTypes[i] = reader.ReadUInt32();
-            instanceIds[i] = reader.ReadUInt32();
-        }
-
-        if (version >= 2u)
-        {
-            for (int i = 0; i < (int)triCount; i++)
-            {
-                uint sourceType = reader.ReadUInt32();
-                uint instanceId = reader.ReadUInt32();
-                reader.ReadUInt32(); // instanceFlags
-                reader.ReadUInt32(); // modelFlags
-                uint groupFlags = reader.ReadUInt32();
-                reader.ReadInt32();  // rootId
-                reader.ReadInt32();  // groupId
-
-                BitConverter.TryWriteBytes(metadataBytes.AsSpan(metadataByteOffset), sourceType);
-                metadataByteOffset += sizeof(uint);
-                BitConverter.TryWriteBytes(metadataBytes.AsSpan(metadataByteOffset), instanceId);
-                metadataByteOffset += sizeof(uint);
-                BitConverter.TryWriteBytes(metadataBytes.AsSpan(metadataByteOffset), groupFlags);
-                metadataByteOffset += sizeof(uint);
-            }
-        }
-        else
-        {
-            for (int i = 0; i < (int)triCount; i++)
-            {
-                BitConverter.TryWriteBytes(metadataBytes.AsSpan(metadataByteOffset), sourceTypes[i]);
-                metadataByteOffset += sizeof(uint);
-                BitConverter.TryWriteBytes(metadataBytes.AsSpan(metadataByteOffset), instanceIds[i]);
-                metadataByteOffset += sizeof(uint);
-                BitConverter.TryWriteBytes(metadataBytes.AsSpan(metadataByteOffset), 0u);
-                metadataByteOffset += sizeof(uint);
-            }
-        }
+            BitConverter.TryWriteBytes(metadataBytes.AsSpan(metadataByteOffset), sourceType);
+            metadataByteOffset += sizeof(uint);
+            BitConverter.TryWriteBytes(metadataBytes.AsSpan(metadataByteOffset), instanceId);
+            metadataByteOffset += sizeof(uint);
+            BitConverter.TryWriteBytes(metadataBytes.AsSpan(metadataByteOffset), groupFlags);
+            metadataByteOffset += sizeof(uint);
+        });
 
         using var compressedStream = new MemoryStream();
         using (var gzip = new GZipStream(compressedStream, CompressionLevel.Fastest, leaveOpen: true))
@@ -353,55 +299,20 @@ public sealed class SceneTileSocketServer : ProtobufSocketServer<SceneTileReques
         }
 
         var selectedTriangles = new List<float[]>();
-        var selectedTriangleLookup = new Dictionary<int, int>();
         var sourceTypes = new List<uint>();
         var instanceIds = new List<uint>();
         var groupFlags = new List<uint>();
 
-        for (int i = 0; i < (int)header.TriangleCount; i++)
+        ReadSceneTriangles(reader, header, (_, v, sourceType, instanceId, tileGroupFlags) =>
         {
-            float ax = reader.ReadSingle();
-            float ay = reader.ReadSingle();
-            float az = reader.ReadSingle();
-            float bx = reader.ReadSingle();
-            float by = reader.ReadSingle();
-            float bz = reader.ReadSingle();
-            float cx = reader.ReadSingle();
-            float cy = reader.ReadSingle();
-            float cz = reader.ReadSingle();
-            uint sourceType = reader.ReadUInt32();
-            uint instanceId = reader.ReadUInt32();
-
-            if (!TriangleOverlapsTile(ax, ay, bx, by, cx, cy, tileMinX, tileMinY, tileMaxX, tileMaxY))
-                continue;
+            if (!TriangleOverlapsTile(v[0], v[1], v[3], v[4], v[6], v[7], tileMinX, tileMinY, tileMaxX, tileMaxY))
+                return;
 
-            selectedTriangleLookup[i] = selectedTriangles.Count;
-            selectedTriangles.Add([ax, ay, az, bx, by, bz, cx, cy, cz]);
+            selectedTriangles.Add(v.ToArray());
             sourceTypes.Add(sourceType);
             instanceIds.Add(instanceId);
-            groupFlags.Add(0u);
-        }
-
-        if (header.Version >= 2u)
-        {
-            for (int i = 0; i < (int)header.TriangleCount; i++)
-            {
-                uint sourceType = reader.ReadUInt32();
-                uint instanceId = reader.ReadUInt32();
-                reader.ReadUInt32(); // instanceFlags
-                reader.ReadUInt32(); // modelFlags
-                uint tileGroupFlags = reader.ReadUInt32();
-                reader.ReadInt32();  // rootId
-                reader.ReadInt32();  // groupId
-
-                if (selectedTriangleLookup.TryGetValue(i, out var selectedIndex))
-                {
-                    sourceTypes[selectedIndex] = sourceType;
-                    instanceIds[selectedIndex] = instanceId;
-                    groupFlags[selectedIndex] = tileGroupFlags;
-                }
-            }
-        }
+            groupFlags.Add(tileGroupFlags);
+        });
 
         if (selectedTriangles.Count == 0)
         {
@@ -440,6 +351,9 @@ public sealed class SceneTileSocketServer : ProtobufSocketServer<SceneTileReques
 
         uint version = reader.ReadUInt32();
         uint mapId = reader.ReadUInt32();
+        if (version == 3u)
+            return TryReadSectionedSceneHeader(reader, path, mapId, out header);
+
         if (version != 1u && version != 2u)
         {
             _logger.LogWarning("[SceneTileServer] Unsupported version in {Path}: {Version}", path, version);
@@ -460,10 +374,133 @@ public sealed class SceneTileSocketServer : ProtobufSocketServer<SceneTileReques
         float maxY = reader.ReadSingle();
         reader.ReadUInt32(); // reserved
 
-        header = new SceneHeader(version, mapId, triangleCount, minX, minY, maxX, maxY);
+        // v1/v2 pack triangles right after the 64-byte header, metadata right after them.
+        long trianglesOffset = LegacySceneHeaderSize;
+        long metadataOffset = trianglesOffset + (long)triangleCount * SceneTriSize;
+        header = new SceneHeader(version, mapId, triangleCount, minX, minY, maxX, maxY, trianglesOffset, metadataOffset, 0, 0, 0);
         return true;
     }
 
+    /// <summary>
+    /// Sectioned (memory-mappable) layouts: fixed 128-byte header followed by a
+    /// section table of (offset u64, count u32, elemSize u32) (version 3).
+    /// Section 0 holds shared vertices (3 floats), section 1 compact triangles
+    /// (3 vertex indices + metadata index), section 2 the metadata table.
+    /// </summary>
+    private bool TryReadSectionedSceneHeader(BinaryReader reader, string path, uint mapId, out SceneHeader header)
+    {
+        header = default;
+
+        uint sectionCount = reader.ReadUInt32();
+        reader.ReadSingle(); // cellSize
+        float minX = reader.ReadSingle();
+        float minY = reader.ReadSingle();
+        float maxX = reader.ReadSingle();
+        float maxY = reader.ReadSingle();
+        if (sectionCount < 3u)
+        {
+            _logger.LogWarning("[SceneTileServer] Scene section table too short in {Path}: {SectionCount}", path, sectionCount);
+            return false;
+        }
+
+        reader.BaseStream.Position = SectionedSceneHeaderSize;
+        long verticesOffset = (long)reader.ReadUInt64();
+        uint vertexCount = reader.ReadUInt32();
+        uint vertexSize = reader.ReadUInt32();
+        long compactTrianglesOffset = (long)reader.ReadUInt64();
+        uint compactTriangleCount = reader.ReadUInt32();
+        uint compactTriangleSize = reader.ReadUInt32();
+        long metadataTableOffset = (long)reader.ReadUInt64();
+        uint metadataTableCount = reader.ReadUInt32();
+        uint metadataTableSize = reader.ReadUInt32();
+        if (vertexSize != SceneVertexSize || compactTriangleSize != CompactSceneTriSize || metadataTableSize != SceneTriMetadataSize)
+        {
+            _logger.LogWarning("[SceneTileServer] Unexpected scene record sizes in {Path}: vertex={VertexSize} tri={TriSize} meta={MetaSize}",
+                path, vertexSize, compactTriangleSize, metadataTableSize);
+            return false;
+        }
+
+        header = new SceneHeader(3u, mapId, compactTriangleCount, minX, minY, maxX, maxY,
+            compactTrianglesOffset, metadataTableOffset, verticesOffset, vertexCount, metadataTableCount);
+        return true;
+    }
+
+    private delegate void SceneTriangleVisitor(int index, ReadOnlySpan<float> vertices, uint sourceType, uint instanceId, uint groupFlags);
+
+    /// <summary>
+    /// Visit every triangle of a scene in file order as 9 vertex floats plus
+    /// sourceType, instanceId and groupFlags. Version 3 triangles are decoded
+    /// from the shared vertex buffer and metadata table; version 1 carries no
+    /// group flags (reported as 0).
+    /// </summary>
+    private static void ReadSceneTriangles(BinaryReader reader, SceneHeader header, SceneTriangleVisitor visit)
+    {
+        var stream = reader.BaseStream;
+        int triangleCount = checked((int)header.TriangleCount);
+        var vertices = new float[9];
+
+        if (header.Version >= 3u)
+        {
+            stream.Position = header.VerticesOffset;
+            var vertexFloats = new float[checked((int)header.VertexCount * 3)];
+            for (int i = 0; i < vertexFloats.Length; i++)
+                vertexFloats[i] = reader.ReadSingle();
+
+            stream.Position = header.MetadataOffset;
+            var metadataTable = new (uint SourceType, uint InstanceId, uint GroupFlags)[checked((int)header.MetadataCount)];
+            for (int i = 0; i < metadataTable.Length; i++)
+                metadataTable[i] = ReadSceneTriMetadata(reader);
+
+            stream.Position = header.TrianglesOffset;
+            for (int i = 0; i < triangleCount; i++)
+            {
+                for (int corner = 0; corner < 3; corner++)
+                    Array.Copy(vertexFloats, checked((int)reader.ReadUInt32() * 3), vertices, corner * 3, 3);
+
+                var metadata = metadataTable[reader.ReadUInt32()];
+                visit(i, vertices, metadata.SourceType, metadata.InstanceId, metadata.GroupFlags);
+            }
+
+            return;
+        }
+
+        // v2 keeps the authoritative metadata in a parallel array after the triangles.
+        (uint SourceType, uint InstanceId, uint GroupFlags)[]? triangleMetadata = null;
+        if (header.Version >= 2u)
+        {
+            stream.Position = header.MetadataOffset;
+            triangleMetadata = new (uint, uint, uint)[triangleCount];
+            for (int i = 0; i < triangleCount; i++)
+                triangleMetadata[i] = ReadSceneTriMetadata(reader);
+        }
+
+        stream.Position = header.TrianglesOffset;
+        for (int i = 0; i < triangleCount; i++)
+        {
+            for (int f = 0; f < 9; f++)
+                vertices[f] = reader.ReadSingle();
+            uint sourceType = reader.ReadUInt32();
+            uint instanceId = reader.ReadUInt32();
+
+            if (triangleMetadata != null)
+                visit(i, vertices, triangleMetadata[i].SourceType, triangleMetadata[i].InstanceId, triangleMetadata[i].GroupFlags);
+            else
+                visit(i, vertices, sourceType, instanceId, 0u);
+        }
+    }
+
+    private static (uint SourceType, uint InstanceId, uint GroupFlags) ReadSceneTriMetadata(BinaryReader reader)
+    {
+        uint sourceType = reader.ReadUInt32();
+        uint instanceId = reader.ReadUInt32();
+        reader.ReadUInt32(); // instanceFlags
+        reader.ReadUInt32(); // modelFlags
+        uint groupFlags = reader.ReadUInt32();
+        reader.ReadInt32();  // rootId
+        reader.ReadInt32();  // groupId
+        return (sourceType, instanceId, groupFlags);
+    }
+
     private static SceneTileResponse CreateCompressedResponse(
         uint mapId,
         uint tileX,
@@ -616,6 +653,13 @@ public sealed class SceneTileSocketServer : ProtobufSocketServer<SceneTileReques
         return tilesDirectory;
     }
 
+    private const int LegacySceneHeaderSize = 64;
+    private const int SectionedSceneHeaderSize = 128;
+    private const int SceneTriSize = 44;
+    private const int SceneTriMetadataSize = 28;
+    private const int SceneVertexSize = 12;
+    private const int CompactSceneTriSize = 16;
+
     private readonly record struct SceneHeader(
         uint Version,
         uint MapId,
@@ -623,5 +667,10 @@ public sealed class SceneTileSocketServer : ProtobufSocketServer<SceneTileReques
         float MinX,
         float MinY,
         float MaxX,
-        float MaxY);
+        float MaxY,
+        long TrianglesOffset,
+        long MetadataOffset,
+        long VerticesOffset,
+        uint VertexCount,
+        uint MetadataCount);
 }
@@ -94,6 +94,34 @@ public sealed class SceneTileSocketServerTests : IDisposable
         Assert.Equal([triangle.SourceType, triangle.InstanceId, triangle.GroupFlags], DecompressUInts(response.TriangleMetadataCompressed, 3));
     }
 
+    [Fact]
+    public void HandleRequest_Version3Tile_DecodesSharedVerticesAndMetadataTable()
+    {
+        var first = CreateTriangle(2u, 77u, 0x00000040u);
+        var second = new TriangleFixture([1f, 2f, 3f, 7f, 8f, 9f, 10f, 11f, 12f], 2u, 77u, 0x00000040u);
+        var terrain = new TriangleFixture([4f, 5f, 6f, 7f, 8f, 9f, 13f, 14f, 15f], 1u, 0u, 0u);
+        WriteSceneTile(
+            Path.Combine(_tempDirectory, "1_29_41.scenetile"),
+            version: 3,
+            fileMapId: 1,
+            triangles: [first, second, terrain],
+            minX: 10f, minY: 20f, maxX: 30f, maxY: 40f);
+
+        using var server = CreateServer();
+        server.LoadTiles(_tempDirectory);
+
+        var response = InvokeHandleRequest(server, 1, 29, 41);
+
+        Assert.True(response.Success);
+        Assert.Equal(3u, response.TriangleCount);
+        Assert.Equal(10f, response.MinX);
+        Assert.Equal(40f, response.MaxY);
+        Assert.Equal(first.Vertices.Concat(second.Vertices).Concat(terrain.Vertices).ToArray(),
+            DecompressFloats(response.TriangleDataCompressed, 27));
+        Assert.Equal([2u, 77u, 0x00000040u, 2u, 77u, 0x00000040u, 1u, 0u, 0u],
+            DecompressUInts(response.TriangleMetadataCompressed, 9));
+    }
+
     [Fact]
     public void HandleRequest_MapHeaderMismatch_ReturnsFailure()
     {
@@ -307,6 +335,12 @@ public sealed class SceneTileSocketServerTests : IDisposable
         using var stream = File.Create(path);
         using var writer = new BinaryWriter(stream);
 
+        if (version >= 3u)
+        {
+            WriteCompactSceneTile(writer, fileMapId, triangles, minX, minY, maxX, maxY);
+            return;
+        }
+
         writer.Write(0x454E4353u);
         writer.Write(version);
         writer.Write(fileMapId);
@@ -348,5 +382,114 @@ public sealed class SceneTileSocketServerTests : IDisposable
         }
     }
 
+    // Mirrors SceneCache's v3 layout: 128-byte fixed header, 10-entry section
+    // table, sections on 64-byte boundaries. The first three sections are the
+    // shared vertex buffer, compact triangles (three vertex indices + metadata
+    // index) and metadata table; the server never reads the index sections.
+    private static void WriteCompactSceneTile(
+        BinaryWriter writer,
+        uint fileMapId,
+        TriangleFixture[] triangles,
+        float minX,
+        float minY,
+        float maxX,
+        float maxY)
+    {
+        const int sectionCount = 10;
+        const int headerSize = 128 + sectionCount * 16;
+        static long Align(long offset) => (offset + 63) & ~63L;
+
+        var vertices = new List<(float X, float Y, float Z)>();
+        var vertexIds = new Dictionary<(float, float, float), uint>();
+        var metadata = new List<TriangleFixture>();
+        var metadataIds = new Dictionary<(uint, uint, uint), uint>();
+        var compact = new List<uint[]>();
+        foreach (var triangle in triangles)
+        {
+            var refs = new uint[4];
+            for (int corner = 0; corner < 3; corner++)
+            {
+                var vertex = (triangle.Vertices[corner * 3], triangle.Vertices[corner * 3 + 1], triangle.Vertices[corner * 3 + 2]);
+                if (!vertexIds.TryGetValue(vertex, out refs[corner]))
+                {
+                    refs[corner] = (uint)vertices.Count;
+                    vertexIds[vertex] = refs[corner];
+                    vertices.Add(vertex);
+                }
+            }
+
+            var key = (triangle.SourceType, triangle.InstanceId, triangle.GroupFlags);
+            if (!metadataIds.TryGetValue(key, out refs[3]))
+            {
+                refs[3] = (uint)metadata.Count;
+                metadataIds[key] = refs[3];
+                metadata.Add(triangle);
+            }
+
+            compact.Add(refs);
+        }
+
+        long verticesOffset = Align(headerSize);
+        long trianglesOffset = Align(verticesOffset + vertices.Count * 12L);
+        long metadataOffset = Align(trianglesOffset + compact.Count * 16L);
+        long endOffset = Align(metadataOffset + metadata.Count * 28L);
+
+        writer.Write(0x454E4353u);
+        writer.Write(3u);
+        writer.Write(fileMapId);
+        writer.Write((uint)sectionCount);
+        writer.Write(4.0f);
+        writer.Write(minX);
+        writer.Write(minY);
+        writer.Write(maxX);
+        writer.Write(maxY);
+        while (writer.BaseStream.Position < 128)
+            writer.Write(0u);
+
+        writer.Write((ulong)verticesOffset);
+        writer.Write((uint)vertices.Count);
+        writer.Write(12u);
+        writer.Write((ulong)trianglesOffset);
+        writer.Write((uint)compact.Count);
+        writer.Write(16u);
+        writer.Write((ulong)metadataOffset);
+        writer.Write((uint)metadata.Count);
+        writer.Write(28u);
+        for (int i = 3; i < sectionCount; i++)
+        {
+            writer.Write((ulong)endOffset);
+            writer.Write(0u);
+            writer.Write(4u);
+        }
+
+        writer.BaseStream.SetLength(endOffset);
+        writer.BaseStream.Position = verticesOffset;
+        foreach (var (x, y, z) in vertices)
+        {
+            writer.Write(x);
+            writer.Write(y);
+            writer.Write(z);
+        }
+
+        writer.BaseStream.Position = trianglesOffset;
+        foreach (var refs in compact)
+        {
+            foreach (var value in refs)
+                writer.Write(value);
+        }
+
+        writer.BaseStream.Position = metadataOffset;
+        foreach (var entry in metadata)
+        {
+            writer.Write(entry.SourceType);
+            writer.Write(entry.InstanceId);
+            writer.Write(0u);
+            writer.Write(0u);
+            writer.Write(entry.GroupFlags);
+            writer.Write(-1);
+            writer.Write(-1);
+        }
+    }
+
     private sealed record TriangleFixture(float[] Vertices, uint SourceType, uint InstanceId, uint GroupFlags);
 }
@@ -0,0 +1,120 @@
+using Xunit;
+using Xunit.Abstractions;
+using static Navigation.Physics.Tests.NavigationInterop;
+
+namespace Navigation.Physics.Tests;
+
+/// <summary>
+/// Per-agent contact cache: stepping through PhysicsStepV2ForAgent reuses the
+/// collision geometry around the bot between frames, must give exactly the
+/// same results as PhysicsStepV2, and must see scene changes immediately.
+/// </summary>
+[Collection("PhysicsEngine")]
+public sealed class AgentContactCacheTests(PhysicsEngineFixture fixture, ITestOutputHelper output) : IDisposable
+{
+    private const uint TestMapId = 1;
+    private const float TileSize = 533.33333f;
+    private const uint MOVEFLAG_FORWARD = 0x1u;
+    private const ulong AgentId = 0xA6E17u;
+    private readonly PhysicsEngineFixture _fixture = fixture;
+    private readonly ITestOutputHelper _output = output;
+
+    public void Dispose()
+    {
+        if (!_fixture.IsInitialized)
+            return;
+        ReleasePhysicsAgent(AgentId);
+        ClearSceneCache(TestMapId);
+    }
+
+    [SkippableFact]
+    public void AgentStep_MatchesPlainStep_AndSeesSceneChanges()
+    {
+        Skip.If(!_fixture.IsInitialized, "Physics engine not available");
+
+        ClearSceneCache(TestMapId);
+        var scene = Scene(10f);
+        Assert.True(InjectSceneTile(TestMapId, 32, 32, 0f, 0f, TileSize, TileSize, scene, scene.Length));
+
+        var input = new PhysicsInput
+        {
+            MapId = TestMapId,
+            X = 10f, Y = 30f, Z = 10.5f,
+            Orientation = 0f,
+            MoveFlags = MOVEFLAG_FORWARD,
+            WalkSpeed = 2.5f, RunSpeed = 7f, RunBackSpeed = 4.5f,
+            SwimSpeed = 4.72f, SwimBackSpeed = 2.5f, FlightSpeed = 7f, TurnSpeed = 3.14159f,
+            Height = 2f, Radius = 0.4f,
+            FallStartZ = -200000f, PrevGroundZ = -200000f, StepUpBaseZ = -200000f,
+            DeltaTime = 0.05f,
+        };
+
+        // Walk into the wall and along the floor, turning now and then; both
+        // paths step from the same input every frame.
+        for (int i = 0; i < 120; i++)
+        {
+            if (i % 30 == 29)
+                input.Orientation += 1.2f;
+            var plain = StepPhysicsV2(ref input);
+            var agent = StepPhysicsV2ForAgent(AgentId, ref input);
+            Assert.Equal(plain, agent);
+            FeedBack(ref input, plain);
+            input.MoveFlags |= MOVEFLAG_FORWARD;
+        }
+        _output.WriteLine($"walk end: ({input.X:F2}, {input.Y:F2}, {input.Z:F2})");
+
+        // Raising the floor replaces the scene cache; the agent's cached view
+        // of the old floor must not be used.
+        input.MoveFlags &= ~MOVEFLAG_FORWARD;
+        input.Vx = input.Vy = input.Vz = 0f;
+        scene = Scene(12f);
+        Assert.True(InjectSceneTile(TestMapId, 32, 32, 0f, 0f, TileSize, TileSize, scene, scene.Length));
+        var raisedPlain = StepPhysicsV2(ref input);
+        var raisedAgent = StepPhysicsV2ForAgent(AgentId, ref input);
+        _output.WriteLine($"after raise: groundZ={raisedAgent.GroundZ:F3}");
+        Assert.Equal(raisedPlain, raisedAgent);
+        Assert.Equal(12f, raisedAgent.GroundZ, 3);
+    }
+
+    private static void FeedBack(ref PhysicsInput input, PhysicsOutput output)
+    {
+        input.X = output.X; input.Y = output.Y; input.Z = output.Z;
+        input.Orientation = output.Orientation; input.Pitch = output.Pitch;
+        input.Vx = output.Vx; input.Vy = output.Vy; input.Vz = output.Vz;
+        input.MoveFlags = output.MoveFlags;
+        input.PrevGroundZ = output.GroundZ;
+        input.PrevGroundNx = output.GroundNx; input.PrevGroundNy = output.GroundNy; input.PrevGroundNz = output.GroundNz;
+        input.PendingDepenX = output.PendingDepenX; input.PendingDepenY = output.PendingDepenY; input.PendingDepenZ = output.PendingDepenZ;
+        input.StandingOnInstanceId = output.StandingOnInstanceId;
+        input.StandingOnLocalX = output.StandingOnLocalX;
+        input.StandingOnLocalY = output.StandingOnLocalY;
+        input.StandingOnLocalZ = output.StandingOnLocalZ;
+        input.FallTime = (uint)output.FallTime;
+        input.FallStartZ = output.FallStartZ;
+        input.GroundedWallState = output.GroundedWallState;
+        input.WasGrounded = 1u;
+    }
+
+    // A 60x60 floor at height z with a 4-yard wall across it at x = 25.
+    private static InjectedTriangle[] Scene(float z)
+    {
+        const float size = 60f;
+        const float wallX = 25f;
+        return
+        [
+            Tri(0f, 0f, z, size, 0f, z, size, size, z),
+            Tri(0f, 0f, z, size, size, z, 0f, size, z),
+            Tri(wallX, 10f, z, wallX, 50f, z, wallX, 50f, z + 4f),
+            Tri(wallX, 10f, z, wallX, 50f, z + 4f, wallX, 10f, z + 4f),
+        ];
+    }
+
+    private static InjectedTriangle Tri(float ax, float ay, float az, float bx, float by, float bz, float cx, float cy, float cz) =>
+        new()
+        {
+            V0X = ax, V0Y = ay, V0Z = az,
+            V1X = bx, V1Y = by, V1Z = bz,
+            V2X = cx, V2Y = cy, V2Z = cz,
+            SourceType = 1u,
+        };
+}
@@ -0,0 +1,80 @@
+using Xunit;
+using Xunit.Abstractions;
+using static Navigation.Physics.Tests.NavigationInterop;
+
+namespace Navigation.Physics.Tests;
+
+/// <summary>
+/// Batched ground-Z and line-of-sight exports must answer every element
+/// exactly as the single-point export would.
+/// </summary>
+[Collection("PhysicsEngine")]
+public sealed class BatchedQueryTests(PhysicsEngineFixture fixture, ITestOutputHelper output) : IDisposable
+{
+    private const uint TestMapId = 1;
+    private const float TileSize = 533.33333f;
+    private readonly PhysicsEngineFixture _fixture = fixture;
+    private readonly ITestOutputHelper _output = output;
+
+    public void Dispose()
+    {
+        if (_fixture.IsInitialized)
+            ClearSceneCache(TestMapId);
+    }
+
+    [SkippableFact]
+    public void BatchQueries_MatchSingleQueries()
+    {
+        Skip.If(!_fixture.IsInitialized, "Physics engine not available");
+
+        ClearSceneCache(TestMapId);
+        var scene = new[]
+        {
+            // Floor at z=10 and a 45-degree ramp rising from x=30 to x=40.
+            Tri(0f, 0f, 10f, 30f, 0f, 10f, 30f, 30f, 10f),
+            Tri(0f, 0f, 10f, 30f, 30f, 10f, 0f, 30f, 10f),
+            Tri(30f, 0f, 10f, 40f, 0f, 20f, 40f, 30f, 20f),
+            Tri(30f, 0f, 10f, 40f, 30f, 20f, 30f, 30f, 10f),
+        };
+        Assert.True(InjectSceneTile(TestMapId, 32, 32, 0f, 0f, TileSize, TileSize, scene, scene.Length));
+
+        var rng = new Random(7);
+        const int count = 500;
+        var points = new Vector3[count];
+        var targets = new Vector3[count];
+        for (int i = 0; i < count; i++)
+        {
+            points[i] = new Vector3(rng.NextSingle() * 45f - 2f, rng.NextSingle() * 34f - 2f, 8f + rng.NextSingle() * 16f);
+            targets[i] = new Vector3(rng.NextSingle() * 45f - 2f, rng.NextSingle() * 34f - 2f, 8f + rng.NextSingle() * 16f);
+        }
+
+        var groundZ = new float[count];
+        var walkableZ = new float[count];
+        var clear = new byte[count];
+        Assert.True(GetGroundZBatch(TestMapId, points, count, 8f, groundZ));
+        Assert.True(GetWalkableGroundZBatch(TestMapId, points, count, 8f, 0.8f, walkableZ));
+        Assert.True(LineOfSightBatch(TestMapId, points, targets, count, clear));
+
+        int found = 0;
+        for (int i = 0; i < count; i++)
+        {
+            var p = points[i];
+            Assert.Equal(GetGroundZ(TestMapId, p.X, p.Y, p.Z, 8f), groundZ[i]);
+            Assert.Equal(GetWalkableGroundZ(TestMapId, p.X, p.Y, p.Z, 8f, 0.8f), walkableZ[i]);
+            Assert.Equal(LineOfSight(TestMapId, p, targets[i]), clear[i] != 0);
+            if (groundZ[i] > -100000f)
+                found++;
+        }
+        _output.WriteLine($"{found}/{count} points found ground");
+        Assert.True(found > 0);
+    }
+
+    private static InjectedTriangle Tri(float ax, float ay, float az, float bx, float by, float bz, float cx, float cy, float cz) =>
+        new()
+        {
+            V0X = ax, V0Y = ay, V0Z = az,
+            V1X = bx, V1Y = by, V1Z = bz,
+            V2X = cx, V2Y = cy, V2Z = cz,
+            SourceType = 1u,
+        };
+}
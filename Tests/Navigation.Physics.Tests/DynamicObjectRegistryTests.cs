@@ -1,6 +1,9 @@
 using Xunit;
 using Xunit.Abstractions;
 using System;
+using System.Collections.Generic;
+using System.Threading;
+using System.Threading.Tasks;
 
 namespace Navigation.Physics.Tests;
 
@@ -50,6 +53,59 @@ public class DynamicObjectRegistryTests(PhysicsEngineFixture fixture, ITestOutpu
         }
     }
 
+    [Fact]
+    public void TransportTimeline_PosesObjectAtQueryTime()
+    {
+        if (!_fixture.IsInitialized)
+            return;
+
+        const ulong guid = 0x7E1E0046UL;
+        const uint displayId = 0xFFFF0046; // unmapped: fallback 1.75 x 4 hull
+        const uint mapId = 0;
+
+        ClearAllDynamicObjects();
+        try
+        {
+            Assert.True(RegisterDynamicObject(guid, 0, displayId, mapId, 1.0f));
+            // Out along +X over 10 s, back over the next 10 s.
+            var path = new[]
+            {
+                new TransportKeyframe { TimeMs = 0, X = 0f, Y = 0f, Z = 0f },
+                new TransportKeyframe { TimeMs = 10000, X = 20f, Y = 0f, Z = 0f },
+            };
+            Assert.True(SetDynamicObjectTimeline(guid, path, path.Length, 20000));
+
+            Assert.True(GetDynamicObjectTimelinePose(guid, 5000, out var x, out _, out _, out _));
+            Assert.Equal(10f, x, 3);
+            Assert.True(GetDynamicObjectTimelinePose(guid, 15000, out x, out _, out _, out _));
+            Assert.Equal(10f, x, 3);
+            Assert.True(GetDynamicObjectTimelinePose(guid, 20000, out x, out _, out _, out _));
+            Assert.Equal(0f, x, 3);
+
+            // A segment through x=10 is blocked only while the transport is there;
+            // position updates no longer move it.
+            SetTransportTime(5000);
+            UpdateDynamicObjectPosition(guid, 100f, 100f, 0f, 0f, 0u);
+            Assert.True(SegmentIntersectsDynamicObjectsDetailed(mapId, 10f, 0f, 10f, 10f, 0f, -5f, out _, out var hitGuid, out _));
+            Assert.Equal(guid, hitGuid);
+            SetTransportTime(0);
+            Assert.False(SegmentIntersectsDynamicObjectsDetailed(mapId, 10f, 0f, 10f, 10f, 0f, -5f, out _, out _, out _));
+
+            // Invalid paths are rejected.
+            var unordered = new[] { path[1], path[0] };
+            Assert.False(SetDynamicObjectTimeline(guid, unordered, unordered.Length, 20000));
+            Assert.False(SetDynamicObjectTimeline(guid, path, path.Length, 10000));
+
+            ClearDynamicObjectTimeline(guid);
+            Assert.False(GetDynamicObjectTimelinePose(guid, 0, out _, out _, out _, out _));
+        }
+        finally
+        {
+            SetTransportTime(0);
+            ClearAllDynamicObjects();
+        }
+    }
+
     [Fact]
     public void FindPath_WithActiveDynamicOverlay_ReformsRouteAroundBlockingObject()
     {
@@ -167,6 +223,304 @@ public class DynamicObjectRegistryTests(PhysicsEngineFixture fixture, ITestOutpu
         }
     }
 
+    [SkippableFact]
+    public void MovedObject_IsReindexed_AndReRegisteringMovesItAcrossMaps()
+    {
+        Skip.If(!_fixture.IsInitialized, "Physics engine not available");
+
+        const ulong guid = 0x0D042001UL;
+        const uint mapA = 7042;
+        const uint mapB = 7043;
+
+        ClearAllDynamicObjects();
+        try
+        {
+            Assert.True(RegisterDynamicObject(guid, 0, FallbackDisplayId, mapA, 1.0f));
+            Assert.Equal(0, CountDynamicTrianglesAround(mapA, 0, 100f, 100f));
+            UpdateDynamicObjectPosition(guid, 100f, 100f, 0f, 0f, 0u);
+            Assert.Equal(FallbackTriangleCount, CountDynamicTrianglesAround(mapA, 0, 100f, 100f));
+
+            // A move across many grid cells files the object under its new cells only.
+            UpdateDynamicObjectPosition(guid, 300f, -150f, 0f, 0f, 0u);
+            Assert.Equal(0, CountDynamicTrianglesAround(mapA, 0, 100f, 100f));
+            Assert.Equal(FallbackTriangleCount, CountDynamicTrianglesAround(mapA, 0, 300f, -150f));
+
+            // Re-registering the guid on another map takes it off the first.
+            Assert.True(RegisterDynamicObject(guid, 0, FallbackDisplayId, mapB, 1.0f));
+            UpdateDynamicObjectPosition(guid, 300f, -150f, 0f, 0f, 0u);
+            Assert.Equal(0, CountDynamicTrianglesAround(mapA, 0, 300f, -150f));
+            Assert.Equal(FallbackTriangleCount, CountDynamicTrianglesAround(mapB, 0, 300f, -150f));
+            Assert.Equal(1, GetDynamicObjectCount());
+
+            ClearDynamicObjects(mapB);
+            Assert.Equal(0, CountDynamicTrianglesAround(mapB, 0, 300f, -150f));
+            Assert.Equal(0, GetDynamicObjectCount());
+        }
+        finally
+        {
+            ClearAllDynamicObjects();
+        }
+    }
+
+    [SkippableFact]
+    public void MovedObject_ReturnsTrianglesAtItsNewPose()
+    {
+        Skip.If(!_fixture.IsInitialized, "Physics engine not available");
+
+        const ulong guid = 0x0D043001UL;
+        const uint mapId = 7042;
+        const float scale = 1.5f;
+        const float moveX = -40f, moveY = 60f, moveZ = 12f, moveO = 1.1f;
+
+        ClearAllDynamicObjects();
+        try
+        {
+            Assert.True(RegisterDynamicObject(guid, 0, FallbackDisplayId, mapId, scale));
+            UpdateDynamicObjectPosition(guid, 10f, 20f, 5f, 0f, 0u);
+            var (before, _) = QueryDynamicTriangles(mapId, 0, -100f, -100f, -50f, 100f, 100f, 50f);
+            Assert.Equal(FallbackTriangleCount, before.Length);
+
+            // Triangles are kept in model space, so the move must show up in
+            // the next query: each vertex carried from the old pose to the new one.
+            UpdateDynamicObjectPosition(guid, moveX, moveY, moveZ, moveO, 0u);
+            var (after, _) = QueryDynamicTriangles(mapId, 0, -100f, -100f, -50f, 100f, 100f, 50f);
+            Assert.Equal(before.Length, after.Length);
+
+            float cos = MathF.Cos(moveO), sin = MathF.Sin(moveO);
+            void AssertMoved(float x, float y, float z, float movedX, float movedY, float movedZ)
+            {
+                float lx = x - 10f, ly = y - 20f;
+                Assert.Equal(lx * cos - ly * sin + moveX, movedX, 3);
+                Assert.Equal(lx * sin + ly * cos + moveY, movedY, 3);
+                Assert.Equal(z - 5f + moveZ, movedZ, 3);
+            }
+            for (int i = 0; i < before.Length; i++)
+            {
+                AssertMoved(before[i].Ax, before[i].Ay, before[i].Az, after[i].Ax, after[i].Ay, after[i].Az);
+                AssertMoved(before[i].Bx, before[i].By, before[i].Bz, after[i].Bx, after[i].By, after[i].Bz);
+                AssertMoved(before[i].Cx, before[i].Cy, before[i].Cz, after[i].Cx, after[i].Cy, after[i].Cz);
+            }
+
+            Assert.Equal(0, CountDynamicTrianglesAround(mapId, 0, 10f, 20f));
+            Assert.True(SegmentIntersectsDynamicObjectsDetailed(mapId, moveX, moveY, moveZ + 10f, moveX, moveY, moveZ - 1f,
+                out _, out var hitGuid, out _));
+            Assert.Equal(guid, hitGuid);
+            Assert.False(SegmentIntersectsDynamicObjectsDetailed(mapId, 10f, 20f, 15f, 10f, 20f, 4f, out _, out _, out _));
+        }
+        finally
+        {
+            ClearAllDynamicObjects();
+        }
+    }
+
+    [SkippableFact]
+    public void BvhCulledQueries_MatchFilteringEveryTriangle_AndSegmentsHitPosedTriangles()
+    {
+        Skip.If(!_fixture.IsInitialized, "Physics engine not available");
+
+        const uint mapId = 7044;
+
+        ClearAllDynamicObjects();
+        try
+        {
+            // Overlapping hulls at assorted scales and orientations.
+            for (int i = 0; i < 6; i++)
+            {
+                ulong guid = 0x0D044000UL + (ulong)i;
+                Assert.True(RegisterDynamicObject(guid, 0, FallbackDisplayId, mapId, 0.6f + 0.25f * i));
+                UpdateDynamicObjectPosition(guid, 2.5f * (i % 3), 2.5f * (i / 3), 0.5f * i, 0.7f * i, 0u);
+            }
+
+            // A box holding every object returns all triangles without culling.
+            var (all, allIds) = QueryDynamicTriangles(mapId, 0, -50f, -50f, -50f, 50f, 50f, 50f);
+            Assert.Equal(6 * FallbackTriangleCount, all.Length);
+
+            // Small boxes walk the model BVHs; they must return exactly the
+            // triangles whose bounds overlap them, in the same order.
+            int nonEmpty = 0;
+            for (float x = -4f; x <= 9f; x += 1.3f)
+            for (float y = -4f; y <= 7f; y += 1.3f)
+            for (float z = -1f; z <= 8f; z += 1.5f)
+            {
+                float maxX = x + 1.1f, maxY = y + 0.9f, maxZ = z + 1.2f;
+                var expected = new List<int>();
+                for (int i = 0; i < all.Length; i++)
+                {
+                    if (TriangleOverlapsBox(all[i], x, y, z, maxX, maxY, maxZ))
+                        expected.Add(i);
+                }
+
+                var (triangles, instanceIds) = QueryDynamicTriangles(mapId, 0, x, y, z, maxX, maxY, maxZ);
+                Assert.Equal(expected.Count, triangles.Length);
+                for (int k = 0; k < expected.Count; k++)
+                {
+                    Assert.Equal(all[expected[k]], triangles[k]);
+                    Assert.Equal(allIds[expected[k]], instanceIds[k]);
+                }
+                if (expected.Count > 0)
+                    nonEmpty++;
+            }
+            _output.WriteLine($"boxes with triangles: {nonEmpty}");
+            Assert.True(nonEmpty > 0);
+
+            // A short segment through any triangle's centroid along its normal hits.
+            for (int i = 0; i < all.Length; i += 3)
+            {
+                var t = all[i];
+                float ux = t.Bx - t.Ax, uy = t.By - t.Ay, uz = t.Bz - t.Az;
+                float vx = t.Cx - t.Ax, vy = t.Cy - t.Ay, vz = t.Cz - t.Az;
+                float nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+                float len = MathF.Sqrt(nx * nx + ny * ny + nz * nz);
+                nx *= 0.3f / len; ny *= 0.3f / len; nz *= 0.3f / len;
+                float cx = (t.Ax + t.Bx + t.Cx) / 3f, cy = (t.Ay + t.By + t.Cy) / 3f, cz = (t.Az + t.Bz + t.Cz) / 3f;
+                Assert.True(SegmentIntersectsDynamicObjectsDetailed(mapId,
+                    cx + nx, cy + ny, cz + nz, cx - nx, cy - ny, cz - nz, out _, out _, out _));
+            }
+            Assert.False(SegmentIntersectsDynamicObjectsDetailed(mapId, 2.5f, 1.25f, 30f, 2.5f, 1.25f, 20f, out _, out _, out _));
+        }
+        finally
+        {
+            ClearAllDynamicObjects();
+        }
+    }
+
+    [SkippableFact]
+    public void MapInstances_AreIsolated_AndClearedIndependently()
+    {
+        Skip.If(!_fixture.IsInitialized, "Physics engine not available");
+
+        const uint mapId = 7045;
+
+        ClearAllDynamicObjects();
+        try
+        {
+            // One object per instance at the same spot.
+            uint[] instances = [0, 7, 8];
+            for (int i = 0; i < instances.Length; i++)
+            {
+                ulong guid = 0x0D045000UL + (ulong)i;
+                Assert.True(RegisterDynamicObjectInInstance(guid, 0, FallbackDisplayId, mapId, instances[i], 1.0f));
+                UpdateDynamicObjectPosition(guid, 0f, 0f, 0f, 0.3f * i, 0u);
+            }
+
+            var seen = new HashSet<uint>();
+            foreach (uint instance in instances)
+            {
+                var (triangles, instanceIds) = QueryDynamicTriangles(mapId, instance, -5f, -5f, -10f, 5f, 5f, 20f);
+                Assert.Equal(FallbackTriangleCount, triangles.Length);
+                Assert.Single(new HashSet<uint>(instanceIds));
+                Assert.True(seen.Add(instanceIds[0]));
+            }
+            // An instance nothing was registered in sees none of them.
+            Assert.Equal(0, CountDynamicTrianglesAround(mapId, 9, 0f, 0f));
+
+            ClearDynamicObjectsInInstance(mapId, 7);
+            Assert.Equal(FallbackTriangleCount, CountDynamicTrianglesAround(mapId, 0, 0f, 0f));
+            Assert.Equal(0, CountDynamicTrianglesAround(mapId, 7, 0f, 0f));
+            Assert.Equal(FallbackTriangleCount, CountDynamicTrianglesAround(mapId, 8, 0f, 0f));
+            Assert.Equal(2, GetDynamicObjectCount());
+
+            ClearDynamicObjects(mapId);
+            foreach (uint instance in instances)
+                Assert.Equal(0, CountDynamicTrianglesAround(mapId, instance, 0f, 0f));
+            Assert.Equal(0, GetDynamicObjectCount());
+        }
+        finally
+        {
+            ClearAllDynamicObjects();
+        }
+    }
+
+    [SkippableFact]
+    public void ConcurrentQueries_MovesAndClears_InOtherShards_DoNotDisturbQueries()
+    {
+        Skip.If(!_fixture.IsInitialized, "Physics engine not available");
+
+        const uint mapId = 7045;
+        const uint otherMapId = 7046;
+        const ulong staticGuid = 0x0D045100UL;
+        const ulong movingGuid = 0x0D045101UL;
+        const ulong churnGuid = 0x0D045102UL;
+
+        ClearAllDynamicObjects();
+        try
+        {
+            Assert.True(RegisterDynamicObjectInInstance(staticGuid, 0, FallbackDisplayId, mapId, 1, 1.0f));
+            UpdateDynamicObjectPosition(staticGuid, 0f, 0f, 0f, 0f, 0u);
+            var (baseline, _) = QueryDynamicTriangles(mapId, 1, -5f, -5f, -10f, 5f, 5f, 20f);
+            Assert.Equal(FallbackTriangleCount, baseline.Length);
+
+            int failures = 0;
+            bool done = false;
+            var readers = new Task[4];
+            for (int r = 0; r < readers.Length; r++)
+            {
+                readers[r] = Task.Run(() =>
+                {
+                    while (!Volatile.Read(ref done))
+                    {
+                        // The static object's instance never changes.
+                        var (triangles, _) = QueryDynamicTriangles(mapId, 1, -5f, -5f, -10f, 5f, 5f, 20f);
+                        if (triangles.Length != baseline.Length || !triangles[0].Equals(baseline[0]))
+                            Interlocked.Increment(ref failures);
+
+                        // The moving object is either fully inside the box or gone.
+                        int moving = CountDynamicTrianglesAround(mapId, 2, 0f, 0f);
+                        if (moving != 0 && moving != FallbackTriangleCount)
+                            Interlocked.Increment(ref failures);
+                    }
+                });
+            }
+
+            // Move, clear and re-register objects in other instances and maps.
+            for (int i = 0; i < 2000; i++)
+            {
+                if (i % 50 == 0)
+                    Assert.True(RegisterDynamicObjectInInstance(movingGuid, 0, FallbackDisplayId, mapId, 2, 1.0f));
+                UpdateDynamicObjectPosition(movingGuid, (i % 2) * 40f, 0f, 0f, 0.01f * i, 0u);
+                if (i % 50 == 25)
+                    ClearDynamicObjectsInInstance(mapId, 2);
+
+                Assert.True(RegisterDynamicObject(churnGuid, 0, FallbackDisplayId, otherMapId, 1.0f));
+                UpdateDynamicObjectPosition(churnGuid, 0f, 0f, 0f, 0f, 0u);
+                if (i % 10 == 0)
+                    ClearDynamicObjects(otherMapId);
+            }
+
+            Volatile.Write(ref done, true);
+            Task.WaitAll(readers);
+            Assert.Equal(0, failures);
+        }
+        finally
+        {
+            ClearAllDynamicObjects();
+        }
+    }
+
+    // Unmapped display IDs get the 12-sided 1.75 x 4 fallback hull: 48 triangles.
+    private const uint FallbackDisplayId = 0xFFFF0042;
+    private const int FallbackTriangleCount = 48;
+
+    // Triangles found in a 10 x 10 box around (x, y), tall enough for the fallback hull.
+    private static int CountDynamicTrianglesAround(uint mapId, uint mapInstanceId, float x, float y) =>
+        QueryDynamicObjectTriangles(mapId, mapInstanceId, x - 5f, y - 5f, -10f, x + 5f, y + 5f, 20f, [], [], 0);
+
+    private static (TerrainTriangle[] Triangles, uint[] InstanceIds) QueryDynamicTriangles(
+        uint mapId, uint mapInstanceId, float minX, float minY, float minZ, float maxX, float maxY, float maxZ)
+    {
+        int count = QueryDynamicObjectTriangles(mapId, mapInstanceId, minX, minY, minZ, maxX, maxY, maxZ, [], [], 0);
+        var triangles = new TerrainTriangle[count];
+        var instanceIds = new uint[count];
+        QueryDynamicObjectTriangles(mapId, mapInstanceId, minX, minY, minZ, maxX, maxY, maxZ, triangles, instanceIds, count);
+        return (triangles, instanceIds);
+    }
+
+    // Same bounds test the registry applies to each triangle.
+    private static bool TriangleOverlapsBox(TerrainTriangle t, float minX, float minY, float minZ, float maxX, float maxY, float maxZ) =>
+        MathF.Max(MathF.Max(t.Ax, t.Bx), t.Cx) >= minX && MathF.Min(MathF.Min(t.Ax, t.Bx), t.Cx) <= maxX &&
+        MathF.Max(MathF.Max(t.Ay, t.By), t.Cy) >= minY && MathF.Min(MathF.Min(t.Ay, t.By), t.Cy) <= maxY &&
+        MathF.Max(MathF.Max(t.Az, t.Bz), t.Cz) >= minZ && MathF.Min(MathF.Min(t.Az, t.Bz), t.Cz) <= maxZ;
+
     private static NavigationInterop.Vector3[] ReadCorridorPath(
         NavigationInterop.Vector3 start,
         NavigationInterop.CorridorResult result)
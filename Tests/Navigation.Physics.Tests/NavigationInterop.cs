@@ -787,6 +787,39 @@ public static partial class NavigationInterop
     public static extern float GetWalkableGroundZ(
         uint mapId, float x, float y, float z, float maxSearchDist, float walkableMinNormalZ);
 
+    /// <summary>
+    /// Batched GetGroundZ: outZ[i] is GetGroundZ at points[i]. One call for a
+    /// whole path or probe column instead of one P/Invoke per point.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "GetGroundZBatch", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool GetGroundZBatch(
+        uint mapId, [In] Vector3[] points, int count, float maxSearchDist, [Out] float[] outZ);
+
+    /// <summary>
+    /// Batched GetWalkableGroundZ: outZ[i] is GetWalkableGroundZ at points[i].
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "GetWalkableGroundZBatch", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool GetWalkableGroundZBatch(
+        uint mapId, [In] Vector3[] points, int count, float maxSearchDist, float walkableMinNormalZ, [Out] float[] outZ);
+
+    /// <summary>
+    /// Line of sight between two world points (VMAP models, ADT terrain and
+    /// dynamic objects).
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "LineOfSight", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool LineOfSight(uint mapId, Vector3 from, Vector3 to);
+
+    /// <summary>
+    /// Batched LineOfSight: outClear[i] is 1 when from[i] -> to[i] is clear.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "LineOfSightBatch", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool LineOfSightBatch(
+        uint mapId, [In] Vector3[] from, [In] Vector3[] to, int count, [Out] byte[] outClear);
+
     [DllImport(NavigationDll, EntryPoint = "FindPath", CallingConvention = CallingConvention.Cdecl)]
     private static extern IntPtr FindPathNative(
         uint mapId,
@@ -2208,6 +2241,64 @@ public static partial class NavigationInterop
     [DllImport(NavigationDll, EntryPoint = "PhysicsStepV2", CallingConvention = CallingConvention.Cdecl)]
     public static extern PhysicsOutput StepPhysicsV2(ref PhysicsInput input);
 
+    /// <summary>
+    /// StepPhysicsV2 through the per-agent contact cache keyed by agentId.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "PhysicsStepV2ForAgent", CallingConvention = CallingConvention.Cdecl)]
+    public static extern PhysicsOutput StepPhysicsV2ForAgent(ulong agentId, ref PhysicsInput input);
+
+    [DllImport(NavigationDll, EntryPoint = "ReleasePhysicsAgent", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void ReleasePhysicsAgent(ulong agentId);
+
+    /// <summary>
+    /// Number of PhysicsStepV2 calls answered by the resting fast path.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "GetRestingStepHitCount", CallingConvention = CallingConvention.Cdecl)]
+    public static extern ulong GetRestingStepHitCount();
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct VmapTileMemoryStats
+    {
+        public ulong TileCount;
+        public ulong PinnedTiles;
+        public ulong ResidentBytes;
+        public ulong Budget;
+        public ulong Evictions;
+    }
+
+    /// <summary>
+    /// Byte budget for the models held by loaded VMAP tiles. Tiles no agent is
+    /// near are unloaded least-recently-used beyond it; 0 disables eviction.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "SetVmapTileMemoryBudget", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void SetVmapTileMemoryBudget(ulong bytes);
+
+    /// <summary>
+    /// How long an agent's tiles stay pinned after its last step, in
+    /// milliseconds (default one minute). 0 keeps them until ReleasePhysicsAgent.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "SetVmapTilePinTimeout", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void SetVmapTilePinTimeout(uint milliseconds);
+
+    [DllImport(NavigationDll, EntryPoint = "GetVmapTileMemoryStats", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool GetVmapTileMemoryStats(out VmapTileMemoryStats stats);
+
+    /// <summary>
+    /// StepPhysicsV2 (agentId 0) or StepPhysicsV2ForAgent with timeline-driven
+    /// transports posed at transportTimeMs. The step spans input.DeltaTime from
+    /// there; a resting bot no transport can reach over that span stays asleep.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "PhysicsStepV2AtTime", CallingConvention = CallingConvention.Cdecl)]
+    public static extern PhysicsOutput StepPhysicsV2AtTime(ulong agentId, ref PhysicsInput input, ulong transportTimeMs);
+
+    /// <summary>
+    /// StepPhysicsV2AtTime inside one instance of the input's map: only dynamic
+    /// objects registered into that instance collide.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "PhysicsStepV2InInstance", CallingConvention = CallingConvention.Cdecl)]
+    public static extern PhysicsOutput StepPhysicsV2InInstance(ulong agentId, ref PhysicsInput input, uint mapInstanceId, ulong transportTimeMs);
+
     /// <summary>
     /// Preloads map data for a given map ID.
     /// </summary>
@@ -2225,6 +2316,54 @@ public static partial class NavigationInterop
         [In] InjectedTriangle[] triangles,
         int triangleCount);
 
+    [DllImport(NavigationDll, EntryPoint = "InjectSceneTile", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool InjectSceneTile(
+        uint mapId,
+        int tileX,
+        int tileY,
+        float minX,
+        float minY,
+        float maxX,
+        float maxY,
+        [In] InjectedTriangle[] triangles,
+        int triangleCount);
+
+    [DllImport(NavigationDll, EntryPoint = "EvictSceneTile", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool EvictSceneTile(uint mapId, int tileX, int tileY);
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct SceneTileMemoryStats
+    {
+        public ulong TileCount;
+        public ulong ResidentBytes;
+        public ulong Budget;
+        public ulong MissingTiles;
+        public ulong Loads;
+        public ulong Evictions;
+    }
+
+    /// <summary>
+    /// Per-map byte budget for streamed .scenetile tiles; 0 restores the default.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "SetSceneTileMemoryBudget", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void SetSceneTileMemoryBudget(ulong bytes);
+
+    /// <summary>
+    /// Resident streamed scene tiles of a map. False when the map is not streamed.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "GetSceneTileMemoryStats", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool GetSceneTileMemoryStats(uint mapId, out SceneTileMemoryStats stats);
+
+    /// <summary>
+    /// Queues background loads of the streamed scene tiles around (x, y) and along
+    /// the velocity lookahead.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "PrefetchSceneTiles", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void PrefetchSceneTiles(uint mapId, float x, float y, float vx, float vy);
+
     [DllImport(NavigationDll, EntryPoint = "ClearSceneCache", CallingConvention = CallingConvention.Cdecl)]
     public static extern void ClearSceneCache(uint mapId);
 
@@ -2250,14 +2389,57 @@ public static partial class NavigationInterop
         ulong guid, uint entry, uint displayId,
         uint mapId, float scale);
 
+    /// <summary>
+    /// Registers a dynamic object into one instance of a map (dungeon, battleground).
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "RegisterDynamicObjectInInstance", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool RegisterDynamicObjectInInstance(
+        ulong guid, uint entry, uint displayId,
+        uint mapId, uint mapInstanceId, float scale);
+
     /// <summary>
     /// Updates the world position and orientation of a dynamic object.
-    /// Rebuilds world-space collision triangles from the cached model mesh.
+    /// Only the pose is stored; triangles stay in model space.
     /// </summary>
     [DllImport(NavigationDll, EntryPoint = "UpdateDynamicObjectPosition", CallingConvention = CallingConvention.Cdecl)]
     public static extern void UpdateDynamicObjectPosition(
         ulong guid, float x, float y, float z, float orientation, uint goState);
 
+    /// <summary>
+    /// One pose on a transport path, timeMs from the start of the cycle.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct TransportKeyframe
+    {
+        public uint TimeMs;
+        public float X, Y, Z;
+        public float Orientation;
+    }
+
+    /// <summary>
+    /// Drives a dynamic object from a looping keyframed path. Keyframe times
+    /// must be strictly increasing and below periodMs.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "SetDynamicObjectTimeline", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool SetDynamicObjectTimeline(
+        ulong guid, TransportKeyframe[] keyframes, int count, uint periodMs);
+
+    [DllImport(NavigationDll, EntryPoint = "ClearDynamicObjectTimeline", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void ClearDynamicObjectTimeline(ulong guid);
+
+    [DllImport(NavigationDll, EntryPoint = "GetDynamicObjectTimelinePose", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool GetDynamicObjectTimelinePose(
+        ulong guid, ulong timeMs, out float x, out float y, out float z, out float orientation);
+
+    /// <summary>
+    /// Transport time used by queries made outside StepPhysicsV2AtTime.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "SetTransportTime", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void SetTransportTime(ulong timeMs);
+
     /// <summary>
     /// Removes a single dynamic object by GUID.
     /// </summary>
@@ -2265,11 +2447,17 @@ public static partial class NavigationInterop
     public static extern void UnregisterDynamicObject(ulong guid);
 
     /// <summary>
-    /// Removes all dynamic objects on a given map.
+    /// Removes all dynamic objects on a given map, in every instance.
     /// </summary>
     [DllImport(NavigationDll, EntryPoint = "ClearDynamicObjects", CallingConvention = CallingConvention.Cdecl)]
     public static extern void ClearDynamicObjects(uint mapId);
 
+    /// <summary>
+    /// Removes all dynamic objects of one map instance.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "ClearDynamicObjectsInInstance", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void ClearDynamicObjectsInInstance(uint mapId, uint mapInstanceId);
+
     /// <summary>
     /// Removes all dynamic objects (keeps model cache).
     /// </summary>
@@ -2288,6 +2476,18 @@ public static partial class NavigationInterop
     [DllImport(NavigationDll, EntryPoint = "GetCachedModelCount", CallingConvention = CallingConvention.Cdecl)]
     public static extern int GetCachedModelCount();
 
+    /// <summary>
+    /// World-space dynamic object triangles of one map instance overlapping the
+    /// box, grouped by object in runtime instance ID order. Returns the total
+    /// found; at most maxTriangles are written.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "QueryDynamicObjectTriangles", CallingConvention = CallingConvention.Cdecl)]
+    public static extern int QueryDynamicObjectTriangles(
+        uint mapId, uint mapInstanceId,
+        float minX, float minY, float minZ,
+        float maxX, float maxY, float maxZ,
+        [Out] TerrainTriangle[] triangles, [Out] uint[] instanceIds, int maxTriangles);
+
     /// <summary>
     /// Checks whether a segment intersects a registered dynamic object and returns
     /// the nearest blocking object identity when it does.
@@ -2321,6 +2521,16 @@ public static partial class NavigationInterop
         uint mapId, string outPath,
         float minX, float minY, float maxX, float maxY);
 
+    /// <summary>
+    /// Builds a scene cache from triangles and saves it as a .scene / .scenetile file.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "WriteSceneCacheFile", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static extern bool WriteSceneCacheFile(
+        uint mapId, string outPath,
+        float minX, float minY, float maxX, float maxY,
+        [In] InjectedTriangle[] triangles, int triangleCount);
+
     /// <summary>
     /// Loads a pre-cached .scene file (fast, ~10ms).
     /// </summary>
@@ -2341,6 +2551,21 @@ public static partial class NavigationInterop
     [DllImport(NavigationDll, EntryPoint = "UnloadSceneCache", CallingConvention = CallingConvention.Cdecl)]
     public static extern void UnloadSceneCache(uint mapId);
 
+    /// <summary>
+    /// Writes a memory-mappable .vmm beside every .vmo in a vmaps directory.
+    /// Returns the number of models converted, or -1 if the directory is missing.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "ConvertVmapModels", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+    public static extern int ConvertVmapModels(string vmapsDir);
+
+    /// <summary>
+    /// Rewrites every older .scene (and tiles/*.scenetile) in a scenes directory in
+    /// the current mappable format. Returns the number of files rewritten, or -1 if
+    /// the directory is missing.
+    /// </summary>
+    [DllImport(NavigationDll, EntryPoint = "ConvertSceneCaches", CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+    public static extern int ConvertSceneCaches(string scenesDir);
+
     /// <summary>
     /// Enables the thin scene-slice runtime so collision queries stay on explicitly
     /// injected nearby geometry instead of auto-loading full-map data on misses.
@@ -0,0 +1,132 @@
+using Xunit;
+using Xunit.Abstractions;
+using static Navigation.Physics.Tests.NavigationInterop;
+
+namespace Navigation.Physics.Tests;
+
+/// <summary>
+/// Resting fast path: once a grounded, motionless bot's step comes back
+/// unchanged, StepV2 returns that result again without simulating, and wakes
+/// as soon as the input or the map's collision changes.
+/// </summary>
+[Collection("PhysicsEngine")]
+public sealed class RestingStepTests(PhysicsEngineFixture fixture, ITestOutputHelper output) : IDisposable
+{
+    private const uint TestMapId = 1;
+    private const float TileSize = 533.33333f;
+    private const uint MOVEFLAG_FORWARD = 0x1u;
+    private readonly PhysicsEngineFixture _fixture = fixture;
+    private readonly ITestOutputHelper _output = output;
+
+    public void Dispose()
+    {
+        if (_fixture.IsInitialized)
+            ClearSceneCache(TestMapId);
+    }
+
+    [SkippableFact]
+    public void RestingBot_GetsStableOutput_AndWakesOnInputOrSceneChange()
+    {
+        Skip.If(!_fixture.IsInitialized, "Physics engine not available");
+
+        ClearSceneCache(TestMapId);
+        var floor = FlatQuad(0f, 0f, 60f, 10f);
+        Assert.True(InjectSceneTile(TestMapId, 32, 32, 0f, 0f, TileSize, TileSize, floor, floor.Length));
+
+        var input = new PhysicsInput
+        {
+            MapId = TestMapId,
+            X = 20f, Y = 20f, Z = 10.5f,
+            Orientation = 1f,
+            WalkSpeed = 2.5f, RunSpeed = 7f, RunBackSpeed = 4.5f,
+            SwimSpeed = 4.72f, SwimBackSpeed = 2.5f, FlightSpeed = 7f, TurnSpeed = 3.14159f,
+            Height = 2f, Radius = 0.4f,
+            FallStartZ = -200000f, PrevGroundZ = -200000f, StepUpBaseZ = -200000f,
+            DeltaTime = 0.05f,
+        };
+
+        PhysicsOutput rest = default;
+        for (int i = 0; i < 10; i++)
+        {
+            rest = StepPhysicsV2(ref input);
+            FeedBack(ref input, rest);
+        }
+        _output.WriteLine($"rest: z={rest.Z:F3} groundZ={rest.GroundZ:F3} flags=0x{rest.MoveFlags:X}");
+        Assert.Equal(10f, rest.Z, 3);
+        Assert.Equal(10f, rest.GroundZ, 3);
+
+        // Same input at a different frame time keeps the resting result, and
+        // is answered by the fast path rather than simulated.
+        foreach (float dt in new[] { 0.016f, 0.1f, 0.25f })
+        {
+            input.DeltaTime = dt;
+            ulong hitsBefore = GetRestingStepHitCount();
+            var again = StepPhysicsV2(ref input);
+            Assert.Equal(hitsBefore + 1, GetRestingStepHitCount());
+            Assert.Equal(rest.X, again.X);
+            Assert.Equal(rest.Y, again.Y);
+            Assert.Equal(rest.Z, again.Z);
+            Assert.Equal(rest.GroundZ, again.GroundZ);
+            Assert.Equal(rest.MoveFlags, again.MoveFlags);
+        }
+
+        // Input change: walking forward must simulate.
+        var walk = input;
+        walk.MoveFlags |= MOVEFLAG_FORWARD;
+        walk.DeltaTime = 0.1f;
+        var moved = StepPhysicsV2(ref walk);
+        float moveDist = MathF.Sqrt((moved.X - input.X) * (moved.X - input.X) + (moved.Y - input.Y) * (moved.Y - input.Y));
+        _output.WriteLine($"forward: moved {moveDist:F3}");
+        Assert.True(moveDist > 0.5f, $"forward step should move the bot, moved {moveDist:F3}");
+
+        // Scene change: raising the floor under a resting bot must be seen.
+        floor = FlatQuad(0f, 0f, 60f, 12f);
+        Assert.True(InjectSceneTile(TestMapId, 32, 32, 0f, 0f, TileSize, TileSize, floor, floor.Length));
+        input.DeltaTime = 0.05f;
+        var raised = StepPhysicsV2(ref input);
+        _output.WriteLine($"after raise: z={raised.Z:F3} groundZ={raised.GroundZ:F3}");
+        Assert.Equal(12f, raised.GroundZ, 3);
+    }
+
+    private static void FeedBack(ref PhysicsInput input, PhysicsOutput output)
+    {
+        input.X = output.X; input.Y = output.Y; input.Z = output.Z;
+        input.Orientation = output.Orientation; input.Pitch = output.Pitch;
+        input.Vx = output.Vx; input.Vy = output.Vy; input.Vz = output.Vz;
+        input.MoveFlags = output.MoveFlags;
+        input.PrevGroundZ = output.GroundZ;
+        input.PrevGroundNx = output.GroundNx; input.PrevGroundNy = output.GroundNy; input.PrevGroundNz = output.GroundNz;
+        input.PendingDepenX = output.PendingDepenX; input.PendingDepenY = output.PendingDepenY; input.PendingDepenZ = output.PendingDepenZ;
+        input.StandingOnInstanceId = output.StandingOnInstanceId;
+        input.StandingOnLocalX = output.StandingOnLocalX;
+        input.StandingOnLocalY = output.StandingOnLocalY;
+        input.StandingOnLocalZ = output.StandingOnLocalZ;
+        input.FallTime = (uint)output.FallTime;
+        input.FallStartZ = output.FallStartZ;
+        input.GroundedWallState = output.GroundedWallState;
+        input.WasGrounded = 1u;
+    }
+
+    private static InjectedTriangle[] FlatQuad(float minX, float minY, float size, float z)
+    {
+        float maxX = minX + size;
+        float maxY = minY + size;
+        return
+        [
+            new InjectedTriangle
+            {
+                V0X = minX, V0Y = minY, V0Z = z,
+                V1X = maxX, V1Y = minY, V1Z = z,
+                V2X = maxX, V2Y = maxY, V2Z = z,
+                SourceType = 1u,
+            },
+            new InjectedTriangle
+            {
+                V0X = minX, V0Y = minY, V0Z = z,
+                V1X = maxX, V1Y = maxY, V1Z = z,
+                V2X = minX, V2Y = maxY, V2Z = z,
+                SourceType = 1u,
+            },
+        ];
+    }
+}
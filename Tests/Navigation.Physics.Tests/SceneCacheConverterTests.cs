@@ -0,0 +1,60 @@
+using Xunit;
+using Xunit.Abstractions;
+using System;
+using System.IO;
+using static Navigation.Physics.Tests.NavigationInterop;
+
+namespace Navigation.Physics.Tests;
+
+/// <summary>
+/// Rewrites older .scene / .scenetile files in the current memory-mappable
+/// format through the ConvertSceneCaches export that tools/NavDataConvert
+/// runs after scene data changes; the runtime loads older files into private
+/// memory but never rewrites them itself.
+///
+/// dotnet test --filter "FullyQualifiedName~SceneCacheConverter" --configuration Release -v n
+/// </summary>
+[Collection("PhysicsEngine")]
+public class SceneCacheConverterTests
+{
+    private readonly ITestOutputHelper _output;
+
+    public SceneCacheConverterTests(ITestOutputHelper output) => _output = output;
+
+    [Fact]
+    [Trait("Category", "SceneConversion")]
+    public void ConvertAllSceneCaches()
+    {
+        var dataDir = Environment.GetEnvironmentVariable("WWOW_DATA_DIR");
+        if (string.IsNullOrEmpty(dataDir))
+        {
+            var candidates = new[]
+            {
+                @"E:\repos\Westworld of Warcraft\Data",
+                @"D:\MaNGOS\data",
+                @"D:\vmangos-server\data",
+            };
+            foreach (var c in candidates)
+                if (Directory.Exists(c)) { dataDir = c; break; }
+        }
+
+        var scenesDir = string.IsNullOrEmpty(dataDir) ? null : Path.Combine(dataDir, "scenes");
+        Skip.If(scenesDir == null || !Directory.Exists(scenesDir),
+            $"WWOW_DATA_DIR not set and no scenes directory found");
+
+        var sw = System.Diagnostics.Stopwatch.StartNew();
+        int converted = ConvertSceneCaches(scenesDir!);
+        sw.Stop();
+        _output.WriteLine($"Converted {converted} scene files in {sw.Elapsed.TotalSeconds:F1}s");
+        Assert.True(converted >= 0);
+
+        // Everything is current now, so a second pass has nothing to rewrite
+        Assert.Equal(0, ConvertSceneCaches(scenesDir!));
+    }
+
+    [Fact]
+    public void MissingDirectory_ReturnsMinusOne()
+    {
+        Assert.Equal(-1, ConvertSceneCaches(Path.Combine(Path.GetTempPath(), Guid.NewGuid().ToString("N"))));
+    }
+}
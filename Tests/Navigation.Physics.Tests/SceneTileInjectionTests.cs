@@ -0,0 +1,78 @@
+using Xunit;
+using Xunit.Abstractions;
+using static Navigation.Physics.Tests.NavigationInterop;
+
+namespace Navigation.Physics.Tests;
+
+/// <summary>
+/// Tile-keyed scene injection: InjectSceneTile adds one ADT tile without
+/// dropping tiles injected earlier, and EvictSceneTile removes just that tile.
+/// </summary>
+[Collection("PhysicsEngine")]
+public sealed class SceneTileInjectionTests(PhysicsEngineFixture fixture, ITestOutputHelper output) : IDisposable
+{
+    private const uint TestMapId = 1;
+    private const float TileSize = 533.33333f;
+    private const float WalkableMinNormalZ = 0.5f;
+    private readonly PhysicsEngineFixture _fixture = fixture;
+    private readonly ITestOutputHelper _output = output;
+
+    public void Dispose()
+    {
+        if (_fixture.IsInitialized)
+            ClearSceneCache(TestMapId);
+    }
+
+    [SkippableFact]
+    public void InjectSceneTile_KeepsPreviouslyInjectedTiles_AndEvictsOnlyTheRequestedOne()
+    {
+        Skip.If(!_fixture.IsInitialized, "Physics engine not available");
+
+        ClearSceneCache(TestMapId);
+
+        // Tile (32,32) spans [0, 533) on both axes; tile (31,32) is the next one along +X.
+        var floorA = FlatQuad(10f, 10f, 20f, 10f);
+        var floorB = FlatQuad(TileSize + 10f, 10f, 20f, 25f);
+
+        Assert.True(InjectSceneTile(TestMapId, 32, 32, 0f, 0f, TileSize, TileSize, floorA, floorA.Length));
+        Assert.True(InjectSceneTile(TestMapId, 31, 32, TileSize, 0f, 2f * TileSize, TileSize, floorB, floorB.Length));
+
+        float zA = GetWalkableGroundZ(TestMapId, 15f, 15f, 12f, 5f, WalkableMinNormalZ);
+        float zB = GetWalkableGroundZ(TestMapId, TileSize + 15f, 15f, 27f, 5f, WalkableMinNormalZ);
+        _output.WriteLine($"after inject: zA={zA:F3} zB={zB:F3}");
+        Assert.Equal(10f, zA, 3);
+        Assert.Equal(25f, zB, 3);
+
+        Assert.True(EvictSceneTile(TestMapId, 31, 32));
+        Assert.False(EvictSceneTile(TestMapId, 31, 32));
+
+        zA = GetWalkableGroundZ(TestMapId, 15f, 15f, 12f, 5f, WalkableMinNormalZ);
+        zB = GetWalkableGroundZ(TestMapId, TileSize + 15f, 15f, 27f, 5f, WalkableMinNormalZ);
+        _output.WriteLine($"after evict: zA={zA:F3} zB={zB:F3}");
+        Assert.Equal(10f, zA, 3);
+        Assert.True(zB < -100000f, $"evicted tile should not report ground, got {zB:F3}");
+    }
+
+    private static InjectedTriangle[] FlatQuad(float minX, float minY, float size, float z)
+    {
+        float maxX = minX + size;
+        float maxY = minY + size;
+        return
+        [
+            new InjectedTriangle
+            {
+                V0X = minX, V0Y = minY, V0Z = z,
+                V1X = maxX, V1Y = minY, V1Z = z,
+                V2X = maxX, V2Y = maxY, V2Z = z,
+                SourceType = 1u,
+            },
+            new InjectedTriangle
+            {
+                V0X = minX, V0Y = minY, V0Z = z,
+                V1X = maxX, V1Y = maxY, V1Z = z,
+                V2X = minX, V2Y = maxY, V2Z = z,
+                SourceType = 1u,
+            },
+        ];
+    }
+}
@@ -223,24 +223,7 @@ public class SceneTileSplitterTests
     {
         var tiles = new HashSet<(int, int)>();
 
-        // Read scene bounds from file header (first 64 bytes)
-        using var fs = File.OpenRead(scenePath);
-        using var br = new BinaryReader(fs);
-        br.ReadUInt32(); // magic
-        br.ReadUInt32(); // version
-        br.ReadUInt32(); // mapId
-        br.ReadUInt32(); // triCount
-        br.ReadSingle(); // cellSize
-        br.ReadUInt32(); // cellsX
-        br.ReadUInt32(); // cellsY
-        br.ReadUInt32(); // triIdxCount
-        br.ReadSingle(); // liquidCellSize
-        br.ReadUInt32(); // liquidCellsX
-        br.ReadUInt32(); // liquidCellsY
-        float minX = br.ReadSingle();
-        float minY = br.ReadSingle();
-        float maxX = br.ReadSingle();
-        float maxY = br.ReadSingle();
+        var (minX, minY, maxX, maxY) = ReadSceneBounds(scenePath);
 
         _output.WriteLine($"    Scene bounds: X=[{minX:F0},{maxX:F0}] Y=[{minY:F0},{maxY:F0}]");
 
@@ -280,12 +263,7 @@ public class SceneTileSplitterTests
     private HashSet<(int tx, int ty)> DiscoverAllTilesInBounds(string scenePath)
     {
         var tiles = new HashSet<(int, int)>();
-        using var fs = File.OpenRead(scenePath);
-        using var br = new BinaryReader(fs);
-        // Skip: magic(4) + version(4) + mapId(4) + triCount(4) + cellSize(4) + cellsX(4) + cellsY(4) + triIdxCount(4) + liquidCellSize(4) + liquidCellsX(4) + liquidCellsY(4) = 44 bytes
-        br.ReadBytes(44); // skip to bounds
-        float minX = br.ReadSingle(), minY = br.ReadSingle();
-        float maxX = br.ReadSingle(), maxY = br.ReadSingle();
+        var (minX, minY, maxX, maxY) = ReadSceneBounds(scenePath);
 
         int minTileX = WorldToTileX(maxX);
         int maxTileX = WorldToTileX(minX);
@@ -299,6 +277,23 @@ public class SceneTileSplitterTests
         return tiles;
     }
 
+    /// <summary>
+    /// Scene XY bounds from the file header. Packed v1/v2 headers carry them
+    /// after eleven 4-byte fields; sectioned v3 headers right after
+    /// magic, version, mapId, sectionCount and cellSize.
+    /// </summary>
+    private static (float minX, float minY, float maxX, float maxY) ReadSceneBounds(string scenePath)
+    {
+        using var fs = File.OpenRead(scenePath);
+        using var br = new BinaryReader(fs);
+        br.ReadUInt32(); // magic
+        uint version = br.ReadUInt32();
+        fs.Position = version >= 3u ? 20 : 44;
+        float minX = br.ReadSingle(), minY = br.ReadSingle();
+        float maxX = br.ReadSingle(), maxY = br.ReadSingle();
+        return (minX, minY, maxX, maxY);
+    }
+
     private HashSet<(int tx, int ty)> DiscoverTilesForMap(uint mapId, string dataDir, string scenePath)
     {
         // Prefer ADT map-file discovery for full continent coverage. Some .scene files are
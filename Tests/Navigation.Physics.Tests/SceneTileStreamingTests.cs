@@ -0,0 +1,204 @@
+using System;
+using System.Diagnostics;
+using System.IO;
+using System.Threading;
+using Xunit;
+using Xunit.Abstractions;
+using static Navigation.Physics.Tests.NavigationInterop;
+
+namespace Navigation.Physics.Tests;
+
+/// <summary>
+/// Per-tile scene streaming: a map with tiles/*.scenetile files loads only the
+/// tiles queries touch, unloads least-recently-used tiles past the memory
+/// budget and pages them back in with the same results, remembers tiles that
+/// have no file, and loads tiles ahead of a bot on a background thread.
+/// </summary>
+[Collection("PhysicsEngine")]
+public sealed class SceneTileStreamingTests(PhysicsEngineFixture fixture, ITestOutputHelper output) : IDisposable
+{
+    private const uint TestMapId = 7001;
+    private const float TileSize = 533.33333f;
+    private readonly PhysicsEngineFixture _fixture = fixture;
+    private readonly ITestOutputHelper _output = output;
+    private readonly string _tempRoot = Path.Combine(Path.GetTempPath(), $"wwow_scene_tiles_{Guid.NewGuid():N}");
+
+    public void Dispose()
+    {
+        if (_fixture.IsInitialized)
+        {
+            SetSceneTileMemoryBudget(0);
+            UnloadSceneCache(TestMapId);
+            string? dataDir = Environment.GetEnvironmentVariable("WWOW_DATA_DIR");
+            SetScenesDir(string.IsNullOrWhiteSpace(dataDir)
+                ? string.Empty
+                : Path.Combine(dataDir, "scenes") + Path.DirectorySeparatorChar);
+        }
+        try
+        {
+            if (Directory.Exists(_tempRoot))
+                Directory.Delete(_tempRoot, recursive: true);
+        }
+        catch
+        {
+        }
+    }
+
+    [SkippableFact]
+    public void TilesStreamIn_EvictUnderBudget_AndPageBackIn()
+    {
+        Skip.If(!_fixture.IsInitialized, "Physics engine not available");
+        string scenesDir = WriteTiles();
+
+        SetScenesDir(scenesDir);
+        UnloadSceneCache(TestMapId);
+
+        // Tile (32,32) holds a floor at 10, tile (31,32) one at 20.
+        Assert.Equal(10f, GetGroundZ(TestMapId, 100f, 100f, 12f, 10f), 3);
+        Assert.True(GetSceneTileMemoryStats(TestMapId, out var first));
+        Assert.Equal(1ul, first.TileCount);
+        Assert.Equal(1ul, first.Loads);
+
+        Assert.Equal(20f, GetGroundZ(TestMapId, TileSize + 100f, 100f, 22f, 10f), 3);
+        Assert.True(GetSceneTileMemoryStats(TestMapId, out var both));
+        Assert.Equal(2ul, both.TileCount);
+
+        // A 1-byte budget unloads every tile; the next probe pages its tile back in.
+        SetSceneTileMemoryBudget(1);
+        Assert.True(GetSceneTileMemoryStats(TestMapId, out var evicted));
+        _output.WriteLine($"evicted: tiles={evicted.TileCount} evictions={evicted.Evictions}");
+        Assert.Equal(0ul, evicted.TileCount);
+        Assert.Equal(2ul, evicted.Evictions);
+
+        Assert.Equal(10f, GetGroundZ(TestMapId, 100f, 100f, 12f, 10f), 3);
+        Assert.True(GetSceneTileMemoryStats(TestMapId, out var reloaded));
+        Assert.Equal(1ul, reloaded.TileCount);
+        Assert.Equal(3ul, reloaded.Loads);
+    }
+
+    [SkippableFact]
+    public void MissingTile_IsRememberedOnce()
+    {
+        Skip.If(!_fixture.IsInitialized, "Physics engine not available");
+        string scenesDir = WriteTiles();
+
+        SetScenesDir(scenesDir);
+        UnloadSceneCache(TestMapId);
+
+        // Tile (33,32) has no file; repeated probes must not load or grow anything.
+        for (int i = 0; i < 3; i++)
+            GetGroundZ(TestMapId, -100f - i, 100f, 12f, 10f);
+
+        Assert.True(GetSceneTileMemoryStats(TestMapId, out var stats));
+        Assert.Equal(1ul, stats.MissingTiles);
+        Assert.Equal(0ul, stats.TileCount);
+        Assert.Equal(0ul, stats.Loads);
+    }
+
+    [SkippableFact]
+    public void Prefetch_LoadsTilesAheadOfTheBot()
+    {
+        Skip.If(!_fixture.IsInitialized, "Physics engine not available");
+        string scenesDir = WriteTiles();
+
+        SetScenesDir(scenesDir);
+        UnloadSceneCache(TestMapId);
+
+        // The first probe creates the streamed cache; prefetching near the tile
+        // edge then loads the neighbour in the background without a query.
+        Assert.Equal(10f, GetGroundZ(TestMapId, 100f, 100f, 12f, 10f), 3);
+        PrefetchSceneTiles(TestMapId, TileSize - 50f, 100f, 7f, 0f);
+
+        var sw = Stopwatch.StartNew();
+        SceneTileMemoryStats stats;
+        do
+        {
+            Assert.True(GetSceneTileMemoryStats(TestMapId, out stats));
+            if (stats.TileCount == 2)
+                break;
+            Thread.Sleep(10);
+        } while (sw.ElapsedMilliseconds < 5000);
+
+        _output.WriteLine($"prefetch: tiles={stats.TileCount} loads={stats.Loads} after {sw.ElapsedMilliseconds} ms");
+        Assert.Equal(2ul, stats.TileCount);
+        Assert.Equal(2ul, stats.Loads);
+        Assert.Equal(20f, GetGroundZ(TestMapId, TileSize + 100f, 100f, 22f, 10f), 3);
+    }
+
+    [SkippableFact]
+    public void AgentView_DoesNotPinEvictedTiles()
+    {
+        Skip.If(!_fixture.IsInitialized, "Physics engine not available");
+        string scenesDir = WriteTiles();
+        const ulong agentId = 0x7001A6u;
+
+        SetScenesDir(scenesDir);
+        UnloadSceneCache(TestMapId);
+        try
+        {
+            var input = new PhysicsInput
+            {
+                MapId = TestMapId,
+                X = 100f, Y = 100f, Z = 10.5f,
+                WalkSpeed = 2.5f, RunSpeed = 7f, RunBackSpeed = 4.5f,
+                SwimSpeed = 4.72f, SwimBackSpeed = 2.5f, FlightSpeed = 7f, TurnSpeed = 3.14159f,
+                Height = 2f, Radius = 0.4f,
+                FallStartZ = -200000f, PrevGroundZ = -200000f, StepUpBaseZ = -200000f,
+                DeltaTime = 0.05f,
+            };
+            var before = StepPhysicsV2ForAgent(agentId, ref input);
+            Assert.Equal(10f, before.GroundZ, 3);
+
+            // The agent's cached view copies its triangles, so the streamer
+            // can still unload the tile under it; the agent keeps stepping
+            // on the same floor.
+            SetSceneTileMemoryBudget(1);
+            Assert.True(GetSceneTileMemoryStats(TestMapId, out var evicted));
+            Assert.Equal(0ul, evicted.TileCount);
+
+            var after = StepPhysicsV2ForAgent(agentId, ref input);
+            Assert.Equal(StepPhysicsV2(ref input), after);
+            Assert.Equal(10f, after.GroundZ, 3);
+        }
+        finally
+        {
+            ReleasePhysicsAgent(agentId);
+        }
+    }
+
+    // Writes tiles (32,32) and (31,32) of TestMapId and returns the scenes directory.
+    private string WriteTiles()
+    {
+        string scenesDir = Path.Combine(_tempRoot, "scenes");
+        string tilesDir = Path.Combine(scenesDir, "tiles");
+        Directory.CreateDirectory(tilesDir);
+
+        WriteTile(tilesDir, 32, 32, 10f);
+        WriteTile(tilesDir, 31, 32, 20f);
+        return scenesDir + Path.DirectorySeparatorChar;
+    }
+
+    private static void WriteTile(string tilesDir, int tileX, int tileY, float z)
+    {
+        float minX = (32 - tileX) * TileSize;
+        float minY = (32 - tileY) * TileSize;
+        float maxX = minX + TileSize;
+        float maxY = minY + TileSize;
+        InjectedTriangle[] floor =
+        [
+            Tri(minX, minY, z, maxX, minY, z, maxX, maxY, z),
+            Tri(minX, minY, z, maxX, maxY, z, minX, maxY, z),
+        ];
+        string path = Path.Combine(tilesDir, $"{TestMapId}_{tileX:D2}_{tileY:D2}.scenetile");
+        Assert.True(WriteSceneCacheFile(TestMapId, path, minX, minY, maxX, maxY, floor, floor.Length));
+    }
+
+    private static InjectedTriangle Tri(float ax, float ay, float az, float bx, float by, float bz, float cx, float cy, float cz) =>
+        new()
+        {
+            V0X = ax, V0Y = ay, V0Z = az,
+            V1X = bx, V1Y = by, V1Z = bz,
+            V2X = cx, V2Y = cy, V2Z = cz,
+            SourceType = 1u,
+        };
+}
@@ -238,7 +238,7 @@ public class UndercityUpperDoorContactTests(PhysicsEngineFixture fixture, ITestO
             $"version={ReadSceneCacheVersion(legacyScenePath)}");
 
         Assert.True(traced);
-        Assert.Equal(2u, ReadSceneCacheVersion(legacyScenePath));
+        Assert.Equal(3u, ReadSceneCacheVersion(legacyScenePath));
         Assert.Equal(0u, trace.SelectedSourceType);
         Assert.Equal(0x00000004u, trace.SelectedInstanceFlags);
         Assert.Equal(0x00000004u, trace.SelectedModelFlags);
@@ -663,10 +663,19 @@ public class UndercityUpperDoorContactTests(PhysicsEngineFixture fixture, ITestO
 
     private static void WriteLegacySceneCacheVersion1(string path)
     {
-        const int headerSize = 64;
-        const int sceneTriSize = 44;
-        const int sceneTriMetadataSize = 28;
-        const int liquidCellSize = 12;
+        // Rewrites a freshly extracted v3 (sectioned, mappable, compact) cache
+        // as the original packed v1 layout: 64-byte header, triangles, grid,
+        // liquid. v3 triangles are decoded from the shared vertex buffer and
+        // the metadata table back into 44-byte SceneTri records.
+        const int sectionedHeaderFixedSize = 128;
+        const int sectionVertices = 0;
+        const int sectionTriangles = 1;
+        const int sectionMetadataTable = 2;
+        const int sectionCellStart = 3;
+        const int sectionCellCount = 4;
+        const int sectionTriIndices = 5;
+        const int sectionLiquid = 6;
+        const int metadataEntrySize = 28;
 
         byte[] allBytes = File.ReadAllBytes(path);
         using var input = new MemoryStream(allBytes, writable: false);
@@ -674,37 +683,81 @@ public class UndercityUpperDoorContactTests(PhysicsEngineFixture fixture, ITestO
 
         uint magic = reader.ReadUInt32();
         uint version = reader.ReadUInt32();
-        reader.ReadUInt32(); // mapId
-        uint triCount = reader.ReadUInt32();
-        reader.ReadSingle(); // cellSize
+        uint mapId = reader.ReadUInt32();
+        uint sectionCount = reader.ReadUInt32();
+        float cellSize = reader.ReadSingle();
+        float minX = reader.ReadSingle();
+        float minY = reader.ReadSingle();
+        float maxX = reader.ReadSingle();
+        float maxY = reader.ReadSingle();
         uint cellsX = reader.ReadUInt32();
         uint cellsY = reader.ReadUInt32();
-        uint triIdxCount = reader.ReadUInt32();
-        reader.ReadSingle(); // liquidCellSize
+        float liquidCellSize = reader.ReadSingle();
+        float liquidMinX = reader.ReadSingle();
+        float liquidMinY = reader.ReadSingle();
         uint liquidCellsX = reader.ReadUInt32();
         uint liquidCellsY = reader.ReadUInt32();
 
         Assert.Equal(0x454E4353u, magic);
-        Assert.Equal(2u, version);
+        Assert.Equal(3u, version);
 
-        int triangleBytes = checked((int)triCount * sceneTriSize);
-        int triangleMetadataBytes = checked((int)triCount * sceneTriMetadataSize);
-        int cellTotal = checked((int)(cellsX * cellsY));
-        int spatialBytes = checked((cellTotal * sizeof(uint) * 2) + ((int)triIdxCount * sizeof(uint)));
-        int liquidBytes = checked((2 * sizeof(float)) + ((int)(liquidCellsX * liquidCellsY) * liquidCellSize));
-        int spatialOffset = headerSize + triangleBytes + triangleMetadataBytes;
-        int expectedLength = checked(spatialOffset + spatialBytes + liquidBytes);
-
-        Assert.Equal(expectedLength, allBytes.Length);
+        input.Position = sectionedHeaderFixedSize;
+        var sections = new (long Offset, int Length)[sectionCount];
+        for (int i = 0; i < sectionCount; i++)
+        {
+            long offset = checked((long)reader.ReadUInt64());
+            uint count = reader.ReadUInt32();
+            uint elemSize = reader.ReadUInt32();
+            sections[i] = (offset, checked((int)(count * elemSize)));
+        }
 
-        byte[] header = allBytes[..headerSize].ToArray();
-        BitConverter.GetBytes(1u).CopyTo(header, sizeof(uint));
+        uint triCount = checked((uint)(sections[sectionTriangles].Length / 16));
+        uint triIdxCount = checked((uint)(sections[sectionTriIndices].Length / sizeof(uint)));
 
-        using var output = new MemoryStream(expectedLength - triangleMetadataBytes);
+        using var output = new MemoryStream();
         using var writer = new BinaryWriter(output);
-        writer.Write(header);
-        writer.Write(allBytes, headerSize, triangleBytes);
-        writer.Write(allBytes, spatialOffset, spatialBytes + liquidBytes);
+        writer.Write(magic);
+        writer.Write(1u);
+        writer.Write(mapId);
+        writer.Write(triCount);
+        writer.Write(cellSize);
+        writer.Write(cellsX);
+        writer.Write(cellsY);
+        writer.Write(triIdxCount);
+        writer.Write(liquidCellSize);
+        writer.Write(liquidCellsX);
+        writer.Write(liquidCellsY);
+        writer.Write(minX);
+        writer.Write(minY);
+        writer.Write(maxX);
+        writer.Write(maxY);
+        writer.Write(0u); // reserved
+
+        void WriteSection(int index) =>
+            writer.Write(allBytes, checked((int)sections[index].Offset), sections[index].Length);
+
+        for (int i = 0; i < triCount; i++)
+        {
+            input.Position = sections[sectionTriangles].Offset + i * 16L;
+            uint v0 = reader.ReadUInt32();
+            uint v1 = reader.ReadUInt32();
+            uint v2 = reader.ReadUInt32();
+            uint metadataIndex = reader.ReadUInt32();
+            foreach (uint vertexIndex in new[] { v0, v1, v2 })
+                writer.Write(allBytes, checked((int)(sections[sectionVertices].Offset + vertexIndex * 12L)), 12);
+
+            // sourceType + instanceId lead each metadata entry
+            writer.Write(allBytes,
+                checked((int)(sections[sectionMetadataTable].Offset + metadataIndex * (long)metadataEntrySize)), 8);
+        }
+
+        WriteSection(sectionCellStart);
+        WriteSection(sectionCellCount);
+        WriteSection(sectionTriIndices);
+        writer.Write(liquidMinX);
+        writer.Write(liquidMinY);
+        WriteSection(sectionLiquid);
+        writer.Flush();
         File.WriteAllBytes(path, output.ToArray());
     }
 
@@ -0,0 +1,61 @@
+using Xunit;
+using Xunit.Abstractions;
+using System;
+using System.IO;
+using System.Linq;
+using static Navigation.Physics.Tests.NavigationInterop;
+
+namespace Navigation.Physics.Tests;
+
+/// <summary>
+/// Converts every vmaps/*.vmo into the memory-mappable .vmm layout beside it
+/// through the ConvertVmapModels export that tools/NavDataConvert runs after
+/// VMAP data changes; the runtime maps a .vmm in place of parsing its .vmo
+/// and ignores one converted from a different .vmo.
+///
+/// dotnet test --filter "FullyQualifiedName~VmapModelConverter" --configuration Release -v n
+/// </summary>
+[Collection("PhysicsEngine")]
+public class VmapModelConverterTests
+{
+    private readonly ITestOutputHelper _output;
+
+    public VmapModelConverterTests(ITestOutputHelper output) => _output = output;
+
+    [Fact]
+    [Trait("Category", "VmapConversion")]
+    public void ConvertAllVmapModels()
+    {
+        var dataDir = Environment.GetEnvironmentVariable("WWOW_DATA_DIR");
+        if (string.IsNullOrEmpty(dataDir))
+        {
+            var candidates = new[]
+            {
+                @"E:\repos\Westworld of Warcraft\Data",
+                @"D:\MaNGOS\data",
+                @"D:\vmangos-server\data",
+            };
+            foreach (var c in candidates)
+                if (Directory.Exists(c)) { dataDir = c; break; }
+        }
+
+        var vmapsDir = string.IsNullOrEmpty(dataDir) ? null : Path.Combine(dataDir, "vmaps");
+        Skip.If(vmapsDir == null || !Directory.Exists(vmapsDir),
+            $"WWOW_DATA_DIR not set and no vmaps directory found");
+
+        var models = Directory.GetFiles(vmapsDir!, "*.vmo");
+        _output.WriteLine($"Converting {models.Length} models in {vmapsDir}");
+
+        var sw = System.Diagnostics.Stopwatch.StartNew();
+        int converted = ConvertVmapModels(vmapsDir!);
+        sw.Stop();
+        _output.WriteLine($"Converted {converted} models in {sw.Elapsed.TotalSeconds:F1}s");
+
+        var missing = models.Where(m => !File.Exists(Path.ChangeExtension(m, ".vmm"))).ToList();
+        foreach (var m in missing.Take(20))
+            _output.WriteLine($"  no .vmm for {Path.GetFileName(m)}");
+
+        Assert.Equal(models.Length, converted);
+        Assert.Empty(missing);
+    }
+}
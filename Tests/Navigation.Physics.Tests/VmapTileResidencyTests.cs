@@ -0,0 +1,178 @@
+using System;
+using System.Threading;
+using System.Threading.Tasks;
+using Xunit;
+using Xunit.Abstractions;
+using static Navigation.Physics.Tests.NavigationInterop;
+
+namespace Navigation.Physics.Tests;
+
+/// <summary>
+/// VMAP tile residency: an agent stepping through PhysicsStepV2ForAgent pins
+/// the tiles around it, releasing the agent lets a memory budget unload them,
+/// and an unloaded tile pages back in with the same collision results.
+/// An agent that stops stepping without being released loses its pins after
+/// the pin timeout. Batched queries page in the tiles they need before
+/// fanning out.
+/// </summary>
+[Collection("PhysicsEngine")]
+public sealed class VmapTileResidencyTests(PhysicsEngineFixture fixture, ITestOutputHelper output) : IDisposable
+{
+    private const ulong AgentId = 0x7E51Du;
+    private readonly PhysicsEngineFixture _fixture = fixture;
+    private readonly ITestOutputHelper _output = output;
+
+    public void Dispose()
+    {
+        if (!_fixture.IsInitialized)
+            return;
+        ReleasePhysicsAgent(AgentId);
+        SetVmapTileMemoryBudget(0);
+        SetVmapTilePinTimeout(60000);
+    }
+
+    [SkippableFact]
+    public void ReleasedAgentTiles_AreEvictedUnderBudget_AndPageBackIn()
+    {
+        Skip.If(!_fixture.IsInitialized, "Physics engine not available");
+
+        var start = WoWWorldCoordinates.Durotar.Orgrimmar.ValleyOfStrength;
+        float groundBefore = GetGroundZ(start.MapId, start.X, start.Y, start.Z + 5f, 50f);
+
+        var input = new PhysicsInput
+        {
+            MapId = start.MapId,
+            X = start.X, Y = start.Y, Z = start.Z,
+            WalkSpeed = 2.5f, RunSpeed = 7f, RunBackSpeed = 4.5f,
+            SwimSpeed = 4.72f, SwimBackSpeed = 2.5f, FlightSpeed = 7f, TurnSpeed = 3.14159f,
+            Height = 2f, Radius = 0.4f,
+            FallStartZ = -200000f, PrevGroundZ = -200000f, StepUpBaseZ = -200000f,
+            DeltaTime = 0.05f,
+        };
+        StepPhysicsV2ForAgent(AgentId, ref input);
+
+        Skip.If(!GetVmapTileMemoryStats(out var pinned) || pinned.TileCount == 0, "No VMAP tiles loaded");
+        _output.WriteLine($"pinned: tiles={pinned.TileCount} pinned={pinned.PinnedTiles} bytes={pinned.ResidentBytes}");
+        Assert.True(pinned.PinnedTiles > 0);
+
+        // A pinned tile survives any budget; once released it is evicted on
+        // the next step elsewhere.
+        SetVmapTileMemoryBudget(1);
+        ReleasePhysicsAgent(AgentId);
+        var elsewhere = input;
+        StepPhysicsV2(ref elsewhere);
+
+        Assert.True(GetVmapTileMemoryStats(out var trimmed));
+        _output.WriteLine($"trimmed: tiles={trimmed.TileCount} pinned={trimmed.PinnedTiles} bytes={trimmed.ResidentBytes} evictions={trimmed.Evictions}");
+        Assert.Equal(0ul, trimmed.PinnedTiles);
+        Assert.True(trimmed.Evictions > pinned.Evictions);
+
+        SetVmapTileMemoryBudget(0);
+        float groundAfter = GetGroundZ(start.MapId, start.X, start.Y, start.Z + 5f, 50f);
+        Assert.Equal(groundBefore, groundAfter, 3);
+    }
+
+    [SkippableFact]
+    public void IdleAgentPins_ExpireWithoutRelease()
+    {
+        Skip.If(!_fixture.IsInitialized, "Physics engine not available");
+
+        var start = WoWWorldCoordinates.Durotar.Orgrimmar.ValleyOfStrength;
+        var input = new PhysicsInput
+        {
+            MapId = start.MapId,
+            X = start.X, Y = start.Y, Z = start.Z,
+            WalkSpeed = 2.5f, RunSpeed = 7f, RunBackSpeed = 4.5f,
+            SwimSpeed = 4.72f, SwimBackSpeed = 2.5f, FlightSpeed = 7f, TurnSpeed = 3.14159f,
+            Height = 2f, Radius = 0.4f,
+            FallStartZ = -200000f, PrevGroundZ = -200000f, StepUpBaseZ = -200000f,
+            DeltaTime = 0.05f,
+        };
+        SetVmapTilePinTimeout(100);
+        StepPhysicsV2ForAgent(AgentId, ref input);
+
+        Skip.If(!GetVmapTileMemoryStats(out var pinned) || pinned.PinnedTiles == 0, "No VMAP tiles pinned");
+
+        // The agent is never released; once it has gone the timeout without
+        // a step, the next trim drops its pins and evicts its tiles.
+        SetVmapTileMemoryBudget(1);
+        Assert.True(GetVmapTileMemoryStats(out var held));
+        Assert.Equal(pinned.PinnedTiles, held.PinnedTiles);
+
+        Thread.Sleep(300);
+        var elsewhere = input;
+        StepPhysicsV2(ref elsewhere);
+
+        Assert.True(GetVmapTileMemoryStats(out var expired));
+        _output.WriteLine($"expired: tiles={expired.TileCount} pinned={expired.PinnedTiles} evictions={expired.Evictions}");
+        Assert.Equal(0ul, expired.PinnedTiles);
+        Assert.True(expired.Evictions > held.Evictions);
+    }
+
+    [SkippableFact]
+    public void BatchesOverEvictedTiles_FromSeveralThreads_MatchSingleQueries()
+    {
+        Skip.If(!_fixture.IsInitialized, "Physics engine not available");
+
+        // A grid spanning several tiles around the start, with segments
+        // crossing into their neighbours.
+        var start = WoWWorldCoordinates.Durotar.Orgrimmar.ValleyOfStrength;
+        const int side = 24;
+        const int count = side * side;
+        var points = new Vector3[count];
+        var targets = new Vector3[count];
+        var rng = new Random(47);
+        for (int i = 0; i < count; i++)
+        {
+            float x = start.X + (i % side - side / 2) * 50f;
+            float y = start.Y + (i / side - side / 2) * 50f;
+            points[i] = new Vector3(x, y, start.Z + 5f);
+            targets[i] = new Vector3(x + rng.NextSingle() * 80f - 40f, y + rng.NextSingle() * 80f - 40f, start.Z + rng.NextSingle() * 20f);
+        }
+
+        var expectedZ = new float[count];
+        var expectedClear = new bool[count];
+        for (int i = 0; i < count; i++)
+        {
+            expectedZ[i] = GetGroundZ(start.MapId, points[i].X, points[i].Y, points[i].Z, 50f);
+            expectedClear[i] = LineOfSight(start.MapId, points[i], targets[i]);
+        }
+        Skip.If(!GetVmapTileMemoryStats(out var loaded) || loaded.TileCount == 0, "No VMAP tiles loaded");
+
+        // Every step under a 1-byte budget unloads the tiles again, so each
+        // batch pages its tiles back in while the others' workers read.
+        var input = new PhysicsInput
+        {
+            MapId = start.MapId,
+            X = start.X, Y = start.Y, Z = start.Z,
+            WalkSpeed = 2.5f, RunSpeed = 7f, RunBackSpeed = 4.5f,
+            SwimSpeed = 4.72f, SwimBackSpeed = 2.5f, FlightSpeed = 7f, TurnSpeed = 3.14159f,
+            Height = 2f, Radius = 0.4f,
+            FallStartZ = -200000f, PrevGroundZ = -200000f, StepUpBaseZ = -200000f,
+            DeltaTime = 0.05f,
+        };
+        SetVmapTileMemoryBudget(1);
+
+        Parallel.For(0, 4, worker =>
+        {
+            var z = new float[count];
+            var clear = new byte[count];
+            for (int round = 0; round < 8; round++)
+            {
+                var step = input;
+                StepPhysicsV2(ref step);
+                Assert.True(GetGroundZBatch(start.MapId, points, count, 50f, z));
+                Assert.True(LineOfSightBatch(start.MapId, points, targets, count, clear));
+                for (int i = 0; i < count; i++)
+                {
+                    Assert.Equal(expectedZ[i], z[i]);
+                    Assert.Equal(expectedClear[i], clear[i] != 0);
+                }
+            }
+        });
+
+        Assert.True(GetVmapTileMemoryStats(out var after));
+        _output.WriteLine($"after: tiles={after.TileCount} evictions={after.Evictions} (before {loaded.Evictions})");
+        Assert.True(after.Evictions > loaded.Evictions);
+    }
+}
@@ -417,6 +417,107 @@ public sealed class SceneDataClientTests
         }
     }
 
+    [Fact]
+    public void EnsureSceneDataAround_RejectedTile_IsRequestedAgainAfterBackoff()
+    {
+        var now = new DateTime(2026, 4, 3, 12, 0, 0, DateTimeKind.Utc);
+        var requestedTiles = new List<(uint TX, uint TY)>();
+        var injectedTiles = new List<(uint TX, uint TY)>();
+        var rejectCenter = true;
+
+        try
+        {
+            SceneDataClient.TestUtcNowOverride = () => now;
+            SceneDataClient.TestSendTileRequestOverride = req =>
+            {
+                requestedTiles.Add((req.TileX, req.TileY));
+                return BuildCompressedTileResponse(req, CompressBytes(new byte[36]), CompressBytes(new byte[12]));
+            };
+            SceneDataClient.TestInjectTileOverride = (_, tx, ty, _) =>
+            {
+                if (rejectCenter && tx == 29u && ty == 41u)
+                    return false;
+                injectedTiles.Add((tx, ty));
+                return true;
+            };
+            SceneDataClient.TestSceneGenerationOverride = _ => 1ul;
+
+            var client = new SceneDataClient(NullLogger.Instance);
+
+            Assert.False(client.EnsureSceneDataAround(1, 1629f, -4373f));
+            Assert.Equal(9, requestedTiles.Count);
+            Assert.Equal(8, injectedTiles.Count);
+
+            rejectCenter = false;
+            requestedTiles.Clear();
+            injectedTiles.Clear();
+
+            // Still inside the retry window
+            Assert.False(client.EnsureSceneDataAround(1, 1629f, -4373f));
+            Assert.Empty(requestedTiles);
+
+            // Only the rejected tile was dropped from the cache
+            now = now.AddSeconds(3);
+            Assert.True(client.EnsureSceneDataAround(1, 1629f, -4373f));
+            Assert.Equal([(29u, 41u)], requestedTiles);
+            Assert.Equal([(29u, 41u)], injectedTiles);
+        }
+        finally
+        {
+            SceneDataClient.TestSendTileRequestOverride = null;
+            SceneDataClient.TestInjectTileOverride = null;
+            SceneDataClient.TestSceneGenerationOverride = null;
+            SceneDataClient.TestUtcNowOverride = null;
+        }
+    }
+
+    [Fact]
+    public void ResyncNativeTilesIfReset_ReinjectsOnlyTilesTheNativeCacheLost()
+    {
+        var injectedTiles = new List<(uint TX, uint TY)>();
+        ulong generation = 1;
+        var lostTile = (TX: 28u, TY: 40u);
+
+        try
+        {
+            SceneDataClient.TestSendTileRequestOverride = req =>
+                BuildCompressedTileResponse(req, CompressBytes(new byte[36]), CompressBytes(new byte[12]));
+            SceneDataClient.TestInjectTileOverride = (_, tx, ty, _) =>
+            {
+                injectedTiles.Add((tx, ty));
+                return true;
+            };
+            SceneDataClient.TestSceneGenerationOverride = _ => generation;
+            SceneDataClient.TestTileInjectedOverride = (_, tx, ty) => (tx, ty) != lostTile;
+
+            var client = new SceneDataClient(NullLogger.Instance);
+            Assert.True(client.EnsureSceneDataAround(1, 1629f, -4373f));
+            Assert.Equal(9, injectedTiles.Count);
+            injectedTiles.Clear();
+
+            // Native cache untouched since the last sync
+            client.ResyncNativeTilesIfReset(1);
+            Assert.Empty(injectedTiles);
+
+            // Something reset the map and one tile is gone
+            generation = 2;
+            client.ResyncNativeTilesIfReset(1);
+            Assert.Equal([lostTile], injectedTiles);
+
+            // The resync itself is not mistaken for another reset
+            injectedTiles.Clear();
+            client.ResyncNativeTilesIfReset(1);
+            Assert.Empty(injectedTiles);
+        }
+        finally
+        {
+            SceneDataClient.TestSendTileRequestOverride = null;
+            SceneDataClient.TestInjectTileOverride = null;
+            SceneDataClient.TestSceneGenerationOverride = null;
+            SceneDataClient.TestTileInjectedOverride = null;
+        }
+    }
+
     private static SceneTileResponse BuildCompressedTileResponse(
         SceneTileRequest request,
         ByteString triangleBytes,
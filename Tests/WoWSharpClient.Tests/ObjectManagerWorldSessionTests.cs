@@ -98,6 +98,35 @@ public class ObjectManagerWorldSessionTests
         Assert.NotSame(originalPlayer, objectManager.Player);
     }
 
+    [Fact]
+    public void ResetWorldSessionState_ReleasesNativePhysicsAgent()
+    {
+        var objectManager = WoWSharpObjectManager.Instance;
+        const ulong playerGuid = 0xAABBCCDDuL;
+        var released = new List<ulong>();
+
+        objectManager.Initialize(
+            _fixture._woWClient.Object,
+            _fixture._pathfindingClient.Object,
+            NullLogger<WoWSharpObjectManager>.Instance,
+            sceneDataClient: null,
+            useLocalPhysics: true);
+        objectManager.EnterWorld(playerGuid);
+        Assert.NotNull(GetPrivateField<MovementController>(objectManager, "_movementController"));
+
+        NativeLocalPhysics.TestReleaseAgentOverride = released.Add;
+        try
+        {
+            objectManager.ResetWorldSessionState("ResetWorldSessionState_ReleasesNativePhysicsAgent");
+        }
+        finally
+        {
+            NativeLocalPhysics.TestReleaseAgentOverride = null;
+        }
+
+        Assert.Equal([playerGuid], released);
+    }
+
     [Fact]
     public async Task EnterWorld_RetriesPendingPlayerLoginUntilWorldVerified()
     {
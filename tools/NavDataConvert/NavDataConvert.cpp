@@ -0,0 +1,57 @@
+// tools/NavDataConvert — offline rewrite of runtime data into mappable formats
+//
+// The runtime maps current-format data files in place and loads older ones
+// into private memory, but never rewrites them: other processes may be
+// mapping the same files. Run this once after the data changes.
+//
+// CLI
+//   NavDataConvert scenes <dir>   rewrite older <dir>/*.scene and
+//                                 <dir>/tiles/*.scenetile as .scene v3
+//   NavDataConvert vmaps <dir>    write a mappable .vmm beside every
+//                                 <dir>/*.vmo
+//
+// Links Navigation and calls its C exports, so the conversion is the one the
+// runtime's loaders agree with.
+
+#include <cstdio>
+#include <cstring>
+
+extern "C" int ConvertSceneCaches(const char* scenesDir);
+extern "C" int ConvertVmapModels(const char* vmapsDir);
+
+namespace
+{
+    void printUsage()
+    {
+        std::fprintf(stderr,
+            "Usage:\n"
+            "  NavDataConvert scenes <dir>\n"
+            "  NavDataConvert vmaps <dir>\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) { printUsage(); return 2; }
+
+    const char* mode = argv[1];
+    const char* dir = argv[2];
+    int converted = -1;
+    if (std::strcmp(mode, "scenes") == 0)
+        converted = ConvertSceneCaches(dir);
+    else if (std::strcmp(mode, "vmaps") == 0)
+        converted = ConvertVmapModels(dir);
+    else
+    {
+        printUsage();
+        return 2;
+    }
+
+    if (converted < 0)
+    {
+        std::fprintf(stderr, "[NavDataConvert] Directory not found: %s\n", dir);
+        return 3;
+    }
+    std::printf("[NavDataConvert] Rewrote %d files in %s\n", converted, dir);
+    return 0;
+}
@@ -353,8 +353,9 @@ internal static class Program
         // Altitude scan tuned for routine use. The original 1500→-50 step=25
         // range made 60+ GetGroundZ calls per sample (3,600 per tile run);
         // each call may force lazy VMAP init, so a tile took ~50min. The
-        // narrower 600→-100 step=50 range makes ~14 calls per sample (~840
-        // per tile run) while still covering 99% of map-0/map-1 terrain.
+        // narrower 600→-100 step=50 range probes 15 altitudes per sample,
+        // all in one GetGroundZBatch call, while still covering 99% of
+        // map-0/map-1 terrain.
         // Tiles whose surface is outside [-100, 600] (e.g. Hyjal at 1000+)
         // need an explicit --probe-altitude override (TODO) or accept that
         // those samples will fall back to Z=300 + FindPath snap.
@@ -367,13 +368,22 @@ internal static class Program
         var rng = new Random(seed);
         var pairs = new List<(Vector3, Vector3)>(count);
 
+        var probeCount = (int)((ProbeAltitudeMax - ProbeAltitudeMin) / ProbeStep) + 1;
+        var probes = new Vector3[probeCount];
+        var probeZ = new float[probeCount];
+
         Vector3 SnapToGround(float wx, float wy)
         {
-            for (var z = ProbeAltitudeMax; z >= ProbeAltitudeMin; z -= ProbeStep)
+            // Highest probe altitude that finds ground wins.
+            for (var k = 0; k < probeCount; k++)
+                probes[k] = new Vector3(wx, wy, ProbeAltitudeMax - k * ProbeStep);
+            if (GetGroundZBatch(mapId, probes, probeCount, SearchDistance, probeZ))
             {
-                var gz = GetGroundZ(mapId, wx, wy, z, SearchDistance);
-                if (gz > -100000f)
-                    return new Vector3(wx, wy, gz);
+                for (var k = 0; k < probeCount; k++)
+                {
+                    if (probeZ[k] > -100000f)
+                        return new Vector3(wx, wy, probeZ[k]);
+                }
             }
             return new Vector3(wx, wy, FallbackZ);
         }
@@ -32,15 +32,21 @@
 //                     [--spawns <path>]    default: gameobject_spawns/<variant>.json
 //                     [--vmaps <path>]     default: ./vmaps
 //                     [--out <dir>]        default: ./scene-cache
+//                     [--threads N]        default: hardware concurrency
 //                     [--silent]
 //
+// Model loading, spawn transforms and tile writes run on --threads workers.
+// Each tile's triangles are concatenated in spawn order, so the output files
+// are byte-identical whatever the thread count.
+//
 // The transform applied to every model triangle matches
-// DynamicObjectRegistry::RebuildWorldTriangles (Exports/Navigation):
+// DynamicObjectRegistry::DynamicObject::WorldTriangle (Exports/Navigation):
 // scale -> rotate around Z (orientation radians) -> translate.
 
 // MMAP_GENERATOR is defined by CMake (see tools/MmapGen/CMakeLists.txt).
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <cstdio>
@@ -53,6 +59,7 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -92,6 +99,15 @@ namespace
         std::vector<uint32_t> indices;
     };
 
+    // One spawn's world-space triangles (9 floats each) and the inclusive
+    // tile range its AABB covers.
+    struct SpawnTriangles
+    {
+        std::vector<float> packed;
+        int tileXMin = 0, tileXMax = -1;
+        int tileYMin = 0, tileYMax = -1;
+    };
+
     struct ProgramOptions
     {
         uint32_t mapId = UINT32_MAX;
@@ -100,6 +116,7 @@ namespace
         std::string spawnsPath;
         std::string vmapsDir = "vmaps";
         std::string outputDir = "scene-cache";
+        unsigned threads = 0;                       // 0 = hardware concurrency
         bool silent = false;
     };
 
@@ -108,13 +125,15 @@ namespace
         std::cerr <<
             "Usage:\n"
             "  SceneCacheBuilder <mapId> [--variant <name>] [--tile X,Y[;X,Y...]]\n"
-            "                    [--spawns <path>] [--vmaps <path>] [--out <dir>] [--silent]\n"
+            "                    [--spawns <path>] [--vmaps <path>] [--out <dir>]\n"
+            "                    [--threads N] [--silent]\n"
             "\n"
             "Defaults:\n"
             "  --variant base\n"
             "  --spawns  gameobject_spawns/<variant>.json\n"
             "  --vmaps   ./vmaps\n"
-            "  --out     ./scene-cache\n";
+            "  --out     ./scene-cache\n"
+            "  --threads hardware concurrency\n";
     }
 
     bool parseTileList(const std::string& s, std::set<std::pair<int, int>>& out)
@@ -138,6 +157,35 @@ namespace
         return !out.empty();
     }
 
+    // Run fn(i) for i in [0, count) on up to `threads` workers (the calling
+    // thread included). Items are claimed through a shared counter; callers
+    // write results into per-item slots so the order of completion is moot.
+    template <typename Fn>
+    void parallelFor(size_t count, unsigned threads, Fn&& fn)
+    {
+        threads = (unsigned)std::min<size_t>(std::max(1u, threads), count);
+        if (threads <= 1)
+        {
+            for (size_t i = 0; i < count; ++i)
+                fn(i);
+            return;
+        }
+
+        std::atomic<size_t> next{ 0 };
+        auto worker = [&]()
+        {
+            for (size_t i = next++; i < count; i = next++)
+                fn(i);
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t)
+            pool.emplace_back(worker);
+        worker();
+        for (auto& th : pool)
+            th.join();
+    }
+
     bool loadDisplayIdMapping(const std::string& vmapsBasePath,
                               std::unordered_map<uint32_t, DisplayInfo>& out)
     {
@@ -291,9 +339,7 @@ namespace
     inline int worldYtoTileX(float wy) { return (int)std::floor((ORIGIN - wy) / GRID_SIZE); }
     inline int worldXtoTileY(float wx) { return (int)std::floor((ORIGIN - wx) / GRID_SIZE); }
 
-    void appendTriangles(const Spawn& spawn, const ModelMesh& mesh,
-                         const DisplayInfo& display,
-                         std::map<std::pair<int, int>, std::vector<float>>& tilesOut)
+    void transformSpawn(const Spawn& spawn, const ModelMesh& mesh, SpawnTriangles& out)
     {
         const float cosO = std::cos(spawn.orientation);
         const float sinO = std::sin(spawn.orientation);
@@ -319,14 +365,8 @@ namespace
             }
         }
 
-        // Tile range from world AABB (X/Y; vertical Z is irrelevant).
-        const int tileXMin = std::max(0, std::min(63, worldYtoTileX(worldMax.y)));
-        const int tileXMax = std::max(0, std::min(63, worldYtoTileX(worldMin.y)));
-        const int tileYMin = std::max(0, std::min(63, worldXtoTileY(worldMax.x)));
-        const int tileYMax = std::max(0, std::min(63, worldXtoTileY(worldMin.x)));
-
         // Pre-pack triangles into a flat float array (9 per tri).
-        std::vector<float> packed;
+        std::vector<float>& packed = out.packed;
         packed.reserve(mesh.indices.size() * 3);
         for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
         {
@@ -338,19 +378,13 @@ namespace
             packed.push_back(c.x); packed.push_back(c.y); packed.push_back(c.z);
         }
         if (packed.empty())
-        {
-            (void)display;  // not currently used for filtering; reserved for future bbox-based skip
             return;
-        }
 
-        for (int ty = tileYMin; ty <= tileYMax; ++ty)
-        {
-            for (int tx = tileXMin; tx <= tileXMax; ++tx)
-            {
-                auto& bucket = tilesOut[{tx, ty}];
-                bucket.insert(bucket.end(), packed.begin(), packed.end());
-            }
-        }
+        // Tile range from world AABB (X/Y; vertical Z is irrelevant).
+        out.tileXMin = std::max(0, std::min(63, worldYtoTileX(worldMax.y)));
+        out.tileXMax = std::max(0, std::min(63, worldYtoTileX(worldMin.y)));
+        out.tileYMin = std::max(0, std::min(63, worldXtoTileY(worldMax.x)));
+        out.tileYMax = std::max(0, std::min(63, worldXtoTileY(worldMin.x)));
     }
 
     bool writeSceneCache(const std::string& path,
@@ -408,6 +442,11 @@ namespace
             else if (a == "--spawns" && i + 1 < argc) { opts.spawnsPath = argv[++i]; }
             else if (a == "--vmaps"  && i + 1 < argc) { opts.vmapsDir   = argv[++i]; }
             else if (a == "--out"    && i + 1 < argc) { opts.outputDir  = argv[++i]; }
+            else if (a == "--threads" && i + 1 < argc)
+            {
+                try { opts.threads = (unsigned)std::stoul(argv[++i]); }
+                catch (...) { std::cerr << "Invalid --threads value\n"; return false; }
+            }
             else if (a == "--silent") { opts.silent = true; }
             else if (a == "--help" || a == "-h") { printUsage(); std::exit(0); }
             else if (!a.empty() && a[0] == '-')
@@ -434,6 +473,8 @@ namespace
         }
         if (opts.spawnsPath.empty())
             opts.spawnsPath = "gameobject_spawns/" + opts.variant + ".json";
+        if (opts.threads == 0)
+            opts.threads = std::max(1u, std::thread::hardware_concurrency());
         return true;
     }
 }
@@ -448,7 +489,8 @@ int main(int argc, char** argv)
                   << " variant=" << opts.variant
                   << " spawns=" << opts.spawnsPath
                   << " vmaps=" << opts.vmapsDir
-                  << " out=" << opts.outputDir << "\n";
+                  << " out=" << opts.outputDir
+                  << " threads=" << opts.threads << "\n";
 
     std::unordered_map<uint32_t, DisplayInfo> displayMap;
     if (!loadDisplayIdMapping(opts.vmapsDir, displayMap))
@@ -470,55 +512,97 @@ int main(int argc, char** argv)
         std::cout << "[SceneCacheBuilder] Loaded " << spawns.size()
                   << " spawns for map " << opts.mapId << "\n";
 
-    // Lazy-load + cache models. Skip displayIds whose model is unresolvable.
-    std::unordered_map<std::string, std::shared_ptr<ModelMesh>> meshCache;
-    std::map<std::pair<int, int>, std::vector<float>> tilesOut;
-    int processed = 0, skipped = 0;
-    for (const Spawn& spawn : spawns)
+    // Resolve each spawn's model; models get indices in first-use order.
+    std::unordered_map<std::string, size_t> modelIndex;
+    std::vector<std::string> modelNames;
+    std::vector<uint32_t> modelFirstDisplayId;
+    std::vector<size_t> spawnModel(spawns.size(), SIZE_MAX);
+    for (size_t si = 0; si < spawns.size(); ++si)
     {
-        auto it = displayMap.find(spawn.displayId);
-        if (it == displayMap.end()) { ++skipped; continue; }
+        auto it = displayMap.find(spawns[si].displayId);
+        if (it == displayMap.end()) continue;
 
         const std::string& modelName = it->second.modelName;
-        auto mit = meshCache.find(modelName);
-        if (mit == meshCache.end())
+        auto [mit, inserted] = modelIndex.emplace(modelName, modelNames.size());
+        if (inserted)
         {
-            auto mesh = loadVmoModel(opts.vmapsDir, modelName);
-            mit = meshCache.emplace(modelName, mesh).first;
-            if (!mesh && !opts.silent)
-                std::cout << "[SceneCacheBuilder] (no .vmo for displayId="
-                          << spawn.displayId << " model=" << modelName << ")\n";
+            modelNames.push_back(modelName);
+            modelFirstDisplayId.push_back(spawns[si].displayId);
         }
-        if (!mit->second) { ++skipped; continue; }
+        spawnModel[si] = mit->second;
+    }
 
-        appendTriangles(spawn, *mit->second, it->second, tilesOut);
+    // Load every referenced model once. Skip displayIds whose model is unresolvable.
+    std::vector<std::shared_ptr<ModelMesh>> meshes(modelNames.size());
+    parallelFor(modelNames.size(), opts.threads, [&](size_t mi)
+    {
+        meshes[mi] = loadVmoModel(opts.vmapsDir, modelNames[mi]);
+    });
+    if (!opts.silent)
+    {
+        for (size_t mi = 0; mi < modelNames.size(); ++mi)
+            if (!meshes[mi])
+                std::cout << "[SceneCacheBuilder] (no .vmo for displayId="
+                          << modelFirstDisplayId[mi] << " model=" << modelNames[mi] << ")\n";
+    }
+
+    // Transform spawns into world space.
+    std::vector<SpawnTriangles> spawnTris(spawns.size());
+    parallelFor(spawns.size(), opts.threads, [&](size_t si)
+    {
+        if (spawnModel[si] != SIZE_MAX && meshes[spawnModel[si]])
+            transformSpawn(spawns[si], *meshes[spawnModel[si]], spawnTris[si]);
+    });
+
+    // Bucket spawn indices per tile (ascending, i.e. spawn order), applying
+    // the --tile filter if given.
+    std::map<std::pair<int, int>, std::vector<size_t>> tileSpawns;
+    int processed = 0, skipped = 0;
+    for (size_t si = 0; si < spawns.size(); ++si)
+    {
+        if (spawnModel[si] == SIZE_MAX || !meshes[spawnModel[si]]) { ++skipped; continue; }
         ++processed;
+
+        const SpawnTriangles& st = spawnTris[si];
+        for (int ty = st.tileYMin; ty <= st.tileYMax; ++ty)
+        {
+            for (int tx = st.tileXMin; tx <= st.tileXMax; ++tx)
+            {
+                if (!opts.tileFilter.empty() && !opts.tileFilter.count({ tx, ty }))
+                    continue;
+                tileSpawns[{tx, ty}].push_back(si);
+            }
+        }
     }
 
     if (!opts.silent)
         std::cout << "[SceneCacheBuilder] Processed " << processed
                   << " spawns, skipped " << skipped
-                  << " (model missing). Cached " << meshCache.size() << " models.\n";
-
-    // Apply --tile filter if given.
-    if (!opts.tileFilter.empty())
-    {
-        std::map<std::pair<int, int>, std::vector<float>> filtered;
-        for (auto& kv : tilesOut)
-            if (opts.tileFilter.count(kv.first))
-                filtered.emplace(kv.first, std::move(kv.second));
-        tilesOut.swap(filtered);
-    }
+                  << " (model missing). Cached " << modelNames.size() << " models.\n";
 
     fs::create_directories(opts.outputDir);
-    int filesWritten = 0;
-    uint64_t totalTris = 0;
-    for (auto& kv : tilesOut)
+    std::vector<std::pair<std::pair<int, int>, const std::vector<size_t>*>> tiles;
+    tiles.reserve(tileSpawns.size());
+    for (const auto& kv : tileSpawns)
+        tiles.emplace_back(kv.first, &kv.second);
+
+    std::atomic<int> filesWritten{ 0 };
+    std::atomic<uint64_t> totalTris{ 0 };
+    std::atomic<bool> writeFailed{ false };
+    parallelFor(tiles.size(), opts.threads, [&](size_t i)
     {
-        const int tx = kv.first.first;
-        const int ty = kv.first.second;
-        const auto& triFloats = kv.second;
-        if (triFloats.empty()) continue;
+        if (writeFailed) return;
+        const int tx = tiles[i].first.first;
+        const int ty = tiles[i].first.second;
+
+        std::vector<float> triFloats;
+        size_t floatCount = 0;
+        for (size_t si : *tiles[i].second)
+            floatCount += spawnTris[si].packed.size();
+        if (floatCount == 0) return;
+        triFloats.reserve(floatCount);
+        for (size_t si : *tiles[i].second)
+            triFloats.insert(triFloats.end(), spawnTris[si].packed.begin(), spawnTris[si].packed.end());
 
         char nameBuf[64];
         std::snprintf(nameBuf, sizeof(nameBuf), "%03u%02d%02d.%s.scenecache",
@@ -526,14 +610,19 @@ int main(int argc, char** argv)
         std::string outPath = opts.outputDir + "/" + nameBuf;
 
         if (!writeSceneCache(outPath, opts.mapId, tx, ty, opts.variant, triFloats))
-            return 5;
+        {
+            writeFailed = true;
+            return;
+        }
         ++filesWritten;
         totalTris += triFloats.size() / 9;
-    }
+    });
+    if (writeFailed)
+        return 5;
 
     if (!opts.silent)
-        std::cout << "[SceneCacheBuilder] Wrote " << filesWritten
-                  << " tile files (" << totalTris << " triangles total) for map="
+        std::cout << "[SceneCacheBuilder] Wrote " << filesWritten.load()
+                  << " tile files (" << totalTris.load() << " triangles total) for map="
                   << opts.mapId << " variant=" << opts.variant << " to "
                   << opts.outputDir << "\n";
     return 0;